@@ -191,6 +191,7 @@ namespace fow {
 
     class FOW_ENGINE_API ModelRendererComponent : public Component {
         ModelPtr m_pModel;
+        ModelInstancePtr m_pInstance;
     public:
         FOW_COMPONENT_CLASS(ModelRendererComponent, Component)
 
@@ -6,6 +6,15 @@
 #include "UI.hpp"
 #include "fow/Renderer/Sprite.hpp"
 
+// RenderQueue2D layer the widgets are drawn on, above the sprites of the scene on layer zero.
+#ifndef FOW_UI_RENDER_LAYER
+    #define FOW_UI_RENDER_LAYER 1000
+#endif
+// Times a frame records its widgets in one render at most, when recording text keeps evicting glyphs of the frame.
+#ifndef FOW_UI_RECORD_PASSES
+    #define FOW_UI_RECORD_PASSES 3
+#endif
+
 namespace fow::UI {
     class Frame;
     using FramePtr = Ref<Frame>;
@@ -74,9 +83,40 @@ namespace fow::UI {
         static Result<ThemePtr> LoadAsset(const Path& path, AssetLoaderFlags::Type flags);
     };
 
+    // Keeps what the widgets drew until they change. Widgets are recorded again only once they are dirty, their quads
+    // stay in sprite batches that live over frames and only the vertices of changed widgets are rewritten and uploaded.
+    // A frame that does not change enqueues one draw per run of batchable widgets and does no other work.
     class FOW_ENGINE_API Frame {
+        // Quads of consecutive retained widgets, drawn with the batch shader as one drawable.
+        class Segment final : public IDrawable2D {
+            mutable SpriteBatch2D m_Batch;
+        public:
+            Segment() : m_Batch(&TextureAtlas::Instance()) { }
+
+            void draw_2d(const Rectangle& rect) const override { m_Batch.submit(); }
+            [[nodiscard]] inline SpriteBatch2D& batch() { return m_Batch; }
+        };
+        // Either a segment or a widget that is enqueued sprite by sprite.
+        struct Item {
+            Ref<Segment> segment;
+            const Widget* widget;
+        };
+        struct Placement {
+            size_t segment;
+            size_t first_quad;
+        };
+
         Vector<WidgetPtr> m_Widgets;
         ThemePtr m_pTheme;
+        Vector<Ref<Segment>> m_Segments;
+        Vector<Item> m_Items;
+        Vector<Placement> m_Placements;                 // Where the quads of each widget are, by widget index
+        SpriteBatch2D m_Recorder;                       // Collects the quads of a widget while it is recorded
+        const Texture* m_pGlyphTexture = nullptr;
+        uint32_t m_uGlyphGeneration = 0;
+        uint32_t m_uAtlasRevision = 0;
+        bool m_bDirty = true;                           // A widget has to be recorded again
+        bool m_bLayoutDirty = true;                     // Widgets were added, removed or drew a different number of quads
     public:
         explicit Frame(const ThemePtr& theme) : m_pTheme(theme) { }
         explicit Frame(ThemePtr&& theme) : m_pTheme(std::move(theme)) { }
@@ -85,9 +125,19 @@ namespace fow::UI {
 
         void add_widget(const WidgetPtr& widget);
         void remove_widget(const WidgetPtr& widget);
+        // Records every widget again, for changes the widgets cannot notice, e.g. to sprites shared by a theme.
+        void invalidate();
 
         void update(double dt) const;
-        void render() const;
+        // Records the dirty widgets and enqueues the frame into the RenderQueue2D, drawn with it.
+        void render();
+        // Deletes the GL objects of the segments, the next render builds them again. Needed before the context is gone.
+        void release();
+    private:
+        void record_widgets();
+        void build_segments();
+
+        friend class Widget;
     };
 
     class FOW_ENGINE_API Widget {
@@ -96,6 +146,11 @@ namespace fow::UI {
         bool m_bVisible = true;
         bool m_bEnabled = true;
         bool m_bMouseInside = false;
+        // Sprites of the last on_draw, with the quads they batched into while every one of them could be batched.
+        Vector<std::pair<Ref<IDrawable2D>, Rectangle>> m_Drawables;
+        Vector<SpriteQuad> m_Quads;
+        bool m_bRetained = true;
+        mutable bool m_bDirty = true;
     public:
         virtual ~Widget() = default;
 
@@ -123,7 +178,20 @@ namespace fow::UI {
         [[nodiscard]] FOW_CONSTEXPR bool is_enabled() const { return m_bEnabled; }
         [[nodiscard]] FOW_CONSTEXPR bool is_mouse_over() const { return m_bMouseInside; }
 
+        // Has the frame call on_draw again before the next render, everything that changes how the widget looks calls it.
+        void mark_dirty() const;
+        [[nodiscard]] FOW_CONSTEXPR bool is_dirty() const { return m_bDirty; }
+        // False while a sprite of the widget cannot be batched, the widget is then enqueued sprite by sprite every frame.
+        [[nodiscard]] FOW_CONSTEXPR bool is_retained() const { return m_bRetained; }
+
         [[nodiscard]] FOW_CONSTEXPR const FramePtr& frame() const { return m_pFrame; }
+    protected:
+        // Draws the sprite into the area of the widget, called by on_draw.
+        void draw(const Ref<IDrawable2D>& sprite);
+    private:
+        void record(SpriteBatch2D& recorder);
+
+        friend class Frame;
     };
 
     class FOW_ENGINE_API Panel : public Widget {
@@ -190,7 +258,7 @@ namespace fow::UI {
 
         FOW_ABSTRACT(bool is_toggle() const);
 
-        virtual void set_pressed(const bool value) { m_bPressed = value; }
+        virtual void set_pressed(const bool value) { m_bPressed = value; mark_dirty(); }
 
         virtual void on_clicked();
         virtual void on_pressed() { }
@@ -248,9 +316,9 @@ namespace fow::UI {
         explicit CheckBox(const FramePtr& frame) : BaseButton(frame), m_Theme(frame->theme()->CheckBox), m_bChecked(false), m_bSelected(false) { }
 
         [[nodiscard]] FOW_CONSTEXPR const CheckBoxTheme& theme() const { return m_Theme; }
-        void set_theme(const CheckBoxTheme& theme) { m_Theme = theme; }
+        void set_theme(const CheckBoxTheme& theme) { m_Theme = theme; mark_dirty(); }
 
-        void set_checked(const bool checked) { m_bChecked = checked; }
+        void set_checked(const bool checked) { m_bChecked = checked; update_sprite(); }
         [[nodiscard]] FOW_CONSTEXPR bool is_checked() const { return m_bChecked; }
         [[nodiscard]] FOW_CONSTEXPR bool is_toggle() const override { return true; }
 
@@ -1,15 +1,26 @@
 #ifndef FOW_RENDERER_HPP
 #define FOW_RENDERER_HPP
 
+#include "fow/Renderer/GlStateCache.hpp"
 #include "fow/Renderer/Texture.hpp"
 #include "fow/Renderer/Shader.hpp"
+#include "fow/Renderer/ProgramCache.hpp"
+#include "fow/Renderer/ShaderVariant.hpp"
+#include "fow/Renderer/ShaderBatch.hpp"
+#include "fow/Renderer/ShaderBundle.hpp"
 #include "fow/Renderer/Material.hpp"
 #include "fow/Renderer/Mesh.hpp"
 #include "fow/Renderer/Model.hpp"
+#include "fow/Renderer/Impostor.hpp"
 #include "fow/Renderer/Skybox.hpp"
+#include "fow/Renderer/GlyphAtlas.hpp"
+#include "fow/Renderer/TextLayout.hpp"
+#include "fow/Renderer/TextureAtlas.hpp"
+#include "fow/Renderer/SpriteBatch.hpp"
 #include "fow/Renderer/Sprite.hpp"
 #include "fow/Renderer/Debug.hpp"
 #include "fow/Renderer/RenderQueue.hpp"
+#include "fow/Renderer/UploadQueue.hpp"
 
 namespace fow {
     enum class BlendFactor : GLenum {
@@ -0,0 +1,115 @@
+#ifndef FOW_RENDERER_GL_STATE_CACHE_HPP
+#define FOW_RENDERER_GL_STATE_CACHE_HPP
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Shared.hpp"
+
+#include <array>
+
+#define FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS 32
+
+namespace fow {
+    // Entry points the state cache forwards to, replaceable to record calls without a GL context.
+    struct FOW_RENDER_API GlFunctionTable {
+        void (*use_program)(GLuint program);
+        void (*bind_vertex_array)(GLuint vao);
+        void (*active_texture)(GLenum unit);
+        void (*bind_texture)(GLenum target, GLuint texture);
+        void (*bind_sampler)(GLuint unit, GLuint sampler);
+        void (*enable)(GLenum capability);
+        void (*disable)(GLenum capability);
+        void (*blend_func)(GLenum src, GLenum dst);
+        void (*depth_func)(GLenum func);
+        void (*depth_mask)(GLboolean enabled);
+        void (*cull_face)(GLenum mode);
+        void (*stencil_func)(GLenum func, GLint ref, GLuint mask);
+        void (*stencil_op)(GLenum stencil_fail, GLenum depth_fail, GLenum depth_pass);
+        void (*stencil_mask)(GLuint mask);
+        void (*bind_framebuffer)(GLenum target, GLuint framebuffer);
+
+        static GlFunctionTable Default();
+    };
+
+    struct GlStateCacheStats {
+        uint64_t forwarded_calls = 0;
+        uint64_t avoided_calls = 0;
+    };
+
+    class FOW_RENDER_API GlStateCache {
+        static constexpr GLuint Unknown = ~0u;
+
+        enum CapabilityIndex : uint8_t {
+            CapabilityBlend,
+            CapabilityCullFace,
+            CapabilityDepthTest,
+            CapabilityStencilTest,
+            CapabilityScissorTest,
+            CapabilityMultisample,
+            CapabilityCount
+        };
+        struct TextureBinding {
+            GLenum target = Unknown;
+            GLuint texture = Unknown;
+        };
+
+        GlFunctionTable m_functions;
+        GlStateCacheStats m_stats;
+
+        GLuint m_uProgram;
+        GLuint m_uVertexArray;
+        GLuint m_uDrawFramebuffer;
+        GLuint m_uReadFramebuffer;
+        GLenum m_eActiveTexture;
+        std::array<TextureBinding, FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS> m_textures;
+        std::array<GLuint, FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS> m_samplers;
+        std::array<int8_t, CapabilityCount> m_capabilities;
+        GLenum m_eBlendSrc, m_eBlendDst;
+        GLenum m_eDepthFunc;
+        int8_t m_iDepthMask;
+        GLenum m_eCullFace;
+        GLenum m_eStencilFunc;
+        GLint m_iStencilRef;
+        GLuint m_uStencilFuncMask;
+        GLenum m_eStencilFail, m_eStencilDepthFail, m_eStencilDepthPass;
+        GLuint m_uStencilWriteMask;
+    public:
+        explicit GlStateCache(const GlFunctionTable& functions = GlFunctionTable::Default());
+
+        void use_program(GLuint program);
+        void bind_vertex_array(GLuint vao);
+        void bind_texture(GLuint unit, GLenum target, GLuint texture);
+        void bind_texture(GLenum target, GLuint texture);
+        void bind_sampler(GLuint unit, GLuint sampler);
+        void set_enabled(GLenum capability, bool enabled);
+        void set_blend_func(GLenum src, GLenum dst);
+        void set_depth_func(GLenum func);
+        void set_depth_mask(bool enabled);
+        void set_cull_face(GLenum mode);
+        void set_stencil_func(GLenum func, GLint ref, GLuint mask);
+        void set_stencil_op(GLenum stencil_fail, GLenum depth_fail, GLenum depth_pass);
+        void set_stencil_mask(GLuint mask);
+        void bind_framebuffer(GLenum target, GLuint framebuffer);
+
+        // GL silently unbinds deleted objects, so the cache has to forget them before their names are reused.
+        void forget_program(GLuint program);
+        void forget_vertex_array(GLuint vao);
+        void forget_texture(GLuint texture);
+        void forget_sampler(GLuint sampler);
+        void forget_framebuffer(GLuint framebuffer);
+
+        // Marks every state as unknown, call after code that changes GL state behind the cache's back.
+        void invalidate();
+
+        [[nodiscard]] FOW_CONSTEXPR const GlStateCacheStats& stats() const { return m_stats; }
+        FOW_CONSTEXPR void reset_stats() { m_stats = { }; }
+
+        static GlStateCache& Instance();
+    private:
+        [[nodiscard]] static int CapabilityToIndex(GLenum capability);
+        void set_active_texture(GLuint unit);
+        FOW_CONSTEXPR bool forward() { ++m_stats.forwarded_calls; return true; }
+        FOW_CONSTEXPR bool avoid() { ++m_stats.avoided_calls; return false; }
+    };
+}
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef FOW_RENDERER_GLYPH_ATLAS_HPP
+#define FOW_RENDERER_GLYPH_ATLAS_HPP
+
+#include <string_view>
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/Texture.hpp"
+
+#ifndef FOW_GLYPH_ATLAS_PAGE_SIZE
+    #define FOW_GLYPH_ATLAS_PAGE_SIZE 1024
+#endif
+#ifndef FOW_GLYPH_ATLAS_MAX_PAGES
+    #define FOW_GLYPH_ATLAS_MAX_PAGES 8
+#endif
+// Empty texels kept around every glyph, so bilinear filtering never reads the neighbour.
+#ifndef FOW_GLYPH_ATLAS_PADDING
+    #define FOW_GLYPH_ATLAS_PADDING 1
+#endif
+// Distance in texels of the bucket size that the SDF covers on each side of an outline.
+#ifndef FOW_GLYPH_SDF_SPREAD
+    #define FOW_GLYPH_SDF_SPREAD 8
+#endif
+#ifndef FOW_GLYPH_SDF_MIN_SIZE
+    #define FOW_GLYPH_SDF_MIN_SIZE 16
+#endif
+#ifndef FOW_GLYPH_SDF_MAX_SIZE
+    #define FOW_GLYPH_SDF_MAX_SIZE 128
+#endif
+
+namespace fow {
+    class Font;
+
+    // Packs rectangles bottom-left first along the skyline of the rectangles placed so far. Cheap enough to add glyphs
+    // one at a time as text needs them, which offline packers like MaxRects are not built for.
+    class FOW_RENDER_API SkylinePacker {
+        struct Node {
+            int x, y, width;
+        };
+
+        Vector2i m_size;
+        Vector<Node> m_skyline;
+        int64_t m_iUsedArea;
+    public:
+        explicit SkylinePacker(const Vector2i& size = { 0, 0 });
+
+        // Top left corner of the placed rectangle, none when it does not fit anymore.
+        [[nodiscard]] Option<Vector2i> pack(const Vector2i& size);
+        void reset(const Vector2i& size);
+
+        [[nodiscard]] FOW_CONSTEXPR const Vector2i& size() const { return m_size; }
+        // Share of the area covered by packed rectangles, the space wasted below the skyline is not counted.
+        [[nodiscard]] float occupancy() const;
+    private:
+        // Y the rectangle would be placed at when its left edge is at the node, none when it does not fit there.
+        [[nodiscard]] Option<int> fit(size_t index, const Vector2i& size) const;
+    };
+
+    // Decodes UTF-8, every malformed sequence decodes to U+FFFD and decoding resumes at the next byte.
+    FOW_RENDER_API Vector<char32_t> DecodeUtf8(std::string_view text);
+    // Decodes the codepoint starting at the offset and moves the offset past it, the offset has to be inside the text.
+    FOW_RENDER_API char32_t DecodeUtf8Next(std::string_view text, size_t& offset);
+    // Glyphs are rasterized at the next power of two of the font size, clamped to the SDF size limits. Text of any
+    // size in between scales the distance field of the bucket.
+    FOW_RENDER_API uint32_t GlyphSizeBucket(float pixel_size);
+
+    struct GlyphKey {
+        uint32_t font;
+        uint32_t glyph;
+        uint32_t bucket;
+
+        FOW_CONSTEXPR bool operator==(const GlyphKey& other) const = default;
+    };
+    struct GlyphKeyHash {
+        size_t operator()(const GlyphKey& key) const noexcept {
+            return std::hash<uint64_t> { }((static_cast<uint64_t>(key.font) << 40) ^ (static_cast<uint64_t>(key.bucket) << 32) ^ key.glyph);
+        }
+    };
+
+    // Metrics are in pixels of the bucket size, the bearing and size include the SDF spread.
+    struct AtlasGlyph {
+        Vector2 uv_min { 0.0f };
+        Vector2 uv_max { 0.0f };
+        uint32_t page = 0;
+        Vector2 bearing { 0.0f };       // From the pen position on the baseline to the top left corner, y up
+        Vector2 size { 0.0f };          // Zero for glyphs without an outline, e.g. spaces
+        float advance = 0.0f;
+    };
+
+    // One glyph placed by a text layout, in pixels from the top left of the text area.
+    struct GlyphQuad {
+        Vector2 min, max;
+        Vector2 uv_min, uv_max;
+        uint32_t page;
+    };
+
+    // Signed distance fields of every glyph used by any text, shared by all fonts. Glyphs are rasterized once per
+    // (font, glyph, size bucket) with FreeType's SDF renderer and packed into the layers of one texture array. The array
+    // grows a layer at a time, when the last layer is full the atlas is cleared and generation() changes so text lays
+    // itself out again.
+    class FOW_RENDER_API GlyphAtlas {
+        HashMap<GlyphKey, AtlasGlyph, GlyphKeyHash> m_glyphs;
+        Vector<SkylinePacker> m_pages;
+        Texture2DArrayPtr m_pTexture;
+        uint32_t m_uGeneration;
+
+        GlyphAtlas() : m_uGeneration(0) { }
+    public:
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        // Rasterizes the glyph on first use, null when FreeType fails to render it. GL thread only.
+        const AtlasGlyph* glyph(const Font& font, uint32_t glyph_index, uint32_t bucket);
+
+        // Changes whenever glyphs were evicted, layouts made before refer to stale atlas space.
+        [[nodiscard]] FOW_CONSTEXPR uint32_t generation() const { return m_uGeneration; }
+        [[nodiscard]] FOW_CONSTEXPR const Texture2DArrayPtr& texture() const { return m_pTexture; }
+        [[nodiscard]] inline size_t glyph_count() const { return m_glyphs.size(); }
+        [[nodiscard]] FOW_CONSTEXPR size_t page_count() const { return m_pages.size(); }
+
+        void clear();
+        // Deletes the texture and forgets every glyph.
+        void release();
+
+        static GlyphAtlas& Instance();
+    private:
+        Option<std::pair<uint32_t, Vector2i>> allocate(const Vector2i& size);
+        Result<> add_page();
+    };
+
+    // Dynamic vertex and index buffer of glyph quads. Positions are normalized to the text area, so the quads stretch
+    // with the rectangle the text is drawn into like a texture would.
+    class FOW_RENDER_API GlyphQuadBuffer {
+        struct GlyphVertex {
+            Vector2 position;
+            Vector3 uv;                 // z is the atlas page
+        };
+
+        GLuint m_uVao, m_uVbo, m_uEbo;
+        size_t m_uCapacity;             // In quads
+        GLsizei m_iIndexCount;
+    public:
+        GlyphQuadBuffer() : m_uVao(0), m_uVbo(0), m_uEbo(0), m_uCapacity(0), m_iIndexCount(0) { }
+        GlyphQuadBuffer(const GlyphQuadBuffer&) = delete;
+        GlyphQuadBuffer(GlyphQuadBuffer&& other) noexcept;
+        ~GlyphQuadBuffer();
+
+        GlyphQuadBuffer& operator=(const GlyphQuadBuffer&) = delete;
+        GlyphQuadBuffer& operator=(GlyphQuadBuffer&& other) noexcept;
+
+        // Only rewrites the vertices, the buffers are reallocated when the quads outgrow them.
+        void update(const Vector<GlyphQuad>& quads, const Vector2& area_size);
+        // Binds the vertex array and draws every quad, the program has to be in use already.
+        void draw(GLsizei instances = 1) const;
+
+        [[nodiscard]] FOW_CONSTEXPR bool is_empty() const { return m_iIndexCount == 0; }
+        [[nodiscard]] FOW_CONSTEXPR size_t quad_count() const { return static_cast<size_t>(m_iIndexCount) / 6; }
+    private:
+        void reserve(size_t quads);
+        void release();
+    };
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef FOW_RENDERER_IMPOSTOR_HPP
+#define FOW_RENDERER_IMPOSTOR_HPP
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/Material.hpp"
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/Model.hpp"
+#include "fow/Renderer/Texture.hpp"
+
+#ifndef FOW_IMPOSTOR_FRAME_SIZE
+    #define FOW_IMPOSTOR_FRAME_SIZE 128u
+#endif
+#ifndef FOW_IMPOSTOR_SWITCH_RADIUS
+    #define FOW_IMPOSTOR_SWITCH_RADIUS 48.0f
+#endif
+
+namespace fow {
+    class Impostor;
+    using ImpostorPtr = Ref<Impostor>;
+
+    // Directions a model is captured from. Columns go around the up axis starting at +Z, rows go from the horizon up to
+    // max_pitch. The atlas has one frame per cell, row 0 at the bottom.
+    struct FOW_RENDER_API ImpostorViewGrid {
+        uint32_t yaw_views = 8;
+        uint32_t pitch_views = 3;
+        float max_pitch = 1.0471976f;   // 60 degrees, in radians
+
+        // Object space direction from the model towards the capture camera.
+        [[nodiscard]] Vector3 direction(uint32_t column, uint32_t row) const;
+        // Cell whose capture direction is closest to the object space direction towards the camera.
+        [[nodiscard]] Vector2u select(const Vector3& to_camera) const;
+        // Texture coordinates of a frame within the atlas.
+        [[nodiscard]] Rectangle frame_rect(uint32_t column, uint32_t row) const;
+    };
+
+    struct ImpostorOptions {
+        ImpostorViewGrid grid;
+        uint32_t frame_size = FOW_IMPOSTOR_FRAME_SIZE;
+    };
+
+    // Mirrors the std430 layout of the "ImpostorInstances" storage buffer.
+    struct ImpostorInstance {
+        Vector4 center_radius;      // World space bounding sphere
+        Vector4 orientation;        // x: rotation around the up axis in radians
+    };
+    static_assert(sizeof(ImpostorInstance) == 32);
+
+    FOW_RENDER_API ImpostorInstance MakeImpostorInstance(const BoundingSphere& bounds, const Matrix4& model_matrix);
+
+    // Flat stand-in for a static model, drawn as camera facing quads that show the captured frame closest to the view
+    // direction. Every instance of an impostor is drawn with a single instanced call. The lighting is the one of the
+    // scene at capture time, so impostors suit upright props seen from far away, like trees and buildings.
+    class FOW_RENDER_API Impostor final : public IDrawable3D, public IDrawable3DInstanced {
+        Texture2DPtr m_pAtlas;
+        MaterialPtr m_pMaterial;
+        MeshPtr m_pQuad;
+        ImpostorViewGrid m_grid;
+        BoundingSphere m_bounds;
+        mutable GLuint m_uInstanceBuffer;
+        mutable GLsizeiptr m_iInstanceBufferSize;
+    public:
+        // The atlas can come from Capture or be loaded from disk, as long as it was laid out with the same grid.
+        Impostor(const Texture2DPtr& atlas, const ImpostorViewGrid& grid, const BoundingSphere& bounds);
+        Impostor(const Impostor&) = delete;
+        ~Impostor() override;
+
+        Impostor& operator= (const Impostor&) = delete;
+
+        [[nodiscard]] FOW_CONSTEXPR const Texture2DPtr& atlas() const { return m_pAtlas; }
+        [[nodiscard]] FOW_CONSTEXPR const MaterialPtr& material() const { return m_pMaterial; }
+        [[nodiscard]] FOW_CONSTEXPR const ImpostorViewGrid& grid() const { return m_grid; }
+        [[nodiscard]] FOW_CONSTEXPR const BoundingSphere& bounds() const { return m_bounds; }
+        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pAtlas != nullptr && m_pMaterial != nullptr && m_pQuad != nullptr; }
+
+        void draw(const Transform& transform) const override;
+        void draw_instances(const Vector<Transform>& transforms) const override;
+        void draw_instances(const Vector<ImpostorInstance>& instances) const;
+
+        // Renders the model into a new atlas, one frame per view of the grid. GL thread only, the meshes of the model
+        // have to be resident already.
+        static Result<ImpostorPtr> Capture(const Model& model, const ImpostorOptions& options = { });
+    };
+
+    // Draws a model up close and its impostor once it covers less than switch_radius pixels on screen. The impostor is
+    // captured the first time it is needed, unless one is given up front.
+    class FOW_RENDER_API ImpostorModel final : public IDrawable3D {
+        ModelPtr m_pModel;
+        mutable ImpostorPtr m_pImpostor;
+        ImpostorOptions m_options;
+        BoundingSphere m_bounds;
+        float m_fSwitchRadius;
+        mutable bool m_bCaptureFailed;
+    public:
+        explicit ImpostorModel(const ModelPtr& model, const ImpostorOptions& options = { }, float switch_radius = FOW_IMPOSTOR_SWITCH_RADIUS);
+        ImpostorModel(const ModelPtr& model, const ImpostorPtr& impostor, float switch_radius = FOW_IMPOSTOR_SWITCH_RADIUS);
+
+        [[nodiscard]] FOW_CONSTEXPR const ModelPtr& model() const { return m_pModel; }
+        [[nodiscard]] FOW_CONSTEXPR const ImpostorPtr& impostor() const { return m_pImpostor; }
+        [[nodiscard]] FOW_CONSTEXPR float switch_radius() const { return m_fSwitchRadius; }
+        FOW_CONSTEXPR void set_switch_radius(const float radius) { m_fSwitchRadius = radius; }
+
+        void draw(const Transform& transform) const override;
+        // Distant instances are collected by the render queue and drawn together after the multi-draw batches.
+        bool enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const override;
+    private:
+        [[nodiscard]] bool use_impostor(const Matrix4& model_matrix) const;
+    };
+    using ImpostorModelPtr = Ref<ImpostorModel>;
+
+    // Bounding sphere around all meshes of a model.
+    FOW_RENDER_API BoundingSphere ModelBounds(const Model& model);
+}
+
+#endif
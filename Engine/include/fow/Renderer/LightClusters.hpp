@@ -0,0 +1,72 @@
+#ifndef FOW_RENDERER_LIGHT_CLUSTERS_HPP
+#define FOW_RENDERER_LIGHT_CLUSTERS_HPP
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Shared.hpp"
+
+#ifndef FOW_LIGHT_CLUSTER_GRID_X
+    #define FOW_LIGHT_CLUSTER_GRID_X 16
+#endif
+#ifndef FOW_LIGHT_CLUSTER_GRID_Y
+    #define FOW_LIGHT_CLUSTER_GRID_Y 9
+#endif
+#ifndef FOW_LIGHT_CLUSTER_GRID_Z
+    #define FOW_LIGHT_CLUSTER_GRID_Z 24
+#endif
+
+namespace fow {
+    // Mirrors the std430 layout of a light in the "SceneLights" storage buffer.
+    struct ClusterLight {
+        Vector4 position_radius;
+        Vector4 color;
+    };
+
+    struct LightClusterRange {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    struct LightClusterBounds {
+        Vector3 min;
+        Vector3 max;
+    };
+
+    class FOW_RENDER_API LightClusterGrid {
+        Vector3u m_size;
+        Matrix4 m_projection;
+        float m_fNear, m_fFar;
+        Vector<LightClusterBounds> m_bounds;
+        Vector<LightClusterRange> m_ranges;
+        Vector<uint32_t> m_indices;
+        mutable GLuint m_uLightBuffer, m_uClusterBuffer, m_uIndexBuffer;
+        mutable GLsizeiptr m_iLightBufferSize, m_iClusterBufferSize, m_iIndexBufferSize;
+    public:
+        explicit LightClusterGrid(const Vector3u& size = Vector3u { FOW_LIGHT_CLUSTER_GRID_X, FOW_LIGHT_CLUSTER_GRID_Y, FOW_LIGHT_CLUSTER_GRID_Z });
+        LightClusterGrid(const LightClusterGrid&) = delete;
+        ~LightClusterGrid();
+
+        LightClusterGrid& operator=(const LightClusterGrid&) = delete;
+
+        // Assigns world space lights to the clusters of the view frustum, only perspective projections are supported.
+        Result<> assign(const Matrix4& view, const Matrix4& projection, const Vector<ClusterLight>& lights);
+        // Uploads lights, cluster ranges and light indices to the storage buffers and binds them.
+        void upload(const Vector<ClusterLight>& lights) const;
+        // Deletes the storage buffers, the next upload creates new ones.
+        void release();
+
+        [[nodiscard]] FOW_CONSTEXPR const Vector3u& size() const { return m_size; }
+        [[nodiscard]] FOW_CONSTEXPR uint32_t cluster_count() const { return m_size.x * m_size.y * m_size.z; }
+        [[nodiscard]] FOW_CONSTEXPR uint32_t cluster_index(const uint32_t x, const uint32_t y, const uint32_t z) const { return x + m_size.x * (y + m_size.y * z); }
+        [[nodiscard]] FOW_CONSTEXPR float near_plane() const { return m_fNear; }
+        [[nodiscard]] FOW_CONSTEXPR float far_plane() const { return m_fFar; }
+        // Scale and bias that map log(view depth) to a depth slice.
+        [[nodiscard]] Vector2 depth_slice_params() const;
+        [[nodiscard]] FOW_CONSTEXPR const Vector<LightClusterBounds>& bounds() const { return m_bounds; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<LightClusterRange>& ranges() const { return m_ranges; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<uint32_t>& indices() const { return m_indices; }
+    private:
+        void build_bounds(const Matrix4& projection);
+    };
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef FOW_RENDERER_MATERIAL_HPP
 #define FOW_RENDERER_MATERIAL_HPP
 
+#include <cstddef>
+#include <cstring>
+
 #include "fow/Shared.hpp"
 #include "fow/Renderer/Shader.hpp"
 
@@ -55,6 +58,94 @@ namespace fow {
         Texture
     };
 
+    using MaterialParamId = GLint;
+    FOW_CONSTEXPR MaterialParamId MaterialParamNone = -1;
+
+    namespace MaterialParameterConversion {
+        template<typename T>
+        using Writer = void(*)(std::byte* dst, const T& value);
+
+        template<typename T>
+        struct VectorTraits {
+            static constexpr bool IsVector = false;
+        };
+        template<glm::length_t L, typename T, glm::qualifier Q>
+        struct VectorTraits<glm::vec<L, T, Q>> {
+            static constexpr bool IsVector = true;
+            static constexpr glm::length_t Length = L;
+            using ValueType = T;
+        };
+
+        template<typename TStorage, typename T>
+        inline void Write(std::byte* dst, const T& value) {
+            const auto converted = static_cast<TStorage>(value);
+            std::memcpy(dst, &converted, sizeof(TStorage));
+        }
+        template<typename TStorage, typename T>
+        inline void WriteBool(std::byte* dst, const T& value) {
+            TStorage converted { };
+            if constexpr (VectorTraits<T>::IsVector) {
+                for (glm::length_t i = 0; i < VectorTraits<T>::Length; ++i) {
+                    converted[i] = value[i] != typename VectorTraits<T>::ValueType(0) ? 1 : 0;
+                }
+            } else {
+                converted = value != T(0) ? 1 : 0;
+            }
+            std::memcpy(dst, &converted, sizeof(TStorage));
+        }
+
+        // GL bool uniforms are stored as integers, the conversion is picked once when a handle is resolved.
+        template<typename T>
+        inline Writer<T> Resolve(const ShaderUniformType type) {
+            if constexpr (std::is_same_v<T, Matrix4>) {
+                return type == ShaderUniformType::Matrix4 ? &Write<Matrix4, T> : nullptr;
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                switch (type) {
+                    case ShaderUniformType::Bool:   return &WriteBool<GLint, T>;
+                    case ShaderUniformType::Int:    return &Write<GLint, T>;
+                    case ShaderUniformType::UInt:   return &Write<GLuint, T>;
+                    case ShaderUniformType::Float:  return &Write<GLfloat, T>;
+                    case ShaderUniformType::Double: return &Write<GLdouble, T>;
+                    default: return nullptr;
+                }
+            } else if constexpr (VectorTraits<T>::IsVector && VectorTraits<T>::Length >= 2 && VectorTraits<T>::Length <= 4) {
+                constexpr glm::length_t L = VectorTraits<T>::Length;
+                constexpr ShaderUniformType bool_types[]   = { ShaderUniformType::BoolVector2,   ShaderUniformType::BoolVector3,   ShaderUniformType::BoolVector4 };
+                constexpr ShaderUniformType int_types[]    = { ShaderUniformType::IntVector2,    ShaderUniformType::IntVector3,    ShaderUniformType::IntVector4 };
+                constexpr ShaderUniformType uint_types[]   = { ShaderUniformType::UIntVector2,   ShaderUniformType::UIntVector3,   ShaderUniformType::UIntVector4 };
+                constexpr ShaderUniformType float_types[]  = { ShaderUniformType::FloatVector2,  ShaderUniformType::FloatVector3,  ShaderUniformType::FloatVector4 };
+                constexpr ShaderUniformType double_types[] = { ShaderUniformType::DoubleVector2, ShaderUniformType::DoubleVector3, ShaderUniformType::DoubleVector4 };
+                if (type == bool_types[L - 2])   { return &WriteBool<glm::vec<L, GLint>, T>; }
+                if (type == int_types[L - 2])    { return &Write<glm::vec<L, GLint>, T>; }
+                if (type == uint_types[L - 2])   { return &Write<glm::vec<L, GLuint>, T>; }
+                if (type == float_types[L - 2])  { return &Write<glm::vec<L, GLfloat>, T>; }
+                if (type == double_types[L - 2]) { return &Write<glm::vec<L, GLdouble>, T>; }
+            }
+            return nullptr;
+        }
+    }
+
+    struct MaterialParameterSlot {
+        GLint location         = -1;
+        ShaderUniformType type = ShaderUniformType::Float;
+        uint32_t offset        = 0;
+        uint32_t size          = 0;
+        GLint texture_unit     = -1;
+        bool in_block          = false;
+        bool assigned          = false;
+
+        [[nodiscard]] FOW_CONSTEXPR bool is_bound() const { return location >= 0 || in_block; }
+    };
+
+    // Handles are indices into the shader's reflected uniform table, so they are valid for every material sharing that shader.
+    template<typename T>
+    struct MaterialParam {
+        MaterialParamId id = MaterialParamNone;
+        MaterialParameterConversion::Writer<T> write = nullptr;
+
+        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return id >= 0; }
+    };
+
     class Material;
     using MaterialPtr = Ref<Material>;
 
@@ -66,19 +157,25 @@ namespace fow {
 
     class FOW_RENDER_API Material final : std::enable_shared_from_this<Material> {
         ShaderPtr m_pShader;
-        HashMap<String, MaterialParameterValue> m_mParams;
+        Vector<MaterialParameterSlot> m_slots;
+        Vector<std::byte> m_block;
+        Vector<TexturePtr> m_textures;
+        mutable Vector<bool> m_dirty;
+        uint32_t m_uBlockSize;
+        mutable GLuint m_uUbo;
+        mutable bool m_bBlockDirty;
         MaterialOptions m_options;
+        uint64_t m_uId;
+
+        void compile();
+        Result<> set_parameter_value(MaterialParamId id, const MaterialParameterValue& value);
     public:
-        Material() : m_pShader(nullptr) { }
-        explicit Material(const ShaderPtr& shader, const HashMap<String, MaterialParameterValue>& params = { }, const MaterialOptions options = { }) :
-            m_pShader(shader), m_mParams(params), m_options(options) { }
-        explicit Material(ShaderPtr&& shader, const HashMap<String, MaterialParameterValue>& params = { }, const MaterialOptions options = { }) :
-            m_pShader(std::move(shader)), m_mParams(params), m_options(options) { }
-        Material(const Material& material) : m_pShader(material.m_pShader), m_mParams(material.m_mParams), m_options(material.m_options) { }
-        Material(Material&& material) noexcept : m_pShader(std::move(material.m_pShader)), m_mParams(std::move(material.m_mParams)), m_options(std::move(material.m_options)) {
-            material.m_pShader = nullptr;
-            material.m_mParams = { };
-        }
+        Material();
+        explicit Material(const ShaderPtr& shader, const HashMap<String, MaterialParameterValue>& params = { }, MaterialOptions options = { });
+        explicit Material(ShaderPtr&& shader, const HashMap<String, MaterialParameterValue>& params = { }, MaterialOptions options = { });
+        Material(const Material& material);
+        Material(Material&& material) noexcept;
+        ~Material();
 
         Material& operator=(const Material& material);
         Material& operator=(Material&& material) noexcept;
@@ -92,10 +189,81 @@ namespace fow {
         void set_depth_test(bool value);
         FOW_CONSTEXPR bool get_depth_test() const { return m_options.depth_test; }
 
+        [[nodiscard]] MaterialParamId find_parameter(const String& name) const;
+
+        template<typename T>
+        [[nodiscard]] Result<MaterialParam<T>> parameter(const MaterialParamId id) const {
+            if (id < 0 || static_cast<size_t>(id) >= m_slots.size() || !m_slots[id].is_bound()) {
+                return Failure(std::format("Shader has no parameter with id {}", id));
+            }
+            const auto& slot = m_slots[id];
+            if constexpr (std::is_convertible_v<T, TexturePtr>) {
+                if (slot.texture_unit < 0) {
+                    return Failure(std::format("Cannot set parameter \"{}\", uniform type {} is not a texture!", m_pShader->uniforms()[id].name, slot.type));
+                }
+                return Success<MaterialParam<T>>(MaterialParam<T> { id, nullptr });
+            } else {
+                const auto write = MaterialParameterConversion::Resolve<T>(slot.type);
+                if (write == nullptr) {
+                    return Failure(std::format("Cannot set parameter \"{}\", cannot convert value to uniform type {}!", m_pShader->uniforms()[id].name, slot.type));
+                }
+                return Success<MaterialParam<T>>(MaterialParam<T> { id, write });
+            }
+        }
+        template<typename T>
+        [[nodiscard]] Result<MaterialParam<T>> parameter(const String& name) const {
+            const auto id = find_parameter(name);
+            if (id < 0) {
+                return Failure(std::format("Shader has no parameter \"{}\"", name));
+            }
+            return parameter<T>(id);
+        }
+
+        // Handles that are invalid or were resolved against another shader are rejected with an assert.
+        template<typename T>
+        void set_parameter(const MaterialParam<T>& param, const T& value) {
+            if (Debug::Assert(param.is_valid() && static_cast<size_t>(param.id) < m_slots.size() && m_slots[param.id].is_bound(),
+                               std::format("Invalid material parameter handle {}", param.id))) {
+                return;
+            }
+            auto& slot = m_slots[param.id];
+            if constexpr (std::is_convertible_v<T, TexturePtr>) {
+                if (Debug::Assert(slot.texture_unit >= 0, std::format("Material parameter {} is not a texture", param.id))) {
+                    return;
+                }
+                m_textures[slot.texture_unit] = value;
+            } else {
+                if (Debug::Assert(slot.texture_unit < 0 && param.write != nullptr, std::format("Material parameter {} cannot take the value", param.id))) {
+                    return;
+                }
+                param.write(m_block.data() + slot.offset, value);
+                m_bBlockDirty |= slot.in_block;
+            }
+            slot.assigned = true;
+            m_dirty[param.id] = true;
+        }
+
         Result<> set_parameter(const String& name, const MaterialParameterValue& value);
         Result<> set_parameter_optional(const String& name, const MaterialParameterValue& value);
         Result<> get_parameter(const String& name, MaterialParameterValue& value) const;
+        // Value of the parameter, none when the id is out of range or the parameter was never set.
+        [[nodiscard]] Option<MaterialParameterValue> get_parameter(MaterialParamId id) const;
+        // Value behind a handle, none when it was never set or is stored as another type.
+        template<typename T>
+        [[nodiscard]] Option<T> get_parameter(const MaterialParam<T>& param) const {
+            const auto value = get_parameter(param.id);
+            if (!value.has_value()) {
+                return std::nullopt;
+            }
+            if (const auto* result = std::get_if<T>(&value.value())) {
+                return *result;
+            }
+            return std::nullopt;
+        }
 
+        // Parameters inside the shader's MaterialParams block live in a std140 uniform buffer owned by the material and are bound
+        // with a single glBindBufferRange. Loose uniforms are uploaded only if they changed since this material was last applied
+        // to its shader program, everything is re-sent when another material used the program in between.
         Result<> apply() const;
 
         [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pShader != nullptr; }
@@ -105,9 +273,15 @@ namespace fow {
         static Result<MaterialPtr> ParseXml(const String& source, const pugi::xml_node& root, AssetLoaderFlags::Type flags);
         static Result<MaterialPtr> LoadAsset(const Path& path, AssetLoaderFlags::Type flags);
 
+        // Uses the shader variant picked by SelectVariant, features the parameters do not need are compiled out and stay
+        // off for the lifetime of the material, even when a parameter that would need them is set later.
         static Result<MaterialPtr> New(const String& shader_name, const HashMap<String, MaterialParameterValue>& params = { });
+        // Smallest set of shader features the parameters need. Textures that are missing or equal to the neutral default
+        // texture of their slot, and flags that are off, leave their feature out.
+        static ShaderVariantKey SelectVariant(const HashMap<String, MaterialParameterValue>& params);
 
         Material make_unique() const;
+        // Keeps the shader unless the parameters need a feature its variant compiled out, then the variant they select is used.
         Material make_unique(const HashMap<String, MaterialParameterValue>& params) const;
         MaterialPtr make_unique_ptr() const;
         MaterialPtr make_unique_ptr(const HashMap<String, MaterialParameterValue>& params) const;
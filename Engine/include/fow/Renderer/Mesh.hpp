@@ -5,6 +5,12 @@
 
 #include "fow/Shared.hpp"
 #include "fow/Renderer/Material.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/MeshArena.hpp"
+#include "fow/Renderer/MeshLod.hpp"
+#include "fow/Renderer/MeshOptimizer.hpp"
+#include "fow/Renderer/MultiDraw.hpp"
+#include "fow/Renderer/VertexLayout.hpp"
 
 #include "fow/Renderer/RenderShared.hpp"
 
@@ -72,42 +78,59 @@ namespace fow {
         bool m_bInitialized;
         MaterialPtr m_pMaterial;
         MeshPrimitive m_ePrimitive;
-
-        Mesh(const GLuint vao, const GLuint vbo, const GLuint ebo, const GLsizei index_count, const MaterialPtr& material, const MeshPrimitive primitive = MeshPrimitive::Triangles) :
+        VertexLayout m_layout;
+        VertexQuantization m_quantization;
+        Vector<MeshLod> m_lods;
+        BoundingSphere m_bounds;
+        MeshArena* m_pArena;
+        MeshArenaHandle m_uArenaHandle;
+
+        Mesh(const GLuint vao, const GLuint vbo, const GLuint ebo, const GLsizei index_count, const MaterialPtr& material, const MeshPrimitive primitive = MeshPrimitive::Triangles,
+             const VertexLayout& layout = VertexLayout::Full, const VertexQuantization& quantization = { }, const Vector<MeshLod>& lods = { }, const BoundingSphere& bounds = { }) :
             m_uVao( vao), m_uVbo(vbo), m_uEbo(ebo),
             m_iIndexCount(index_count),
             m_bInitialized(true), m_pMaterial(material),
-            m_ePrimitive(primitive) { }
+            m_ePrimitive(primitive), m_layout(layout), m_quantization(quantization),
+            m_lods(lods.empty() ? Vector<MeshLod> { MeshLod { 0, index_count, 0.0f } } : lods), m_bounds(bounds),
+            m_pArena(nullptr), m_uArenaHandle(0) { }
+        Mesh(MeshArena& arena, const MeshArenaHandle handle, const GLsizei index_count, const MaterialPtr& material, const MeshPrimitive primitive,
+             const VertexQuantization& quantization, const Vector<MeshLod>& lods, const BoundingSphere& bounds) :
+            m_uVao(0), m_uVbo(0), m_uEbo(0),
+            m_iIndexCount(index_count),
+            m_bInitialized(true), m_pMaterial(material),
+            m_ePrimitive(primitive), m_layout(arena.layout()), m_quantization(quantization),
+            m_lods(lods.empty() ? Vector<MeshLod> { MeshLod { 0, index_count, 0.0f } } : lods), m_bounds(bounds),
+            m_pArena(&arena), m_uArenaHandle(handle) { }
+
+        void release();
+        // Called by the UploadQueue once the data of a pending mesh is in the arena.
+        void make_resident(MeshArena& arena, MeshArenaHandle handle);
+
+        static Result<MeshPtr> CreateWithIndexRanges(const MaterialPtr& material, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const Vector<MeshLod>& lods,
+                                                     const VertexLayout& layout, MeshPrimitive primitive, MeshDrawMode draw_mode);
 
     public:
-        Mesh() : m_uVao(0), m_uVbo(0), m_uEbo(0), m_iIndexCount(0), m_bInitialized(false), m_ePrimitive(MeshPrimitive::Triangles) { }
+        Mesh() : m_uVao(0), m_uVbo(0), m_uEbo(0), m_iIndexCount(0), m_bInitialized(false), m_ePrimitive(MeshPrimitive::Triangles), m_pArena(nullptr), m_uArenaHandle(0) { }
         Mesh(const Mesh& mesh) = delete;
         Mesh(Mesh&& mesh) noexcept :
             m_uVao(mesh.m_uVao), m_uVbo(mesh.m_uVbo), m_uEbo(mesh.m_uEbo),
             m_iIndexCount(mesh.m_iIndexCount),
-            m_bInitialized(mesh.m_bInitialized), m_pMaterial(std::move(mesh.m_pMaterial)), m_ePrimitive(mesh.m_ePrimitive) {
+            m_bInitialized(mesh.m_bInitialized), m_pMaterial(std::move(mesh.m_pMaterial)), m_ePrimitive(mesh.m_ePrimitive),
+            m_layout(mesh.m_layout), m_quantization(mesh.m_quantization), m_lods(std::move(mesh.m_lods)), m_bounds(mesh.m_bounds),
+            m_pArena(mesh.m_pArena), m_uArenaHandle(mesh.m_uArenaHandle) {
             mesh.m_uVao = 0;
             mesh.m_uVbo = 0;
             mesh.m_uEbo = 0;
             mesh.m_iIndexCount = 0;
             mesh.m_bInitialized = false;
             mesh.m_pMaterial = CreateRef<Material>();
+            mesh.m_pArena = nullptr;
         }
         ~Mesh() override;
 
         Mesh& operator=(const Mesh& mesh) = delete;
         Mesh& operator=(Mesh&& mesh) noexcept {
-            if (m_bInitialized) {
-                if (m_uVao != 0) {
-                    glDeleteVertexArrays(1, &m_uVao);
-                }
-                if (m_uVbo != 0) {
-                    glDeleteBuffers(1, &m_uVbo);
-                }
-                if (m_uEbo != 0) {
-                    glDeleteBuffers(1, &m_uEbo);
-                }
-            }
+            release();
 
             m_uVao = mesh.m_uVao;
             m_uVbo = mesh.m_uVbo;
@@ -116,6 +139,12 @@ namespace fow {
             m_bInitialized = mesh.m_bInitialized;
             m_pMaterial = mesh.m_pMaterial;
             m_ePrimitive = mesh.m_ePrimitive;
+            m_layout = mesh.m_layout;
+            m_quantization = mesh.m_quantization;
+            m_lods = std::move(mesh.m_lods);
+            m_bounds = mesh.m_bounds;
+            m_pArena = mesh.m_pArena;
+            m_uArenaHandle = mesh.m_uArenaHandle;
 
             mesh.m_uVao = 0;
             mesh.m_uVbo = 0;
@@ -123,6 +152,7 @@ namespace fow {
             mesh.m_iIndexCount = 0;
             mesh.m_bInitialized = false;
             mesh.m_pMaterial = CreateRef<Material>();
+            mesh.m_pArena = nullptr;
 
             return *this;
         }
@@ -130,17 +160,36 @@ namespace fow {
         void update_data(const Vector<Vertex>& vertices, const Vector<GLuint>& indices);
         void update_data_2d(const Vector<Vertex2D>& vertices, const Vector<GLuint>& indices);
 
-        [[nodiscard]] FOW_CONSTEXPR GLuint vao() const { return m_uVao; }
-        [[nodiscard]] FOW_CONSTEXPR GLuint vbo() const { return m_uVbo; }
-        [[nodiscard]] FOW_CONSTEXPR GLuint ebo() const { return m_uEbo; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint vao() const { return m_pArena != nullptr ? m_pArena->vao() : m_uVao; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint vbo() const { return m_pArena != nullptr ? m_pArena->vbo() : m_uVbo; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint ebo() const { return m_pArena != nullptr ? m_pArena->ebo() : m_uEbo; }
+        // Arena the mesh is sub-allocated from, null when it owns its buffers.
+        [[nodiscard]] FOW_CONSTEXPR MeshArena* arena() const { return m_pArena; }
+        [[nodiscard]] FOW_CONSTEXPR GLint base_vertex() const { return m_pArena != nullptr ? static_cast<GLint>(m_pArena->allocation(m_uArenaHandle).base_vertex) : 0; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint first_index() const { return m_pArena != nullptr ? m_pArena->allocation(m_uArenaHandle).first_index : 0; }
         [[nodiscard]] FOW_CONSTEXPR GLsizei index_count() const { return m_iIndexCount; }
-        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_uVao != 0 && m_uVbo != 0 && m_uEbo != 0; }
+        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return vao() != 0 && vbo() != 0 && ebo() != 0; }
+        // False while the mesh waits in the UploadQueue, pending meshes are skipped when drawing.
+        [[nodiscard]] FOW_CONSTEXPR bool is_resident() const { return is_valid(); }
         [[nodiscard]] FOW_CONSTEXPR MaterialPtr& material() { return m_pMaterial; }
         [[nodiscard]] FOW_CONSTEXPR const MaterialPtr& material() const { return m_pMaterial; }
         void set_material(const MaterialPtr& material);
         [[nodiscard]] FOW_CONSTEXPR MeshPrimitive primitive_type() const { return m_ePrimitive; }
+        [[nodiscard]] FOW_CONSTEXPR const VertexLayout& layout() const { return m_layout; }
+        [[nodiscard]] FOW_CONSTEXPR const VertexQuantization& quantization() const { return m_quantization; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<MeshLod>& lods() const { return m_lods; }
+        [[nodiscard]] FOW_CONSTEXPR const BoundingSphere& bounds() const { return m_bounds; }
+        [[nodiscard]] MeshLod lod(size_t index) const;
+        // Selects the level of detail for the current camera, current is the previously selected level of the drawn object.
+        [[nodiscard]] size_t select_lod(const Matrix4& model_matrix, size_t current = SIZE_MAX) const;
 
         static Result<MeshPtr> Create(const MaterialPtr& material, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, MeshPrimitive primitive = MeshPrimitive::Triangles, MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
+        static Result<MeshPtr> Create(const MaterialPtr& material, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const VertexLayout& layout, MeshPrimitive primitive = MeshPrimitive::Triangles, MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
+        static Result<MeshPtr> CreateWithLods(const MaterialPtr& material, const std::vector<Vertex>& vertices, const Vector<MeshLodLevel>& lods, const VertexLayout& layout = VertexLayout::Full, MeshPrimitive primitive = MeshPrimitive::Triangles, MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
+        // Creates a mesh from vertex data already encoded in the layout, e.g. from a cooked mesh file. The lods index into indices.
+        static Result<MeshPtr> CreateFromEncoded(const MaterialPtr& material, const VertexLayout& layout, const VertexQuantization& quantization, const void* vertex_data, uint32_t vertex_count,
+                                                 const GLuint* indices, uint32_t index_total, const Vector<MeshLod>& lods, const BoundingSphere& bounds,
+                                                 MeshPrimitive primitive = MeshPrimitive::Triangles, MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
         static Result<MeshPtr> Create2D(const MaterialPtr& material, const std::vector<Vertex2D>& vertices, const std::vector<GLuint>& indices, MeshPrimitive primitive = MeshPrimitive::Triangles, MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
         static Result<MeshPtr> CreateQuad(const MaterialPtr& material, const Vector2& scale = Vector2(1.0f), MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
         static Result<MeshPtr> CreateCube(const MaterialPtr& material, const Vector3& mins, const Vector3& maxs, MeshDrawMode draw_mode = MeshDrawMode::StaticDraw);
@@ -158,15 +207,24 @@ namespace fow {
         void draw(const MaterialPtr& override_material) const;
         void draw(const MaterialPtr& override_material, const Transform& transform) const;
         void draw(const MaterialPtr& override_material, const Matrix4& model_matrix) const;
+        void draw_lod(size_t lod, const Matrix4& model_matrix) const;
+        void draw_lod(size_t lod, const MaterialPtr& override_material, const Matrix4& model_matrix) const;
+        bool enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const override;
+        // Whether the mesh can be drawn through a multi-draw batch with the given material.
+        [[nodiscard]] bool supports_multi_draw(const MaterialPtr& material) const;
+        [[nodiscard]] DrawItem draw_item(size_t lod, const MaterialPtr& material, const Matrix4& model_matrix) const;
         void draw_instances(const Vector<Transform>& transforms) const override;
         void draw_instances(const MaterialPtr& override_material, const Vector<Transform>& transforms) const;
         void draw_2d(const Rectangle& rect) const override;
         void draw_2d(const Rectangle& rect, const MaterialPtr& override_material) const;
+
+        friend class UploadQueue;
     };
 
     class FOW_RENDER_API MeshBuilder final {
         Vector<Vertex> m_vertices;
         Vector<GLuint> m_indices;
+        VertexWelder m_welder;
         MeshPrimitive m_ePrimitive;
         MaterialPtr m_pMaterial;
     public:
@@ -182,7 +240,7 @@ namespace fow {
             append(Vertex { position, normal, tangent, bitangent, uv });
         }
 
-        Result<MeshPtr> create_mesh(MeshDrawMode draw_mode) const;
+        Result<MeshPtr> create_mesh(MeshDrawMode draw_mode, const VertexLayout& layout = VertexLayout::Full) const;
     };
 }
 
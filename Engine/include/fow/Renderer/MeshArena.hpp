@@ -0,0 +1,93 @@
+#ifndef FOW_RENDERER_MESH_ARENA_HPP
+#define FOW_RENDERER_MESH_ARENA_HPP
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/VertexLayout.hpp"
+#include "fow/Shared.hpp"
+
+#ifndef FOW_MESH_ARENA_VERTEX_CAPACITY
+    #define FOW_MESH_ARENA_VERTEX_CAPACITY (1u << 18)
+#endif
+#ifndef FOW_MESH_ARENA_INDEX_CAPACITY
+    #define FOW_MESH_ARENA_INDEX_CAPACITY (1u << 20)
+#endif
+
+namespace fow {
+    // First fit free-list allocator over a range of elements, free blocks are kept sorted and coalesced.
+    class FOW_RENDER_API RangeAllocator {
+        struct Block {
+            uint32_t offset, size;
+        };
+        uint32_t m_uCapacity;
+        Vector<Block> m_free;
+    public:
+        explicit RangeAllocator(uint32_t capacity = 0);
+
+        [[nodiscard]] Option<uint32_t> allocate(uint32_t size);
+        void free(uint32_t offset, uint32_t size);
+        // Extends the range, the new space is merged with a free block at the end.
+        void grow(uint32_t capacity);
+        // Marks the first used elements as allocated and the rest as free, used after compacting.
+        void reset(uint32_t capacity, uint32_t used);
+
+        [[nodiscard]] FOW_CONSTEXPR uint32_t capacity() const { return m_uCapacity; }
+        [[nodiscard]] uint32_t free_size() const;
+        [[nodiscard]] uint32_t largest_free_block() const;
+        [[nodiscard]] FOW_CONSTEXPR size_t free_block_count() const { return m_free.size(); }
+    };
+
+    using MeshArenaHandle = uint32_t;
+
+    struct MeshArenaAllocation {
+        uint32_t base_vertex;
+        uint32_t vertex_count;
+        uint32_t first_index;
+        uint32_t index_count;
+        bool live;
+    };
+
+    // Large shared vertex and element buffers for all meshes of one vertex layout. Meshes are ranges that are drawn with
+    // glDrawElementsBaseVertex, so they share a single vertex array and can be merged into multi-draws.
+    class FOW_RENDER_API MeshArena {
+        VertexLayout m_layout;
+        GLuint m_uVao, m_uVbo, m_uEbo;
+        RangeAllocator m_vertices, m_indices;
+        Vector<MeshArenaAllocation> m_allocations;
+        Vector<MeshArenaHandle> m_free_handles;
+    public:
+        explicit MeshArena(const VertexLayout& layout, uint32_t vertex_capacity = FOW_MESH_ARENA_VERTEX_CAPACITY, uint32_t index_capacity = FOW_MESH_ARENA_INDEX_CAPACITY);
+        MeshArena(const MeshArena&) = delete;
+        ~MeshArena();
+
+        MeshArena& operator=(const MeshArena&) = delete;
+
+        // Reserves space for a mesh, the buffers are compacted or grown when no free block is large enough.
+        Result<MeshArenaHandle> allocate(uint32_t vertex_count, uint32_t index_count);
+        // Uploads vertex data that is already encoded in the layout of the arena.
+        void write(MeshArenaHandle handle, const void* vertex_data, const GLuint* indices) const;
+        // Same as write, but copies on the GPU from a staging buffer holding the encoded vertices and the indices.
+        void copy(MeshArenaHandle handle, GLuint source, GLintptr vertex_offset, GLintptr index_offset) const;
+        void free(MeshArenaHandle handle);
+        // Moves all live allocations to the front of the buffers, the handles stay valid.
+        void defragment();
+        // Deletes the GL objects, allocations made afterwards create new ones.
+        void release();
+
+        [[nodiscard]] FOW_CONSTEXPR const MeshArenaAllocation& allocation(const MeshArenaHandle handle) const { return m_allocations[handle]; }
+        [[nodiscard]] FOW_CONSTEXPR const VertexLayout& layout() const { return m_layout; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint vao() const { return m_uVao; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint vbo() const { return m_uVbo; }
+        [[nodiscard]] FOW_CONSTEXPR GLuint ebo() const { return m_uEbo; }
+        [[nodiscard]] FOW_CONSTEXPR const RangeAllocator& vertex_ranges() const { return m_vertices; }
+        [[nodiscard]] FOW_CONSTEXPR const RangeAllocator& index_ranges() const { return m_indices; }
+
+        // Arena shared by all meshes of the layout.
+        static MeshArena& Get(const VertexLayout& layout);
+        static void ReleaseAll();
+    private:
+        Result<> create_buffers(uint32_t vertex_capacity, uint32_t index_capacity);
+        void resize_buffers(uint32_t vertex_capacity, uint32_t index_capacity, bool compact);
+    };
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef FOW_RENDERER_MESH_FILE_HPP
+#define FOW_RENDERER_MESH_FILE_HPP
+
+#include <span>
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/MeshLod.hpp"
+#include "fow/Renderer/VertexLayout.hpp"
+#include "fow/Shared.hpp"
+
+#define FOW_MESH_FILE_EXTENSION ".fmesh"
+#define FOW_MESH_FILE_VERSION   1
+
+namespace fow {
+    // Submesh of a cooked model, the vertex data is already encoded in the layout of the model.
+    struct CookedSubmesh {
+        uint32_t material_index;
+        uint32_t vertex_offset;     // Bytes into the vertex data
+        uint32_t vertex_count;
+        uint32_t index_offset;      // Elements into the indices, the index offsets of the lods are relative to it
+        uint32_t index_count;       // Indices of all levels of detail
+        VertexQuantization quantization;
+        BoundingSphere bounds;
+        Vector<MeshLod> lods;
+    };
+
+    struct CookedModel {
+        VertexLayout layout;
+        uint32_t material_count = 0;
+        BoundingSphere bounds;
+        Vector<CookedSubmesh> submeshes;
+        Vector<std::byte> vertex_data;
+        Vector<GLuint> indices;
+    };
+
+    // Parsed mesh file, the vertex and index data point into the loaded file so they can be uploaded without a copy.
+    struct MeshFileView {
+        VertexLayout layout;
+        uint32_t material_count;
+        BoundingSphere bounds;
+        Vector<CookedSubmesh> submeshes;
+        std::span<const std::byte> vertex_data;
+        std::span<const GLuint> indices;
+    };
+
+    // Serializes a cooked model into the versioned .fmesh format.
+    FOW_RENDER_API Vector<std::byte> WriteMeshFile(const CookedModel& model);
+    // Validates the header and all ranges of a .fmesh file. The data has to stay alive as long as the view is used.
+    FOW_RENDER_API Result<MeshFileView> ReadMeshFile(std::span<const std::byte> data);
+}
+
+#endif
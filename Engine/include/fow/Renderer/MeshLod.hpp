@@ -0,0 +1,59 @@
+#ifndef FOW_RENDERER_MESH_LOD_HPP
+#define FOW_RENDERER_MESH_LOD_HPP
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Shared.hpp"
+
+#ifndef FOW_MESH_MAX_LODS
+    #define FOW_MESH_MAX_LODS 5
+#endif
+
+namespace fow {
+    struct Vertex;
+
+    struct FOW_RENDER_API BoundingSphere {
+        Vector3 center { 0.0f };
+        float radius = 0.0f;
+
+        [[nodiscard]] BoundingSphere transformed(const Matrix4& matrix) const;
+
+        static BoundingSphere FromVertices(const Vector<Vertex>& vertices);
+    };
+
+    // Index range of one level of detail within the element buffer of a mesh.
+    struct MeshLod {
+        GLuint index_offset;
+        GLsizei index_count;
+        float error;        // Simplification error relative to the bounding sphere radius
+    };
+
+    struct MeshLodLevel {
+        Vector<GLuint> indices;
+        float error;
+    };
+
+    struct MeshLodOptions {
+        uint32_t max_levels = FOW_MESH_MAX_LODS;
+        float reduction = 0.5f;     // Triangle count of each level relative to the previous one
+        float max_error = 0.05f;    // Relative to the bounding sphere radius
+    };
+
+    struct MeshLodSelectionParams {
+        float pixel_error = 1.0f;   // Largest allowed simplification error on screen
+        float hysteresis = 0.25f;   // A coarser level is only picked once its error is this much below the threshold
+    };
+
+    // Simplifies a triangle list by collapsing edges ordered by their quadric error. The vertices are not modified,
+    // the returned indices reference the same vertex buffer. Border and attribute seam vertices are never moved.
+    FOW_RENDER_API Vector<GLuint> SimplifyMesh(const Vector<Vertex>& vertices, const Vector<GLuint>& indices, size_t target_index_count, float target_error, float* result_error = nullptr);
+    // Builds a chain of progressively simplified index buffers, the first level is the input itself.
+    FOW_RENDER_API Vector<MeshLodLevel> GenerateMeshLods(const Vector<Vertex>& vertices, const Vector<GLuint>& indices, const MeshLodOptions& options = { });
+
+    // Radius of a world space sphere in pixels, infinite when the camera is inside of it.
+    FOW_RENDER_API float ProjectSphereRadius(const BoundingSphere& sphere, const Matrix4& view, const Matrix4& projection, float viewport_height);
+    // Picks the coarsest level whose error stays below the pixel threshold. Pass the previously selected level as current
+    // to apply hysteresis, or a value out of range for none.
+    FOW_RENDER_API size_t SelectMeshLod(const Vector<MeshLod>& lods, float projected_radius, size_t current, const MeshLodSelectionParams& params = { });
+}
+
+#endif
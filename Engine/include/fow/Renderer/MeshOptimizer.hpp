@@ -0,0 +1,63 @@
+#ifndef FOW_RENDERER_MESH_OPTIMIZER_HPP
+#define FOW_RENDERER_MESH_OPTIMIZER_HPP
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Shared.hpp"
+
+#ifndef FOW_VERTEX_CACHE_SIZE
+    #define FOW_VERTEX_CACHE_SIZE 16
+#endif
+
+namespace fow {
+    struct Vertex;
+
+    enum class VertexWeldMode : uint8_t {
+        Exact,      // All attributes are equal
+        Epsilon     // All attributes are within the tolerances of VertexWeldOptions
+    };
+
+    struct VertexWeldOptions {
+        VertexWeldMode mode = VertexWeldMode::Exact;
+        float position_epsilon = 1e-5f;
+        float normal_epsilon = 1e-3f;   // Per component, also used for tangents and bitangents
+        float uv_epsilon = 1e-5f;
+    };
+
+    // Hash based vertex deduplication, the vertices are stored by the caller.
+    class FOW_RENDER_API VertexWelder {
+        VertexWeldOptions m_options;
+        HashMap<uint64_t, GLuint> m_buckets;
+        Vector<GLuint> m_next;
+    public:
+        explicit VertexWelder(const VertexWeldOptions& options = { }) : m_options(options) { }
+
+        // Returns the index of a matching vertex in vertices, or appends the vertex and returns its index.
+        GLuint add(Vector<Vertex>& vertices, const Vertex& vertex);
+        void reserve(size_t vertex_count);
+        void clear();
+
+        [[nodiscard]] FOW_CONSTEXPR const VertexWeldOptions& options() const { return m_options; }
+    private:
+        [[nodiscard]] bool matches(const Vertex& a, const Vertex& b) const;
+        [[nodiscard]] GLuint find(const Vector<Vertex>& vertices, uint64_t key, const Vertex& vertex) const;
+    };
+
+    // Welds duplicate vertices and remaps the indices, returns the number of removed vertices.
+    FOW_RENDER_API size_t WeldVertices(Vector<Vertex>& vertices, Vector<GLuint>& indices, const VertexWeldOptions& options = { });
+    // Removes triangles that reference the same vertex more than once, returns the number of removed triangles.
+    FOW_RENDER_API size_t RemoveDegenerateTriangles(Vector<GLuint>& indices);
+    // Reorders the triangles for the post-transform vertex cache (Tipsify). cluster_offsets receives the first index of
+    // every cluster of triangles that was emitted without a jump, it can be passed to OptimizeOverdraw.
+    FOW_RENDER_API void OptimizeVertexCache(Vector<GLuint>& indices, size_t vertex_count, uint32_t cache_size = FOW_VERTEX_CACHE_SIZE, Vector<size_t>* cluster_offsets = nullptr);
+    // Sorts the clusters so that the ones facing away from the mesh center are drawn first, the order within the clusters is kept.
+    FOW_RENDER_API void OptimizeOverdraw(Vector<GLuint>& indices, const Vector<Vertex>& vertices, const Vector<size_t>& cluster_offsets);
+    // Reorders the vertices by first use and drops unreferenced ones.
+    FOW_RENDER_API void OptimizeVertexFetch(Vector<Vertex>& vertices, Vector<GLuint>& indices);
+    // Average cache miss ratio (transformed vertices per triangle) of a FIFO cache.
+    FOW_RENDER_API float ComputeACMR(const Vector<GLuint>& indices, size_t vertex_count, uint32_t cache_size = FOW_VERTEX_CACHE_SIZE);
+
+    // Welds, reorders for the vertex cache and overdraw, and reorders the vertices of a triangle list.
+    FOW_RENDER_API void OptimizeMesh(Vector<Vertex>& vertices, Vector<GLuint>& indices, const VertexWeldOptions& options = { });
+}
+
+#endif
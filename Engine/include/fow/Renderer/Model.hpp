@@ -4,6 +4,7 @@
 #include "fow/Shared.hpp"
 #include "fow/Renderer/Material.hpp"
 #include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/MeshFile.hpp"
 
 namespace fow {
     class Model;
@@ -33,7 +34,12 @@ namespace fow {
         void draw() const;
         void draw(const Transform& transform) const override;
         void draw(const Matrix4& model_matrix) const;
+        // Draws with the levels of detail in lods as the previous selection and stores the new one.
+        void draw(const Matrix4& model_matrix, Vector<size_t>& lods) const;
         void draw_instances(const Vector<Transform>& transforms) const override;
+        bool enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const override;
+        // Same as draw with lods, but adds the meshes to a multi-draw batch. False if any of them has to be drawn directly.
+        bool enqueue_draws(MultiDrawBuilder& builder, const Matrix4& model_matrix, Vector<size_t>& lods) const;
 
         [[nodiscard]] Vector<MaterialPtr> materials() const;
         void set_materials(const Vector<MaterialPtr>& materials) const;
@@ -45,11 +51,32 @@ namespace fow {
         void set_material_overrides(const Vector<MaterialPtr>& material_overrides);
         void set_material_override(const MaterialPtr& material, size_t index);
 
-        static Result<ModelPtr> Load(const String& source_path, const Vector<uint8_t>& data, const Vector<MaterialPtr>& materials);
+        // With deferred the meshes are handed to the UploadQueue and stay pending until it uploads them, which makes
+        // loading safe on a loader thread as long as the materials are already loaded.
+        static Result<ModelPtr> Load(const String& source_path, const Vector<uint8_t>& data, const Vector<MaterialPtr>& materials, bool deferred = false);
+        // Loads a model cooked into the .fmesh format, see MeshFile.hpp.
+        static Result<ModelPtr> LoadCooked(const String& source_path, const Vector<uint8_t>& data, const Vector<MaterialPtr>& materials, bool deferred = false);
+        // Imports a model with assimp, optimizes it and generates its levels of detail, for writing with WriteMeshFile.
+        static Result<CookedModel> Cook(const String& source_path, const Vector<uint8_t>& data, const VertexLayout& layout = VertexLayout::Full);
         static Result<ModelPtr> LoadAsset(const Path& path, AssetLoaderFlags::Type flags);
 
         friend class Animation;
     };
+
+    // Per object state of a shared model, keeps the selected levels of detail between frames for hysteresis.
+    class FOW_RENDER_API ModelInstance final : public IDrawable3D {
+        ModelPtr m_pModel;
+        mutable Vector<size_t> m_lods;
+    public:
+        explicit ModelInstance(const ModelPtr& model) : m_pModel(model) { }
+
+        [[nodiscard]] FOW_CONSTEXPR const ModelPtr& model() const { return m_pModel; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<size_t>& selected_lods() const { return m_lods; }
+
+        void draw(const Transform& transform) const override;
+        bool enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const override;
+    };
+    using ModelInstancePtr = Ref<ModelInstance>;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef FOW_RENDERER_MULTI_DRAW_HPP
+#define FOW_RENDERER_MULTI_DRAW_HPP
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/Material.hpp"
+#include "fow/Renderer/MeshArena.hpp"
+#include "fow/Shared.hpp"
+
+namespace fow {
+    // Mirrors the command layout glMultiDrawElementsIndirect reads from the indirect buffer.
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+    static_assert(sizeof(DrawElementsIndirectCommand) == 20);
+
+    // Mirrors the std430 layout of one entry in the "DrawParams" storage buffer, indexed with gl_DrawID.
+    struct DrawParams {
+        Matrix4 model;
+        Vector4 position_scale;     // xyz: dequantization scale of the mesh
+        Vector4 position_offset;    // xyz: dequantization offset of the mesh
+        Vector4u material;          // x: index of the material in MultiDrawBuilder::materials()
+    };
+    static_assert(sizeof(DrawParams) == 112);
+
+    // One index range of a mesh that lives in an arena, holds everything needed to build its command without GL.
+    struct DrawItem {
+        MaterialPtr material;
+        const MeshArena* arena;
+        GLuint first_index;
+        GLsizei index_count;
+        GLint base_vertex;
+        VertexQuantization quantization;
+        Matrix4 model_matrix;
+    };
+
+    // Consecutive commands that share material and arena, submitted with one glMultiDrawElementsIndirect.
+    struct MultiDrawBatch {
+        MaterialPtr material;
+        const MeshArena* arena;
+        uint32_t first_command;
+        uint32_t command_count;
+    };
+
+    class FOW_RENDER_API MultiDrawBuilder {
+        Vector<DrawItem> m_items;
+        Vector<DrawElementsIndirectCommand> m_commands;
+        Vector<DrawParams> m_params;
+        Vector<MultiDrawBatch> m_batches;
+        Vector<const Material*> m_materials;
+        mutable GLuint m_uCommandBuffer, m_uParamsBuffer;
+        mutable GLsizeiptr m_iCommandBufferSize, m_iParamsBufferSize;
+    public:
+        MultiDrawBuilder();
+        MultiDrawBuilder(const MultiDrawBuilder&) = delete;
+        ~MultiDrawBuilder();
+
+        MultiDrawBuilder& operator=(const MultiDrawBuilder&) = delete;
+
+        void add(const DrawItem& item);
+        // Sorts the items by shader, material and arena, then builds the commands and per-draw data of each batch.
+        void build();
+        // Uploads the commands and per-draw data and issues one multi-draw per batch.
+        void submit() const;
+        void clear();
+        // Clears the items and deletes the buffers, the next submit creates new ones.
+        void release();
+
+        [[nodiscard]] FOW_CONSTEXPR const Vector<DrawItem>& items() const { return m_items; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<DrawElementsIndirectCommand>& commands() const { return m_commands; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<DrawParams>& params() const { return m_params; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<MultiDrawBatch>& batches() const { return m_batches; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<const Material*>& materials() const { return m_materials; }
+    };
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef FOW_RENDERER_PROGRAM_CACHE_HPP
+#define FOW_RENDERER_PROGRAM_CACHE_HPP
+
+#include <span>
+#include <string_view>
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Shared.hpp"
+
+#define FOW_PROGRAM_CACHE_EXTENSION ".fprog"
+#define FOW_PROGRAM_CACHE_VERSION   1
+
+namespace fow {
+    // Identifies a linked program. The file name only depends on the sources, so a driver update overwrites the stale
+    // binaries instead of piling up new ones next to them.
+    struct FOW_RENDER_API ProgramCacheKey {
+        uint64_t source_hash = 0;   // Sources and defines
+        uint64_t driver_hash = 0;   // GL vendor, renderer and version strings
+
+        [[nodiscard]] String filename() const;
+
+        [[nodiscard]] FOW_CONSTEXPR bool operator== (const ProgramCacheKey& other) const = default;
+
+        static ProgramCacheKey Create(std::string_view vertex, std::string_view fragment, std::string_view defines, std::string_view driver);
+    };
+
+    struct ProgramBinary {
+        GLenum format = 0;
+        Vector<std::byte> data;
+    };
+
+    FOW_RENDER_API Vector<std::byte> WriteProgramCacheFile(const ProgramCacheKey& key, const ProgramBinary& binary);
+    // Fails when the file is damaged or was written for other sources or another driver.
+    FOW_RENDER_API Result<ProgramBinary> ReadProgramCacheFile(std::span<const std::byte> data, const ProgramCacheKey& key);
+
+    // Linked program binaries kept on disk between runs, so only the first start after a shader or driver change pays
+    // for compiling and linking.
+    namespace ProgramCache {
+        // An empty directory disables the cache, which is the default.
+        FOW_RENDER_API void SetDirectory(const Path& directory);
+        FOW_RENDER_API Path GetDirectory();
+        // False without a directory or when the driver offers no binary formats. Needs a GL context.
+        FOW_RENDER_API bool IsEnabled();
+
+        // Vendor, renderer and version of the GL driver. Needs a GL context.
+        FOW_RENDER_API const String& DriverId();
+        FOW_RENDER_API ProgramCacheKey MakeKey(std::string_view vertex, std::string_view fragment, std::string_view defines = { });
+
+        // Creates a program from the cached binary, none when there is none or the driver rejects it.
+        FOW_RENDER_API Option<GLuint> Load(const ProgramCacheKey& key);
+        // The program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+        FOW_RENDER_API void Store(const ProgramCacheKey& key, GLuint program);
+        FOW_RENDER_API void Clear();
+    }
+}
+
+#endif
@@ -5,21 +5,32 @@
 
 #include "Mesh.hpp"
 #include "Model.hpp"
+#include "Impostor.hpp"
 #include "Sprite.hpp"
 #include "Skybox.hpp"
 
+#ifndef FOW_LIGHT_ATTENUATION_CUTOFF
+    #define FOW_LIGHT_ATTENUATION_CUTOFF 0.01f
+#endif
+
 namespace fow {
     struct FOW_RENDER_API LightInfo {
         const Transform* transform;
         Vector3 color;
         float intensity;
         bool enabled;
+
+        // Distance at which the inverse square falloff drops below FOW_LIGHT_ATTENUATION_CUTOFF.
+        [[nodiscard]] float radius() const;
     };
     using LightInfoPtr = Ref<LightInfo>;
 
     namespace RenderQueue {
         FOW_RENDER_API void Enqueue(const Ref<IDrawable3D>& drawable, const Transform& transform);
         FOW_RENDER_API void EnqueueInstanced(const Ref<IDrawable3DInstanced>& drawable, const Vector<Transform>& transforms);
+        // Instances of one impostor are gathered over the frame and drawn with a single call after the multi-draw batches,
+        // before the meshes that are drawn one by one.
+        FOW_RENDER_API void EnqueueImpostor(const ImpostorPtr& impostor, const Matrix4& model_matrix);
         FOW_RENDER_API void SetSkybox(const SkyboxPtr& skybox);
         FOW_RENDER_API void SetEnvMap(const TextureCubeMapPtr& texture, const TextureCubeMapPtr& texture_blurred, float intensity);
         FOW_RENDER_API void SetSunlight(const Transform& transform, const Color& color, float intensity, bool is_enabled = true);
@@ -34,7 +45,10 @@ namespace fow {
         FOW_RENDER_API LightInfoPtr AddLight(const Transform& transform, const Color& color, float intensity, bool is_enabled = true);
         FOW_RENDER_API void RemoveLight(const LightInfoPtr& light);
         FOW_RENDER_API void Render();
+        FOW_RENDER_API void UpdateSceneParams();
         FOW_RENDER_API void ApplyCurrentSceneParamsToMaterial(const MaterialPtr& mat);
+        // Drops the queued draws and deletes the GL objects of the queue, called by Renderer::Terminate.
+        FOW_RENDER_API void Release();
 
         template<Drawable3DType T>
         inline void Enqueue(const Ref<T>& drawable, const Transform& transform) {
@@ -46,10 +60,16 @@ namespace fow {
         }
     }
 
+    // Drawn through the SpriteBatch2D, by layer and in the order of enqueueing within a layer. Drawables that cannot be
+    // batched are drawn on their own between the batches.
     namespace RenderQueue2D {
-        FOW_RENDER_API void Enqueue(const Sprite2DPtr& sprite, const Rectangle& rectangle);
-        FOW_RENDER_API void Enqueue(const TextSprite2DPtr& sprite, const Rectangle& rectangle);
+        FOW_RENDER_API void Enqueue(const Ref<IDrawable2D>& drawable, const Rectangle& rectangle, int32_t layer = 0);
         FOW_RENDER_API void Render();
+
+        template<Drawable2DType T>
+        inline void Enqueue(const Ref<T>& drawable, const Rectangle& rectangle, const int32_t layer = 0) {
+            Enqueue(CastRef<IDrawable2D>(drawable), rectangle, layer);
+        }
     }
 }
 
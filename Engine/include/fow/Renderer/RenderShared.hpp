@@ -4,10 +4,15 @@
 #include <fow/Shared.hpp>
 
 namespace fow {
+    class MultiDrawBuilder;
+    class SpriteBatch2D;
+
     struct FOW_RENDER_API IDrawable2D {
         virtual ~IDrawable2D() = default;
 
         FOW_ABSTRACT(void draw_2d(const Rectangle& rect) const);
+        // Adds quads to a sprite batch instead of drawing right away, false without adding any if the drawable has to be drawn directly.
+        virtual bool batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const { return false; }
     };
     struct FOW_RENDER_API IDrawable2DAnimated : public IDrawable2D {
         FOW_ABSTRACT(void draw_2d_and_progress_frame(const Rectangle& rect));
@@ -16,6 +21,8 @@ namespace fow {
         virtual ~IDrawable3D() = default;
 
         FOW_ABSTRACT(void draw(const Transform& transform) const);
+        // Adds the draws to a multi-draw batch instead of drawing right away, false if the drawable has to be drawn directly.
+        virtual bool enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const { return false; }
     };
     struct FOW_RENDER_API IDrawable3DInstanced {
         virtual ~IDrawable3DInstanced() = default;
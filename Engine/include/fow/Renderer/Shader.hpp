@@ -3,6 +3,8 @@
 
 #include "fow/Renderer/GL.hpp"
 
+#include <string>
+#include <string_view>
 #include <variant>
 #include <glm/glm.hpp>
 #include <pugixml.hpp>
@@ -10,9 +12,26 @@
 #include "fow/Shared.hpp"
 #include "fow/Renderer/Texture.hpp"
 #include "fow/Renderer/ShaderLib.hpp"
+#include "fow/Renderer/ShaderVariant.hpp"
 
 #define FOW_SHADER_PLACEHOLDER_NAME "NULL"
 
+#define FOW_SHADER_SCENE_BLOCK_BINDING    0
+#define FOW_SHADER_MATERIAL_BLOCK_BINDING 1
+#define FOW_SHADER_SCENE_BLOCK_NAME       "SceneParams"
+#define FOW_SHADER_MATERIAL_BLOCK_NAME    "MaterialParams"
+
+#define FOW_SHADER_LIGHT_BUFFER_BINDING             0
+#define FOW_SHADER_CLUSTER_BUFFER_BINDING           1
+#define FOW_SHADER_CLUSTER_INDEX_BUFFER_BINDING     2
+#define FOW_SHADER_DRAW_PARAMS_BUFFER_BINDING       3
+#define FOW_SHADER_IMPOSTOR_INSTANCE_BUFFER_BINDING 4
+#define FOW_SHADER_LIGHT_BUFFER_NAME                "SceneLights"
+#define FOW_SHADER_CLUSTER_BUFFER_NAME              "LightClusters"
+#define FOW_SHADER_CLUSTER_INDEX_BUFFER_NAME        "LightClusterIndices"
+#define FOW_SHADER_DRAW_PARAMS_BUFFER_NAME          "DrawParams"
+#define FOW_SHADER_IMPOSTOR_INSTANCE_BUFFER_NAME    "ImpostorInstances"
+
 namespace fow {
     enum class ShaderUniformType {
         Bool             = GL_BOOL,
@@ -45,10 +64,48 @@ namespace fow {
         SamplerCubeArray = GL_SAMPLER_CUBE_MAP_ARRAY
     };
 
+    FOW_CONSTEXPR bool IsSamplerUniformType(const ShaderUniformType type) {
+        return type == ShaderUniformType::Sampler1D      || type == ShaderUniformType::Sampler2D      ||
+               type == ShaderUniformType::Sampler3D      || type == ShaderUniformType::SamplerCube    ||
+               type == ShaderUniformType::Sampler1DArray || type == ShaderUniformType::Sampler2DArray ||
+               type == ShaderUniformType::SamplerCubeArray;
+    }
+
     struct FOW_RENDER_API ShaderUniformInfo {
         String name;
         GLint location;
         ShaderUniformType type;
+        GLint array_size   = 1;
+        GLint block_index  = -1;
+        GLint block_offset = -1;
+        String default_value;
+    };
+
+    struct FOW_RENDER_API ShaderUniformBlockInfo {
+        String name;
+        GLint index;
+        GLint binding;
+        GLint data_size;
+    };
+
+    // Uniform names are looked up as std::string_view, so finding a uniform does not allocate a String.
+    struct ShaderUniformNameHash {
+        using is_transparent = void;
+        size_t operator()(const std::string_view name) const noexcept { return std::hash<std::string_view>()(name); }
+        size_t operator()(const String& name) const noexcept { return operator()(std::string_view(name.as_cstr(), name.size())); }
+    };
+    struct ShaderUniformNameEqual {
+        using is_transparent = void;
+        bool operator()(const String& a, const String& b) const noexcept { return View(a) == View(b); }
+        bool operator()(const String& a, const std::string_view b) const noexcept { return View(a) == b; }
+        bool operator()(const std::string_view a, const String& b) const noexcept { return a == View(b); }
+    private:
+        static std::string_view View(const String& name) noexcept { return { name.as_cstr(), name.size() }; }
+    };
+
+    struct ShaderUniformSlot {
+        size_t index;
+        GLint location;
     };
 
     class Shader;
@@ -56,16 +113,33 @@ namespace fow {
     using ShaderPtr = Ref<Shader>;
     using ShaderPtr = Ref<Shader>;
 
+    // Uniform block members cannot have initializers, their defaults are written as "Type Name; // default: value".
+    FOW_RENDER_API void ParseShaderUniformDefaults(const String& source, HashMap<String, String>& defaults);
+
     class FOW_RENDER_API Shader final {
         GLuint m_uProgram;
         bool   m_bInitialized;
         String m_sName;
+        Vector<ShaderUniformInfo> m_uniforms;
+        HashMap<String, ShaderUniformSlot, ShaderUniformNameHash, ShaderUniformNameEqual> m_uniform_lookup;
+        HashMap<GLint, size_t> m_uniform_locations;
+        Vector<ShaderUniformBlockInfo> m_uniform_blocks;
 
-        explicit Shader(const String& name, const GLuint id) : m_uProgram(id), m_bInitialized(true), m_sName(name) { }
+        explicit Shader(const String& name, const GLuint id, const HashMap<String, String>& defaults = { }) : m_uProgram(id), m_bInitialized(true), m_sName(name) {
+            reflect(defaults);
+        }
+
+        void reflect(const HashMap<String, String>& defaults);
+        // Takes ownership of a program that is linked already, used by the compile batch.
+        static ShaderPtr CacheLinkedProgram(const String& name, GLuint program, const String& vertex, const String& fragment);
+
+        friend class ShaderCompileBatch;
     public:
         Shader() : m_uProgram(0),  m_bInitialized(false), m_sName("NULL") { }
         Shader(const Shader& other) = delete;
-        Shader(Shader&& other) noexcept : m_uProgram(other.m_uProgram), m_bInitialized(other.m_bInitialized), m_sName(std::move(other.m_sName)) {
+        Shader(Shader&& other) noexcept : m_uProgram(other.m_uProgram), m_bInitialized(other.m_bInitialized), m_sName(std::move(other.m_sName)),
+            m_uniforms(std::move(other.m_uniforms)), m_uniform_lookup(std::move(other.m_uniform_lookup)), m_uniform_locations(std::move(other.m_uniform_locations)),
+            m_uniform_blocks(std::move(other.m_uniform_blocks)) {
             other.m_uProgram = 0;
             other.m_bInitialized = false;
             other.m_sName = "";
@@ -78,6 +152,10 @@ namespace fow {
             }
             m_uProgram = other.m_uProgram;
             m_bInitialized = other.m_bInitialized;
+            m_uniforms = other.m_uniforms;
+            m_uniform_lookup = other.m_uniform_lookup;
+            m_uniform_locations = other.m_uniform_locations;
+            m_uniform_blocks = other.m_uniform_blocks;
             return *this;
         }
         Shader& operator=(Shader&& other) noexcept {
@@ -87,6 +165,10 @@ namespace fow {
                 }
                 m_uProgram = other.m_uProgram;
                 m_bInitialized = other.m_bInitialized;
+                m_uniforms = std::move(other.m_uniforms);
+                m_uniform_lookup = std::move(other.m_uniform_lookup);
+                m_uniform_locations = std::move(other.m_uniform_locations);
+                m_uniform_blocks = std::move(other.m_uniform_blocks);
                 other.m_uProgram = 0;
                 other.m_bInitialized = false;
             }
@@ -201,14 +283,25 @@ namespace fow {
         bool get_uniform(const String& name, glm::dvec4& value)     const;
         bool get_uniform(const String& name, Matrix4& value)      const;
 
-        [[nodiscard]] GLint uniform_location(const String& name) const;
+        // Locations are resolved from the table reflected at link time, the returned value can be kept as a handle
+        // for the GLint overloads of set_uniform.
+        [[nodiscard]] GLint uniform_location(std::string_view name) const;
+        [[nodiscard]] inline GLint uniform_location(const String& name) const { return uniform_location(std::string_view(name.as_cstr(), name.size())); }
+        [[nodiscard]] inline GLint uniform_location(const char* name) const { return uniform_location(std::string_view(name)); }
         [[nodiscard]] inline bool has_uniform(const String& name) const { return uniform_location(name) >= 0; }
+        [[nodiscard]] const ShaderUniformInfo* find_uniform(std::string_view name) const;
+        // Index into uniforms(), array elements other than the first one are not indexed.
+        [[nodiscard]] ssize_t uniform_index(std::string_view name) const;
 
         [[nodiscard]] Result<ShaderUniformInfo> get_uniform_info(const String& name) const;
         [[nodiscard]] Result<ShaderUniformInfo> get_uniform_info(GLint location) const;
-        [[nodiscard]] size_t get_uniform_count() const;
+        [[nodiscard]] inline size_t get_uniform_count() const { return m_uniforms.size(); }
+        [[nodiscard]] inline const Vector<ShaderUniformInfo>& uniforms() const { return m_uniforms; }
         [[nodiscard]] HashMap<String, ShaderUniformInfo> list_uniforms() const;
 
+        [[nodiscard]] inline const Vector<ShaderUniformBlockInfo>& uniform_blocks() const { return m_uniform_blocks; }
+        [[nodiscard]] const ShaderUniformBlockInfo* find_uniform_block(std::string_view name) const;
+
 #if __cplusplus >= 202302L
         [[nodiscard]] constexpr const String& name() const { return m_sName; }
 #else
@@ -216,11 +309,15 @@ namespace fow {
 #endif
 
         static Result<ShaderPtr> Compile(const String& name, const String& vertex, const String& fragment);
+        // Compiles a shader library shader with only the features of the key, cached under its variant name.
+        static Result<ShaderPtr> CompileVariant(const String& name, ShaderVariantKey key);
         static Result<ShaderPtr> FromBinary(const String& name, const void* data, size_t data_size, const String& vertex_entry, const String& fragment_entry);
+        // SPIR-V carries no "// default:" comments, the defaults of the uniform block members are passed separately.
         static Result<ShaderPtr> FromBinary(const String& name,
             const void* vertex_data,   size_t vertex_data_size,
             const void* fragment_data, size_t fragment_data_size,
-            const String& vertex_entry, const String& fragment_entry
+            const String& vertex_entry, const String& fragment_entry,
+            const HashMap<String, String>& defaults = { }
         );
 
         static ShaderPtr PlaceHolder();
@@ -228,6 +325,7 @@ namespace fow {
         static ShaderPtr CacheShader(ShaderPtr&& shader) noexcept;
         static ShaderPtr FromCache(const String& name);
         static bool IsCached(const String& name);
+        static void UncacheShader(const String& name);
         static void UnloadShaderCache();
     };
 }
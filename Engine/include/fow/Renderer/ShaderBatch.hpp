@@ -0,0 +1,81 @@
+#ifndef FOW_RENDERER_SHADER_BATCH_HPP
+#define FOW_RENDERER_SHADER_BATCH_HPP
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/ProgramCache.hpp"
+#include "fow/Renderer/Shader.hpp"
+
+#ifndef FOW_SHADER_BATCH_POLL_TIME_BUDGET_MS
+    #define FOW_SHADER_BATCH_POLL_TIME_BUDGET_MS 4.0
+#endif
+
+namespace fow {
+    // Compiles every shader a scene needs up front instead of one by one on first use. All programs are submitted to the
+    // driver at once and their status is only queried once it reports them as done, so with
+    // GL_KHR_parallel_shader_compile the driver compiles them on its own threads while the loading screen keeps drawing.
+    // Without the extension the programs are finished one per poll. GL thread only.
+    class FOW_RENDER_API ShaderCompileBatch final {
+        struct Job {
+            String name;
+            String vertex;
+            String fragment;
+            Option<ProgramCacheKey> cache_key = std::nullopt;
+            GLuint vertex_id = 0;
+            GLuint fragment_id = 0;
+            GLuint program = 0;
+            bool from_cache = false;
+        };
+
+        Vector<Job> m_jobs;
+        Vector<Job> m_pending;
+        Vector<Error> m_errors;
+        size_t m_uCompleted;
+        bool m_bSubmitted;
+    public:
+        ShaderCompileBatch() : m_uCompleted(0), m_bSubmitted(false) { }
+        ShaderCompileBatch(const ShaderCompileBatch&) = delete;
+        ShaderCompileBatch(ShaderCompileBatch&&) noexcept = default;
+        // Unfinished programs are deleted, their shaders are not cached.
+        ~ShaderCompileBatch();
+
+        ShaderCompileBatch& operator= (const ShaderCompileBatch&) = delete;
+        // Deletes the unfinished programs of this batch before taking over the other one.
+        ShaderCompileBatch& operator= (ShaderCompileBatch&& other) noexcept;
+
+        // Shaders that are cached already or were added before are skipped. Has to be called before submit.
+        void add(const String& name, const String& vertex, const String& fragment);
+        // Looks the sources up in the shader library.
+        Result<> add(const String& shader_name);
+        // Adds the variant of a shader library shader, see Shader::CompileVariant.
+        Result<> add(const String& shader_name, ShaderVariantKey key);
+
+        // Hands every shader to the driver without waiting for any of them.
+        void submit();
+        // Finishes the programs the driver is done with and returns whether the batch is complete. Submits first when
+        // needed. Without parallel compiling at least one program is finished per call, even over the time budget.
+        bool poll(double time_budget_ms = FOW_SHADER_BATCH_POLL_TIME_BUDGET_MS);
+        // Blocks until every program is finished, fails with the first error.
+        Result<> wait();
+
+        [[nodiscard]] FOW_CONSTEXPR size_t total() const { return m_uCompleted + m_jobs.size() + m_pending.size(); }
+        [[nodiscard]] FOW_CONSTEXPR size_t completed() const { return m_uCompleted; }
+        [[nodiscard]] FOW_CONSTEXPR bool is_done() const { return m_bSubmitted && m_pending.empty(); }
+        // Share of finished programs between 0 and 1, for loading screens. An empty batch is complete.
+        [[nodiscard]] FOW_CONSTEXPR float progress() const {
+            return total() == 0 ? 1.0f : static_cast<float>(m_uCompleted) / static_cast<float>(total());
+        }
+        // Shaders that failed to compile or link, they count as completed.
+        [[nodiscard]] FOW_CONSTEXPR const Vector<Error>& errors() const { return m_errors; }
+
+        // Whether the driver offers GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile. Needs a GL context.
+        static bool IsParallelSupported();
+    private:
+        void start(Job& job);
+        [[nodiscard]] bool is_ready(const Job& job) const;
+        void finish(Job& job);
+        static void Release(Job& job);
+    };
+}
+
+#endif
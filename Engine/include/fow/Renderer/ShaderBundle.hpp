@@ -0,0 +1,46 @@
+#ifndef FOW_RENDERER_SHADER_BUNDLE_HPP
+#define FOW_RENDERER_SHADER_BUNDLE_HPP
+
+#include <span>
+#include <string_view>
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/Shader.hpp"
+
+#define FOW_SHADER_BUNDLE_EXTENSION ".fspv"
+#define FOW_SHADER_BUNDLE_FILENAME  "shaders" FOW_SHADER_BUNDLE_EXTENSION
+#define FOW_SHADER_BUNDLE_VERSION   1
+
+namespace fow {
+    // A shader or shader variant compiled to SPIR-V by the shader cooker.
+    struct ShaderBundleEntry {
+        String name;                        // Name the shader is cached under, see ShaderVariantName
+        uint64_t source_hash = 0;           // ShaderSourceHash of the GLSL it was cooked from
+        HashMap<String, String> defaults;   // Uniform block defaults, see ParseShaderUniformDefaults
+        Vector<uint32_t> vertex;
+        Vector<uint32_t> fragment;
+    };
+
+    // Hash of the GLSL sources a bundle entry was cooked from. The runtime compares it with the sources of the shader
+    // library, so an outdated bundle is never used in place of newer sources.
+    FOW_RENDER_API uint64_t ShaderSourceHash(std::string_view vertex, std::string_view fragment);
+
+    // Serializes the entries into the versioned .fspv format, the manifest of names, hashes and defaults comes first.
+    FOW_RENDER_API Vector<std::byte> WriteShaderBundle(const Vector<ShaderBundleEntry>& entries);
+    // Validates the header and every range of a .fspv file.
+    FOW_RENDER_API Result<Vector<ShaderBundleEntry>> ReadShaderBundle(std::span<const std::byte> data);
+
+    // Cooked SPIR-V loaded with glShaderBinary and glSpecializeShader, so the driver does not parse any GLSL. Shaders
+    // that are missing from the bundle or were cooked from other sources are still compiled from GLSL.
+    namespace ShaderBundle {
+        FOW_RENDER_API Result<> Load(const Path& path);
+        FOW_RENDER_API void Unload();
+        [[nodiscard]] FOW_RENDER_API bool IsLoaded();
+
+        // Null when the bundle has no entry for these sources, or when the driver does not report uniform names for
+        // SPIR-V programs. The engine binds uniforms by name, so the bundle is not used for the rest of the run then.
+        FOW_RENDER_API ShaderPtr TryLoad(const String& name, const String& vertex, const String& fragment);
+    }
+}
+
+#endif
@@ -1,22 +1,61 @@
 #ifndef FOW_SHADERLIB_HPP
 #define FOW_SHADERLIB_HPP
 
+#include <string_view>
+
 #include "fow/Shared/Api.hpp"
 #include "fow/Shared/String.hpp"
 #include "fow/Shared/Result.hpp"
 
+// Has to match SHADER_LIB_TABLE_VERSION and the table layout of shaders/shaderlib/ShaderLib.hpp
+#define FOW_SHADERLIB_TABLE_VERSION 1
+
 namespace fow {
+    // Names of the sources of a shader, views into the read-only data of the shader library.
     struct FOW_RENDER_API ShaderSources {
-        std::string vertex, fragment;
+        std::string_view vertex, fragment;
     };
 
+    namespace ShaderLibStage {
+        enum Type : uint32_t {
+            None     = 0,
+            Vertex   = 1u << 0,
+            Fragment = 1u << 1
+        };
+    }
+
+    // The constexpr table exported by the generated shader library, see Scripts/compile_shaders.py
+    extern "C" {
+        struct ShaderLibSource {
+            const char* name;
+            const char* source;
+            size_t size;
+            uint32_t stages;                // ShaderLibStage it is used as, None for includes
+        };
+        struct ShaderLibShader {
+            const char* name;
+            uint32_t vertex, fragment;      // Indices into the sources
+        };
+        struct ShaderLibTable {
+            uint32_t version;
+            uint32_t source_count;
+            uint32_t shader_count;
+            const ShaderLibSource* sources; // Sorted by name
+            const ShaderLibShader* shaders; // Sorted by name
+        };
+    }
+
     namespace ShaderLib {
         FOW_RENDER_API Result<> Load(const Path& base_path);
+        // Uses a table that is linked into the executable instead of the shader library, the table has to outlive its use.
+        FOW_RENDER_API Result<> LoadTable(const ShaderLibTable* table);
         FOW_RENDER_API Result<ShaderSources> GetSourcesForShader(const String& name);
-        FOW_RENDER_API Result<String> GetSource(const String& name);
+        // The view stays valid until the shader library is unloaded.
+        FOW_RENDER_API Result<std::string_view> GetSource(const String& name);
+        FOW_RENDER_API uint32_t GetSourceStages(const String& name);
         FOW_RENDER_API Vector<String> GetShaders();
         FOW_RENDER_API void Unload();
     }
 }
 
-#endif
\ No newline at end of file
+#endif
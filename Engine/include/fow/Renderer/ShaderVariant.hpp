@@ -0,0 +1,55 @@
+#ifndef FOW_RENDERER_SHADER_VARIANT_HPP
+#define FOW_RENDERER_SHADER_VARIANT_HPP
+
+#include <string_view>
+
+#include "fow/Shared.hpp"
+
+// Injected into every variant. Sources define all of their features when it is missing, so the shader compiled under
+// its plain name keeps every feature.
+#define FOW_SHADER_VARIANT_DEFINE "SHADER_VARIANT"
+
+namespace fow {
+    // Optional parts of a shader that are compiled out of variants that do not need them. A source takes part by
+    // checking the define of the feature with #ifdef.
+    namespace ShaderFeatures {
+        enum Type : uint32_t {
+            None          = 0,
+            NormalMap     = 1u << 0,    // NORMAL_MAP
+            SpecularMap   = 1u << 1,    // SPECULAR_MAP
+            EmissionMap   = 1u << 2,    // EMISSION_MAP
+            ColorTintMask = 1u << 3,    // COLOR_TINT_MASK
+            AlphaScissor  = 1u << 4,    // ALPHA_SCISSOR
+            All           = 0b11111
+        };
+    }
+
+    // Bitset of ShaderFeatures.
+    using ShaderVariantKey = uint32_t;
+
+    struct ShaderVariantSources {
+        String name;        // Name the variant is cached under
+        String vertex;
+        String fragment;
+    };
+
+    FOW_RENDER_API std::string_view ShaderFeatureDefine(ShaderFeatures::Type feature);
+    // Features whose define appears in the source.
+    FOW_RENDER_API ShaderVariantKey ShaderSourceFeatures(std::string_view source);
+    // The variant marker followed by one #define per feature of the key.
+    FOW_RENDER_API String ShaderVariantDefines(ShaderVariantKey key);
+    // Inserts the defines after the #version line. A #line directive keeps the line numbers of compile errors intact.
+    FOW_RENDER_API String InjectShaderDefines(std::string_view source, std::string_view defines);
+    // e.g. "PbrGeneric[NORMAL_MAP|ALPHA_SCISSOR]", the plain name for the variant with every feature.
+    FOW_RENDER_API String ShaderVariantName(const String& name, ShaderVariantKey key, ShaderVariantKey supported = ShaderFeatures::All);
+    // Name of the shader and key of a variant name, every feature for a plain name.
+    FOW_RENDER_API std::pair<String, ShaderVariantKey> ParseShaderVariantName(const String& name);
+
+    // Injects the defines of the key into the sources of a shader. Features the sources do not check for are dropped
+    // from the key, so keys that only differ in those share one variant.
+    FOW_RENDER_API ShaderVariantSources MakeShaderVariantSources(const String& name, const String& vertex, const String& fragment, ShaderVariantKey key);
+    // MakeShaderVariantSources for a shader of the shader library.
+    FOW_RENDER_API Result<ShaderVariantSources> GetShaderVariantSources(const String& name, ShaderVariantKey key);
+}
+
+#endif
@@ -7,11 +7,12 @@
 #include "fow/Renderer/Texture.hpp"
 #include "fow/Renderer/Material.hpp"
 #include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/GlyphAtlas.hpp"
+#include "fow/Renderer/TextLayout.hpp"
+#include "fow/Renderer/SpriteBatch.hpp"
 
 #include <ft2build.h>
 
-#include "Sprite.hpp"
-
 #include FT_FREETYPE_H
 
 namespace fow {
@@ -46,6 +47,21 @@ namespace fow {
     class TextSprite2D;
     using TextSprite2DPtr = Ref<TextSprite2D>;
 
+    // Handles of the material parameters a sprite builds its SpriteBatch2D quad from, resolved again only when the
+    // material has another shader or the sprite expects another one.
+    struct SpriteBatchParams {
+        ShaderPtr shader;
+        std::string_view expected_shader;
+        bool is_batchable = false;
+        MaterialParam<Vector2> uv_offset;
+        MaterialParam<Vector2> uv_scale;
+        MaterialParam<Vector4> color_tint;
+        MaterialParam<TexturePtr> main_texture;
+        MaterialParam<float> border_thickness;
+        MaterialParam<bool> alpha_scissor;
+        MaterialParam<float> alpha_scissor_threshold;
+    };
+
     class FOW_RENDER_API Sprite : public IDrawable3D, public IDrawable3DInstanced {
         MaterialPtr m_pMaterial;
         MeshPtr m_pMesh;
@@ -78,6 +94,7 @@ namespace fow {
     protected:
         MaterialPtr m_pMaterial;
         MeshPtr m_pMesh;
+        mutable SpriteBatchParams m_batchParams;
     public:
         explicit Sprite2D(const MaterialPtr& material);
         explicit Sprite2D(MaterialPtr&& material);
@@ -91,6 +108,8 @@ namespace fow {
         [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pMesh != nullptr; }
 
         void draw_2d(const Rectangle& rect) const override;
+        // Only materials with the Generic2D shader and no border are batched.
+        bool batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const override;
 
         static Result<Sprite2DPtr> LoadAsset(const Path& path, AssetLoaderFlags::Type flags);
     private:
@@ -103,6 +122,7 @@ namespace fow {
         std::variant<Texture2DPtr, Texture2DArrayPtr> m_pTexture;
         int m_iColumns, m_iRows;
         size_t m_uIndex = 0;
+        mutable SpriteBatchParams m_batchParams;
     public:
         ArraySprite2D(const Texture2DPtr& texture, int columns, int rows, size_t index = 0);
         explicit ArraySprite2D(const Texture2DArrayPtr& texture, size_t index = 0);
@@ -115,6 +135,8 @@ namespace fow {
         void set_texture(const Texture2DArrayPtr& texture, size_t index = 0);
 
         void draw_2d(const Rectangle& rect) const override;
+        // Only materials with the Generic2D or Array2D shader that matches the texture and no border are batched.
+        bool batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const override;
 
         static Result<ArraySprite2DPtr> LoadAsset(const Path& path, AssetLoaderFlags::Type flags);
     private:
@@ -168,6 +190,8 @@ namespace fow {
         void set_background_texture(const Texture2DPtr& texture);
 
         void draw_2d(const Rectangle& rect) const override;
+        // Only materials with the Rectangle2D shader are batched.
+        bool batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const override;
 
         static Result<QuadSprite2DPtr> FromXml(const pugi::xml_document& doc);
         static Result<QuadSprite2DPtr> FromXml(const pugi::xml_node& node);
@@ -205,8 +229,9 @@ namespace fow {
         void setup_sprite();
     };
 
+    // The slices are the top left 3x3 cells of a 4x4 grid over the texture, each tiled across a third of the area. Areas
+    // no wider than twice the texture leave out the middle column.
     class FOW_RENDER_API NineSliceSprite2D : public IDrawable2D {
-        MeshPtr m_pMeshes[9];
         Texture2DPtr m_pTexture;
     public:
         explicit NineSliceSprite2D(const Texture2DPtr& texture);
@@ -216,29 +241,36 @@ namespace fow {
         void set_texture(Texture2DPtr&& texture) noexcept;
 
         [[nodiscard]] FOW_CONSTEXPR const Texture2DPtr& texture() const { return m_pTexture; }
-        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const {
-            return m_pMeshes[0] != nullptr && m_pMeshes[1] != nullptr && m_pMeshes[2] != nullptr &&
-                   m_pMeshes[3] != nullptr && m_pMeshes[4] != nullptr && m_pMeshes[5] != nullptr &&
-                   m_pMeshes[6] != nullptr && m_pMeshes[7] != nullptr && m_pMeshes[8] != nullptr &&
-                   m_pTexture != nullptr;
-        }
+        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pTexture != nullptr; }
 
+        // All nine slices in one draw through the sprite batch.
         void draw_2d(const Rectangle& rect) const override;
-    private:
-        void setup_sprite();
+        bool batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const override;
     };
 
     class FOW_RENDER_API Font final {
         FT_Face m_pFace;
+        uint32_t m_uId;
+        uint32_t m_uSize;
+        float m_fAscender, m_fDescender, m_fLineHeight;
     public:
         Font(const Path& path, uint32_t size);
         ~Font();
 
         [[nodiscard]] FOW_RENDER_API constexpr bool is_valid() const { return m_pFace != nullptr; }
+        // Unique per loaded face, keys the glyphs of the font in the GlyphAtlas.
+        [[nodiscard]] FOW_CONSTEXPR uint32_t id() const { return m_uId; }
+        [[nodiscard]] FOW_CONSTEXPR uint32_t size() const { return m_uSize; }
+        // Line metrics in pixels at the size of the font, the descender is negative.
+        [[nodiscard]] FOW_CONSTEXPR float ascender() const { return m_fAscender; }
+        [[nodiscard]] FOW_CONSTEXPR float descender() const { return m_fDescender; }
+        [[nodiscard]] FOW_CONSTEXPR float line_height() const { return m_fLineHeight; }
 
         Result<> change_font(const Path& path, uint32_t size);
 
         friend class TextRenderer;
+        friend class GlyphAtlas;
+        friend class TextLayoutCache;
         friend class BaseTextSprite;
         friend class TextSprite;
         friend class TextSprite2D;
@@ -269,6 +301,8 @@ namespace fow {
         String m_sText;
         Color m_Color = ColorConstants::White;
         TextAlignment m_eTextAlignment = { HorizontalAlignment::Left, VerticalAlignment::Top };
+        int32_t m_iWrapWidth = 0;
+        mutable TextLayoutPtr m_pLayout = nullptr;
     public:
         TextRenderer(const String& text, const Path& font_path, float size);
         TextRenderer(const String& text, const FontPtr& font);
@@ -280,32 +314,41 @@ namespace fow {
         void set_alignment(const HorizontalAlignment& horizontal_alignment, const VerticalAlignment& vertical_alignment);
         void set_alignment(const HorizontalAlignment& alignment);
         void set_alignment(const VerticalAlignment& vertical_alignment);
+        // Width in pixels lines wrap at between words, zero only breaks lines at '\n'.
+        void set_wrap_width(int32_t width);
 
         [[nodiscard]] FOW_CONSTEXPR Color color() const { return m_Color; }
         [[nodiscard]] FOW_CONSTEXPR const String& text() const { return m_sText; }
         [[nodiscard]] FOW_CONSTEXPR const FontPtr& font() const { return m_pFont; }
         [[nodiscard]] FOW_CONSTEXPR const TextAlignment& alignment() const { return m_eTextAlignment; }
+        [[nodiscard]] FOW_CONSTEXPR int32_t wrap_width() const { return m_iWrapWidth; }
 
         [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pFont != nullptr; }
 
-        [[nodiscard]] Result<Texture2DPtr> create_texture(const Vector2i& texture_size) const;
-        [[nodiscard]] Result<Texture2DPtr> create_texture(const Vector2i& texture_size, const TextureInfo& info) const;
-        [[nodiscard]] Result<Texture2DPtr> create_texture(const Vector2i& texture_size, const TexturePtr& reuse) const;
-        [[nodiscard]] Result<Texture2DPtr> create_texture(const Vector2i& texture_size, const TextureInfo& info, const TexturePtr& reuse) const;
+        // Places a quad per glyph of the UTF-8 text, in pixels from the top left of the area. Lines break at '\n' and
+        // the wrap width, and are aligned inside the area. The glyph runs come from the TextLayoutCache, a new text
+        // continues from the previous layout when only its end changed. Rasterizes glyphs missing from the GlyphAtlas,
+        // so GL thread only.
+        [[nodiscard]] Result<Vector<GlyphQuad>> layout(const Vector2i& area_size) const;
     };
 
+    // Text drawn as quads of signed distance field glyphs from the GlyphAtlas. Changing the text only rewrites the
+    // vertices, changing the color only a uniform. The material needs a text shader, "Text2D" or "Text".
     class FOW_RENDER_API BaseTextSprite {
     protected:
-        Texture2DPtr m_pTexture = nullptr;
         MaterialPtr m_pMaterial = nullptr;
-        MeshPtr m_pMesh = nullptr;
         TextRenderer m_textRenderer;
         IntRectangle m_textArea = { 0, 0, 128, 128 };
+        mutable Vector<GlyphQuad> m_glyphs;
+        mutable GlyphQuadBuffer m_quads;                // Only filled for direct draws, batched text skips the upload
+        mutable uint32_t m_uAtlasGeneration = 0;
+        mutable bool m_bLayoutValid = false;
+        mutable bool m_bQuadsValid = false;
     public:
         BaseTextSprite(const String& text, const FontPtr& font, const MaterialPtr& material, const IntRectangle& text_area);
         virtual ~BaseTextSprite() = default;
 
-        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pMesh != nullptr && m_textRenderer.is_valid(); }
+        [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_pMaterial != nullptr && m_textRenderer.is_valid(); }
 
         void set_material(const MaterialPtr& material);
         [[nodiscard]] FOW_CONSTEXPR const MaterialPtr& material() const { return m_pMaterial; }
@@ -322,17 +365,28 @@ namespace fow {
         void set_alignment(const TextAlignment& alignment);
         [[nodiscard]] FOW_CONSTEXPR const TextAlignment& alignment() const { return m_textRenderer.alignment(); }
 
+        void set_wrap_width(int32_t width);
+        [[nodiscard]] FOW_CONSTEXPR int32_t wrap_width() const { return m_textRenderer.wrap_width(); }
+
         [[nodiscard]] FOW_CONSTEXPR const IntRectangle& text_area() const { return m_textArea; }
         void set_text_area(const IntRectangle& rect);
 
-        void update_texture();
+        // Lays the text out again, draws do this on their own after a change or when the atlas evicted glyphs.
+        void update_layout() const;
 
     protected:
         virtual void setup_sprite();
+        // Lays out when needed, false when there is nothing to draw.
+        [[nodiscard]] bool update_glyphs() const;
+        // Lays out and uploads the glyphs when needed and applies the atlas and color, false when there is nothing to draw.
+        [[nodiscard]] bool prepare_draw() const;
     };
 
     class FOW_RENDER_API TextSprite : public BaseTextSprite, public IDrawable3D, public IDrawable3DInstanced {
         BillboardMode m_eBillboardMode;
+        mutable ShaderPtr m_pModelMatrixShader;         // Shader m_iModelMatrixLocation was looked up in
+        mutable GLint m_iModelMatrixLocation = -1;
+        mutable Vector<Matrix4> m_modelMatrices;
     public:
         TextSprite(const String& text, const FontPtr& font, const MaterialPtr& material, const IntRectangle& text_area, const BillboardMode& mode = BillboardMode::None);
 
@@ -350,6 +404,8 @@ namespace fow {
         TextSprite2D(const String& text, const FontPtr& font, const MaterialPtr& material, const IntRectangle& text_area);
 
         void draw_2d(const Rectangle& rect) const override;
+        // Only materials with the Text2D shader are batched.
+        bool batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const override;
     protected:
         void setup_sprite() override;
     };
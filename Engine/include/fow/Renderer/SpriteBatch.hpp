@@ -0,0 +1,134 @@
+#ifndef FOW_RENDERER_SPRITE_BATCH_HPP
+#define FOW_RENDERER_SPRITE_BATCH_HPP
+
+#include <array>
+#include <span>
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/Material.hpp"
+#include "fow/Renderer/Texture.hpp"
+#include "fow/Renderer/TextureAtlas.hpp"
+
+// Textures a single batch samples from, a batch ends when a quad needs one more. SpriteBatch2D.fsh declares as many
+// samplers.
+#define FOW_SPRITE_BATCH_TEXTURE_SLOTS 8
+#define FOW_SPRITE_BATCH_ARRAY_SLOTS   4
+
+namespace fow {
+    struct IDrawable2D;
+
+    // How SpriteBatch2D.fsh turns the texel of a quad into a color.
+    namespace SpriteQuadMode {
+        enum Type : uint32_t {
+            Texture       = 0,      // Texel times color, like Generic2D
+            DistanceField = 1,      // Glyph from the GlyphAtlas in the color, like Text2D
+            RoundedRect   = 2,      // Like Rectangle2D, params: size xy, corner radius, border thickness
+            Stretch       = 3,      // Like StretchSprite2D, uv repeats the UV rectangle in params: start xy, end zw
+        };
+    }
+
+    struct SpriteQuad {
+        Rectangle rect;                                 // In pixels, like the area of draw_2d
+        Vector2 uv_min { 0.0f, 0.0f };
+        Vector2 uv_max { 1.0f, 1.0f };
+        float array_layer = 0.0f;                       // Layer sampled from array textures
+        Vector4 params { 0.0f };
+        Color color = ColorConstants::White;
+        Color border_color = ColorConstants::Black;
+        TexturePtr texture;
+        SpriteQuadMode::Type mode = SpriteQuadMode::Texture;
+        float alpha_scissor = 0.0f;                     // Alpha below which fragments are discarded, zero keeps all
+    };
+
+    struct SpriteVertex {
+        Vector2 position;
+        Vector3 uv;                                     // z is the array layer
+        Vector4 params;
+        uint32_t color;                                 // RGBA8
+        uint32_t border_color;                          // RGBA8
+        uint32_t flags;                                 // Bits 0-3: texture slot, bit 4: array slot, bits 8-15: mode
+        float alpha_scissor;
+    };
+    static_assert(sizeof(SpriteVertex) == 52);
+
+    // Consecutive quads drawn with one glDrawElements, the textures are bound to the slots of the batch shader.
+    struct SpriteBatchRange {
+        uint32_t first_quad;
+        uint32_t quad_count;
+        std::array<TexturePtr, FOW_SPRITE_BATCH_TEXTURE_SLOTS> textures;
+        std::array<TexturePtr, FOW_SPRITE_BATCH_ARRAY_SLOTS> arrays;
+        uint32_t texture_count;
+        uint32_t array_count;
+    };
+
+    FOW_RENDER_API uint32_t PackColorRGBA8(const Color& color);
+    // Points the quad at the atlas page instead of its texture, false when the UVs of the quad cannot be expressed on the
+    // page, e.g. repeating UVs outside of the texture.
+    FOW_RENDER_API bool RemapToAtlas(SpriteQuad& quad, const AtlasRegion& region);
+
+    // Collects the quads of 2D drawables over a frame into one dynamic vertex buffer and draws them with as few draws as
+    // the textures allow. Quads are drawn by layer, quads of a layer in the order they were added. Textures never split
+    // a batch until it samples from more than the slots of the shader.
+    class FOW_RENDER_API SpriteBatch2D {
+        Vector<SpriteQuad> m_quads;
+        Vector<int32_t> m_layers;
+        Vector<SpriteVertex> m_vertices;
+        Vector<SpriteBatchRange> m_batches;
+        int32_t m_iLayer;
+        bool m_bOrdered;                                // Quads were added by layer, build kept their order
+        const TextureAtlas* m_pAtlas;
+        mutable MaterialPtr m_pMaterial;
+        mutable Vector<MaterialParam<TexturePtr>> m_textureParams;
+        mutable Vector<MaterialParam<TexturePtr>> m_arrayParams;
+        mutable GLuint m_uVao, m_uVbo, m_uEbo;
+        mutable size_t m_uCapacity;                     // In quads
+        mutable size_t m_uUploadBegin, m_uUploadEnd;    // Quads changed since the last submit
+        mutable size_t m_uDrawCalls;
+    public:
+        explicit SpriteBatch2D(const TextureAtlas* atlas = nullptr);
+        SpriteBatch2D(const SpriteBatch2D&) = delete;
+        ~SpriteBatch2D();
+
+        SpriteBatch2D& operator=(const SpriteBatch2D&) = delete;
+
+        // Layer of the quads added from now on.
+        inline void set_layer(const int32_t layer) { m_iLayer = layer; }
+        [[nodiscard]] FOW_CONSTEXPR int32_t layer() const { return m_iLayer; }
+        // Quads of textures on the atlas are added with the page instead, none keeps every texture as it is.
+        inline void set_atlas(const TextureAtlas* atlas) { m_pAtlas = atlas; }
+        [[nodiscard]] FOW_CONSTEXPR const TextureAtlas* atlas() const { return m_pAtlas; }
+
+        void add(const SpriteQuad& quad);
+        // Orders the quads by layer, then writes the vertices and splits them into batches by texture slots.
+        void build();
+        // Replaces built quads in place and rewrites only their vertices, so a batch that is kept over frames uploads
+        // just the changed part. False when the quads would need the batches rebuilt, e.g. a texture without a free
+        // slot, then neither the quads nor the slots of the batches changed.
+        bool patch(size_t first_quad, std::span<const SpriteQuad> quads);
+        // Uploads the vertices changed since the last submit and issues one draw per batch. GL thread only.
+        void submit() const;
+        void clear();
+        // Builds, submits and clears. Has to happen before anything is drawn without the batch, so the order is kept.
+        void flush();
+        // Draws the drawable through the batch right away, false when it cannot be batched.
+        bool draw_immediate(const IDrawable2D& drawable, const Rectangle& rect);
+        // Deletes the buffers and the material.
+        void release();
+
+        [[nodiscard]] FOW_CONSTEXPR bool is_empty() const { return m_quads.empty(); }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<SpriteQuad>& quads() const { return m_quads; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<SpriteVertex>& vertices() const { return m_vertices; }
+        [[nodiscard]] FOW_CONSTEXPR const Vector<SpriteBatchRange>& batches() const { return m_batches; }
+        // Draws issued by submit since the last call to reset_draw_calls.
+        [[nodiscard]] FOW_CONSTEXPR size_t draw_calls() const { return m_uDrawCalls; }
+        inline void reset_draw_calls() { m_uDrawCalls = 0; }
+
+        static SpriteBatch2D& Instance();
+    private:
+        bool prepare_gl(size_t quads) const;
+        void remap(SpriteQuad& quad) const;
+    };
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef FOW_RENDERER_TEXT_LAYOUT_HPP
+#define FOW_RENDERER_TEXT_LAYOUT_HPP
+
+#include <list>
+#include <string_view>
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/GlyphAtlas.hpp"
+
+// Bytes of glyph runs the TextLayoutCache keeps before it evicts the least recently used layouts.
+#ifndef FOW_TEXT_LAYOUT_CACHE_BUDGET
+    #define FOW_TEXT_LAYOUT_CACHE_BUDGET (1024 * 1024)
+#endif
+
+namespace fow {
+    class Font;
+
+    struct TextLayoutKey {
+        uint32_t font;
+        uint32_t size;
+        uint64_t text_hash;
+        int32_t wrap_width;
+
+        FOW_CONSTEXPR bool operator==(const TextLayoutKey& other) const = default;
+    };
+    struct TextLayoutKeyHash {
+        size_t operator()(const TextLayoutKey& key) const noexcept {
+            return std::hash<uint64_t> { }(key.text_hash ^ (static_cast<uint64_t>(key.font) << 48) ^ (static_cast<uint64_t>(key.size) << 32) ^ static_cast<uint32_t>(key.wrap_width));
+        }
+    };
+
+    struct TextLine {
+        uint32_t first_glyph;
+        uint32_t first_codepoint;
+        float width;                    // Up to the end of the last glyph that is not whitespace
+        bool wrapped;                   // Started by word wrapping instead of '\n'
+    };
+
+    // State of the layout before a codepoint, layouts of a text with the same beginning continue from here.
+    struct TextCursor {
+        uint32_t byte;
+        uint32_t glyph;                 // Glyphs placed before the codepoint
+        uint32_t line;
+        uint32_t previous;              // Glyph index to kern with, zero at word starts
+        float pen_x;
+        float line_width;
+    };
+
+    // Positioned glyphs of a UTF-8 text in one font, before alignment. Quads are in pixels from the left of their line
+    // and the top of the first line.
+    struct FOW_RENDER_API TextLayout {
+        String text;
+        uint32_t font = 0;
+        uint32_t size = 0;
+        int32_t wrap_width = 0;         // Zero without word wrapping
+        uint32_t generation = 0;        // Of the GlyphAtlas the quads point into
+        float height = 0.0f;
+        Vector<GlyphQuad> glyphs;
+        Vector<TextLine> lines;
+        Vector<TextCursor> cursors;     // One per codepoint and one for the end of the text
+
+        // Cursor to continue from when laying out the text instead, everything before it stays the same.
+        [[nodiscard]] size_t resume_cursor(std::string_view new_text) const;
+        [[nodiscard]] size_t memory_usage() const;
+    };
+    using TextLayoutPtr = Ref<const TextLayout>;
+
+    // Glyph runs of recently laid out texts keyed by font, size, text and wrap width, so UI text that keeps switching
+    // between a few values, or only changes at the end like counters do, is not shaped from scratch every frame.
+    class FOW_RENDER_API TextLayoutCache {
+        struct Entry {
+            TextLayoutKey key;
+            TextLayoutPtr layout;
+        };
+
+        std::list<Entry> m_entries;     // Most recently used first
+        HashMap<TextLayoutKey, std::list<Entry>::iterator, TextLayoutKeyHash> m_index;
+        size_t m_uBudget;
+        size_t m_uMemoryUsage;
+        size_t m_uHits, m_uMisses, m_uResumed;
+    public:
+        explicit TextLayoutCache(size_t budget = FOW_TEXT_LAYOUT_CACHE_BUDGET);
+        TextLayoutCache(const TextLayoutCache&) = delete;
+        TextLayoutCache& operator=(const TextLayoutCache&) = delete;
+
+        // Cached layout of the text, or a new one continued from the previous layout of the same text object when only
+        // the end of the text changed. Rasterizes glyphs missing from the GlyphAtlas, so GL thread only.
+        Result<TextLayoutPtr> get(const Font& font, std::string_view text, int32_t wrap_width, const TextLayoutPtr& previous = nullptr);
+
+        [[nodiscard]] TextLayoutPtr find(const TextLayoutKey& key, std::string_view text);
+        // Layouts larger than the whole budget are not kept.
+        void insert(const TextLayoutKey& key, const TextLayoutPtr& layout);
+        void clear();
+
+        void set_budget(size_t budget);
+        [[nodiscard]] FOW_CONSTEXPR size_t budget() const { return m_uBudget; }
+        [[nodiscard]] FOW_CONSTEXPR size_t memory_usage() const { return m_uMemoryUsage; }
+        [[nodiscard]] inline size_t size() const { return m_entries.size(); }
+        [[nodiscard]] FOW_CONSTEXPR size_t hits() const { return m_uHits; }
+        [[nodiscard]] FOW_CONSTEXPR size_t misses() const { return m_uMisses; }
+        // Misses that reused the beginning of the previous layout.
+        [[nodiscard]] FOW_CONSTEXPR size_t resumed() const { return m_uResumed; }
+
+        static TextLayoutKey MakeKey(uint32_t font, uint32_t size, std::string_view text, int32_t wrap_width);
+        static TextLayoutCache& Instance();
+    private:
+        void evict();
+        Result<Ref<TextLayout>> layout(const Font& font, std::string_view text, int32_t wrap_width, const TextLayout* previous);
+    };
+}
+
+#endif
@@ -50,6 +50,8 @@ namespace fow {
         LuminanceAlpha      = GL_LUMINANCE8_ALPHA8_EXT,
         RGB                 = GL_RGB8,
         RGBA                = GL_RGBA8,
+        SRGB                = GL_SRGB8,
+        SRGBA               = GL_SRGB8_ALPHA8,
         CompressedRGTC1     = GL_COMPRESSED_RED_RGTC1,
         CompressedRGTC1S    = GL_COMPRESSED_SIGNED_RED_RGTC1,
         CompressedRGTC2     = GL_COMPRESSED_RED_GREEN_RGTC2_EXT,
@@ -130,6 +132,7 @@ namespace fow {
         }
 
         [[nodiscard]] FOW_CONSTEXPR GLuint id() const { return m_uId; }
+        // False while the texture waits in the UploadQueue, a pending 2D texture binds a neutral gray texture instead.
         [[nodiscard]] FOW_CONSTEXPR bool is_valid() const { return m_uId != 0; }
         FOW_ABSTRACT(TextureTarget target() const);
 
@@ -164,6 +167,8 @@ namespace fow {
         static TexturePtr DefaultBlack();
         static TexturePtr DefaultNormal();
         static void UnloadPlaceHolder();
+
+        friend class UploadQueue;
     };
 
     class FOW_RENDER_API Texture2D final : public Texture {
@@ -181,6 +186,9 @@ namespace fow {
 
         static Result<Texture2DPtr> Load(const TextureInfo& info);
         static Result<Texture2DPtr> LoadFromMemory(const Vector<uint8_t>& data, const TextureInfo& info);
+        // Decodes the image on the calling thread and hands the pixels to the UploadQueue, the texture stays pending until
+        // it is uploaded. Safe to call from loader threads.
+        static Result<Texture2DPtr> LoadFromMemoryDeferred(const Vector<uint8_t>& data, const TextureInfo& info);
         static Result<Texture2DPtr> LoadAsset(const Path& path, AssetLoaderFlags::Type flags);
 
         static Result<Texture2DPtr> CreateFromRawData(const Vector<uint8_t>& data, const Vector2i& size, const TextureInfo& info, TexturePixelFormat format, TextureInternalPixelFormat internal_format);
@@ -191,6 +199,7 @@ namespace fow {
 
         friend class Texture;
         friend class Shader;
+        friend class TextureAtlas;
     };
     class FOW_RENDER_API Texture2DArray final : public Texture {
     protected:
@@ -214,6 +223,7 @@ namespace fow {
 
         friend class Texture;
         friend class Shader;
+        friend class GlyphAtlas;
     };
     class FOW_RENDER_API TextureCubeMap final : public Texture {
     protected:
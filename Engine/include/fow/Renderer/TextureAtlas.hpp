@@ -0,0 +1,105 @@
+#ifndef FOW_RENDERER_TEXTURE_ATLAS_HPP
+#define FOW_RENDERER_TEXTURE_ATLAS_HPP
+
+#include <mutex>
+
+#include "fow/Shared.hpp"
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/Texture.hpp"
+
+#ifndef FOW_TEXTURE_ATLAS_PAGE_SIZE
+    #define FOW_TEXTURE_ATLAS_PAGE_SIZE 2048
+#endif
+// Larger textures are not worth a share of a page, they stay textures of their own.
+#ifndef FOW_TEXTURE_ATLAS_MAX_SIZE
+    #define FOW_TEXTURE_ATLAS_MAX_SIZE 512
+#endif
+// Texels of replicated edge around every texture and the alignment of the cells, a power of two. The pages have mips
+// down to the level where the gutter shrinks to one texel, so no level mixes neighbouring textures.
+#ifndef FOW_TEXTURE_ATLAS_PADDING
+    #define FOW_TEXTURE_ATLAS_PADDING 4
+#endif
+
+namespace fow {
+    // Packs rectangles into the free rectangle that leaves the shortest side over, keeping every maximal free rectangle
+    // around. Packs tighter than SkylinePacker, which is worth the cost for textures that are placed once at load.
+    class FOW_RENDER_API MaxRectsPacker {
+        struct Rect {
+            int x, y, width, height;
+        };
+
+        Vector2i m_size;
+        Vector<Rect> m_free;
+        int64_t m_iUsedArea;
+    public:
+        explicit MaxRectsPacker(const Vector2i& size = { 0, 0 });
+
+        // Top left corner of the placed rectangle, none when it does not fit anymore.
+        [[nodiscard]] Option<Vector2i> pack(const Vector2i& size);
+        void reset(const Vector2i& size);
+
+        [[nodiscard]] FOW_CONSTEXPR const Vector2i& size() const { return m_size; }
+        [[nodiscard]] inline size_t free_rect_count() const { return m_free.size(); }
+        // Share of the area covered by packed rectangles.
+        [[nodiscard]] float occupancy() const;
+    private:
+        void prune();
+    };
+
+    // Where an atlased texture lies on its page, texture UVs map to uv_offset + uv * uv_scale.
+    struct AtlasRegion {
+        Texture2DPtr page;
+        Vector2 uv_offset { 0.0f };
+        Vector2 uv_scale { 1.0f };
+        std::weak_ptr<Texture> source;
+
+        [[nodiscard]] inline Vector2 map(const Vector2& uv) const { return uv_offset + uv * uv_scale; }
+    };
+
+    // Copies small 2D textures of sprites and UI into shared pages, so SpriteBatch2D draws them from the page and quads
+    // of different sprites stop splitting batches by texture. The source textures stay valid for everything else.
+    class FOW_RENDER_API TextureAtlas {
+        struct Page {
+            Texture2DPtr texture;
+            MaxRectsPacker packer;
+            TextureMagFilterMode filter;
+            bool is_dirty;
+        };
+
+        Vector<Page> m_pages;
+        HashMap<const Texture*, AtlasRegion> m_regions;
+        Vector<std::weak_ptr<Texture2D>> m_pending;
+        mutable std::mutex m_mutex;
+        uint32_t m_uRevision;
+    public:
+        TextureAtlas() : m_uRevision(0) { }
+        TextureAtlas(const TextureAtlas&) = delete;
+
+        TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+        // Queues the texture for the next update. Safe to call from loader threads, the texture may still be pending.
+        void add(const Texture2DPtr& texture);
+        // Copies the queued textures that are resident into the pages, textures still uploading wait for the next update.
+        // Only RGBA8 textures up to FOW_TEXTURE_ATLAS_MAX_SIZE are taken, everything else is dropped. GL thread only.
+        void update();
+        // Region of the texture, null when it is not on a page (yet).
+        [[nodiscard]] const AtlasRegion* find(const Texture* texture) const;
+        // Deletes the pages, every region is gone.
+        void release();
+
+        [[nodiscard]] inline size_t page_count() const { return m_pages.size(); }
+        [[nodiscard]] inline size_t region_count() const { return m_regions.size(); }
+        // Changes whenever textures were placed, quads remapped before may now have a page to move to.
+        [[nodiscard]] FOW_CONSTEXPR uint32_t revision() const { return m_uRevision; }
+
+        // Size the texture takes on a page, the gutters included and rounded up to the padding.
+        [[nodiscard]] static Vector2i CellSize(const Vector2i& size);
+        static TextureAtlas& Instance();
+    private:
+        Option<std::pair<size_t, Vector2i>> allocate(const Vector2i& size, TextureMagFilterMode filter);
+        Result<> add_page(TextureMagFilterMode filter);
+        void copy(const Texture2D& texture, const Page& page, const Vector2i& position, const Vector2i& size) const;
+    };
+}
+
+#endif
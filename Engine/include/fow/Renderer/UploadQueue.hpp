@@ -0,0 +1,125 @@
+#ifndef FOW_RENDERER_UPLOAD_QUEUE_HPP
+#define FOW_RENDERER_UPLOAD_QUEUE_HPP
+
+#include <mutex>
+#include <variant>
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/Texture.hpp"
+#include "fow/Shared.hpp"
+
+#ifndef FOW_UPLOAD_STAGING_SIZE
+    #define FOW_UPLOAD_STAGING_SIZE (32u << 20)
+#endif
+#ifndef FOW_UPLOAD_FRAME_BYTE_BUDGET
+    #define FOW_UPLOAD_FRAME_BYTE_BUDGET (8u << 20)
+#endif
+#ifndef FOW_UPLOAD_FRAME_TIME_BUDGET_MS
+    #define FOW_UPLOAD_FRAME_TIME_BUDGET_MS 2.0
+#endif
+
+namespace fow {
+    // Ring of bytes that are handed out in order and given back in the same order, used for the staging buffer where
+    // space can only be reused once the GPU finished the copies reading it.
+    class FOW_RENDER_API RingAllocator {
+        size_t m_uCapacity;
+        size_t m_uHead;
+        size_t m_uUsed;
+        uint64_t m_uPosition;
+    public:
+        explicit RingAllocator(size_t capacity = 0) : m_uCapacity(capacity), m_uHead(0), m_uUsed(0), m_uPosition(0) { }
+
+        // Returns the offset of the allocation, none while not enough space has been released.
+        [[nodiscard]] Option<size_t> allocate(size_t size, size_t alignment = 1);
+        // Releases everything allocated before position() returned the given value.
+        void release_until(uint64_t position);
+        void reset(size_t capacity);
+
+        // Total bytes allocated so far, including the padding skipped for alignment and at the end of the ring.
+        [[nodiscard]] FOW_CONSTEXPR uint64_t position() const { return m_uPosition; }
+        [[nodiscard]] FOW_CONSTEXPR size_t capacity() const { return m_uCapacity; }
+        [[nodiscard]] FOW_CONSTEXPR size_t used() const { return m_uUsed; }
+    };
+
+    // CPU side data of a static mesh, the vertices are already encoded in the layout. Produced on any thread.
+    struct MeshUploadPayload {
+        MaterialPtr material;
+        VertexLayout layout;
+        VertexQuantization quantization;
+        Vector<std::byte> vertex_data;
+        uint32_t vertex_count;
+        Vector<GLuint> indices;
+        Vector<MeshLod> lods;           // Index into indices
+        BoundingSphere bounds;
+        MeshPrimitive primitive = MeshPrimitive::Triangles;
+    };
+
+    // CPU side pixels of a 2D texture. Produced on any thread.
+    struct TextureUploadPayload {
+        Vector<uint8_t> pixels;
+        Vector2i size;
+        TextureInfo info;
+        TexturePixelFormat format;
+        TextureInternalPixelFormat internal_format;
+    };
+
+    // Moves uploads off the frame that creates a resource. Loader threads enqueue payloads and get pending meshes and
+    // textures back, the GL thread copies them into a persistently mapped staging buffer and from there into their GL
+    // objects under a per frame byte and time budget. Staging space is reused once a fence says the GPU is done with it.
+    class FOW_RENDER_API UploadQueue {
+        struct MeshJob {
+            std::weak_ptr<Mesh> mesh;
+            MeshUploadPayload payload;
+        };
+        struct TextureJob {
+            std::weak_ptr<Texture2D> texture;
+            TextureUploadPayload payload;
+        };
+        using Job = std::variant<MeshJob, TextureJob>;
+
+        struct StagingFence {
+            GLsync sync;
+            uint64_t position;
+        };
+
+        mutable std::mutex m_mutex;
+        Deque<Job> m_jobs;
+        RingAllocator m_ring;
+        Deque<StagingFence> m_fences;
+        GLuint m_uStagingBuffer;
+        std::byte* m_pStaging;
+        bool m_bStagingFailed;
+
+        UploadQueue() : m_uStagingBuffer(0), m_pStaging(nullptr), m_bStagingFailed(false) { }
+    public:
+        UploadQueue(const UploadQueue&) = delete;
+        UploadQueue& operator=(const UploadQueue&) = delete;
+
+        // Thread safe, the returned resources stay pending until process uploaded them.
+        MeshPtr enqueue(MeshUploadPayload&& payload);
+        Texture2DPtr enqueue(TextureUploadPayload&& payload);
+
+        // Uploads queued resources in order until one of the budgets is used up. GL thread only, called once per frame
+        // by RenderQueue::Render. The first upload of a frame ignores the byte budget so large resources still get through.
+        void process(size_t byte_budget = FOW_UPLOAD_FRAME_BYTE_BUDGET, double time_budget_ms = FOW_UPLOAD_FRAME_TIME_BUDGET_MS);
+        // Uploads everything that is queued and waits for staging space when needed, e.g. behind a loading screen.
+        void flush();
+        // Deletes the staging buffer, queued jobs are kept and use a new one.
+        void release();
+
+        [[nodiscard]] size_t pending() const;
+
+        static UploadQueue& Instance();
+    private:
+        Result<> create_staging();
+        void retire_fences(bool wait);
+        // Reserves space in the staging buffer, none when the ring is full or the payload does not fit at all.
+        Option<size_t> stage(size_t size, size_t alignment);
+        // Returns false when the job has to wait for staging space.
+        bool upload(MeshJob& job, size_t& uploaded_bytes);
+        bool upload(TextureJob& job, size_t& uploaded_bytes);
+    };
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef FOW_RENDERER_VERTEX_LAYOUT_HPP
+#define FOW_RENDERER_VERTEX_LAYOUT_HPP
+
+#include <cstddef>
+
+#include "fow/Renderer/GL.hpp"
+#include "fow/Shared.hpp"
+
+// Bits of the VERTEX_FORMAT shader uniform.
+#define FOW_VERTEX_FORMAT_OCTAHEDRAL_NORMALS 0x1u
+#define FOW_VERTEX_FORMAT_PACKED_TANGENTS    0x2u
+
+namespace fow {
+    struct Vertex;
+
+    enum class VertexPositionFormat : uint8_t {
+        Float32,
+        Unorm16     // Quantized to the mesh bounds, dequantized with VertexQuantization in the vertex shader
+    };
+    enum class VertexNormalFormat : uint8_t {
+        Float32,
+        Octahedral  // Octahedral snorm16x2 normal, 10:10:10 tangent with the bitangent sign in w
+    };
+    enum class VertexUVFormat : uint8_t {
+        Float32,
+        Half,
+        Unorm16     // Only for UVs within [0, 1]
+    };
+
+    struct VertexQuantization {
+        Vector3 scale  { 1.0f };
+        Vector3 offset { 0.0f };
+    };
+
+    struct FOW_RENDER_API VertexLayout {
+        VertexPositionFormat position = VertexPositionFormat::Float32;
+        VertexNormalFormat normal = VertexNormalFormat::Float32;
+        VertexUVFormat uv = VertexUVFormat::Float32;
+
+        [[nodiscard]] FOW_CONSTEXPR uint32_t position_size() const { return position == VertexPositionFormat::Float32 ? 12 : 8; }
+        [[nodiscard]] FOW_CONSTEXPR uint32_t normal_size() const { return normal == VertexNormalFormat::Float32 ? 36 : 8; }
+        [[nodiscard]] FOW_CONSTEXPR uint32_t uv_size() const { return uv == VertexUVFormat::Float32 ? 8 : 4; }
+        [[nodiscard]] FOW_CONSTEXPR uint32_t stride() const { return position_size() + normal_size() + uv_size(); }
+        [[nodiscard]] FOW_CONSTEXPR GLuint shader_flags() const {
+            return normal == VertexNormalFormat::Octahedral ? FOW_VERTEX_FORMAT_OCTAHEDRAL_NORMALS | FOW_VERTEX_FORMAT_PACKED_TANGENTS : 0u;
+        }
+
+        bool operator==(const VertexLayout& other) const = default;
+
+        // Encodes the vertices into an interleaved buffer of this layout. With fit_bounds the quantization receives the
+        // dequantization transform of the vertex bounds, otherwise the given one is reused and positions outside of it are clamped.
+        [[nodiscard]] Vector<std::byte> encode(const Vector<Vertex>& vertices, VertexQuantization& quantization, bool fit_bounds = true) const;
+        // Sets up the attribute pointers of the currently bound vertex array.
+        void setup_attributes() const;
+
+        static const VertexLayout Full;
+        static const VertexLayout Compact;
+    };
+
+    FOW_RENDER_API Vector2 EncodeOctahedral(const Vector3& normal);
+    FOW_RENDER_API Vector3 DecodeOctahedral(const Vector2& encoded);
+}
+
+#endif
@@ -24,8 +24,8 @@ namespace fow {
     using Deque = std::deque<T>;
     template<typename T>
     using InitList = std::initializer_list<T>;
-    template<typename K, typename V>
-    using HashMap = std::unordered_map<K, V>;
+    template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    using HashMap = std::unordered_map<K, V, Hash, KeyEqual>;
     template<typename K, typename V>
     using SortedMap = std::map<K, V>;
 
@@ -88,7 +88,9 @@ namespace fow {
     namespace AssetLoaderFlags {
         enum Type {
             Default    = 0b0000,
-            IgnoreMods = 0b0001
+            IgnoreMods = 0b0001,
+            // Textures and models hand their GPU uploads to the UploadQueue and are returned pending.
+            Deferred   = 0b0010
         };
     }
 
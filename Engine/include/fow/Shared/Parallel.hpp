@@ -0,0 +1,15 @@
+#ifndef FOW_PARALLEL_HPP
+#define FOW_PARALLEL_HPP
+
+#include <fow/Shared/Api.hpp>
+#include <functional>
+
+namespace fow {
+    // Number of worker threads used by ParallelFor, at least one.
+    FOW_SHARED_API size_t GetWorkerThreadCount();
+    // Runs job for every index in [0, count) on up to max_threads threads (0 uses GetWorkerThreadCount) and waits for all of them.
+    // The calling thread takes part, so a single job or a single thread runs inline. Jobs must not throw.
+    FOW_SHARED_API void ParallelFor(size_t count, const std::function<void(size_t)>& job, size_t max_threads = 0);
+}
+
+#endif
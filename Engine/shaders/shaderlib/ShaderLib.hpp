@@ -1,12 +1,8 @@
 #ifndef SHADERCACHE_HPP
 #define SHADERCACHE_HPP
 
-#include <string>
-#include <optional>
-#include <memory>
-#include <ranges>
-#include <vector>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
 
 #ifdef SHADER_LIB_EXPORTS
     #ifdef _WIN32
@@ -22,15 +18,32 @@
     #endif
 #endif
 
+// Has to match FOW_SHADERLIB_TABLE_VERSION and the layout of the table in fow/Renderer/ShaderLib.hpp
+#define SHADER_LIB_TABLE_VERSION 1
+
+#define SHADER_LIB_STAGE_VERTEX   (1u << 0)
+#define SHADER_LIB_STAGE_FRAGMENT (1u << 1)
+
 extern "C" {
-    struct SHADER_LIB_API ShaderSources {
-        std::string vertex, fragment;
+    struct ShaderLibSource {
+        const char* name;
+        const char* source;
+        size_t size;
+        uint32_t stages;                // SHADER_LIB_STAGE_* it is used as, 0 for includes
+    };
+    struct ShaderLibShader {
+        const char* name;
+        uint32_t vertex, fragment;      // Indices into the sources
+    };
+    struct ShaderLibTable {
+        uint32_t version;
+        uint32_t source_count;
+        uint32_t shader_count;
+        const ShaderLibSource* sources; // Sorted by name
+        const ShaderLibShader* shaders; // Sorted by name
     };
 
-    SHADER_LIB_API void ShaderLibInitialize();
-    SHADER_LIB_API const char* ShaderLibGetSource(const char* name);
-    SHADER_LIB_API bool ShaderLibGetRequiredSources(const char* name, ShaderSources* sources);
-    SHADER_LIB_API void ShaderLibGetShaders(std::vector<std::string>* shaders);
+    SHADER_LIB_API const ShaderLibTable* ShaderLibGetTable();
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -289,10 +289,10 @@ namespace fow {
             const auto transform = entity().get_component<TransformComponent>();
 
             if (m_pMaterial == nullptr) {
-                if (const auto material = Material::New("Sprite"); material.has_value()) {
+                if (const auto material = Material::New("Text"); material.has_value()) {
                     m_pMaterial = material.value();
                 } else {
-                    Debug::LogError("Failed to create material with shader \"Sprite\"");
+                    Debug::LogError("Failed to create material with shader \"Text\"");
                 }
             }
 
@@ -405,16 +405,19 @@ namespace fow {
     }
     void ModelRendererComponent::on_update(double dt) {
         const auto transform = entity().get_component<TransformComponent>();
-        RenderQueue::Enqueue(m_pModel, transform->transform());
+        if (m_pInstance != nullptr) {
+            RenderQueue::Enqueue(m_pInstance, transform->transform());
+        }
     }
 
     void ModelRendererComponent::set_model(const ModelPtr& model) {
         m_pModel = model;
+        m_pInstance = model != nullptr ? CreateRef<ModelInstance>(model) : nullptr;
     }
     bool ModelRendererComponent::load_model(const Path& path) {
         auto model_result = Assets::Load<Model>(path);
         if (model_result.has_value()) {
-            m_pModel = model_result.value().ptr();
+            set_model(model_result.value().ptr());
             return true;
         }
 
@@ -425,7 +428,7 @@ namespace fow {
     void ModelRendererComponent::set_parameter(const String& name, const String& value) {
         if (name.equals("model", StringCompareType::CaseInsensitive)) {
             if (const auto model = Assets::Load<Model>(value); model.has_value()) {
-                m_pModel = model.value().ptr();
+                set_model(model.value().ptr());
             } else {
                 Debug::LogError(std::format("Failed to load model \"{}\": {}", value, model.error().message));
             }
@@ -460,10 +463,10 @@ namespace fow {
         if (m_pText == nullptr) {
             const auto transform = entity().get_component<Transform2DComponent>();
             if (m_pMaterial == nullptr) {
-                if (const auto material = Material::New("Generic2D"); material.has_value()) {
+                if (const auto material = Material::New("Text2D"); material.has_value()) {
                     m_pMaterial = material.value();
                 } else {
-                    Debug::LogError("Failed to create material with shader \"Generic2D\"");
+                    Debug::LogError("Failed to create material with shader \"Text2D\"");
                 }
             }
             m_pText = CreateRef<TextSprite2D>(m_sText, m_pFont, m_pMaterial, m_TextRect);
@@ -231,6 +231,12 @@ namespace fow {
             }
             Renderer::EnableBlend(true);
             Renderer::SetViewport(0.0f, 0.0f, resolution.x, resolution.y);
+            if (!args.contains("-noshadercache")) {
+                if (char* pref_path = SDL_GetPrefPath("FogOfWar", s_window_title.as_cstr()); pref_path != nullptr) {
+                    ProgramCache::SetDirectory(Path(pref_path) / "shadercache");
+                    SDL_free(pref_path);
+                }
+            }
 
             SDL_GL_SetSwapInterval(vsync_enabled ? 1 : 0);
 
@@ -335,10 +341,11 @@ namespace fow {
                     s_game_class->on_render(time - last_time);
                 }
 
-                RenderQueue2D::Render();
+                // Widgets are only drawn again once they change, the frame enqueues the batches it keeps between frames.
                 if (s_scene != nullptr && s_scene->ui_frame() != nullptr) {
                     s_scene->ui_frame()->render();
                 }
+                RenderQueue2D::Render();
                 ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
                 SDL_GL_SwapWindow(s_window);
@@ -347,6 +354,9 @@ namespace fow {
 
             if (s_scene != nullptr) {
                 s_scene->destroy_all();
+                if (s_scene->ui_frame() != nullptr) {
+                    s_scene->ui_frame()->release();
+                }
             }
 
             auto cfg_path = s_base_path / "cfg";
@@ -364,6 +374,7 @@ namespace fow {
             Texture::UnloadPlaceHolder();
             Shader::UnloadShaderCache();
             Assets::ClearCache();
+            Renderer::Terminate();
 
             ImGui_ImplOpenGL3_Shutdown();
             ImGui_ImplSDL3_Shutdown();
@@ -129,6 +129,7 @@ namespace fow::UI {
                     return Failure(std::format("Failed to load texture \"{}\": {}", bg_texture_path, bg_texture_result.error().message));
                 }
                 auto bg_texture = bg_texture_result.value().ptr();
+                TextureAtlas::Instance().add(bg_texture);
 
                 return Success<RectangleTheme>(RectangleTheme {
                     CreateRef<NineSliceSprite2D>(bg_texture)
@@ -389,21 +390,134 @@ namespace fow::UI {
 
     void Frame::add_widget(const WidgetPtr& widget) {
         m_Widgets.emplace_back(widget);
+        widget->mark_dirty();
+        m_bLayoutDirty = true;
     }
     void Frame::remove_widget(const WidgetPtr& widget) {
         if (const auto& it = std::ranges::find(m_Widgets, widget); it != m_Widgets.end()) {
             m_Widgets.erase(it);
+            m_bLayoutDirty = true;
         }
     }
 
+    void Frame::invalidate() {
+        for (const auto& widget : m_Widgets) {
+            widget->m_bDirty = true;
+        }
+        m_bDirty = true;
+    }
+
     void Frame::update(const double dt) const {
         for (const auto& widget : m_Widgets) {
             widget->on_update(dt);
         }
     }
-    void Frame::render() const {
-        for (const auto& widget : m_Widgets) {
-            widget->on_draw();
+    void Frame::render() {
+        // Textures recorded before they were placed on an atlas page move there once the segments are built again.
+        if (TextureAtlas::Instance().revision() != m_uAtlasRevision) {
+            m_uAtlasRevision = TextureAtlas::Instance().revision();
+            m_bLayoutDirty = true;
+        }
+        // Recorded text refers to glyph space that was evicted, or to the glyph texture before it grew. Recording can do
+        // either itself, then the widgets recorded before it in the same pass are recorded again right away. Passes past
+        // the limit cannot help when the frame needs more glyphs than fit at once, the next frame tries again.
+        const auto& glyphs = GlyphAtlas::Instance();
+        for (int pass = 0; pass < FOW_UI_RECORD_PASSES; ++pass) {
+            if (glyphs.generation() != m_uGlyphGeneration || glyphs.texture().get() != m_pGlyphTexture) {
+                m_uGlyphGeneration = glyphs.generation();
+                m_pGlyphTexture = glyphs.texture().get();
+                invalidate();
+            }
+            if (!m_bDirty && !m_bLayoutDirty) {
+                break;
+            }
+            record_widgets();
+        }
+
+        for (const auto& [ segment, widget ] : m_Items) {
+            if (segment != nullptr) {
+                RenderQueue2D::Enqueue(segment, Rectangle { }, FOW_UI_RENDER_LAYER);
+                continue;
+            }
+            for (const auto& [ sprite, area ] : widget->m_Drawables) {
+                RenderQueue2D::Enqueue(sprite, area, FOW_UI_RENDER_LAYER);
+            }
+        }
+    }
+
+    void Frame::release() {
+        for (const auto& segment : m_Segments) {
+            segment->batch().release();
+        }
+        m_Segments.clear();
+        m_Items.clear();
+        m_Recorder.release();
+        invalidate();
+        m_bLayoutDirty = true;
+    }
+
+    void Frame::record_widgets() {
+        Vector<size_t> recorded;
+        for (size_t i = 0; i < m_Widgets.size(); ++i) {
+            auto& widget = *m_Widgets[i];
+            if (!widget.m_bDirty) {
+                continue;
+            }
+            const size_t quad_count = widget.m_Quads.size();
+            const bool was_retained = widget.m_bRetained;
+            widget.record(m_Recorder);
+            if (widget.m_Quads.size() != quad_count || widget.m_bRetained != was_retained) {
+                m_bLayoutDirty = true;
+            }
+            recorded.push_back(i);
+        }
+        m_bDirty = false;
+
+        if (!m_bLayoutDirty) {
+            // Same number of quads in the same places, only the vertices of the recorded widgets change.
+            for (const size_t index : recorded) {
+                const auto& widget = *m_Widgets[index];
+                const auto& placement = m_Placements[index];
+                if (widget.m_bRetained && !m_Segments[placement.segment]->batch().patch(placement.first_quad, widget.m_Quads)) {
+                    m_bLayoutDirty = true;
+                    break;
+                }
+            }
+        }
+        if (m_bLayoutDirty) {
+            build_segments();
+            m_bLayoutDirty = false;
+        }
+    }
+
+    void Frame::build_segments() {
+        m_Items.clear();
+        m_Placements.assign(m_Widgets.size(), Placement { SIZE_MAX, 0 });
+        size_t segment_count = 0;
+        for (size_t i = 0; i < m_Widgets.size(); ++i) {
+            const auto& widget = *m_Widgets[i];
+            if (!widget.m_bRetained) {
+                m_Items.push_back(Item { nullptr, &widget });
+                continue;
+            }
+            // A widget that is not retained splits the segments, so the order of the widgets is kept.
+            if (m_Items.empty() || m_Items.back().segment == nullptr) {
+                if (segment_count == m_Segments.size()) {
+                    m_Segments.push_back(CreateRef<Segment>());
+                }
+                m_Segments[segment_count]->batch().clear();
+                m_Items.push_back(Item { m_Segments[segment_count], nullptr });
+                ++segment_count;
+            }
+            auto& batch = m_Items.back().segment->batch();
+            m_Placements[i] = Placement { segment_count - 1, batch.quads().size() };
+            for (const auto& quad : widget.m_Quads) {
+                batch.add(quad);
+            }
+        }
+        m_Segments.resize(segment_count);
+        for (const auto& segment : m_Segments) {
+            segment->batch().build();
         }
     }
 
@@ -421,13 +535,50 @@ namespace fow::UI {
         }
     }
 
+    void Widget::mark_dirty() const {
+        m_bDirty = true;
+        if (m_pFrame != nullptr) {
+            m_pFrame->m_bDirty = true;
+        }
+    }
+
+    void Widget::draw(const Ref<IDrawable2D>& sprite) {
+        if (sprite != nullptr) {
+            m_Drawables.emplace_back(sprite, area());
+        }
+    }
+
+    void Widget::record(SpriteBatch2D& recorder) {
+        m_bDirty = false;
+        m_Drawables.clear();
+        on_draw();
+
+        // Quads are kept without the atlas, the segments remap them whenever they are built.
+        recorder.clear();
+        m_bRetained = true;
+        for (const auto& [ sprite, rect ] : m_Drawables) {
+            if (!sprite->batch_2d(recorder, rect)) {
+                m_bRetained = false;
+                break;
+            }
+        }
+        if (m_bRetained) {
+            m_Quads = recorder.quads();
+        } else {
+            m_Quads.clear();
+        }
+        recorder.clear();
+    }
+
     void Widget::set_area(const IntRectangle& area) {
         const auto prev = m_Area;
         m_Area = area;
         if (prev.size() != m_Area.size()) {
+            mark_dirty();
             on_resized();
         }
         if (prev.position() != m_Area.position()) {
+            mark_dirty();
             on_moved();
         }
     }
@@ -437,6 +588,7 @@ namespace fow::UI {
             return;
         }
         m_bVisible = visible;
+        mark_dirty();
         on_visibility_changed(visible);
     }
 
@@ -445,11 +597,13 @@ namespace fow::UI {
             return;
         }
         m_bEnabled = enabled;
+        mark_dirty();
         on_enabled_changed(enabled);
     }
 
     void Panel::set_theme(const RectangleTheme& theme) {
         m_Theme = theme;
+        mark_dirty();
     }
 
     void Panel::on_draw() {
@@ -461,13 +615,13 @@ namespace fow::UI {
         }
 
         if (sprite != nullptr && is_visible() && is_enabled()) {
-            sprite->draw_2d(area());
+            draw(sprite);
         }
     }
 
     Label::Label(const FramePtr& frame, const String& text) : Label(frame, text, frame->theme()->Text) { }
     Label::Label(const FramePtr& frame, const String& text, const TextTheme& theme) : Widget(frame), m_Theme(theme), m_pText(nullptr), m_sText(text) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -477,7 +631,7 @@ namespace fow::UI {
         }
     }
     Label::Label(const FramePtr& frame, const String& text, TextTheme&& theme) : Widget(frame), m_Theme(std::move(theme)), m_pText(nullptr), m_sText(text) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -488,7 +642,7 @@ namespace fow::UI {
     }
     Label::Label(const FramePtr& frame, String&& text) : Label(frame, std::move(text), frame->theme()->Text) { }
     Label::Label(const FramePtr& frame, String&& text, const TextTheme& theme) : Widget(frame), m_Theme(theme), m_pText(nullptr), m_sText(std::move(text)) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -498,7 +652,7 @@ namespace fow::UI {
         }
     }
     Label::Label(const FramePtr& frame, String&& text, TextTheme&& theme) : Widget(frame), m_Theme(std::move(theme)), m_pText(nullptr), m_sText(std::move(text)) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -513,11 +667,13 @@ namespace fow::UI {
         m_pText->set_font(m_Theme.font);
         m_pText->set_color(m_Theme.color);
         m_pText->set_alignment(m_Theme.alignment);
+        mark_dirty();
     }
 
     void Label::set_text(const String& text) {
         m_sText = text;
         m_pText->set_text(text);
+        mark_dirty();
     }
 
     void Label::on_resized() {
@@ -526,30 +682,33 @@ namespace fow::UI {
 
     void Label::on_draw() {
         if (m_pText != nullptr && is_visible()) {
-            m_pText->draw_2d(area());
+            draw(m_pText);
         }
     }
 
     void Label::on_enabled_changed(const bool enabled) {
         Widget::on_enabled_changed(enabled);
         m_pText->set_color(enabled ? m_Theme.color : m_Theme.disabled_color);
+        mark_dirty();
     }
 
     void ImageSprite::set_theme(const ImageTheme& theme) {
         m_Theme = theme;
+        mark_dirty();
     }
 
     void ImageSprite::set_image(const Texture2DPtr& normal, const Texture2DPtr& disabled) const {
         m_Theme.background->set_background_texture(normal);
         m_Theme.background_disabled->set_background_texture(disabled);
+        mark_dirty();
     }
 
     void ImageSprite::on_draw() {
         if (is_visible()) {
             if (is_enabled()) {
-                m_Theme.background->draw_2d(area());
+                draw(m_Theme.background);
             } else {
-                m_Theme.background_disabled->draw_2d(area());
+                draw(m_Theme.background_disabled);
             }
         }
     }
@@ -585,7 +744,7 @@ namespace fow::UI {
     }
 
     Button::Button(const FramePtr& frame, const String& text, const ButtonTheme& theme) : BaseButton(frame), m_Theme(theme), m_sText(text), m_pText(nullptr), m_bSelected(false) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -598,7 +757,7 @@ namespace fow::UI {
     }
     Button::Button(const FramePtr& frame, const String& text) : Button(frame, text, frame->theme()->Button) { }
     Button::Button(const FramePtr& frame, String&& text, const ButtonTheme& theme) : BaseButton(frame), m_Theme(theme), m_sText(std::move(text)), m_pText(nullptr), m_bSelected(false) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -610,7 +769,7 @@ namespace fow::UI {
         }
     }
     Button::Button(const FramePtr& frame, String&& text, ButtonTheme&& theme) : BaseButton(frame), m_Theme(std::move(theme)), m_sText(std::move(text)), m_pText(nullptr), m_bSelected(false) {
-        auto material = Material::New("Generic2D");
+        auto material = Material::New("Text2D");
         Debug::AssertFatal(material);
         if (material.has_value()) {
             material->get()->set_opaque(false);
@@ -625,6 +784,7 @@ namespace fow::UI {
 
     void Button::set_theme(const ButtonTheme& theme) {
         m_Theme = theme;
+        mark_dirty();
     }
 
     void Button::set_text(const String& text) {
@@ -696,10 +856,10 @@ namespace fow::UI {
         }
 
         if (sprite != nullptr) {
-            sprite->draw_2d(area());
+            draw(sprite);
         }
         if (m_pText != nullptr) {
-            m_pText->draw_2d(area());
+            draw(m_pText);
         }
     }
 
@@ -735,6 +895,8 @@ namespace fow::UI {
     }
 
     void Button::update_text_theme() const {
+        // Called on every change of state, which also picks the background.
+        mark_dirty();
         if (m_bPressed) {
             if (is_enabled()) {
                 if (m_bSelected) {
@@ -790,7 +952,7 @@ namespace fow::UI {
     void CheckBox::on_draw() {
         BaseButton::on_draw();
         if (m_Theme.sprite_sheet != nullptr) {
-            m_Theme.sprite_sheet->draw_2d(area());
+            draw(m_Theme.sprite_sheet);
         }
     }
 
@@ -806,6 +968,7 @@ namespace fow::UI {
     }
 
     void CheckBox::update_sprite() const {
+        mark_dirty();
         if (m_Theme.sprite_sheet != nullptr) {
             if (m_bSelected) {
                 if (m_bChecked) {
@@ -11,7 +11,7 @@ namespace fow::Debug {
         const auto vertex = WireMeshVertex { position, color };
 
         glGenVertexArrays(1, &m_uVao);
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
 
         glGenBuffers(1, &m_uVbo);
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
@@ -25,10 +25,11 @@ namespace fow::Debug {
         glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(WireMeshVertex), reinterpret_cast<void*>(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
 
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
     }
     PointMesh::~PointMesh() {
         if (m_uVao != 0) {
+            GlStateCache::Instance().forget_vertex_array(m_uVao);
             glDeleteVertexArrays(1, &m_uVao);
         }
         if (m_uVbo != 0) {
@@ -45,7 +46,7 @@ namespace fow::Debug {
 
     WireMesh::WireMesh(const Vector<WireMeshVertex>& verts, const MeshPrimitive& primitive) : m_uVao(0), m_uVbo(0), m_iVertexCount(verts.size()), m_ePrimitive(primitive) {
         glGenVertexArrays(1, &m_uVao);
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
 
         glGenBuffers(1, &m_uVbo);
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
@@ -59,10 +60,11 @@ namespace fow::Debug {
         glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(WireMeshVertex), reinterpret_cast<void*>(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
 
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
     }
     WireMesh::~WireMesh() {
         if (m_uVao != 0) {
+            GlStateCache::Instance().forget_vertex_array(m_uVao);
             glDeleteVertexArrays(1, &m_uVao);
         }
         if (m_uVbo != 0) {
@@ -101,16 +103,15 @@ namespace fow::Debug {
         FOW_DISCARD(shader->set_uniform("MATRIX_VIEW", Renderer::GetViewMatrix()));
         FOW_DISCARD(shader->set_uniform("MATRIX_MODEL", model));
 
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
         glDrawArrays(static_cast<GLenum>(m_ePrimitive), 0, m_iVertexCount);
-        glBindVertexArray(0);
     }
     void WireMesh::draw(const Transform& transform) const {
         draw(transform.matrix());
     }
 
     void WireMesh::update_vertices(const Vector<WireMeshVertex>& verts, const MeshPrimitive& primitive) {
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
         // Clear data
         glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(WireMeshVertex), nullptr, GL_DYNAMIC_DRAW);
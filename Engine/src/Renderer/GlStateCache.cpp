@@ -0,0 +1,235 @@
+#include "fow/Renderer/GlStateCache.hpp"
+
+namespace fow {
+    GlFunctionTable GlFunctionTable::Default() {
+        return GlFunctionTable {
+            .use_program       = [](const GLuint program) { glUseProgram(program); },
+            .bind_vertex_array = [](const GLuint vao) { glBindVertexArray(vao); },
+            .active_texture    = [](const GLenum unit) { glActiveTexture(unit); },
+            .bind_texture      = [](const GLenum target, const GLuint texture) { glBindTexture(target, texture); },
+            .bind_sampler      = [](const GLuint unit, const GLuint sampler) { glBindSampler(unit, sampler); },
+            .enable            = [](const GLenum capability) { glEnable(capability); },
+            .disable           = [](const GLenum capability) { glDisable(capability); },
+            .blend_func        = [](const GLenum src, const GLenum dst) { glBlendFunc(src, dst); },
+            .depth_func        = [](const GLenum func) { glDepthFunc(func); },
+            .depth_mask        = [](const GLboolean enabled) { glDepthMask(enabled); },
+            .cull_face         = [](const GLenum mode) { glCullFace(mode); },
+            .stencil_func      = [](const GLenum func, const GLint ref, const GLuint mask) { glStencilFunc(func, ref, mask); },
+            .stencil_op        = [](const GLenum stencil_fail, const GLenum depth_fail, const GLenum depth_pass) { glStencilOp(stencil_fail, depth_fail, depth_pass); },
+            .stencil_mask      = [](const GLuint mask) { glStencilMask(mask); },
+            .bind_framebuffer  = [](const GLenum target, const GLuint framebuffer) { glBindFramebuffer(target, framebuffer); }
+        };
+    }
+
+    GlStateCache::GlStateCache(const GlFunctionTable& functions) : m_functions(functions) {
+        invalidate();
+    }
+
+    void GlStateCache::use_program(const GLuint program) {
+        if (m_uProgram == program ? avoid() : forward()) {
+            m_uProgram = program;
+            m_functions.use_program(program);
+        }
+    }
+
+    void GlStateCache::bind_vertex_array(const GLuint vao) {
+        if (m_uVertexArray == vao ? avoid() : forward()) {
+            m_uVertexArray = vao;
+            m_functions.bind_vertex_array(vao);
+        }
+    }
+
+    void GlStateCache::set_active_texture(const GLuint unit) {
+        const GLenum gl_unit = GL_TEXTURE0 + unit;
+        if (m_eActiveTexture == gl_unit ? avoid() : forward()) {
+            m_eActiveTexture = gl_unit;
+            m_functions.active_texture(gl_unit);
+        }
+    }
+
+    void GlStateCache::bind_texture(const GLuint unit, const GLenum target, const GLuint texture) {
+        Debug::Assert(unit < FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS, std::format("Texture unit {} is out of range!", unit));
+        auto& binding = m_textures[unit % FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS];
+        if (binding.target == target && binding.texture == texture) {
+            avoid();
+            return;
+        }
+        set_active_texture(unit % FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS);
+        forward();
+        binding = TextureBinding { target, texture };
+        m_functions.bind_texture(target, texture);
+    }
+    void GlStateCache::bind_texture(const GLenum target, const GLuint texture) {
+        if (m_eActiveTexture == Unknown) {
+            set_active_texture(0);
+        }
+        bind_texture(m_eActiveTexture - GL_TEXTURE0, target, texture);
+    }
+
+    void GlStateCache::bind_sampler(const GLuint unit, const GLuint sampler) {
+        Debug::Assert(unit < FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS, std::format("Texture unit {} is out of range!", unit));
+        auto& bound = m_samplers[unit % FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS];
+        if (bound == sampler ? avoid() : forward()) {
+            bound = sampler;
+            m_functions.bind_sampler(unit, sampler);
+        }
+    }
+
+    int GlStateCache::CapabilityToIndex(const GLenum capability) {
+        switch (capability) {
+            case GL_BLEND:        return CapabilityBlend;
+            case GL_CULL_FACE:    return CapabilityCullFace;
+            case GL_DEPTH_TEST:   return CapabilityDepthTest;
+            case GL_STENCIL_TEST: return CapabilityStencilTest;
+            case GL_SCISSOR_TEST: return CapabilityScissorTest;
+            case GL_MULTISAMPLE:  return CapabilityMultisample;
+            default:              return -1;
+        }
+    }
+
+    void GlStateCache::set_enabled(const GLenum capability, const bool enabled) {
+        const int index = CapabilityToIndex(capability);
+        if (index >= 0) {
+            if (m_capabilities[index] == static_cast<int8_t>(enabled)) {
+                avoid();
+                return;
+            }
+            m_capabilities[index] = static_cast<int8_t>(enabled);
+        }
+        forward();
+        if (enabled) {
+            m_functions.enable(capability);
+        } else {
+            m_functions.disable(capability);
+        }
+    }
+
+    void GlStateCache::set_blend_func(const GLenum src, const GLenum dst) {
+        if (m_eBlendSrc == src && m_eBlendDst == dst ? avoid() : forward()) {
+            m_eBlendSrc = src;
+            m_eBlendDst = dst;
+            m_functions.blend_func(src, dst);
+        }
+    }
+
+    void GlStateCache::set_depth_func(const GLenum func) {
+        if (m_eDepthFunc == func ? avoid() : forward()) {
+            m_eDepthFunc = func;
+            m_functions.depth_func(func);
+        }
+    }
+
+    void GlStateCache::set_depth_mask(const bool enabled) {
+        if (m_iDepthMask == static_cast<int8_t>(enabled) ? avoid() : forward()) {
+            m_iDepthMask = static_cast<int8_t>(enabled);
+            m_functions.depth_mask(enabled ? GL_TRUE : GL_FALSE);
+        }
+    }
+
+    void GlStateCache::set_cull_face(const GLenum mode) {
+        if (m_eCullFace == mode ? avoid() : forward()) {
+            m_eCullFace = mode;
+            m_functions.cull_face(mode);
+        }
+    }
+
+    void GlStateCache::set_stencil_func(const GLenum func, const GLint ref, const GLuint mask) {
+        if (m_eStencilFunc == func && m_iStencilRef == ref && m_uStencilFuncMask == mask ? avoid() : forward()) {
+            m_eStencilFunc = func;
+            m_iStencilRef = ref;
+            m_uStencilFuncMask = mask;
+            m_functions.stencil_func(func, ref, mask);
+        }
+    }
+
+    void GlStateCache::set_stencil_op(const GLenum stencil_fail, const GLenum depth_fail, const GLenum depth_pass) {
+        if (m_eStencilFail == stencil_fail && m_eStencilDepthFail == depth_fail && m_eStencilDepthPass == depth_pass ? avoid() : forward()) {
+            m_eStencilFail = stencil_fail;
+            m_eStencilDepthFail = depth_fail;
+            m_eStencilDepthPass = depth_pass;
+            m_functions.stencil_op(stencil_fail, depth_fail, depth_pass);
+        }
+    }
+
+    void GlStateCache::set_stencil_mask(const GLuint mask) {
+        if (m_uStencilWriteMask == mask ? avoid() : forward()) {
+            m_uStencilWriteMask = mask;
+            m_functions.stencil_mask(mask);
+        }
+    }
+
+    void GlStateCache::bind_framebuffer(const GLenum target, const GLuint framebuffer) {
+        const bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+        const bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+        if ((!draw || m_uDrawFramebuffer == framebuffer) && (!read || m_uReadFramebuffer == framebuffer)) {
+            avoid();
+            return;
+        }
+        forward();
+        if (draw) {
+            m_uDrawFramebuffer = framebuffer;
+        }
+        if (read) {
+            m_uReadFramebuffer = framebuffer;
+        }
+        m_functions.bind_framebuffer(target, framebuffer);
+    }
+
+    void GlStateCache::forget_program(const GLuint program) {
+        if (m_uProgram == program) {
+            m_uProgram = Unknown;
+        }
+    }
+    void GlStateCache::forget_vertex_array(const GLuint vao) {
+        if (m_uVertexArray == vao) {
+            m_uVertexArray = Unknown;
+        }
+    }
+    void GlStateCache::forget_texture(const GLuint texture) {
+        for (auto& binding : m_textures) {
+            if (binding.texture == texture) {
+                binding = TextureBinding { };
+            }
+        }
+    }
+    void GlStateCache::forget_sampler(const GLuint sampler) {
+        for (auto& bound : m_samplers) {
+            if (bound == sampler) {
+                bound = Unknown;
+            }
+        }
+    }
+    void GlStateCache::forget_framebuffer(const GLuint framebuffer) {
+        if (m_uDrawFramebuffer == framebuffer) {
+            m_uDrawFramebuffer = Unknown;
+        }
+        if (m_uReadFramebuffer == framebuffer) {
+            m_uReadFramebuffer = Unknown;
+        }
+    }
+
+    void GlStateCache::invalidate() {
+        m_uProgram = Unknown;
+        m_uVertexArray = Unknown;
+        m_uDrawFramebuffer = Unknown;
+        m_uReadFramebuffer = Unknown;
+        m_eActiveTexture = Unknown;
+        m_textures.fill(TextureBinding { });
+        m_samplers.fill(Unknown);
+        m_capabilities.fill(-1);
+        m_eBlendSrc = m_eBlendDst = Unknown;
+        m_eDepthFunc = Unknown;
+        m_iDepthMask = -1;
+        m_eCullFace = Unknown;
+        m_eStencilFunc = Unknown;
+        m_iStencilRef = -1;
+        m_uStencilFuncMask = Unknown;
+        m_eStencilFail = m_eStencilDepthFail = m_eStencilDepthPass = Unknown;
+        m_uStencilWriteMask = Unknown;
+    }
+
+    GlStateCache& GlStateCache::Instance() {
+        static GlStateCache s_instance;
+        return s_instance;
+    }
+}
@@ -0,0 +1,406 @@
+#include "fow/Renderer/GlyphAtlas.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/Sprite.hpp"
+#include "fow/Renderer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+
+#include FT_MODULE_H
+
+namespace fow {
+    SkylinePacker::SkylinePacker(const Vector2i& size) : m_iUsedArea(0) {
+        reset(size);
+    }
+
+    void SkylinePacker::reset(const Vector2i& size) {
+        m_size = size;
+        m_skyline.clear();
+        m_iUsedArea = 0;
+        if (size.x > 0 && size.y > 0) {
+            m_skyline.push_back(Node { 0, 0, size.x });
+        }
+    }
+
+    float SkylinePacker::occupancy() const {
+        const auto area = static_cast<int64_t>(m_size.x) * m_size.y;
+        return area > 0 ? static_cast<float>(static_cast<double>(m_iUsedArea) / static_cast<double>(area)) : 0.0f;
+    }
+
+    Option<int> SkylinePacker::fit(const size_t index, const Vector2i& size) const {
+        if (m_skyline[index].x + size.x > m_size.x) {
+            return std::nullopt;
+        }
+        int y = 0;
+        int width_left = size.x;
+        for (size_t i = index; width_left > 0; ++i) {
+            y = std::max(y, m_skyline[i].y);
+            if (y + size.y > m_size.y) {
+                return std::nullopt;
+            }
+            width_left -= m_skyline[i].width;
+        }
+        return y;
+    }
+
+    Option<Vector2i> SkylinePacker::pack(const Vector2i& size) {
+        if (size.x <= 0 || size.y <= 0) {
+            return std::nullopt;
+        }
+
+        // Lowest top edge first, the narrower node on ties so wide gaps stay open for wide rectangles.
+        size_t best_index = SIZE_MAX;
+        int best_y = INT_MAX;
+        int best_width = INT_MAX;
+        for (size_t i = 0; i < m_skyline.size(); ++i) {
+            if (const auto y = fit(i, size); y.has_value()) {
+                if (y.value() + size.y < best_y || (y.value() + size.y == best_y && m_skyline[i].width < best_width)) {
+                    best_index = i;
+                    best_y = y.value() + size.y;
+                    best_width = m_skyline[i].width;
+                }
+            }
+        }
+        if (best_index == SIZE_MAX) {
+            return std::nullopt;
+        }
+
+        const Vector2i position { m_skyline[best_index].x, best_y - size.y };
+        m_skyline.insert(m_skyline.begin() + static_cast<ptrdiff_t>(best_index), Node { position.x, best_y, size.x });
+
+        // Cut the nodes the new one covers.
+        for (size_t i = best_index + 1; i < m_skyline.size();) {
+            const auto& previous = m_skyline[i - 1];
+            auto& node = m_skyline[i];
+            const int previous_end = previous.x + previous.width;
+            if (node.x >= previous_end) {
+                break;
+            }
+            const int shrink = previous_end - node.x;
+            if (node.width <= shrink) {
+                m_skyline.erase(m_skyline.begin() + static_cast<ptrdiff_t>(i));
+                continue;
+            }
+            node.x += shrink;
+            node.width -= shrink;
+            break;
+        }
+        // Merge neighbours of the same height.
+        for (size_t i = 0; i + 1 < m_skyline.size();) {
+            if (m_skyline[i].y == m_skyline[i + 1].y) {
+                m_skyline[i].width += m_skyline[i + 1].width;
+                m_skyline.erase(m_skyline.begin() + static_cast<ptrdiff_t>(i + 1));
+            } else {
+                ++i;
+            }
+        }
+
+        m_iUsedArea += static_cast<int64_t>(size.x) * size.y;
+        return position;
+    }
+
+    char32_t DecodeUtf8Next(const std::string_view text, size_t& offset) {
+        static constexpr char32_t Replacement = 0xFFFD;
+
+        const auto lead = static_cast<uint8_t>(text[offset]);
+        if (lead < 0x80) {
+            ++offset;
+            return lead;
+        }
+
+        size_t length;
+        char32_t codepoint;
+        char32_t min_codepoint;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2; codepoint = lead & 0x1F; min_codepoint = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3; codepoint = lead & 0x0F; min_codepoint = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4; codepoint = lead & 0x07; min_codepoint = 0x10000;
+        } else {
+            ++offset;
+            return Replacement;
+        }
+
+        bool valid = offset + length <= text.size();
+        for (size_t j = 1; valid && j < length; ++j) {
+            const auto continuation = static_cast<uint8_t>(text[offset + j]);
+            valid = (continuation & 0xC0) == 0x80;
+            codepoint = (codepoint << 6) | (continuation & 0x3F);
+        }
+        // Overlong encodings, UTF-16 surrogates and values past the last plane are rejected as well.
+        if (!valid || codepoint < min_codepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+            ++offset;
+            return Replacement;
+        }
+        offset += length;
+        return codepoint;
+    }
+
+    Vector<char32_t> DecodeUtf8(const std::string_view text) {
+        Vector<char32_t> result;
+        result.reserve(text.size());
+        for (size_t offset = 0; offset < text.size();) {
+            result.push_back(DecodeUtf8Next(text, offset));
+        }
+        return result;
+    }
+
+    uint32_t GlyphSizeBucket(const float pixel_size) {
+        const auto size = static_cast<uint32_t>(std::ceil(std::max(pixel_size, 1.0f)));
+        return std::clamp<uint32_t>(std::bit_ceil(size), FOW_GLYPH_SDF_MIN_SIZE, FOW_GLYPH_SDF_MAX_SIZE);
+    }
+
+    GlyphAtlas& GlyphAtlas::Instance() {
+        static GlyphAtlas s_instance;
+        return s_instance;
+    }
+
+    Result<> GlyphAtlas::add_page() {
+        if (m_pages.size() >= FOW_GLYPH_ATLAS_MAX_PAGES) {
+            return Failure("Glyph atlas is full");
+        }
+        const auto layers = static_cast<GLsizei>(m_pages.size() + 1);
+
+        GLuint id = 0;
+        glGenTextures(1, &id);
+        if (id == 0) {
+            return Failure(std::format("Failed to create glyph atlas texture: GL error {}", glGetError()));
+        }
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D_ARRAY, id);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8, FOW_GLYPH_ATLAS_PAGE_SIZE, FOW_GLYPH_ATLAS_PAGE_SIZE, layers);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        // Texel 0 is the farthest distance outside of any outline.
+        constexpr GLubyte zero = 0;
+        glClearTexImage(id, 0, GL_RED, GL_UNSIGNED_BYTE, &zero);
+        // Glyphs already placed keep their page and UVs, only the texture they are read from changes.
+        if (m_pTexture != nullptr) {
+            glCopyImageSubData(m_pTexture->id(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+                               id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+                               FOW_GLYPH_ATLAS_PAGE_SIZE, FOW_GLYPH_ATLAS_PAGE_SIZE, layers - 1);
+        }
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D_ARRAY, 0);
+
+        m_pTexture = CreateRef<Texture2DArray>(Texture2DArray(id));
+        m_pages.emplace_back(Vector2i { FOW_GLYPH_ATLAS_PAGE_SIZE, FOW_GLYPH_ATLAS_PAGE_SIZE });
+        return Success();
+    }
+
+    Option<std::pair<uint32_t, Vector2i>> GlyphAtlas::allocate(const Vector2i& size) {
+        for (size_t page = 0; page < m_pages.size(); ++page) {
+            if (const auto position = m_pages[page].pack(size); position.has_value()) {
+                return std::make_pair(static_cast<uint32_t>(page), position.value());
+            }
+        }
+        if (const auto result = add_page(); !result.has_value()) {
+            return std::nullopt;
+        }
+        if (const auto position = m_pages.back().pack(size); position.has_value()) {
+            return std::make_pair(static_cast<uint32_t>(m_pages.size() - 1), position.value());
+        }
+        return std::nullopt;
+    }
+
+    const AtlasGlyph* GlyphAtlas::glyph(const Font& font, const uint32_t glyph_index, const uint32_t bucket) {
+        if (!font.is_valid()) {
+            return nullptr;
+        }
+        const GlyphKey key { font.id(), glyph_index, bucket };
+        if (const auto it = m_glyphs.find(key); it != m_glyphs.end()) {
+            return &it->second;
+        }
+
+        static bool s_bSpreadSet = false;
+        if (!s_bSpreadSet) {
+            FT_Int spread = FOW_GLYPH_SDF_SPREAD;
+            FT_Property_Set(Renderer::FontLibrary(), "sdf", "spread", &spread);
+            FT_Property_Set(Renderer::FontLibrary(), "bsdf", "spread", &spread);
+            s_bSpreadSet = true;
+        }
+
+        // Unhinted, so the metrics of the bucket scale to every size in it.
+        const FT_Face face = font.m_pFace;
+        FT_Set_Pixel_Sizes(face, 0, bucket);
+        const auto load_error = FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_HINTING);
+        const auto render_error = load_error == FT_Err_Ok && face->glyph->format == FT_GLYPH_FORMAT_OUTLINE && face->glyph->outline.n_points > 0 ?
+                                  FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF) : load_error;
+        if (load_error != FT_Err_Ok || render_error != FT_Err_Ok) {
+            FT_Set_Pixel_Sizes(face, 0, font.size());
+            Debug::LogWarning(std::format("Failed to render glyph {} at size {}: {}", glyph_index, bucket, static_cast<int>(load_error != FT_Err_Ok ? load_error : render_error)));
+            return nullptr;
+        }
+
+        const FT_GlyphSlot slot = face->glyph;
+        AtlasGlyph glyph;
+        glyph.advance = static_cast<float>(slot->advance.x) / 64.0f;
+
+        const bool has_bitmap = slot->format == FT_GLYPH_FORMAT_BITMAP && slot->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY && slot->bitmap.width > 0 && slot->bitmap.rows > 0;
+        if (has_bitmap) {
+            const Vector2i bitmap_size { static_cast<int>(slot->bitmap.width), static_cast<int>(slot->bitmap.rows) };
+            auto placement = allocate(bitmap_size + Vector2i(2 * FOW_GLYPH_ATLAS_PADDING));
+            if (!placement.has_value()) {
+                // Every page is full, start over. Text notices the new generation and lays itself out again.
+                Debug::LogDebug(std::format("Glyph atlas is full with {} glyphs, evicting all of them", m_glyphs.size()));
+                clear();
+                placement = allocate(bitmap_size + Vector2i(2 * FOW_GLYPH_ATLAS_PADDING));
+            }
+            if (!placement.has_value()) {
+                FT_Set_Pixel_Sizes(face, 0, font.size());
+                Debug::LogWarning(std::format("Glyph {} at size {} does not fit into the glyph atlas", glyph_index, bucket));
+                return nullptr;
+            }
+            const auto [ page, position ] = placement.value();
+            const Vector2i origin = position + Vector2i(FOW_GLYPH_ATLAS_PADDING);
+
+            GlStateCache::Instance().bind_texture(GL_TEXTURE_2D_ARRAY, m_pTexture->id());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, std::abs(slot->bitmap.pitch));
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, origin.x, origin.y, static_cast<GLint>(page), bitmap_size.x, bitmap_size.y, 1, GL_RED, GL_UNSIGNED_BYTE, slot->bitmap.buffer);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            GlStateCache::Instance().bind_texture(GL_TEXTURE_2D_ARRAY, 0);
+
+            glyph.page = page;
+            glyph.uv_min = Vector2(origin) / static_cast<float>(FOW_GLYPH_ATLAS_PAGE_SIZE);
+            glyph.uv_max = Vector2(origin + bitmap_size) / static_cast<float>(FOW_GLYPH_ATLAS_PAGE_SIZE);
+            glyph.bearing = Vector2 { static_cast<float>(slot->bitmap_left), static_cast<float>(slot->bitmap_top) };
+            glyph.size = Vector2(bitmap_size);
+        }
+        FT_Set_Pixel_Sizes(face, 0, font.size());
+
+        return &m_glyphs.insert_or_assign(key, glyph).first->second;
+    }
+
+    void GlyphAtlas::clear() {
+        m_glyphs.clear();
+        for (auto& page : m_pages) {
+            page.reset(page.size());
+        }
+        ++m_uGeneration;
+    }
+
+    void GlyphAtlas::release() {
+        m_glyphs.clear();
+        m_pages.clear();
+        m_pTexture = nullptr;
+        ++m_uGeneration;
+    }
+
+    GlyphQuadBuffer::GlyphQuadBuffer(GlyphQuadBuffer&& other) noexcept :
+        m_uVao(other.m_uVao), m_uVbo(other.m_uVbo), m_uEbo(other.m_uEbo), m_uCapacity(other.m_uCapacity), m_iIndexCount(other.m_iIndexCount) {
+        other.m_uVao = other.m_uVbo = other.m_uEbo = 0;
+        other.m_uCapacity = 0;
+        other.m_iIndexCount = 0;
+    }
+    GlyphQuadBuffer::~GlyphQuadBuffer() {
+        release();
+    }
+
+    GlyphQuadBuffer& GlyphQuadBuffer::operator=(GlyphQuadBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_uVao = other.m_uVao;
+            m_uVbo = other.m_uVbo;
+            m_uEbo = other.m_uEbo;
+            m_uCapacity = other.m_uCapacity;
+            m_iIndexCount = other.m_iIndexCount;
+            other.m_uVao = other.m_uVbo = other.m_uEbo = 0;
+            other.m_uCapacity = 0;
+            other.m_iIndexCount = 0;
+        }
+        return *this;
+    }
+
+    void GlyphQuadBuffer::release() {
+        if (m_uVao != 0) {
+            GlStateCache::Instance().forget_vertex_array(m_uVao);
+            glDeleteVertexArrays(1, &m_uVao);
+        }
+        if (m_uVbo != 0) {
+            glDeleteBuffers(1, &m_uVbo);
+        }
+        if (m_uEbo != 0) {
+            glDeleteBuffers(1, &m_uEbo);
+        }
+        m_uVao = m_uVbo = m_uEbo = 0;
+        m_uCapacity = 0;
+        m_iIndexCount = 0;
+    }
+
+    void GlyphQuadBuffer::reserve(const size_t quads) {
+        if (quads <= m_uCapacity && m_uVao != 0) {
+            return;
+        }
+        const size_t capacity = std::max<size_t>(std::bit_ceil(quads), 16);
+        if (m_uVao == 0) {
+            glGenVertexArrays(1, &m_uVao);
+            glGenBuffers(1, &m_uVbo);
+            glGenBuffers(1, &m_uEbo);
+        }
+
+        // The indices never change for a capacity, only the vertices are rewritten on updates.
+        Vector<GLuint> indices;
+        indices.reserve(capacity * 6);
+        for (GLuint quad = 0; quad < capacity; ++quad) {
+            const GLuint base = quad * 4;
+            indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+        }
+
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * 4 * sizeof(GlyphVertex)), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uEbo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), reinterpret_cast<void*>(offsetof(GlyphVertex, position)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), reinterpret_cast<void*>(offsetof(GlyphVertex, uv)));
+        GlStateCache::Instance().bind_vertex_array(0);
+
+        m_uCapacity = capacity;
+    }
+
+    void GlyphQuadBuffer::update(const Vector<GlyphQuad>& quads, const Vector2& area_size) {
+        m_iIndexCount = 0;
+        if (quads.empty() || area_size.x <= 0.0f || area_size.y <= 0.0f) {
+            return;
+        }
+        reserve(quads.size());
+
+        Vector<GlyphVertex> vertices;
+        vertices.reserve(quads.size() * 4);
+        for (const auto& quad : quads) {
+            const Vector2 min = quad.min / area_size;
+            const Vector2 max = quad.max / area_size;
+            const auto page = static_cast<float>(quad.page);
+            vertices.push_back(GlyphVertex { Vector2 { min.x, min.y }, Vector3 { quad.uv_min.x, quad.uv_min.y, page } });
+            vertices.push_back(GlyphVertex { Vector2 { min.x, max.y }, Vector3 { quad.uv_min.x, quad.uv_max.y, page } });
+            vertices.push_back(GlyphVertex { Vector2 { max.x, max.y }, Vector3 { quad.uv_max.x, quad.uv_max.y, page } });
+            vertices.push_back(GlyphVertex { Vector2 { max.x, min.y }, Vector3 { quad.uv_max.x, quad.uv_min.y, page } });
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(GlyphVertex)), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        m_iIndexCount = static_cast<GLsizei>(quads.size() * 6);
+    }
+
+    void GlyphQuadBuffer::draw(const GLsizei instances) const {
+        if (m_iIndexCount == 0 || instances <= 0) {
+            return;
+        }
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
+        if (instances == 1) {
+            glDrawElements(GL_TRIANGLES, m_iIndexCount, GL_UNSIGNED_INT, nullptr);
+        } else {
+            glDrawElementsInstanced(GL_TRIANGLES, m_iIndexCount, GL_UNSIGNED_INT, nullptr, instances);
+        }
+    }
+}
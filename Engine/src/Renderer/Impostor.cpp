@@ -0,0 +1,290 @@
+#include "fow/Renderer/Impostor.hpp"
+
+#include "fow/Renderer.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/RenderQueue.hpp"
+
+#include <bit>
+
+#include <glm/gtc/constants.hpp>
+
+namespace fow {
+    Vector3 ImpostorViewGrid::direction(const uint32_t column, const uint32_t row) const {
+        const float yaw = static_cast<float>(column) * glm::two_pi<float>() / static_cast<float>(std::max(yaw_views, 1u));
+        const float pitch = pitch_views > 1 ? static_cast<float>(row) * max_pitch / static_cast<float>(pitch_views - 1) : 0.0f;
+        return Vector3 { std::cos(pitch) * std::sin(yaw), std::sin(pitch), std::cos(pitch) * std::cos(yaw) };
+    }
+
+    Vector2u ImpostorViewGrid::select(const Vector3& to_camera) const {
+        const auto columns = static_cast<int64_t>(std::max(yaw_views, 1u));
+        const float yaw = std::atan2(to_camera.x, to_camera.z);
+        const auto column = static_cast<int64_t>(std::round(yaw / glm::two_pi<float>() * static_cast<float>(columns)));
+
+        uint32_t row = 0;
+        if (pitch_views > 1 && max_pitch > 0.0f) {
+            const float length = glm::length(to_camera);
+            const float pitch = length > 0.0f ? std::asin(std::clamp(to_camera.y / length, -1.0f, 1.0f)) : 0.0f;
+            // Views from below the horizon use the lowest row, the grid never captures them.
+            const float cell = std::round(pitch / max_pitch * static_cast<float>(pitch_views - 1));
+            row = static_cast<uint32_t>(std::clamp(cell, 0.0f, static_cast<float>(pitch_views - 1)));
+        }
+        return Vector2u { static_cast<uint32_t>((column % columns + columns) % columns), row };
+    }
+
+    Rectangle ImpostorViewGrid::frame_rect(const uint32_t column, const uint32_t row) const {
+        const float width = 1.0f / static_cast<float>(std::max(yaw_views, 1u));
+        const float height = 1.0f / static_cast<float>(std::max(pitch_views, 1u));
+        return Rectangle { static_cast<float>(column) * width, static_cast<float>(row) * height, width, height };
+    }
+
+    ImpostorInstance MakeImpostorInstance(const BoundingSphere& bounds, const Matrix4& model_matrix) {
+        const auto world = bounds.transformed(model_matrix);
+        const Vector3 forward = Vector3(model_matrix * Vector4(0.0f, 0.0f, 1.0f, 0.0f));
+        return ImpostorInstance { Vector4(world.center, world.radius), Vector4(std::atan2(forward.x, forward.z), 0.0f, 0.0f, 0.0f) };
+    }
+
+    BoundingSphere ModelBounds(const Model& model) {
+        Option<BoundingSphere> result = std::nullopt;
+        for (const auto& mesh : model.meshes()) {
+            const auto& sphere = mesh->bounds();
+            if (!result.has_value()) {
+                result = sphere;
+                continue;
+            }
+            const float distance = glm::length(sphere.center - result->center);
+            if (distance + sphere.radius <= result->radius) {
+                continue;
+            }
+            if (distance + result->radius <= sphere.radius) {
+                result = sphere;
+                continue;
+            }
+            const float radius = (distance + result->radius + sphere.radius) * 0.5f;
+            result->center += (sphere.center - result->center) * ((radius - result->radius) / distance);
+            result->radius = radius;
+        }
+        return result.value_or(BoundingSphere { });
+    }
+
+    Impostor::Impostor(const Texture2DPtr& atlas, const ImpostorViewGrid& grid, const BoundingSphere& bounds) :
+        m_pAtlas(atlas), m_grid(grid), m_bounds(bounds), m_uInstanceBuffer(0), m_iInstanceBufferSize(0) {
+        auto material = Material::New("Impostor", {
+            { "MainTexture", atlas },
+            { "YawViews", m_grid.yaw_views },
+            { "PitchViews", m_grid.pitch_views },
+            { "MaxPitch", m_grid.max_pitch }
+        });
+        if (!material.has_value()) {
+            Debug::LogError(std::format("Failed to create impostor material: {}", material.error().message));
+            return;
+        }
+        m_pMaterial = material.value();
+
+        const auto quad = Mesh::CreateQuad(m_pMaterial);
+        if (!quad.has_value()) {
+            Debug::LogError("Failed to create quad mesh for impostor");
+            return;
+        }
+        m_pQuad = quad.value();
+    }
+
+    Impostor::~Impostor() {
+        if (m_uInstanceBuffer != 0) {
+            glDeleteBuffers(1, &m_uInstanceBuffer);
+        }
+    }
+
+    void Impostor::draw(const Transform& transform) const {
+        draw_instances(Vector { MakeImpostorInstance(m_bounds, transform.matrix()) });
+    }
+
+    void Impostor::draw_instances(const Vector<Transform>& transforms) const {
+        Vector<ImpostorInstance> instances;
+        instances.reserve(transforms.size());
+        for (const auto& transform : transforms) {
+            instances.push_back(MakeImpostorInstance(m_bounds, transform.matrix()));
+        }
+        draw_instances(instances);
+    }
+
+    void Impostor::draw_instances(const Vector<ImpostorInstance>& instances) const {
+        if (instances.empty() || !is_valid() || !m_pQuad->is_resident()) {
+            return;
+        }
+
+        const auto size = static_cast<GLsizeiptr>(instances.size() * sizeof(ImpostorInstance));
+        if (m_uInstanceBuffer == 0) {
+            glGenBuffers(1, &m_uInstanceBuffer);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_uInstanceBuffer);
+        if (m_iInstanceBufferSize < size) {
+            // Grows geometrically, the number of distant instances changes a little every frame.
+            m_iInstanceBufferSize = std::max(size, m_iInstanceBufferSize * 2);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, m_iInstanceBufferSize, nullptr, GL_STREAM_DRAW);
+        }
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, instances.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FOW_SHADER_IMPOSTOR_INSTANCE_BUFFER_BINDING, m_uInstanceBuffer);
+
+        Debug::Assert(m_pMaterial->apply());
+        const auto& shader = m_pMaterial->shader();
+        FOW_DISCARD(shader->set_uniform("VERTEX_POSITION_SCALE", m_pQuad->quantization().scale));
+        FOW_DISCARD(shader->set_uniform("VERTEX_POSITION_OFFSET", m_pQuad->quantization().offset));
+
+        const auto lod = m_pQuad->lod(0);
+        GlStateCache::Instance().bind_vertex_array(m_pQuad->vao());
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.index_count, GL_UNSIGNED_INT, reinterpret_cast<void*>((m_pQuad->first_index() + lod.index_offset) * sizeof(GLuint)),
+                                          static_cast<GLsizei>(instances.size()), m_pQuad->base_vertex());
+    }
+
+    Result<ImpostorPtr> Impostor::Capture(const Model& model, const ImpostorOptions& options) {
+        const auto& grid = options.grid;
+        if (grid.yaw_views == 0 || grid.pitch_views == 0 || options.frame_size == 0) {
+            return Failure("Failed to capture impostor: The view grid is empty");
+        }
+        if (std::ranges::any_of(model.meshes(), [](const MeshPtr& mesh) { return !mesh->is_resident(); })) {
+            return Failure("Failed to capture impostor: The model is not uploaded yet");
+        }
+        const auto bounds = ModelBounds(model);
+        if (bounds.radius <= 0.0f) {
+            return Failure("Failed to capture impostor: The model is empty");
+        }
+
+        const auto width = static_cast<GLsizei>(grid.yaw_views * options.frame_size);
+        const auto height = static_cast<GLsizei>(grid.pitch_views * options.frame_size);
+        const auto levels = static_cast<GLsizei>(std::bit_width(static_cast<uint32_t>(std::max(width, height))));
+
+        GLuint texture = 0, depth = 0, framebuffer = 0;
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, levels, GL_RGBA8, width, height);
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glCreateRenderbuffers(1, &depth);
+        glNamedRenderbufferStorage(depth, GL_DEPTH_COMPONENT24, width, height);
+        glCreateFramebuffers(1, &framebuffer);
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, texture, 0);
+        glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+        const auto release_targets = [&] {
+            GlStateCache::Instance().forget_framebuffer(framebuffer);
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &depth);
+        };
+        if (const auto status = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER); status != GL_FRAMEBUFFER_COMPLETE) {
+            release_targets();
+            glDeleteTextures(1, &texture);
+            return Failure(std::format("Failed to capture impostor: Framebuffer is incomplete ({})", status));
+        }
+
+        const auto view = Renderer::GetViewMatrix();
+        const auto projection = Renderer::GetProjectionMatrix();
+        const auto viewport = Renderer::GetViewport();
+        const auto camera_position = Renderer::GetCameraPosition();
+        const auto camera_target = Renderer::GetCameraTarget();
+        const auto camera_up = Renderer::GetCameraUp();
+
+        GlStateCache::Instance().bind_framebuffer(GL_FRAMEBUFFER, framebuffer);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Orthographic views fitted to the bounding sphere, so every frame shows the model at the same scale.
+        const float radius = bounds.radius;
+        Renderer::UpdateCameraProjectionOrtho(-radius, -radius, radius * 2.0f, radius * 2.0f, radius * 0.5f, radius * 3.5f);
+        const auto frame_size = static_cast<float>(options.frame_size);
+        for (uint32_t row = 0; row < grid.pitch_views; ++row) {
+            for (uint32_t column = 0; column < grid.yaw_views; ++column) {
+                const auto direction = grid.direction(column, row);
+                const auto up = std::abs(direction.y) > 0.999f ? Vector3 { 0.0f, 0.0f, -1.0f } : Vector3 { 0.0f, 1.0f, 0.0f };
+                Renderer::SetViewport(static_cast<float>(column) * frame_size, static_cast<float>(row) * frame_size, frame_size, frame_size);
+                Renderer::UpdateCameraPosition(bounds.center + direction * (radius * 2.0f), bounds.center, up);
+                RenderQueue::UpdateSceneParams();
+
+                const auto& meshes = model.meshes();
+                const auto& overrides = model.material_overrides();
+                for (size_t i = 0; i < meshes.size(); ++i) {
+                    if (i < overrides.size() && overrides[i] != nullptr) {
+                        meshes[i]->draw_lod(0, overrides[i], Matrix4Constants::Identity);
+                    } else {
+                        meshes[i]->draw_lod(0, Matrix4Constants::Identity);
+                    }
+                }
+            }
+        }
+
+        GlStateCache::Instance().bind_framebuffer(GL_FRAMEBUFFER, 0);
+        release_targets();
+        glGenerateTextureMipmap(texture);
+
+        Renderer::UpdateCameraPosition(camera_position, camera_target, camera_up);
+        Renderer::UpdateCameraViewMatrix(view);
+        Renderer::UpdateCameraProjectionMatrix(projection);
+        Renderer::SetViewport(viewport);
+        RenderQueue::UpdateSceneParams();
+
+        auto impostor = CreateRef<Impostor>(CreateRef<Texture2D>(texture), grid, bounds);
+        if (!impostor->is_valid()) {
+            return Failure("Failed to capture impostor: Could not create its material");
+        }
+        return impostor;
+    }
+
+    ImpostorModel::ImpostorModel(const ModelPtr& model, const ImpostorOptions& options, const float switch_radius) :
+        m_pModel(model), m_pImpostor(nullptr), m_options(options), m_bounds(model != nullptr ? ModelBounds(*model) : BoundingSphere { }),
+        m_fSwitchRadius(switch_radius), m_bCaptureFailed(false) { }
+    ImpostorModel::ImpostorModel(const ModelPtr& model, const ImpostorPtr& impostor, const float switch_radius) :
+        m_pModel(model), m_pImpostor(impostor), m_bounds(model != nullptr ? ModelBounds(*model) : BoundingSphere { }),
+        m_fSwitchRadius(switch_radius), m_bCaptureFailed(false) {
+        if (m_pImpostor != nullptr) {
+            m_options.grid = m_pImpostor->grid();
+        }
+    }
+
+    void ImpostorModel::draw(const Transform& transform) const {
+        if (m_pModel == nullptr) {
+            return;
+        }
+        const auto model_matrix = transform.matrix();
+        if (use_impostor(model_matrix)) {
+            m_pImpostor->draw(transform);
+        } else {
+            m_pModel->draw(model_matrix);
+        }
+    }
+
+    bool ImpostorModel::enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const {
+        if (m_pModel == nullptr) {
+            return true;
+        }
+        const auto model_matrix = transform.matrix();
+        if (use_impostor(model_matrix)) {
+            RenderQueue::EnqueueImpostor(m_pImpostor, model_matrix);
+            return true;
+        }
+        Vector<size_t> lods;
+        return m_pModel->enqueue_draws(builder, model_matrix, lods);
+    }
+
+    bool ImpostorModel::use_impostor(const Matrix4& model_matrix) const {
+        const auto bounds = m_bounds.transformed(model_matrix);
+        const float projected_radius = ProjectSphereRadius(bounds, Renderer::GetViewMatrix(), Renderer::GetProjectionMatrix(), Renderer::GetViewport().height);
+        if (projected_radius >= m_fSwitchRadius) {
+            return false;
+        }
+        if (m_pImpostor == nullptr && !m_bCaptureFailed) {
+            // Pending meshes are simply drawn as they are until they become resident.
+            if (std::ranges::any_of(m_pModel->meshes(), [](const MeshPtr& mesh) { return !mesh->is_resident(); })) {
+                return false;
+            }
+            auto result = Impostor::Capture(*m_pModel, m_options);
+            if (!result.has_value()) {
+                Debug::LogError(result.error().message);
+                m_bCaptureFailed = true;
+                return false;
+            }
+            m_pImpostor = result.value();
+        }
+        return m_pImpostor != nullptr;
+    }
+}
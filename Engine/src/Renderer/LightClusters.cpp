@@ -0,0 +1,231 @@
+#include "fow/Renderer/LightClusters.hpp"
+#include "fow/Renderer/Shader.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define FOW_LIGHT_CLUSTERS_USE_SSE 1
+#else
+    #define FOW_LIGHT_CLUSTERS_USE_SSE 0
+#endif
+
+namespace fow {
+    // View space lights that overlap one depth slice, stored as padded structure of arrays so four can be tested at once.
+    struct SliceCandidates {
+        Vector<float> x, y, z, radius_sq;
+        Vector<uint32_t> light_index;
+
+        void clear() {
+            x.clear();
+            y.clear();
+            z.clear();
+            radius_sq.clear();
+            light_index.clear();
+        }
+        void push(const Vector3& center, const float radius, const uint32_t index) {
+            x.push_back(center.x);
+            y.push_back(center.y);
+            z.push_back(center.z);
+            radius_sq.push_back(radius * radius);
+            light_index.push_back(index);
+        }
+        // Padding entries have a negative squared radius and never intersect anything.
+        void pad() {
+            while (x.size() % 4 != 0) {
+                push(Vector3 { 0.0f }, 0.0f, 0);
+                radius_sq.back() = -1.0f;
+            }
+        }
+        [[nodiscard]] bool is_empty() const { return x.empty(); }
+    };
+
+    static void AppendIntersectingLights(const SliceCandidates& candidates, const LightClusterBounds& box, Vector<uint32_t>& indices) {
+#if FOW_LIGHT_CLUSTERS_USE_SSE
+        const __m128 min_x = _mm_set1_ps(box.min.x), max_x = _mm_set1_ps(box.max.x);
+        const __m128 min_y = _mm_set1_ps(box.min.y), max_y = _mm_set1_ps(box.max.y);
+        const __m128 min_z = _mm_set1_ps(box.min.z), max_z = _mm_set1_ps(box.max.z);
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t i = 0; i < candidates.x.size(); i += 4) {
+            const __m128 cx = _mm_loadu_ps(candidates.x.data() + i);
+            const __m128 cy = _mm_loadu_ps(candidates.y.data() + i);
+            const __m128 cz = _mm_loadu_ps(candidates.z.data() + i);
+            const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_x, cx), _mm_sub_ps(cx, max_x)), zero);
+            const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_y, cy), _mm_sub_ps(cy, max_y)), zero);
+            const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_z, cz), _mm_sub_ps(cz, max_z)), zero);
+            const __m128 distance_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            auto mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(distance_sq, _mm_loadu_ps(candidates.radius_sq.data() + i))));
+            while (mask != 0) {
+                indices.push_back(candidates.light_index[i + std::countr_zero(mask)]);
+                mask &= mask - 1;
+            }
+        }
+#else
+        for (size_t i = 0; i < candidates.x.size(); ++i) {
+            const float dx = std::max({ box.min.x - candidates.x[i], candidates.x[i] - box.max.x, 0.0f });
+            const float dy = std::max({ box.min.y - candidates.y[i], candidates.y[i] - box.max.y, 0.0f });
+            const float dz = std::max({ box.min.z - candidates.z[i], candidates.z[i] - box.max.z, 0.0f });
+            if (dx * dx + dy * dy + dz * dz <= candidates.radius_sq[i]) {
+                indices.push_back(candidates.light_index[i]);
+            }
+        }
+#endif
+    }
+
+    static float SliceDepth(const float near, const float far, const uint32_t slice, const uint32_t slice_count) {
+        return near * std::pow(far / near, static_cast<float>(slice) / static_cast<float>(slice_count));
+    }
+
+    LightClusterGrid::LightClusterGrid(const Vector3u& size) :
+        m_size(glm::max(size, Vector3u { 1u })), m_projection(0.0f), m_fNear(0.0f), m_fFar(0.0f),
+        m_uLightBuffer(0), m_uClusterBuffer(0), m_uIndexBuffer(0), m_iLightBufferSize(0), m_iClusterBufferSize(0), m_iIndexBufferSize(0) { }
+
+    LightClusterGrid::~LightClusterGrid() {
+        release();
+    }
+
+    void LightClusterGrid::release() {
+        for (GLuint* buffer : { &m_uLightBuffer, &m_uClusterBuffer, &m_uIndexBuffer }) {
+            if (*buffer != 0) {
+                glDeleteBuffers(1, buffer);
+                *buffer = 0;
+            }
+        }
+        m_iLightBufferSize = m_iClusterBufferSize = m_iIndexBufferSize = 0;
+    }
+
+    Vector2 LightClusterGrid::depth_slice_params() const {
+        if (m_fNear <= 0.0f || m_fFar <= m_fNear) {
+            return Vector2 { 0.0f };
+        }
+        const float log_range = std::log(m_fFar / m_fNear);
+        const auto slices = static_cast<float>(m_size.z);
+        return Vector2 { slices / log_range, -slices * std::log(m_fNear) / log_range };
+    }
+
+    void LightClusterGrid::build_bounds(const Matrix4& projection) {
+        m_projection = projection;
+        m_bounds.resize(cluster_count());
+
+        // Rays through the tile corners, scaled so that they reach a view depth of 1.
+        const Matrix4 inverse_projection = glm::inverse(projection);
+        Vector<Vector3> corners;
+        corners.reserve((m_size.x + 1) * (m_size.y + 1));
+        for (uint32_t y = 0; y <= m_size.y; ++y) {
+            for (uint32_t x = 0; x <= m_size.x; ++x) {
+                const Vector4 ndc {
+                    -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(m_size.x),
+                    -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(m_size.y),
+                    -1.0f, 1.0f
+                };
+                const Vector4 point = inverse_projection * ndc;
+                const Vector3 view_point = Vector3(point) / point.w;
+                corners.push_back(view_point / -view_point.z);
+            }
+        }
+
+        for (uint32_t z = 0; z < m_size.z; ++z) {
+            const float depths[] = { SliceDepth(m_fNear, m_fFar, z, m_size.z), SliceDepth(m_fNear, m_fFar, z + 1, m_size.z) };
+            for (uint32_t y = 0; y < m_size.y; ++y) {
+                for (uint32_t x = 0; x < m_size.x; ++x) {
+                    auto& bounds = m_bounds[cluster_index(x, y, z)];
+                    bounds.min = Vector3 { std::numeric_limits<float>::max() };
+                    bounds.max = Vector3 { std::numeric_limits<float>::lowest() };
+                    for (const auto corner : { x + y * (m_size.x + 1), x + 1 + y * (m_size.x + 1), x + (y + 1) * (m_size.x + 1), x + 1 + (y + 1) * (m_size.x + 1) }) {
+                        for (const float depth : depths) {
+                            const Vector3 point = corners[corner] * depth;
+                            bounds.min = glm::min(bounds.min, point);
+                            bounds.max = glm::max(bounds.max, point);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Result<> LightClusterGrid::assign(const Matrix4& view, const Matrix4& projection, const Vector<ClusterLight>& lights) {
+        if (projection[2][3] != -1.0f || projection[3][3] != 0.0f) {
+            return Failure("Failed to assign lights to clusters: Only perspective projections are supported!");
+        }
+        const float near = projection[3][2] / (projection[2][2] - 1.0f);
+        const float far  = projection[3][2] / (projection[2][2] + 1.0f);
+        if (!(near > 0.0f) || !(far > near)) {
+            return Failure(std::format("Failed to assign lights to clusters: Invalid clipping planes (near: {}, far: {})", near, far));
+        }
+        if (m_bounds.empty() || projection != m_projection) {
+            m_fNear = near;
+            m_fFar = far;
+            build_bounds(projection);
+        }
+
+        m_ranges.assign(cluster_count(), LightClusterRange { 0, 0 });
+        m_indices.clear();
+
+        Vector<Vector4> view_lights;
+        view_lights.reserve(lights.size());
+        for (const auto& light : lights) {
+            const Vector4 center = view * Vector4(Vector3(light.position_radius), 1.0f);
+            view_lights.emplace_back(Vector3(center), light.position_radius.w);
+        }
+
+        SliceCandidates candidates;
+        for (uint32_t z = 0; z < m_size.z; ++z) {
+            const float slice_near = SliceDepth(m_fNear, m_fFar, z, m_size.z);
+            const float slice_far  = SliceDepth(m_fNear, m_fFar, z + 1, m_size.z);
+
+            candidates.clear();
+            for (uint32_t i = 0; i < view_lights.size(); ++i) {
+                const float depth = -view_lights[i].z;
+                const float radius = view_lights[i].w;
+                if (depth + radius >= slice_near && depth - radius <= slice_far) {
+                    candidates.push(Vector3(view_lights[i]), radius, i);
+                }
+            }
+            if (candidates.is_empty()) {
+                continue;
+            }
+            candidates.pad();
+
+            for (uint32_t y = 0; y < m_size.y; ++y) {
+                for (uint32_t x = 0; x < m_size.x; ++x) {
+                    const uint32_t index = cluster_index(x, y, z);
+                    const auto offset = static_cast<uint32_t>(m_indices.size());
+                    AppendIntersectingLights(candidates, m_bounds[index], m_indices);
+                    m_ranges[index] = LightClusterRange { offset, static_cast<uint32_t>(m_indices.size()) - offset };
+                }
+            }
+        }
+
+        return Success();
+    }
+
+    static void UploadStorageBuffer(GLuint& buffer, GLsizeiptr& capacity, const GLuint binding, const void* data, const GLsizeiptr size) {
+        // Empty storage buffers are not allowed to be bound, keep at least one element around.
+        const GLsizeiptr required = std::max<GLsizeiptr>(size, 16);
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        if (capacity < required) {
+            glBufferData(GL_SHADER_STORAGE_BUFFER, required, nullptr, GL_DYNAMIC_DRAW);
+            capacity = required;
+        }
+        if (size > 0) {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    }
+
+    void LightClusterGrid::upload(const Vector<ClusterLight>& lights) const {
+        UploadStorageBuffer(m_uLightBuffer, m_iLightBufferSize, FOW_SHADER_LIGHT_BUFFER_BINDING,
+            lights.data(), static_cast<GLsizeiptr>(lights.size() * sizeof(ClusterLight)));
+        UploadStorageBuffer(m_uClusterBuffer, m_iClusterBufferSize, FOW_SHADER_CLUSTER_BUFFER_BINDING,
+            m_ranges.data(), static_cast<GLsizeiptr>(m_ranges.size() * sizeof(LightClusterRange)));
+        UploadStorageBuffer(m_uIndexBuffer, m_iIndexBufferSize, FOW_SHADER_CLUSTER_INDEX_BUFFER_BINDING,
+            m_indices.data(), static_cast<GLsizeiptr>(m_indices.size() * sizeof(uint32_t)));
+    }
+}
@@ -1,1029 +1,428 @@
 #include "fow/Renderer/GL.hpp"
 #include "fow/Renderer/Material.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+
+#include <algorithm>
 
 namespace fow {
-    Result<> Material::set_parameter(const String& name, const MaterialParameterValue& value) {
-        ShaderPtr shader = m_pShader == nullptr ? Shader::PlaceHolder() : m_pShader;
-        const auto info = shader->get_uniform_info(name);
-        if (!info.has_value()) {
-            return Failure(std::format("Shader has no parameter \"{}\"", name));
+    static constexpr GLint MaxMaterialTextures = 32;
+
+    static uint64_t s_next_material_id = 1;
+    static HashMap<GLuint, uint64_t> s_program_owners;
+
+    static uint32_t UniformStorageSize(const ShaderUniformType type) {
+        switch (type) {
+            case ShaderUniformType::Bool:
+            case ShaderUniformType::Int:
+            case ShaderUniformType::UInt:
+            case ShaderUniformType::Float:         return 4;
+            case ShaderUniformType::BoolVector2:
+            case ShaderUniformType::IntVector2:
+            case ShaderUniformType::UIntVector2:
+            case ShaderUniformType::FloatVector2:
+            case ShaderUniformType::Double:        return 8;
+            case ShaderUniformType::BoolVector3:
+            case ShaderUniformType::IntVector3:
+            case ShaderUniformType::UIntVector3:
+            case ShaderUniformType::FloatVector3:  return 12;
+            case ShaderUniformType::BoolVector4:
+            case ShaderUniformType::IntVector4:
+            case ShaderUniformType::UIntVector4:
+            case ShaderUniformType::FloatVector4:
+            case ShaderUniformType::DoubleVector2: return 16;
+            case ShaderUniformType::DoubleVector3: return 24;
+            case ShaderUniformType::DoubleVector4: return 32;
+            case ShaderUniformType::Matrix4:       return 64;
+            default:                               return 0;
         }
-        switch (info->type) {
-            case ShaderUniformType::Bool: {
-                if (value.index() == static_cast<int>(MaterialParameterType::Bool)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UInt)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<1>(value) != 0;
-                    } else {
-                        m_mParams.emplace(name, std::get<1>(value) != 0);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Int)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<2>(value) != 0;
-                    } else {
-                        m_mParams.emplace(name, std::get<2>(value) != 0);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Float)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<3>(value) != 0.0f;
-                    } else {
-                        m_mParams.emplace(name, std::get<3>(value) != 0.0f);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Double)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<4>(value) != 0.0;
-                    } else {
-                        m_mParams.emplace(name, std::get<4>(value) != 0.0);
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to boolean!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::Int: {
-                if (value.index() == static_cast<int>(MaterialParameterType::Bool)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<0>(value) ? 1 : 0;
-                    } else {
-                        m_mParams.emplace(name, std::get<0>(value) ? 1 : 0);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UInt)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLint>(std::get<1>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLint>(std::get<1>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Int)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Float)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLint>(std::get<3>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLint>(std::get<3>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Double)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLint>(std::get<4>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLint>(std::get<4>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to integer!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::UInt: {
-                if (value.index() == static_cast<int>(MaterialParameterType::Bool)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<0>(value) ? 1u : 0u;
-                    } else {
-                        m_mParams.emplace(name, std::get<0>(value) ? 1u : 0u);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UInt)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<1>(value);
-                    } else {
-                        m_mParams.emplace(name, std::get<1>(value));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Int)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLuint>(std::get<2>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLuint>(std::get<2>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Float)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLuint>(std::get<3>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLuint>(std::get<3>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Double)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLuint>(std::get<4>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLuint>(std::get<4>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to unsigned integer!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::Float: {
-                if (value.index() == static_cast<int>(MaterialParameterType::Bool)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<0>(value) ? 1.0f : 0.0f;
-                    } else {
-                        m_mParams.emplace(name, std::get<0>(value) ? 1.0f : 0.0f);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UInt)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLfloat>(std::get<1>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLfloat>(std::get<1>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Int)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLfloat>(std::get<2>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLfloat>(std::get<2>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Float)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Double)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLfloat>(std::get<4>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLfloat>(std::get<4>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to float!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::Double: {
-                if (value.index() == static_cast<int>(MaterialParameterType::Bool)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = std::get<0>(value) ? 1.0 : 0.0;
-                    } else {
-                        m_mParams.emplace(name, std::get<0>(value) ? 1.0 : 0.0);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UInt)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLdouble>(std::get<1>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLdouble>(std::get<1>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Int)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLdouble>(std::get<2>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLdouble>(std::get<2>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Float)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = static_cast<GLdouble>(std::get<3>(value));
-                    } else {
-                        m_mParams.emplace(name, static_cast<GLdouble>(std::get<3>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::Double)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to double!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::BoolVector2: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        const auto uvec2 = std::get<8>(value);
-                        m_mParams.at(name) = Vector2b(uvec2.x != 0, uvec2.y != 0);
-                    } else {
-                        const auto uvec2 = std::get<8>(value);
-                        m_mParams.emplace(name, Vector2b(uvec2.x != 0, uvec2.y != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        const auto ivec2 = std::get<11>(value);
-                        m_mParams.at(name) = Vector2b(ivec2.x != 0, ivec2.y != 0);
-                    } else {
-                        const auto ivec2 = std::get<11>(value);
-                        m_mParams.emplace(name, Vector2b(ivec2.x != 0, ivec2.y != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector2)) {
-                    if (m_mParams.contains(name)) {
-                        const auto fvec2 = std::get<14>(value);
-                        m_mParams.at(name) = Vector2b(fvec2.x != 0, fvec2.y != 0);
-                    } else {
-                        const auto fvec2 = std::get<14>(value);
-                        m_mParams.emplace(name, Vector2b(fvec2.x != 0, fvec2.y != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector2)) {
-                    if (m_mParams.contains(name)) {
-                        const auto dvec2 = std::get<17>(value);
-                        m_mParams.at(name) = Vector2b(dvec2.x != 0, dvec2.y != 0);
-                    } else {
-                        const auto dvec2 = std::get<17>(value);
-                        m_mParams.emplace(name, Vector2b(dvec2.x != 0, dvec2.y != 0));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to bvec2!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::BoolVector3: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        const auto uvec3 = std::get<9>(value);
-                        m_mParams.at(name) = Vector3b(uvec3.x != 0, uvec3.y != 0, uvec3.z != 0);
-                    } else {
-                        const auto uvec3 = std::get<9>(value);
-                        m_mParams.emplace(name, Vector3b(uvec3.x != 0, uvec3.y != 0, uvec3.z != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        const auto ivec3 = std::get<12>(value);
-                        m_mParams.at(name) = Vector3b(ivec3.x != 0, ivec3.y != 0, ivec3.z != 0);
-                    } else {
-                        const auto ivec3 = std::get<12>(value);
-                        m_mParams.emplace(name, Vector3b(ivec3.x != 0, ivec3.y != 0, ivec3.z != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector3)) {
-                    if (m_mParams.contains(name)) {
-                        const auto fvec3 = std::get<15>(value);
-                        m_mParams.at(name) = Vector3b(fvec3.x != 0, fvec3.y != 0, fvec3.z != 0);
-                    } else {
-                        const auto fvec3 = std::get<15>(value);
-                        m_mParams.emplace(name, Vector3b(fvec3.x != 0, fvec3.y != 0, fvec3.z != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector3)) {
-                    if (m_mParams.contains(name)) {
-                        const auto dvec3 = std::get<18>(value);
-                        m_mParams.at(name) = Vector3b(dvec3.x != 0, dvec3.y != 0, dvec3.z != 0);
-                    } else {
-                        const auto dvec3 = std::get<18>(value);
-                        m_mParams.emplace(name, Vector3b(dvec3.x != 0, dvec3.y != 0, dvec3.z != 0));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to bvec3!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::BoolVector4: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        const auto uvec4 = std::get<10>(value);
-                        m_mParams.at(name) = Vector4b(uvec4.x != 0, uvec4.y != 0, uvec4.z != 0, uvec4.w != 0);
-                    } else {
-                        const auto uvec4 = std::get<10>(value);
-                        m_mParams.emplace(name, Vector4b(uvec4.x != 0, uvec4.y != 0, uvec4.z != 0, uvec4.w != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        const auto ivec4 = std::get<13>(value);
-                        m_mParams.at(name) = Vector4b(ivec4.x != 0, ivec4.y != 0, ivec4.z != 0, ivec4.w != 0);
-                    } else {
-                        const auto ivec4 = std::get<13>(value);
-                        m_mParams.emplace(name, Vector4b(ivec4.x != 0, ivec4.y != 0, ivec4.z != 0, ivec4.w != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector4)) {
-                    if (m_mParams.contains(name)) {
-                        const auto fvec4 = std::get<16>(value);
-                        m_mParams.at(name) = Vector4b(fvec4.x != 0, fvec4.y != 0, fvec4.z != 0, fvec4.w != 0);
-                    } else {
-                        const auto fvec4 = std::get<16>(value);
-                        m_mParams.emplace(name, Vector4b(fvec4.x != 0, fvec4.y != 0, fvec4.z != 0, fvec4.w != 0));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector4)) {
-                    if (m_mParams.contains(name)) {
-                        const auto dvec4 = std::get<19>(value);
-                        m_mParams.at(name) = Vector4b(dvec4.x != 0, dvec4.y != 0, dvec4.z != 0, dvec4.w != 0);
-                    } else {
-                        const auto dvec4 = std::get<19>(value);
-                        m_mParams.emplace(name, Vector4b(dvec4.x != 0, dvec4.y != 0, dvec4.z != 0, dvec4.w != 0));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to bvec4!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::IntVector2: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2i(std::get<5>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2i(std::get<5>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2i(std::get<8>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2i(std::get<8>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2i(std::get<11>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2i(std::get<11>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2i(std::get<14>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2i(std::get<14>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2i(std::get<17>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2i(std::get<17>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to ivec2!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::IntVector3: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3i(std::get<6>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3i(std::get<6>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3i(std::get<9>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3i(std::get<9>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3i(std::get<12>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3i(std::get<12>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3i(std::get<15>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3i(std::get<15>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3i(std::get<18>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3i(std::get<18>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to ivec3!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::IntVector4: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4i(std::get<7>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4i(std::get<7>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4i(std::get<10>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4i(std::get<10>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4i(std::get<13>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4i(std::get<13>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4i(std::get<16>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4i(std::get<16>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4i(std::get<19>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4i(std::get<19>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to ivec4!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::UIntVector2: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2u(std::get<5>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2u(std::get<5>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2u(std::get<8>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2u(std::get<8>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2u(std::get<11>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2u(std::get<11>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2u(std::get<14>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2u(std::get<14>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2u(std::get<17>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2u(std::get<17>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to uvec2!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::UIntVector3: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3u(std::get<6>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3u(std::get<6>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3u(std::get<9>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3u(std::get<9>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3u(std::get<12>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3u(std::get<12>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3u(std::get<15>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3u(std::get<15>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3u(std::get<18>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3u(std::get<18>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to uvec3!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::UIntVector4: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4u(std::get<7>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4u(std::get<7>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4u(std::get<10>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4u(std::get<10>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4u(std::get<13>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4u(std::get<13>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4u(std::get<16>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4u(std::get<16>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4u(std::get<19>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4u(std::get<19>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to uvec4!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::FloatVector2: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2(std::get<5>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2(std::get<5>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2(std::get<8>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2(std::get<8>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2(std::get<11>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2(std::get<11>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2(std::get<14>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2(std::get<14>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector2(std::get<17>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector2(std::get<17>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to vec2!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
-            }
-            case ShaderUniformType::FloatVector3: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3(std::get<6>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3(std::get<6>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3(std::get<9>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3(std::get<9>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3(std::get<12>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3(std::get<12>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3(std::get<15>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3(std::get<15>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector3(std::get<18>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector3(std::get<18>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to vec3!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
+    }
+
+    static void UploadParameter(const MaterialParameterSlot& slot, const std::byte* data) {
+        const auto* i = reinterpret_cast<const GLint*>(data);
+        const auto* u = reinterpret_cast<const GLuint*>(data);
+        const auto* f = reinterpret_cast<const GLfloat*>(data);
+        const auto* d = reinterpret_cast<const GLdouble*>(data);
+        switch (slot.type) {
+            case ShaderUniformType::Bool:
+            case ShaderUniformType::Int:           glUniform1iv(slot.location, 1, i);  break;
+            case ShaderUniformType::BoolVector2:
+            case ShaderUniformType::IntVector2:    glUniform2iv(slot.location, 1, i);  break;
+            case ShaderUniformType::BoolVector3:
+            case ShaderUniformType::IntVector3:    glUniform3iv(slot.location, 1, i);  break;
+            case ShaderUniformType::BoolVector4:
+            case ShaderUniformType::IntVector4:    glUniform4iv(slot.location, 1, i);  break;
+            case ShaderUniformType::UInt:          glUniform1uiv(slot.location, 1, u); break;
+            case ShaderUniformType::UIntVector2:   glUniform2uiv(slot.location, 1, u); break;
+            case ShaderUniformType::UIntVector3:   glUniform3uiv(slot.location, 1, u); break;
+            case ShaderUniformType::UIntVector4:   glUniform4uiv(slot.location, 1, u); break;
+            case ShaderUniformType::Float:         glUniform1fv(slot.location, 1, f);  break;
+            case ShaderUniformType::FloatVector2:  glUniform2fv(slot.location, 1, f);  break;
+            case ShaderUniformType::FloatVector3:  glUniform3fv(slot.location, 1, f);  break;
+            case ShaderUniformType::FloatVector4:  glUniform4fv(slot.location, 1, f);  break;
+            case ShaderUniformType::Double:        glUniform1dv(slot.location, 1, d);  break;
+            case ShaderUniformType::DoubleVector2: glUniform2dv(slot.location, 1, d);  break;
+            case ShaderUniformType::DoubleVector3: glUniform3dv(slot.location, 1, d);  break;
+            case ShaderUniformType::DoubleVector4: glUniform4dv(slot.location, 1, d);  break;
+            case ShaderUniformType::Matrix4:       glUniformMatrix4fv(slot.location, 1, GL_FALSE, f); break;
+            default: break;
+        }
+    }
+
+    template<typename T>
+    static T ReadParameter(const std::byte* data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    static MaterialParameterValue ReadParameter(const MaterialParameterSlot& slot, const std::byte* data) {
+        switch (slot.type) {
+            case ShaderUniformType::Bool:          return ReadParameter<GLint>(data) != 0;
+            case ShaderUniformType::BoolVector2:   return Vector2b(ReadParameter<Vector2i>(data));
+            case ShaderUniformType::BoolVector3:   return Vector3b(ReadParameter<Vector3i>(data));
+            case ShaderUniformType::BoolVector4:   return Vector4b(ReadParameter<Vector4i>(data));
+            case ShaderUniformType::Int:           return ReadParameter<GLint>(data);
+            case ShaderUniformType::IntVector2:    return ReadParameter<Vector2i>(data);
+            case ShaderUniformType::IntVector3:    return ReadParameter<Vector3i>(data);
+            case ShaderUniformType::IntVector4:    return ReadParameter<Vector4i>(data);
+            case ShaderUniformType::UInt:          return ReadParameter<GLuint>(data);
+            case ShaderUniformType::UIntVector2:   return ReadParameter<Vector2u>(data);
+            case ShaderUniformType::UIntVector3:   return ReadParameter<Vector3u>(data);
+            case ShaderUniformType::UIntVector4:   return ReadParameter<Vector4u>(data);
+            case ShaderUniformType::Float:         return ReadParameter<GLfloat>(data);
+            case ShaderUniformType::FloatVector2:  return ReadParameter<Vector2>(data);
+            case ShaderUniformType::FloatVector3:  return ReadParameter<Vector3>(data);
+            case ShaderUniformType::FloatVector4:  return ReadParameter<Vector4>(data);
+            case ShaderUniformType::Double:        return ReadParameter<GLdouble>(data);
+            case ShaderUniformType::DoubleVector2: return ReadParameter<glm::dvec2>(data);
+            case ShaderUniformType::DoubleVector3: return ReadParameter<glm::dvec3>(data);
+            case ShaderUniformType::DoubleVector4: return ReadParameter<glm::dvec4>(data);
+            case ShaderUniformType::Matrix4:       return ReadParameter<Matrix4>(data);
+            default:                               return GLint(0);
+        }
+    }
+
+    static Result<MaterialParameterValue> ParseParameterValue(const ShaderUniformType type, const String& value) {
+        const auto parsed = [&]<typename T>(const Result<T>& result) -> Result<MaterialParameterValue> {
+            if (!result.has_value()) {
+                return Failure(std::format("Failed to parse data: \"{}\"!", result.error().message));
             }
+            return Success<MaterialParameterValue>(MaterialParameterValue { result.value() });
+        };
+        switch (type) {
+            case ShaderUniformType::Bool:          return parsed(StringToBool(value));
+            case ShaderUniformType::BoolVector2:   return parsed(StringToBVec2(value));
+            case ShaderUniformType::BoolVector3:   return parsed(StringToBVec3(value));
+            case ShaderUniformType::BoolVector4:   return parsed(StringToBVec4(value));
+            case ShaderUniformType::Int:           return parsed(StringToInt<GLint>(value));
+            case ShaderUniformType::IntVector2:    return parsed(StringToIVec2(value));
+            case ShaderUniformType::IntVector3:    return parsed(StringToIVec3(value));
+            case ShaderUniformType::IntVector4:    return parsed(StringToIVec4(value));
+            case ShaderUniformType::UInt:          return parsed(StringToInt<GLuint>(value));
+            case ShaderUniformType::UIntVector2:   return parsed(StringToUVec2(value));
+            case ShaderUniformType::UIntVector3:   return parsed(StringToUVec3(value));
+            case ShaderUniformType::UIntVector4:   return parsed(StringToUVec4(value));
+            case ShaderUniformType::Float:         return parsed(StringToFloat<GLfloat>(value));
+            case ShaderUniformType::FloatVector2:  return parsed(StringToVec2(value));
+            case ShaderUniformType::FloatVector3:  return parsed(StringToVec3(value));
             case ShaderUniformType::FloatVector4: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4(std::get<7>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4(std::get<7>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4(std::get<10>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4(std::get<10>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4(std::get<13>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4(std::get<13>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4(std::get<16>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4(std::get<16>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = Vector4(std::get<19>(value));
-                    } else {
-                        m_mParams.emplace(name, Vector4(std::get<19>(value)));
-                    }
-                    return Success();
+                if (const auto trimmed = value.clone_trimmed(); trimmed.starts_with('#')) {
+                    const auto result = StringToInt<uint32_t>(trimmed);
+                    if (!result.has_value()) {
+                        return parsed(result);
+                    }
+                    const uint32_t rgba = result.value();
+                    return Success<MaterialParameterValue>(Vector4 {
+                        ((rgba >> 24) & 0xFF) / 255.0f,
+                        ((rgba >> 16) & 0xFF) / 255.0f,
+                        ((rgba >> 8 ) & 0xFF) / 255.0f,
+                        (rgba & 0xFF)         / 255.0f
+                    });
+                } else {
+                    return parsed(StringToVec4(trimmed));
                 }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to vec4!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
             }
-            case ShaderUniformType::DoubleVector2: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec2(std::get<5>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec2(std::get<5>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec2(std::get<8>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec2(std::get<8>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec2(std::get<11>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec2(std::get<11>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec2(std::get<14>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec2(std::get<14>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector2)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec2(std::get<17>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec2(std::get<17>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to dvec2!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
+            case ShaderUniformType::Double:        return parsed(StringToFloat<GLdouble>(value));
+            case ShaderUniformType::DoubleVector2: return parsed(StringToDVec2(value));
+            case ShaderUniformType::DoubleVector3: return parsed(StringToDVec3(value));
+            case ShaderUniformType::DoubleVector4: return parsed(StringToDVec4(value));
+            case ShaderUniformType::Matrix4:       return parsed(StringToMat4(value));
+            default: return Failure(std::format("Uniform type \"{}\" is not supported!", type));
+        }
+    }
+
+    // Parameters that only exist in variants with the feature, they are dropped instead of warned about otherwise.
+    struct MaterialFeatureParameter {
+        ShaderFeatures::Type feature;
+        const char* name;
+    };
+    static constexpr MaterialFeatureParameter MaterialFeatureParameters[] = {
+        { ShaderFeatures::NormalMap,     "NormalMap" },
+        { ShaderFeatures::SpecularMap,   "SpecularMap" },
+        { ShaderFeatures::EmissionMap,   "EmissionMap" },
+        { ShaderFeatures::ColorTintMask, "ColorTintMask" },
+        { ShaderFeatures::ColorTintMask, "UseColorTintMask" },
+        { ShaderFeatures::AlphaScissor,  "AlphaScissor" },
+        { ShaderFeatures::AlphaScissor,  "AlphaScissorThreshold" }
+    };
+
+    // A texture equal to the neutral one does the same as the code that replaces it in variants without the feature.
+    static bool HasTextureParameter(const HashMap<String, MaterialParameterValue>& params, const char* name, TexturePtr(*neutral)()) {
+        const auto it = params.find(name);
+        if (it == params.end()) {
+            return false;
+        }
+        const auto* texture = std::get_if<TexturePtr>(&it->second);
+        return texture != nullptr && *texture != nullptr && *texture != neutral();
+    }
+    static bool HasFlagParameter(const HashMap<String, MaterialParameterValue>& params, const char* name) {
+        const auto it = params.find(name);
+        if (it == params.end()) {
+            return false;
+        }
+        const auto* value = std::get_if<bool>(&it->second);
+        return value != nullptr && *value;
+    }
+
+    static bool IsFeatureParameter(const std::string_view name) {
+        return std::ranges::any_of(MaterialFeatureParameters, [name](const MaterialFeatureParameter& param) {
+            return name == param.name;
+        });
+    }
+
+    static HashMap<String, MaterialParameterValue> VariantParameters(const ShaderPtr& shader, const HashMap<String, MaterialParameterValue>& params) {
+        if (shader == nullptr) {
+            return params;
+        }
+        HashMap<String, MaterialParameterValue> result;
+        for (const auto& [ name, value ] : params) {
+            const std::string_view name_view(name.as_cstr(), name.size());
+            if (shader->find_uniform(name_view) != nullptr || !IsFeatureParameter(name_view)) {
+                result.emplace(name, value);
             }
-            case ShaderUniformType::DoubleVector3: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec3(std::get<6>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec3(std::get<6>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec3(std::get<9>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec3(std::get<9>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec3(std::get<12>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec3(std::get<12>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec3(std::get<15>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec3(std::get<15>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector3)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec3(std::get<18>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec3(std::get<18>(value)));
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to dvec3!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
+        }
+        return result;
+    }
+
+    // Parameters that turn on a feature the shader compiled out move the material to the variant they select. Shaders that
+    // are not variants of the shader library have every feature they support.
+    static ShaderPtr ShaderForParameters(const ShaderPtr& shader, const HashMap<String, MaterialParameterValue>& params) {
+        if (shader == nullptr) {
+            return shader;
+        }
+        const auto [ name, features ] = ParseShaderVariantName(shader->name());
+        const auto key = Material::SelectVariant(params);
+        if ((key & ~features) == 0) {
+            return shader;
+        }
+        const auto variant = Shader::CompileVariant(name, key);
+        if (!variant.has_value()) {
+            Debug::LogError(std::format("Failed to compile variant of shader \"{}\": {}", name, variant.error().message));
+            return shader;
+        }
+        return variant.value();
+    }
+
+    Material::Material() : m_pShader(nullptr), m_uBlockSize(0), m_uUbo(0), m_bBlockDirty(false), m_uId(s_next_material_id++) { }
+    Material::Material(const ShaderPtr& shader, const HashMap<String, MaterialParameterValue>& params, const MaterialOptions options) :
+        m_pShader(shader), m_uBlockSize(0), m_uUbo(0), m_bBlockDirty(false), m_options(options), m_uId(s_next_material_id++) {
+        compile();
+        for (const auto& [ name, value ] : params) {
+            Debug::AssertWarn(set_parameter(name, value));
+        }
+    }
+    Material::Material(ShaderPtr&& shader, const HashMap<String, MaterialParameterValue>& params, const MaterialOptions options) :
+        m_pShader(std::move(shader)), m_uBlockSize(0), m_uUbo(0), m_bBlockDirty(false), m_options(options), m_uId(s_next_material_id++) {
+        compile();
+        for (const auto& [ name, value ] : params) {
+            Debug::AssertWarn(set_parameter(name, value));
+        }
+    }
+    Material::Material(const Material& material) : m_pShader(material.m_pShader), m_slots(material.m_slots), m_block(material.m_block),
+        m_textures(material.m_textures), m_dirty(material.m_dirty), m_uBlockSize(material.m_uBlockSize), m_uUbo(0), m_bBlockDirty(true),
+        m_options(material.m_options), m_uId(s_next_material_id++) { }
+    Material::Material(Material&& material) noexcept : m_pShader(std::move(material.m_pShader)), m_slots(std::move(material.m_slots)),
+        m_block(std::move(material.m_block)), m_textures(std::move(material.m_textures)), m_dirty(std::move(material.m_dirty)),
+        m_uBlockSize(material.m_uBlockSize), m_uUbo(material.m_uUbo), m_bBlockDirty(material.m_bBlockDirty),
+        m_options(material.m_options), m_uId(material.m_uId) {
+        material.m_pShader = nullptr;
+        material.m_uBlockSize = 0;
+        material.m_uUbo = 0;
+        material.m_uId = s_next_material_id++;
+    }
+    Material::~Material() {
+        if (m_uUbo != 0) {
+            glDeleteBuffers(1, &m_uUbo);
+        }
+    }
+
+    void Material::compile() {
+        m_slots.clear();
+        m_block.clear();
+        m_textures.clear();
+        m_dirty.clear();
+        m_uBlockSize = 0;
+        m_bBlockDirty = true;
+        if (m_pShader == nullptr) {
+            return;
+        }
+
+        const auto& uniforms = m_pShader->uniforms();
+        m_slots.resize(uniforms.size());
+
+        const auto* material_block = m_pShader->find_uniform_block(FOW_SHADER_MATERIAL_BLOCK_NAME);
+        if (material_block != nullptr) {
+            m_uBlockSize = static_cast<uint32_t>(material_block->data_size);
+        }
+
+        // The std140 image of the material block comes first, loose uniforms are stored after it.
+        uint32_t block_size = (m_uBlockSize + 7u) & ~7u;
+        GLint texture_unit = 0;
+        for (size_t i = 0; i < uniforms.size(); ++i) {
+            const auto& info = uniforms[i];
+            auto& slot = m_slots[i];
+            slot.location = info.location;
+            slot.type = info.type;
+            if (info.location < 0) {
+                if (material_block != nullptr && info.block_index == material_block->index && info.block_offset >= 0) {
+                    slot.in_block = true;
+                    slot.size = UniformStorageSize(info.type);
+                    slot.offset = static_cast<uint32_t>(info.block_offset);
+                }
+                continue;
             }
-            case ShaderUniformType::DoubleVector4: {
-                if (value.index() == static_cast<int>(MaterialParameterType::BoolVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec4(std::get<7>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec4(std::get<7>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::UIntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec4(std::get<10>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec4(std::get<10>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::IntVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec4(std::get<13>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec4(std::get<13>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::FloatVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec4(std::get<16>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec4(std::get<16>(value)));
-                    }
-                    return Success();
-                }
-                if (value.index() == static_cast<int>(MaterialParameterType::DoubleVector4)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = glm::dvec4(std::get<19>(value));
-                    } else {
-                        m_mParams.emplace(name, glm::dvec4(std::get<19>(value)));
-                    }
-                    return Success();
+            if (IsSamplerUniformType(info.type)) {
+                if (texture_unit < MaxMaterialTextures) {
+                    slot.texture_unit = texture_unit++;
+                } else {
+                    Debug::LogWarning(std::format("Texture limit reached! Parameter \"{}\" of shader \"{}\" will not be bound!", info.name, m_pShader->name()));
                 }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to dvec4!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
+                continue;
             }
-            case ShaderUniformType::Matrix4: {
-                 if (value.index() == static_cast<int>(MaterialParameterType::Matrix4)) {
-                     if (m_mParams.contains(name)) {
-                         m_mParams.at(name) = value;
-                     } else {
-                         m_mParams.emplace(name, value);
-                     }
-                    return Success();
-                 }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to mat4!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())))
-                );
+            slot.size = UniformStorageSize(info.type);
+            slot.offset = block_size;
+            block_size += (slot.size + 7u) & ~7u;
+        }
+
+        m_block.resize(block_size);
+        m_textures.resize(texture_unit);
+        m_dirty.assign(m_slots.size(), false);
+
+        for (size_t i = 0; i < uniforms.size(); ++i) {
+            if (uniforms[i].default_value.is_empty() || !m_slots[i].is_bound() || m_slots[i].texture_unit >= 0) {
+                continue;
             }
-            case ShaderUniformType::Sampler1D:
-            case ShaderUniformType::Sampler1DArray:
-            case ShaderUniformType::Sampler2D:
-            case ShaderUniformType::Sampler2DArray:
-            case ShaderUniformType::Sampler3D:
-            case ShaderUniformType::SamplerCube:
-            case ShaderUniformType::SamplerCubeArray: {
-                if (value.index() == static_cast<int>(MaterialParameterType::Texture)) {
-                    if (m_mParams.contains(name)) {
-                        m_mParams.at(name) = value;
-                    } else {
-                        m_mParams.emplace(name, value);
-                    }
-                    return Success();
-                }
-                return Failure(std::format("Cannot set parameter \"{}\", cannot convert {} type to {}!",
-                    name,
-                    rfl::enum_to_string(static_cast<MaterialParameterType>(value.index())),
-                    info->type
-                ));
-            } break;
+            if (const auto value = ParseParameterValue(uniforms[i].type, uniforms[i].default_value); value.has_value()) {
+                Debug::AssertWarn(set_parameter_value(static_cast<MaterialParamId>(i), value.value()));
+            } else {
+                Debug::LogWarning(std::format("Ignoring default value of \"{}\" in shader \"{}\": {}", uniforms[i].name, m_pShader->name(), value.error().message));
+            }
+        }
+    }
+
+    MaterialParamId Material::find_parameter(const String& name) const {
+        if (m_pShader == nullptr) {
+            return MaterialParamNone;
         }
-        return Failure(std::format("Cannot set parameter \"{}\", unsupported parameter type {}!",
-            name,
-            rfl::enum_to_string(static_cast<MaterialParameterType>(value.index()))
-        ));
+        const auto index = m_pShader->uniform_index(std::string_view(name.as_cstr(), name.size()));
+        if (index < 0 || static_cast<size_t>(index) >= m_slots.size() || !m_slots[index].is_bound()) {
+            return MaterialParamNone;
+        }
+        return static_cast<MaterialParamId>(index);
+    }
+
+    Result<> Material::set_parameter(const String& name, const MaterialParameterValue& value) {
+        const auto id = find_parameter(name);
+        if (id < 0) {
+            return Failure(std::format("Shader has no parameter \"{}\"", name));
+        }
+        return set_parameter_value(id, value);
+    }
+
+    Result<> Material::set_parameter_value(const MaterialParamId id, const MaterialParameterValue& value) {
+        return std::visit([this, id]<typename T>(const T& v) -> Result<> {
+            const auto param = parameter<T>(id);
+            if (!param.has_value()) {
+                return Failure(param.error());
+            }
+            set_parameter(param.value(), v);
+            return Success();
+        }, value);
     }
 
     Result<> Material::set_parameter_optional(const String& name, const MaterialParameterValue& value) {
-        if (shader()->has_uniform(name)) {
+        if (find_parameter(name) >= 0) {
             return set_parameter(name, value);
         }
         return Success();
     }
 
     Result<> Material::get_parameter(const String& name, MaterialParameterValue& value) const {
-        if (const auto info = m_pShader->get_uniform_info(name); !info.has_value()) {
+        const auto id = find_parameter(name);
+        if (id < 0) {
             return Failure(std::format("Shader has no parameter \"{}\"", name));
         }
-        if (m_mParams.contains(name)) {
-            value = m_mParams.at(name);
+        if (auto result = get_parameter(id); result.has_value()) {
+            value = std::move(result.value());
             return Success();
         }
         return Failure(std::format("Material has no parameter defined \"{}\"", name));
     }
+    Option<MaterialParameterValue> Material::get_parameter(const MaterialParamId id) const {
+        if (id < 0 || static_cast<size_t>(id) >= m_slots.size()) {
+            return std::nullopt;
+        }
+        const auto& slot = m_slots[id];
+        if (slot.texture_unit >= 0) {
+            if (m_textures[slot.texture_unit] != nullptr) {
+                return m_textures[slot.texture_unit];
+            }
+        } else if (slot.assigned) {
+            return ReadParameter(slot, m_block.data() + slot.offset);
+        }
+        return std::nullopt;
+    }
 
     Material& Material::operator=(const Material& material) {
-        m_pShader = material.m_pShader;
-        m_mParams = material.m_mParams;
+        if (this != &material) {
+            if (m_uUbo != 0 && m_uBlockSize != material.m_uBlockSize) {
+                glDeleteBuffers(1, &m_uUbo);
+                m_uUbo = 0;
+            }
+            m_pShader = material.m_pShader;
+            m_slots = material.m_slots;
+            m_block = material.m_block;
+            m_textures = material.m_textures;
+            m_dirty.assign(m_slots.size(), true);
+            m_uBlockSize = material.m_uBlockSize;
+            m_bBlockDirty = true;
+            m_options = material.m_options;
+        }
         return *this;
     }
 
     Material& Material::operator=(Material&& material) noexcept {
-        m_pShader = material.m_pShader;
-        m_mParams = material.m_mParams;
-        material.m_pShader = nullptr;
-        material.m_mParams = { };
+        if (this != &material) {
+            m_pShader = std::move(material.m_pShader);
+            m_slots = std::move(material.m_slots);
+            m_block = std::move(material.m_block);
+            m_textures = std::move(material.m_textures);
+            m_dirty.assign(m_slots.size(), true);
+            if (m_uUbo != 0) {
+                glDeleteBuffers(1, &m_uUbo);
+            }
+            m_uBlockSize = material.m_uBlockSize;
+            m_uUbo = material.m_uUbo;
+            m_bBlockDirty = material.m_bBlockDirty;
+            m_options = material.m_options;
+            material.m_pShader = nullptr;
+            material.m_uBlockSize = 0;
+            material.m_uUbo = 0;
+            material.m_slots = { };
+            material.m_block = { };
+            material.m_textures = { };
+            material.m_dirty = { };
+        }
         return *this;
     }
 
@@ -1043,128 +442,80 @@ namespace fow {
             shader = Shader::PlaceHolder();
         }
 
-        if (get_backface_culling()) {
-            glEnable(GL_CULL_FACE);
-        } else {
-            glDisable(GL_CULL_FACE);
-        }
-        if (!get_opaque()) {
-            glEnable(GL_BLEND);
-        } else {
-            glDisable(GL_BLEND);
-        }
-        if (get_depth_test()) {
-            glEnable(GL_DEPTH_TEST);
-        } else {
-            glDisable(GL_DEPTH_TEST);
-        }
+        auto& state = GlStateCache::Instance();
+        state.set_enabled(GL_CULL_FACE, get_backface_culling());
+        state.set_enabled(GL_BLEND, !get_opaque());
+        state.set_enabled(GL_DEPTH_TEST, get_depth_test());
 
-        Vector<String> used_uniforms = { };
         shader->use();
-        GLuint texture_unit = 0;
-        for (const auto& [ name, value ] : m_mParams) {
-            switch (static_cast<MaterialParameterType>(value.index())) {
-                case MaterialParameterType::Bool: {
-                    shader->set_uniform(name, std::get<0>(value));
-                } break;
-                case MaterialParameterType::UInt: {
-                    shader->set_uniform(name, std::get<1>(value));
-                } break;
-                case MaterialParameterType::Int: {
-                    shader->set_uniform(name, std::get<2>(value));
-                } break;
-                case MaterialParameterType::Float: {
-                    shader->set_uniform(name, std::get<3>(value));
-                } break;
-                case MaterialParameterType::Double: {
-                    shader->set_uniform(name, std::get<4>(value));
-                } break;
-                case MaterialParameterType::BoolVector2: {
-                    shader->set_uniform(name, std::get<5>(value));
-                } break;
-                case MaterialParameterType::BoolVector3: {
-                    shader->set_uniform(name, std::get<6>(value));
-                } break;
-                case MaterialParameterType::BoolVector4: {
-                    shader->set_uniform(name, std::get<7>(value));
-                } break;
-                case MaterialParameterType::UIntVector2: {
-                    shader->set_uniform(name, std::get<8>(value));
-                } break;
-                case MaterialParameterType::UIntVector3: {
-                    shader->set_uniform(name, std::get<9>(value));
-                } break;
-                case MaterialParameterType::UIntVector4: {
-                    shader->set_uniform(name, std::get<10>(value));
-                } break;
-                case MaterialParameterType::IntVector2: {
-                    shader->set_uniform(name, std::get<11>(value));
-                } break;
-                case MaterialParameterType::IntVector3: {
-                    shader->set_uniform(name, std::get<12>(value));
-                } break;
-                case MaterialParameterType::IntVector4: {
-                    shader->set_uniform(name, std::get<13>(value));
-                } break;
-                case MaterialParameterType::FloatVector2: {
-                    shader->set_uniform(name, std::get<14>(value));
-                } break;
-                case MaterialParameterType::FloatVector3: {
-                    shader->set_uniform(name, std::get<15>(value));
-                } break;
-                case MaterialParameterType::FloatVector4: {
-                    shader->set_uniform(name, std::get<16>(value));
-                } break;
-                case MaterialParameterType::DoubleVector2: {
-                    shader->set_uniform(name, std::get<17>(value));
-                } break;
-                case MaterialParameterType::DoubleVector3: {
-                    shader->set_uniform(name, std::get<18>(value));
-                } break;
-                case MaterialParameterType::DoubleVector4: {
-                    shader->set_uniform(name, std::get<19>(value));
-                } break;
-                case MaterialParameterType::Matrix4: {
-                    shader->set_uniform(name, std::get<20>(value));
-                } break;
-                case MaterialParameterType::Texture: {
-                    if (texture_unit > 31) {
-                        return Failure(std::format("Texture limit reached! Material cannot have more then 32 texture parameters!"));
-                    }
-                    auto texture = std::get<21>(value);
-                    if (!texture->is_valid()) {
-                        texture = Texture2D::PlaceHolder();
-                    }
-                    texture->bind(texture_unit);
-                    Debug::Assert(shader->set_uniform(name, static_cast<GLint>(texture_unit)), "Failed to set texture!");
-                    ++texture_unit;
-                } break;
+
+        if (m_uBlockSize > 0) {
+            if (m_uUbo == 0) {
+                glGenBuffers(1, &m_uUbo);
+                glBindBuffer(GL_UNIFORM_BUFFER, m_uUbo);
+                glBufferData(GL_UNIFORM_BUFFER, m_uBlockSize, m_block.data(), GL_DYNAMIC_DRAW);
+                m_bBlockDirty = false;
+            } else if (m_bBlockDirty) {
+                glBindBuffer(GL_UNIFORM_BUFFER, m_uUbo);
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, m_uBlockSize, m_block.data());
+                m_bBlockDirty = false;
             }
-            used_uniforms.emplace_back(name);
+            glBindBufferRange(GL_UNIFORM_BUFFER, FOW_SHADER_MATERIAL_BLOCK_BINDING, m_uUbo, 0, m_uBlockSize);
         }
 
-        for (size_t i = 0; i < shader->get_uniform_count(); ++i) {
-            if (const auto info = shader->get_uniform_info(i); info.has_value()) {
-                if (std::ranges::find(used_uniforms, info->name) == used_uniforms.end()) {
-                    if (info->type == ShaderUniformType::Sampler1D ||
-                        info->type == ShaderUniformType::Sampler2D ||
-                        info->type == ShaderUniformType::Sampler3D ||
-                        info->type == ShaderUniformType::SamplerCube ||
-                        info->type == ShaderUniformType::Sampler1DArray ||
-                        info->type == ShaderUniformType::Sampler2DArray ||
-                        info->type == ShaderUniformType::SamplerCubeArray
-                    ) {
-                        const auto placeholder = Texture::PlaceHolder();
-                        placeholder->bind(31);
-                        shader->set_uniform(info->name, 31);
-                    }
-                }
+        auto& owner = s_program_owners[shader->id()];
+        const bool upload_all = owner != m_uId;
+        owner = m_uId;
+
+        for (size_t i = 0; i < m_slots.size(); ++i) {
+            const auto& slot = m_slots[i];
+            if (slot.texture_unit >= 0) {
+                auto texture = m_textures[slot.texture_unit];
+                if (texture == nullptr || !texture->is_valid()) {
+                    texture = Texture::PlaceHolder();
+                }
+                texture->bind(slot.texture_unit);
+                if (upload_all) {
+                    shader->set_uniform(slot.location, slot.texture_unit);
+                }
+            } else if (!slot.in_block && slot.assigned && (upload_all || m_dirty[i])) {
+                UploadParameter(slot, m_block.data() + slot.offset);
             }
         }
+        m_dirty.assign(m_slots.size(), false);
 
         return Success();
     }
 
+    // The variant follows from the raw values of the feature parameters, so it is the only program compiled and the
+    // other parameters are parsed against its uniforms. Only the default textures are neutral, any texture path needs
+    // the feature even when it fails to load, its placeholder is sampled then.
+    static ShaderVariantKey SelectXmlVariant(const pugi::xml_node& params_node) {
+        HashMap<String, MaterialParameterValue> params;
+        for (const auto& child : params_node.children()) {
+            const std::string_view name = child.name();
+            const char* value = child.child_value();
+            if (name == "NormalMap" || name == "SpecularMap" || name == "EmissionMap") {
+                TexturePtr texture = Texture::PlaceHolder();
+                if (strcmp(value, "$DEFAULT_WHITE") == 0) {
+                    texture = Texture::DefaultWhite();
+                } else if (strcmp(value, "$DEFAULT_BLACK") == 0) {
+                    texture = Texture::DefaultBlack();
+                } else if (strcmp(value, "$DEFAULT_GRAY") == 0 || strcmp(value, "$DEFAULT_GREY") == 0) {
+                    texture = Texture::DefaultGray();
+                } else if (strcmp(value, "$DEFAULT_NORMAL") == 0) {
+                    texture = Texture::DefaultNormal();
+                }
+                params.emplace(child.name(), texture);
+            } else if (name == "UseColorTintMask" || name == "AlphaScissor") {
+                if (const auto flag = ParseParameterValue(ShaderUniformType::Bool, value); flag.has_value()) {
+                    params.emplace(child.name(), flag.value());
+                }
+            }
+        }
+        return Material::SelectVariant(params);
+    }
+
     Result<MaterialPtr> Material::ParseXml(const String& source_asset_path, const String& xml_src, const AssetLoaderFlags::Type flags) {
         pugi::xml_document doc;
         if (const auto result = doc.load_string(xml_src.as_cstr()); result.status != pugi::status_ok) {
@@ -1184,21 +535,8 @@ namespace fow {
             return Failure(std::format("Failed to load material \"{}\": Expected attribute 'shader' in root node 'Material'!", source));
         }
 
-        const auto shader_sources_result = ShaderLib::GetSourcesForShader(shader_attrib.value());
-        if (!shader_sources_result.has_value()) {
-            return Failure(std::format("Failed to load material \"{}\": Could not find shader \"{}\"\n{}", source, shader_attrib.value(), shader_sources_result.error().message));
-        }
-
-        const auto vert_result = ShaderLib::GetSource(shader_sources_result.value().vertex);
-        if (!vert_result.has_value()) {
-            return Failure(std::format("Failed to load material \"{}\": Could not find shader source for vertex shader \"{}\": {}", source, shader_sources_result.value().vertex, vert_result.error().message));
-        }
-        const auto frag_result = ShaderLib::GetSource(shader_sources_result.value().fragment);
-        if (!frag_result.has_value()) {
-            return Failure(std::format("Failed to load material \"{}\": Could not find shader source for fragment shader \"{}\": {}", source, shader_sources_result.value().fragment, frag_result.error().message));
-        }
-
-        const auto shader_result = Shader::Compile(shader_attrib.value(), vert_result.value(), frag_result.value());
+        const auto params_node = root.child("Parameters");
+        const auto shader_result = Shader::CompileVariant(shader_attrib.value(), SelectXmlVariant(params_node));
         if (!shader_result.has_value()) {
             return Failure(std::format("Failed to load material \"{}\": Failed to load shader \"{}\":\n{}", source, shader_attrib.value(), shader_result.error().message));
         }
@@ -1210,165 +548,11 @@ namespace fow {
         auto backface_culling_node = root.child("BackfaceCulling");
         auto depth_test_node       = root.child("DepthTest");
 
-        if (auto params_node = root.child("Parameters")) {
+        if (params_node) {
             for (const auto& child : params_node.children()) {
                 if (const char* param_name = child.name(); param_name != nullptr) {
-                    if (const auto uniform_info = shader->get_uniform_info(child.name()); uniform_info.has_value()) {
+                    if (const auto* uniform_info = shader->find_uniform(param_name); uniform_info != nullptr) {
                         switch (uniform_info->type) {
-                            case ShaderUniformType::Bool: {
-                                if (const auto result = StringToBool(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::BoolVector2: {
-                                if (const auto result = StringToBVec2(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::BoolVector3: {
-                                if (const auto result = StringToBVec3(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::Int: {
-                                if (const auto result = StringToInt<GLint>(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::IntVector2: {
-                                if (const auto result = StringToIVec2(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::IntVector3: {
-                                if (const auto result = StringToIVec3(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::IntVector4: {
-                                if (const auto result = StringToIVec4(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::UInt: {
-                                if (const auto result = StringToInt<GLuint>(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::UIntVector2: {
-                                if (const auto result = StringToUVec2(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::UIntVector3: {
-                                if (const auto result = StringToUVec3(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::UIntVector4: {
-                                if (const auto result = StringToUVec4(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::Float: {
-                                if (const auto result = StringToFloat<GLfloat>(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::FloatVector2: {
-                                if (const auto result = StringToVec2(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::FloatVector3: {
-                                if (const auto result = StringToVec3(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::FloatVector4: {
-                                if (const auto value = String(child.child_value()).clone_trimmed(); value.starts_with('#')) {
-                                    if (const auto result = StringToInt<uint32_t>(value); result.has_value()) {
-                                        const uint32_t rgba = result.value();
-                                        params.emplace(child.name(), Vector4 {
-                                                           ((rgba >> 24) & 0xFF) / 255.0f,
-                                                           ((rgba >> 16) & 0xFF) / 255.0f,
-                                                           ((rgba >> 8 ) & 0xFF) / 255.0f,
-                                                           (rgba & 0xFF)         / 255.0f
-                                                       });
-                                    } else {
-                                        Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                    }
-                                } else {
-                                    if (const auto result = StringToVec4(value); result.has_value()) {
-                                        params.emplace(child.name(), result.value());
-                                    } else {
-                                        Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                    }
-                                }
-                            } break;
-                            case ShaderUniformType::Double: {
-                                if (const auto result = StringToFloat<GLdouble>(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::DoubleVector2: {
-                                if (const auto result = StringToDVec2(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::DoubleVector3: {
-                                if (const auto result = StringToDVec3(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::DoubleVector4: {
-                                if (const auto result = StringToDVec4(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
-                            case ShaderUniformType::Matrix4: {
-                                if (const auto result = StringToMat4(child.child_value()); result.has_value()) {
-                                    params.emplace(child.name(), result.value());
-                                } else {
-                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Failed to parse data: \"{}\"!", child.name(), source, uniform_info->type, result.error().message));
-                                }
-                            } break;
                             case ShaderUniformType::Sampler2D: {
                                 const char* texture_path = child.child_value();
                                 if (strcmp(texture_path, "$DEFAULT_WHITE") == 0) {
@@ -1436,10 +620,14 @@ namespace fow {
                                 }
                             } break;
                             default: {
-                                Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": Uniform type \"{}\" is not supported!", child.name(), source, uniform_info->type));
+                                if (const auto result = ParseParameterValue(uniform_info->type, child.child_value()); result.has_value()) {
+                                    params.emplace(child.name(), result.value());
+                                } else {
+                                    Debug::LogError(std::format("Ignoring parameter \"{}\" in material \"{}\": {}", child.name(), source, result.error().message));
+                                }
                             } break;
                         }
-                    } else {
+                    } else if (!IsFeatureParameter(param_name)) {
                         Debug::LogWarning(std::format("Ignoring parameter \"{}\" in material \"{}\": Shader \"{}\" has no such uniform!", child.name(), source, shader_attrib.value()));
                     }
                 } else {
@@ -1486,44 +674,47 @@ namespace fow {
     }
 
     Result<MaterialPtr> Material::New(const String& shader_name, const HashMap<String, MaterialParameterValue>& params) {
-        auto shader = Shader::FromCache(shader_name);
-        if (shader == nullptr) {
-            const auto source_paths = ShaderLib::GetSourcesForShader(shader_name);
-            if (!source_paths.has_value()) {
-                return Failure(std::format("Failed to create material: Sources for shader \"{}\" not found!", shader_name));
-            }
-
-            const auto vertex_src = ShaderLib::GetSource(source_paths->vertex);
-            if (!vertex_src.has_value()) {
-                return Failure(std::format("Failed to create material: Failed to load vertex shader \"{}\"!", source_paths->vertex));
-            }
-
-            const auto fragment_src = ShaderLib::GetSource(source_paths->fragment);
-            if (!fragment_src.has_value()) {
-                return Failure(std::format("Failed to create material: Failed to load fragment shader \"{}\"!", source_paths->fragment));
-            }
+        const auto shader = Shader::CompileVariant(shader_name, SelectVariant(params));
+        if (!shader.has_value()) {
+            return Failure(std::format("Failed to create material with shader \"{}\": {}", shader_name, shader.error().message));
+        }
+        return Success<MaterialPtr>(std::make_shared<Material>(shader.value(), VariantParameters(shader.value(), params)));
+    }
 
-            if (const auto result = Shader::Compile(shader_name, vertex_src.value(), fragment_src.value()); result.has_value()) {
-                shader = result.value();
-            } else {
-                return Failure(std::format("Failed to create material with shader \"{}\": {}", shader_name, result.error().message));
-            }
+    ShaderVariantKey Material::SelectVariant(const HashMap<String, MaterialParameterValue>& params) {
+        ShaderVariantKey key = ShaderFeatures::None;
+        if (HasTextureParameter(params, "NormalMap", &Texture::DefaultNormal)) {
+            key |= ShaderFeatures::NormalMap;
+        }
+        if (HasTextureParameter(params, "SpecularMap", &Texture::DefaultWhite)) {
+            key |= ShaderFeatures::SpecularMap;
+        }
+        if (HasTextureParameter(params, "EmissionMap", &Texture::DefaultBlack)) {
+            key |= ShaderFeatures::EmissionMap;
+        }
+        if (HasFlagParameter(params, "UseColorTintMask")) {
+            key |= ShaderFeatures::ColorTintMask;
+        }
+        if (HasFlagParameter(params, "AlphaScissor")) {
+            key |= ShaderFeatures::AlphaScissor;
         }
-        return Success<MaterialPtr>(std::make_shared<Material>(shader, params));
+        return key;
     }
 
     Material Material::make_unique() const {
         return std::move(Material(*this));
     }
     Material Material::make_unique(const HashMap<String, MaterialParameterValue>& params) const {
-        return std::move(Material(m_pShader, params));
+        const auto shader = ShaderForParameters(m_pShader, params);
+        return std::move(Material(shader, VariantParameters(shader, params)));
     }
 
     MaterialPtr Material::make_unique_ptr() const {
         return std::make_shared<Material>(*this);
     }
     MaterialPtr Material::make_unique_ptr(const HashMap<String, MaterialParameterValue>& params) const {
-        return std::make_shared<Material>(m_pShader, params);
+        const auto shader = ShaderForParameters(m_pShader, params);
+        return std::make_shared<Material>(shader, VariantParameters(shader, params));
     }
 
     const Material Material::Null = { };
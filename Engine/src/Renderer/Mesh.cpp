@@ -1,5 +1,6 @@
 #include "fow/Renderer/GL.hpp"
 #include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
 #include "fow/Renderer.hpp"
 
 namespace fow {
@@ -28,8 +29,15 @@ namespace fow {
     }
 
     Mesh::~Mesh() {
-        if (m_bInitialized) {
+        release();
+    }
+    void Mesh::release() {
+        if (m_pArena != nullptr) {
+            m_pArena->free(m_uArenaHandle);
+            m_pArena = nullptr;
+        } else if (m_bInitialized) {
             if (m_uVao != 0) {
+                GlStateCache::Instance().forget_vertex_array(m_uVao);
                 glDeleteVertexArrays(1, &m_uVao);
             }
             if (m_uVbo != 0) {
@@ -40,23 +48,58 @@ namespace fow {
             }
         }
     }
+    void Mesh::make_resident(MeshArena& arena, const MeshArenaHandle handle) {
+        m_pArena = &arena;
+        m_uArenaHandle = handle;
+    }
 
     void Mesh::update_data(const Vector<Vertex>& vertices, const Vector<GLuint>& indices) {
-        glBindVertexArray(m_uVao);
+        if (m_pArena != nullptr) {
+            const auto& allocation = m_pArena->allocation(m_uArenaHandle);
+            if (allocation.vertex_count != vertices.size() || allocation.index_count != indices.size()) {
+                m_pArena->free(m_uArenaHandle);
+                const auto handle = m_pArena->allocate(static_cast<uint32_t>(vertices.size()), static_cast<uint32_t>(indices.size()));
+                if (!handle.has_value()) {
+                    Debug::LogError(handle.error().message);
+                    m_pArena = nullptr;
+                    return;
+                }
+                m_uArenaHandle = handle.value();
+            }
+            if (m_layout == VertexLayout::Full) {
+                m_pArena->write(m_uArenaHandle, vertices.data(), indices.data());
+            } else {
+                const auto data = m_layout.encode(vertices, m_quantization, false);
+                m_pArena->write(m_uArenaHandle, data.data(), indices.data());
+            }
+            m_iIndexCount = indices.size();
+            m_lods = { MeshLod { 0, m_iIndexCount, 0.0f } };
+            m_bounds = BoundingSphere::FromVertices(vertices);
+            return;
+        }
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data());
+        if (m_layout == VertexLayout::Full) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data());
+        } else {
+            // Keeps the quantization the mesh was created with, the uniforms of existing draws stay valid.
+            const auto data = m_layout.encode(vertices, m_quantization, false);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(data.size()), data.data());
+        }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uEbo);
         glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data());
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
         m_iIndexCount = indices.size();
+        m_lods = { MeshLod { 0, m_iIndexCount, 0.0f } };
+        m_bounds = BoundingSphere::FromVertices(vertices);
     }
     void Mesh::update_data_2d(const Vector<Vertex2D>& vertices, const Vector<GLuint>& indices) {
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
         glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex2D)), vertices.data());
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uEbo);
         glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data());
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
         m_iIndexCount = indices.size();
     }
 
@@ -65,49 +108,83 @@ namespace fow {
     }
 
     Result<MeshPtr> Mesh::Create(const MaterialPtr& material, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const MeshPrimitive primitive, MeshDrawMode draw_mode) {
+        return Create(material, vertices, indices, VertexLayout::Full, primitive, draw_mode);
+    }
+    Result<MeshPtr> Mesh::Create(const MaterialPtr& material, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const VertexLayout& layout, const MeshPrimitive primitive, MeshDrawMode draw_mode) {
+        return CreateWithIndexRanges(material, vertices, indices, { }, layout, primitive, draw_mode);
+    }
+    Result<MeshPtr> Mesh::CreateWithLods(const MaterialPtr& material, const std::vector<Vertex>& vertices, const Vector<MeshLodLevel>& lods, const VertexLayout& layout, const MeshPrimitive primitive, MeshDrawMode draw_mode) {
+        // All levels share the vertex buffer and are stored back to back in the element buffer.
+        Vector<GLuint> indices;
+        Vector<MeshLod> ranges;
+        ranges.reserve(lods.size());
+        for (const auto& level : lods) {
+            ranges.push_back(MeshLod { static_cast<GLuint>(indices.size()), static_cast<GLsizei>(level.indices.size()), level.error });
+            indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+        }
+        return CreateWithIndexRanges(material, vertices, indices, ranges, layout, primitive, draw_mode);
+    }
+    Result<MeshPtr> Mesh::CreateWithIndexRanges(const MaterialPtr& material, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices, const Vector<MeshLod>& lods,
+                                                const VertexLayout& layout, const MeshPrimitive primitive, MeshDrawMode draw_mode) {
+        VertexQuantization quantization;
+        if (layout == VertexLayout::Full) {
+            return CreateFromEncoded(material, layout, quantization, vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(), static_cast<uint32_t>(indices.size()),
+                                     lods, BoundingSphere::FromVertices(vertices), primitive, draw_mode);
+        }
+        const auto encoded = layout.encode(vertices, quantization);
+        return CreateFromEncoded(material, layout, quantization, encoded.data(), static_cast<uint32_t>(vertices.size()), indices.data(), static_cast<uint32_t>(indices.size()),
+                                 lods, BoundingSphere::FromVertices(vertices), primitive, draw_mode);
+    }
+    Result<MeshPtr> Mesh::CreateFromEncoded(const MaterialPtr& material, const VertexLayout& layout, const VertexQuantization& quantization, const void* vertex_data, const uint32_t vertex_count,
+                                            const GLuint* indices, const uint32_t index_total, const Vector<MeshLod>& lods, const BoundingSphere& bounds, const MeshPrimitive primitive, MeshDrawMode draw_mode) {
+        const auto index_count = lods.empty() ? static_cast<GLsizei>(index_total) : lods.front().index_count;
+
+        // Static meshes live in the shared arena of their layout, dynamic ones keep their own buffers so updates stay cheap.
+        if (draw_mode == MeshDrawMode::StaticDraw) {
+            auto& arena = MeshArena::Get(layout);
+            const auto handle = arena.allocate(vertex_count, index_total);
+            if (!handle.has_value()) {
+                return Failure(handle.error());
+            }
+            arena.write(handle.value(), vertex_data, indices);
+            return Success<MeshPtr>(std::move(std::make_shared<Mesh>(std::move(Mesh {
+                arena, handle.value(), index_count, material, primitive, quantization, lods, bounds
+            }))));
+        }
+
         GLuint vao, vbo, ebo;
         glGenVertexArrays(1, &vao);
         if (vao == 0) {
             return Failure(std::format("Failed to generate vertex array handle: GL error {}", glGetError()));
         }
-        glBindVertexArray(vao);
+        GlStateCache::Instance().bind_vertex_array(vao);
 
         glGenBuffers(1, &vbo);
         if (vbo == 0) {
+            GlStateCache::Instance().forget_vertex_array(vao);
             glDeleteVertexArrays(1, &vao);
             return Failure(std::format("Failed to generate vertex buffer object handle: GL error {}", glGetError()));
         }
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), static_cast<GLenum>(draw_mode));
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_count) * layout.stride(), vertex_data, static_cast<GLenum>(draw_mode));
 
         glGenBuffers(1, &ebo);
         if (ebo == 0) {
+            GlStateCache::Instance().forget_vertex_array(vao);
             glDeleteVertexArrays(1, &vao);
             glDeleteBuffers(1, &vbo);
             return Failure(std::format("Failed to generate element buffer object handle: GL error {}", glGetError()));
         }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(), static_cast<GLenum>(draw_mode));
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_total * sizeof(GLuint)), indices, static_cast<GLenum>(draw_mode));
 
-        // Position
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(0));
-        glEnableVertexAttribArray(0);
-        // Normal
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        // Tangent
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-        // Bitangent
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(9 * sizeof(float)));
-        glEnableVertexAttribArray(3);
-        // UV
-        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(12 * sizeof(float)));
-        glEnableVertexAttribArray(4);
+        layout.setup_attributes();
 
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
 
-        return Success<MeshPtr>(std::move(std::make_shared<Mesh>(std::move(Mesh { vao, vbo, ebo, static_cast<GLsizei>(indices.size()), material, primitive }))));
+        return Success<MeshPtr>(std::move(std::make_shared<Mesh>(std::move(Mesh {
+            vao, vbo, ebo, index_count, material, primitive, layout, quantization, lods, bounds
+        }))));
     }
 
     Result<MeshPtr> Mesh::Create2D(const MaterialPtr& material, const std::vector<Vertex2D>& vertices, const std::vector<GLuint>& indices, const MeshPrimitive primitive, MeshDrawMode draw_mode) {
@@ -116,18 +193,20 @@ namespace fow {
         if (vao == 0) {
             return Failure(std::format("Failed to generate vertex array handle: GL error {}", glGetError()));
         }
-        glBindVertexArray(vao);
+        GlStateCache::Instance().bind_vertex_array(vao);
 
         glGenBuffers(1, &vbo);
         if (vbo == 0) {
+            GlStateCache::Instance().forget_vertex_array(vao);
             glDeleteVertexArrays(1, &vao);
             return Failure(std::format("Failed to generate vertex buffer object handle: GL error {}", glGetError()));
         }
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data(), static_cast<GLenum>(draw_mode));
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex2D)), vertices.data(), static_cast<GLenum>(draw_mode));
 
         glGenBuffers(1, &ebo);
         if (ebo == 0) {
+            GlStateCache::Instance().forget_vertex_array(vao);
             glDeleteVertexArrays(1, &vao);
             glDeleteBuffers(1, &vbo);
             return Failure(std::format("Failed to generate element buffer object handle: GL error {}", glGetError()));
@@ -142,7 +221,7 @@ namespace fow {
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), reinterpret_cast<void*>(2 * sizeof(float)));
         glEnableVertexAttribArray(1);
 
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
 
         return Success<MeshPtr>(std::move(std::make_shared<Mesh>(std::move(Mesh { vao, vbo, ebo, static_cast<GLsizei>(indices.size()), material, primitive }))));
     }
@@ -193,28 +272,46 @@ namespace fow {
 
     const Mesh Mesh::Null = Mesh { };
 
-    static void MeshDraw(const GLuint vao, const GLsizei index_count, const MaterialPtr& material, const Matrix4& model_matrix) {
+    static void ApplyVertexFormat(const ShaderPtr& shader, const Mesh& mesh) {
+        // Program uniforms persist between draws, so these are set even for the full layout.
+        FOW_DISCARD(shader->set_uniform("VERTEX_FORMAT", mesh.layout().shader_flags()));
+        FOW_DISCARD(shader->set_uniform("VERTEX_POSITION_SCALE", mesh.quantization().scale));
+        FOW_DISCARD(shader->set_uniform("VERTEX_POSITION_OFFSET", mesh.quantization().offset));
+        FOW_DISCARD(shader->set_uniform("MULTI_DRAW", false));
+    }
+
+    static void MeshDraw(const Mesh& mesh, const size_t lod_index, const MaterialPtr& material, const Matrix4& model_matrix) {
+        if (!mesh.is_resident()) {
+            return;
+        }
         if (material != nullptr && material->is_valid()) {
+            RenderQueue::ApplyCurrentSceneParamsToMaterial(material);
             Debug::Assert(material->apply());
             Debug::Assert(material->shader()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix()), "Error while applying uniform \"MATRIX_PROJECTION\"");
             Debug::Assert(material->shader()->set_uniform("MATRIX_VIEW", Renderer::GetViewMatrix()), "Error while applying uniform \"MATRIX_VIEW\"");
+            ApplyVertexFormat(material->shader(), mesh);
             Debug::Assert(material->shader()->set_uniform("MATRIX_MODEL[0]", model_matrix), "Error while applying uniform \"MATRIX_MODEL\"");
         } else {
             Shader::PlaceHolder()->use();
             Debug::Assert(Shader::PlaceHolder()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix()), "Error while applying uniform \"MATRIX_PROJECTION\"");
             Debug::Assert(Shader::PlaceHolder()->set_uniform("MATRIX_VIEW", Renderer::GetViewMatrix()), "Error while applying uniform \"MATRIX_VIEW\"");
+            ApplyVertexFormat(Shader::PlaceHolder(), mesh);
             Debug::Assert(Shader::PlaceHolder()->set_uniform("MATRIX_MODEL[0]", model_matrix), "Error while applying uniform \"MATRIX_MODEL\"");
         }
-        RenderQueue::ApplyCurrentSceneParamsToMaterial(material);
-        glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
+        const auto lod = mesh.lod(lod_index);
+        GlStateCache::Instance().bind_vertex_array(mesh.vao());
+        glDrawElementsBaseVertex(GL_TRIANGLES, lod.index_count, GL_UNSIGNED_INT, reinterpret_cast<void*>((mesh.first_index() + lod.index_offset) * sizeof(GLuint)), mesh.base_vertex());
     }
-    static void MeshDrawInstances(const GLuint vao, const GLsizei index_count, const MaterialPtr& material, const Vector<Transform>& transforms) {
+    static void MeshDrawInstances(const Mesh& mesh, const MaterialPtr& material, const Vector<Transform>& transforms) {
+        if (!mesh.is_resident()) {
+            return;
+        }
         if (material != nullptr && material->is_valid()) {
+            RenderQueue::ApplyCurrentSceneParamsToMaterial(material);
             Debug::Assert(material->apply());
             Debug::Assert(material->shader()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix()), "Error while applying uniform \"MATRIX_PROJECTION\"");
             Debug::Assert(material->shader()->set_uniform("MATRIX_VIEW", Renderer::GetViewMatrix()), "Error while applying uniform \"MATRIX_VIEW\"");
+            ApplyVertexFormat(material->shader(), mesh);
             auto i = 0;
             for (const auto& transform : transforms) {
                 Debug::Assert(material->shader()->set_uniform(
@@ -228,6 +325,7 @@ namespace fow {
             Shader::PlaceHolder()->use();
             Debug::Assert(Shader::PlaceHolder()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix()), "Error while applying uniform \"MATRIX_PROJECTION\"");
             Debug::Assert(Shader::PlaceHolder()->set_uniform("MATRIX_VIEW", Renderer::GetViewMatrix()), "Error while applying uniform \"MATRIX_VIEW\"");
+            ApplyVertexFormat(Shader::PlaceHolder(), mesh);
             auto i = 0;
             for (const auto& transform : transforms) {
                 Debug::Assert(Shader::PlaceHolder()->set_uniform(
@@ -239,9 +337,15 @@ namespace fow {
             }
         }
 
-        glBindVertexArray(vao);
-        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(transforms.size()));
-        glBindVertexArray(0);
+        // The finest level any of the instances needs.
+        size_t lod_index = SIZE_MAX;
+        for (const auto& transform : transforms) {
+            lod_index = std::min(lod_index, mesh.select_lod(transform.matrix()));
+        }
+        const auto lod = mesh.lod(lod_index);
+        GlStateCache::Instance().bind_vertex_array(mesh.vao());
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.index_count, GL_UNSIGNED_INT, reinterpret_cast<void*>((mesh.first_index() + lod.index_offset) * sizeof(GLuint)),
+                                          static_cast<GLsizei>(transforms.size()), mesh.base_vertex());
     }
 
     static void MeshDraw2D(const GLuint vao, const GLsizei index_count, const MaterialPtr& material, const Rectangle& rect) {
@@ -256,9 +360,8 @@ namespace fow {
             Debug::Assert(Shader::PlaceHolder()->set_uniform("AreaPosition", rect.position()), "Error while applying uniform \"AreaPosition\"");
             Debug::Assert(Shader::PlaceHolder()->set_uniform("AreaSize", rect.size()), "Error while applying uniform \"AreaSize\"");
         }
-        glBindVertexArray(vao);
+        GlStateCache::Instance().bind_vertex_array(vao);
         glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
     }
 
     void Mesh::draw() const {
@@ -268,8 +371,22 @@ namespace fow {
         draw(transform.matrix());
     }
 
+    MeshLod Mesh::lod(const size_t index) const {
+        if (index < m_lods.size()) {
+            return m_lods[index];
+        }
+        return m_lods.empty() ? MeshLod { 0, m_iIndexCount, 0.0f } : m_lods.front();
+    }
+    size_t Mesh::select_lod(const Matrix4& model_matrix, const size_t current) const {
+        if (m_lods.size() <= 1) {
+            return 0;
+        }
+        const float projected_radius = ProjectSphereRadius(m_bounds.transformed(model_matrix), Renderer::GetViewMatrix(), Renderer::GetProjectionMatrix(), Renderer::GetViewport().height);
+        return SelectMeshLod(m_lods, projected_radius, current);
+    }
+
     void Mesh::draw(const Matrix4& model_matrix) const {
-        MeshDraw(m_uVao, m_iIndexCount, m_pMaterial, model_matrix);
+        MeshDraw(*this, select_lod(model_matrix), m_pMaterial, model_matrix);
     }
     void Mesh::draw(const MaterialPtr& override_material) const {
         draw(override_material, Matrix4Constants::Identity);
@@ -278,36 +395,52 @@ namespace fow {
         draw(override_material, transform.matrix());
     }
     void Mesh::draw(const MaterialPtr& override_material, const Matrix4& model_matrix) const {
-        MeshDraw(m_uVao, m_iIndexCount, override_material, model_matrix);
+        MeshDraw(*this, select_lod(model_matrix), override_material, model_matrix);
+    }
+    void Mesh::draw_lod(const size_t lod, const Matrix4& model_matrix) const {
+        MeshDraw(*this, lod, m_pMaterial, model_matrix);
+    }
+    void Mesh::draw_lod(const size_t lod, const MaterialPtr& override_material, const Matrix4& model_matrix) const {
+        MeshDraw(*this, lod, override_material, model_matrix);
+    }
+
+    bool Mesh::enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const {
+        if (!supports_multi_draw(m_pMaterial)) {
+            return false;
+        }
+        const auto model_matrix = transform.matrix();
+        builder.add(draw_item(select_lod(model_matrix), m_pMaterial, model_matrix));
+        return true;
+    }
+    bool Mesh::supports_multi_draw(const MaterialPtr& material) const {
+        // Only arena meshes share a vertex array, and only shaders that read the per-draw storage buffer can be used.
+        // Batches are drawn before the direct draws, transparent meshes stay direct so they blend over them in queue order.
+        return m_pArena != nullptr && material != nullptr && material->is_valid() && material->get_opaque() &&
+               material->shader()->has_uniform("MULTI_DRAW");
+    }
+    DrawItem Mesh::draw_item(const size_t lod_index, const MaterialPtr& material, const Matrix4& model_matrix) const {
+        const auto lod = this->lod(lod_index);
+        return DrawItem { material, m_pArena, first_index() + lod.index_offset, lod.index_count, base_vertex(), m_quantization, model_matrix };
     }
 
     void Mesh::draw_instances(const Vector<Transform>& transforms) const {
-        MeshDrawInstances(m_uVao, m_iIndexCount, m_pMaterial, transforms);
+        MeshDrawInstances(*this, m_pMaterial, transforms);
     }
     void Mesh::draw_instances(const MaterialPtr& override_material, const Vector<Transform>& transforms) const {
-        MeshDrawInstances(m_uVao, m_iIndexCount, override_material, transforms);
+        MeshDrawInstances(*this, override_material, transforms);
     }
 
     void Mesh::draw_2d(const Rectangle& rect) const {
-        MeshDraw2D(m_uVao, m_iIndexCount, m_pMaterial, rect);
+        MeshDraw2D(vao(), m_iIndexCount, m_pMaterial, rect);
     }
     void Mesh::draw_2d(const Rectangle& rect, const MaterialPtr& override_material) const {
-        MeshDraw2D(m_uVao, m_iIndexCount, override_material, rect);
+        MeshDraw2D(vao(), m_iIndexCount, override_material, rect);
     }
 
     void MeshBuilder::append(const Vertex& vertex) {
-        const auto it = std::ranges::find_if(m_vertices, [&vertex](const auto& v) {
-            return v.position == vertex.position && v.normal == vertex.normal && v.uv == vertex.uv;
-        });
-
-        if (it != m_vertices.end()) {
-            m_indices.emplace_back(std::distance(m_vertices.begin(), it));
-        } else {
-            m_indices.emplace_back(m_vertices.size());
-            m_vertices.emplace_back(vertex);
-        }
+        m_indices.emplace_back(m_welder.add(m_vertices, vertex));
     }
-    Result<MeshPtr> MeshBuilder::create_mesh(const MeshDrawMode draw_mode) const {
-        return Mesh::Create(m_pMaterial, m_vertices, m_indices, m_ePrimitive, draw_mode);
+    Result<MeshPtr> MeshBuilder::create_mesh(const MeshDrawMode draw_mode, const VertexLayout& layout) const {
+        return Mesh::Create(m_pMaterial, m_vertices, m_indices, layout, m_ePrimitive, draw_mode);
     }
 }
@@ -0,0 +1,292 @@
+#include "fow/Renderer/MeshArena.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+
+#include <algorithm>
+
+namespace fow {
+    RangeAllocator::RangeAllocator(const uint32_t capacity) : m_uCapacity(capacity) {
+        if (capacity > 0) {
+            m_free.push_back(Block { 0, capacity });
+        }
+    }
+
+    Option<uint32_t> RangeAllocator::allocate(const uint32_t size) {
+        if (size == 0) {
+            return 0u;
+        }
+        for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+            if (it->size < size) {
+                continue;
+            }
+            const uint32_t offset = it->offset;
+            it->offset += size;
+            it->size -= size;
+            if (it->size == 0) {
+                m_free.erase(it);
+            }
+            return offset;
+        }
+        return std::nullopt;
+    }
+
+    void RangeAllocator::free(const uint32_t offset, const uint32_t size) {
+        if (size == 0) {
+            return;
+        }
+        auto it = std::ranges::lower_bound(m_free, offset, { }, &Block::offset);
+        it = m_free.insert(it, Block { offset, size });
+        if (const auto next = it + 1; next != m_free.end() && it->offset + it->size == next->offset) {
+            it->size += next->size;
+            m_free.erase(next);
+        }
+        if (it != m_free.begin()) {
+            if (const auto prev = it - 1; prev->offset + prev->size == it->offset) {
+                prev->size += it->size;
+                m_free.erase(it);
+            }
+        }
+    }
+
+    void RangeAllocator::grow(const uint32_t capacity) {
+        if (capacity <= m_uCapacity) {
+            return;
+        }
+        if (!m_free.empty() && m_free.back().offset + m_free.back().size == m_uCapacity) {
+            m_free.back().size += capacity - m_uCapacity;
+        } else {
+            m_free.push_back(Block { m_uCapacity, capacity - m_uCapacity });
+        }
+        m_uCapacity = capacity;
+    }
+
+    void RangeAllocator::reset(const uint32_t capacity, const uint32_t used) {
+        m_uCapacity = capacity;
+        m_free.clear();
+        if (used < capacity) {
+            m_free.push_back(Block { used, capacity - used });
+        }
+    }
+
+    uint32_t RangeAllocator::free_size() const {
+        uint32_t size = 0;
+        for (const auto& block : m_free) {
+            size += block.size;
+        }
+        return size;
+    }
+    uint32_t RangeAllocator::largest_free_block() const {
+        uint32_t size = 0;
+        for (const auto& block : m_free) {
+            size = std::max(size, block.size);
+        }
+        return size;
+    }
+
+    MeshArena::MeshArena(const VertexLayout& layout, const uint32_t vertex_capacity, const uint32_t index_capacity) :
+        m_layout(layout), m_uVao(0), m_uVbo(0), m_uEbo(0), m_vertices(vertex_capacity), m_indices(index_capacity) { }
+
+    MeshArena::~MeshArena() {
+        release();
+    }
+
+    Result<> MeshArena::create_buffers(const uint32_t vertex_capacity, const uint32_t index_capacity) {
+        glGenVertexArrays(1, &m_uVao);
+        if (m_uVao == 0) {
+            return Failure(std::format("Failed to generate vertex array handle: GL error {}", glGetError()));
+        }
+        glGenBuffers(1, &m_uVbo);
+        glGenBuffers(1, &m_uEbo);
+        if (m_uVbo == 0 || m_uEbo == 0) {
+            const auto error = glGetError();
+            release();
+            return Failure(std::format("Failed to generate mesh arena buffers: GL error {}", error));
+        }
+
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_capacity) * m_layout.stride(), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uEbo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_capacity) * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+        m_layout.setup_attributes();
+        GlStateCache::Instance().bind_vertex_array(0);
+        return Success();
+    }
+
+    void MeshArena::resize_buffers(const uint32_t vertex_capacity, const uint32_t index_capacity, const bool compact) {
+        GLuint buffers[2];
+        glGenBuffers(2, buffers);
+        const GLsizeiptr stride = m_layout.stride();
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(vertex_capacity) * stride, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(index_capacity) * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+
+        // Live allocations are copied in their current order, compacting closes the gaps between them.
+        Vector<MeshArenaAllocation*> live;
+        for (auto& allocation : m_allocations) {
+            if (allocation.live) {
+                live.push_back(&allocation);
+            }
+        }
+        std::ranges::sort(live, { }, [](const MeshArenaAllocation* allocation) { return allocation->base_vertex; });
+        uint32_t vertex_end = 0;
+        for (auto* allocation : live) {
+            const uint32_t base_vertex = compact ? vertex_end : allocation->base_vertex;
+            glBindBuffer(GL_COPY_READ_BUFFER, m_uVbo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->base_vertex * stride, base_vertex * stride, allocation->vertex_count * stride);
+            allocation->base_vertex = base_vertex;
+            vertex_end = std::max(vertex_end, base_vertex + allocation->vertex_count);
+        }
+        std::ranges::sort(live, { }, [](const MeshArenaAllocation* allocation) { return allocation->first_index; });
+        uint32_t index_end = 0;
+        for (auto* allocation : live) {
+            const uint32_t first_index = compact ? index_end : allocation->first_index;
+            glBindBuffer(GL_COPY_READ_BUFFER, m_uEbo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->first_index * sizeof(GLuint), first_index * sizeof(GLuint), allocation->index_count * sizeof(GLuint));
+            allocation->first_index = first_index;
+            index_end = std::max(index_end, first_index + allocation->index_count);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &m_uVbo);
+        glDeleteBuffers(1, &m_uEbo);
+        m_uVbo = buffers[0];
+        m_uEbo = buffers[1];
+
+        // The vertex array references the buffers, point it to the new ones.
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+        m_layout.setup_attributes();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uEbo);
+        GlStateCache::Instance().bind_vertex_array(0);
+
+        if (compact) {
+            m_vertices.reset(vertex_capacity, vertex_end);
+            m_indices.reset(index_capacity, index_end);
+        } else {
+            m_vertices.grow(vertex_capacity);
+            m_indices.grow(index_capacity);
+        }
+    }
+
+    Result<MeshArenaHandle> MeshArena::allocate(const uint32_t vertex_count, const uint32_t index_count) {
+        if (m_uVao == 0) {
+            if (const auto result = create_buffers(m_vertices.capacity(), m_indices.capacity()); !result.has_value()) {
+                return Failure(result.error());
+            }
+        }
+
+        auto vertex_offset = m_vertices.allocate(vertex_count);
+        auto index_offset = m_indices.allocate(index_count);
+        if (!vertex_offset.has_value() || !index_offset.has_value()) {
+            if (vertex_offset.has_value()) {
+                m_vertices.free(vertex_offset.value(), vertex_count);
+            }
+            if (index_offset.has_value()) {
+                m_indices.free(index_offset.value(), index_count);
+            }
+            // Compacting is enough when the free space is only fragmented, otherwise the buffers grow as well.
+            uint32_t vertex_capacity = m_vertices.capacity();
+            if (m_vertices.free_size() < vertex_count) {
+                vertex_capacity = std::max(vertex_capacity * 2, vertex_capacity - m_vertices.free_size() + vertex_count);
+            }
+            uint32_t index_capacity = m_indices.capacity();
+            if (m_indices.free_size() < index_count) {
+                index_capacity = std::max(index_capacity * 2, index_capacity - m_indices.free_size() + index_count);
+            }
+            resize_buffers(vertex_capacity, index_capacity, true);
+
+            vertex_offset = m_vertices.allocate(vertex_count);
+            index_offset = m_indices.allocate(index_count);
+            if (!vertex_offset.has_value() || !index_offset.has_value()) {
+                return Failure(std::format("Failed to allocate {} vertices and {} indices in mesh arena", vertex_count, index_count));
+            }
+        }
+
+        const auto allocation = MeshArenaAllocation { vertex_offset.value(), vertex_count, index_offset.value(), index_count, true };
+        if (!m_free_handles.empty()) {
+            const auto handle = m_free_handles.back();
+            m_free_handles.pop_back();
+            m_allocations[handle] = allocation;
+            return handle;
+        }
+        m_allocations.push_back(allocation);
+        return static_cast<MeshArenaHandle>(m_allocations.size() - 1);
+    }
+
+    void MeshArena::write(const MeshArenaHandle handle, const void* vertex_data, const GLuint* indices) const {
+        const auto& allocation = m_allocations[handle];
+        const GLsizeiptr stride = m_layout.stride();
+        // The copy target does not touch the element buffer binding of the currently bound vertex array.
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_uVbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.base_vertex * stride, allocation.vertex_count * stride, vertex_data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_uEbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.first_index * sizeof(GLuint), allocation.index_count * sizeof(GLuint), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    void MeshArena::copy(const MeshArenaHandle handle, const GLuint source, const GLintptr vertex_offset, const GLintptr index_offset) const {
+        const auto& allocation = m_allocations[handle];
+        const GLsizeiptr stride = m_layout.stride();
+        glBindBuffer(GL_COPY_READ_BUFFER, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_uVbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, vertex_offset, allocation.base_vertex * stride, allocation.vertex_count * stride);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_uEbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, index_offset, allocation.first_index * sizeof(GLuint), allocation.index_count * sizeof(GLuint));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    void MeshArena::free(const MeshArenaHandle handle) {
+        if (handle >= m_allocations.size() || !m_allocations[handle].live) {
+            return;
+        }
+        auto& allocation = m_allocations[handle];
+        m_vertices.free(allocation.base_vertex, allocation.vertex_count);
+        m_indices.free(allocation.first_index, allocation.index_count);
+        allocation.live = false;
+        m_free_handles.push_back(handle);
+    }
+
+    void MeshArena::defragment() {
+        if (m_uVao == 0) {
+            return;
+        }
+        resize_buffers(m_vertices.capacity(), m_indices.capacity(), true);
+    }
+
+    void MeshArena::release() {
+        if (m_uVao != 0) {
+            GlStateCache::Instance().forget_vertex_array(m_uVao);
+            glDeleteVertexArrays(1, &m_uVao);
+            m_uVao = 0;
+        }
+        if (m_uVbo != 0) {
+            glDeleteBuffers(1, &m_uVbo);
+            m_uVbo = 0;
+        }
+        if (m_uEbo != 0) {
+            glDeleteBuffers(1, &m_uEbo);
+            m_uEbo = 0;
+        }
+    }
+
+    static Vector<std::unique_ptr<MeshArena>> s_arenas;
+
+    MeshArena& MeshArena::Get(const VertexLayout& layout) {
+        for (const auto& arena : s_arenas) {
+            if (arena->layout() == layout) {
+                return *arena;
+            }
+        }
+        return *s_arenas.emplace_back(std::make_unique<MeshArena>(layout));
+    }
+
+    void MeshArena::ReleaseAll() {
+        for (const auto& arena : s_arenas) {
+            arena->release();
+        }
+    }
+}
@@ -0,0 +1,196 @@
+#include "fow/Renderer/MeshFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace fow {
+    // On disk layout, all values are little endian. The header is followed by the submesh table, the lod table,
+    // the vertex data and the indices. The vertex data and the indices start at 16 byte aligned offsets.
+    struct MeshFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint8_t position_format;
+        uint8_t normal_format;
+        uint8_t uv_format;
+        uint8_t padding;
+        uint32_t material_count;
+        uint32_t submesh_count;
+        uint32_t lod_count;
+        uint64_t vertex_data_offset;
+        uint64_t vertex_data_size;
+        uint64_t index_data_offset;
+        uint64_t index_count;
+        float bounds[4];
+    };
+    static_assert(sizeof(MeshFileHeader) == 72);
+
+    struct MeshFileSubmesh {
+        uint32_t material_index;
+        uint32_t vertex_offset;
+        uint32_t vertex_count;
+        uint32_t index_offset;
+        uint32_t index_count;
+        uint32_t first_lod;
+        uint32_t lod_count;
+        float quantization_scale[3];
+        float quantization_offset[3];
+        float bounds[4];
+    };
+    static_assert(sizeof(MeshFileSubmesh) == 68);
+
+    struct MeshFileLod {
+        uint32_t index_offset;
+        int32_t index_count;
+        float error;
+    };
+    static_assert(sizeof(MeshFileLod) == 12);
+
+    static constexpr char MeshFileMagic[4] = { 'F', 'M', 'S', 'H' };
+
+    static size_t AlignOffset(const size_t offset) {
+        return (offset + 15) & ~static_cast<size_t>(15);
+    }
+
+    template<typename T>
+    static void WriteValue(Vector<std::byte>& out, const T& value) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    Vector<std::byte> WriteMeshFile(const CookedModel& model) {
+        size_t lod_count = 0;
+        for (const auto& submesh : model.submeshes) {
+            lod_count += submesh.lods.size();
+        }
+        const size_t tables_end = sizeof(MeshFileHeader) + model.submeshes.size() * sizeof(MeshFileSubmesh) + lod_count * sizeof(MeshFileLod);
+        const size_t vertex_data_offset = AlignOffset(tables_end);
+        const size_t index_data_offset = AlignOffset(vertex_data_offset + model.vertex_data.size());
+
+        MeshFileHeader header { };
+        std::memcpy(header.magic, MeshFileMagic, sizeof(MeshFileMagic));
+        header.version = FOW_MESH_FILE_VERSION;
+        header.position_format = static_cast<uint8_t>(model.layout.position);
+        header.normal_format = static_cast<uint8_t>(model.layout.normal);
+        header.uv_format = static_cast<uint8_t>(model.layout.uv);
+        header.material_count = model.material_count;
+        header.submesh_count = static_cast<uint32_t>(model.submeshes.size());
+        header.lod_count = static_cast<uint32_t>(lod_count);
+        header.vertex_data_offset = vertex_data_offset;
+        header.vertex_data_size = model.vertex_data.size();
+        header.index_data_offset = index_data_offset;
+        header.index_count = model.indices.size();
+        header.bounds[0] = model.bounds.center.x;
+        header.bounds[1] = model.bounds.center.y;
+        header.bounds[2] = model.bounds.center.z;
+        header.bounds[3] = model.bounds.radius;
+
+        Vector<std::byte> out;
+        out.reserve(index_data_offset + model.indices.size() * sizeof(GLuint));
+        WriteValue(out, header);
+        uint32_t first_lod = 0;
+        for (const auto& submesh : model.submeshes) {
+            const auto& q = submesh.quantization;
+            const auto& b = submesh.bounds;
+            WriteValue(out, MeshFileSubmesh {
+                submesh.material_index, submesh.vertex_offset, submesh.vertex_count, submesh.index_offset, submesh.index_count,
+                first_lod, static_cast<uint32_t>(submesh.lods.size()),
+                { q.scale.x, q.scale.y, q.scale.z }, { q.offset.x, q.offset.y, q.offset.z },
+                { b.center.x, b.center.y, b.center.z, b.radius }
+            });
+            first_lod += static_cast<uint32_t>(submesh.lods.size());
+        }
+        for (const auto& submesh : model.submeshes) {
+            for (const auto& lod : submesh.lods) {
+                WriteValue(out, MeshFileLod { lod.index_offset, lod.index_count, lod.error });
+            }
+        }
+        out.resize(vertex_data_offset);
+        out.insert(out.end(), model.vertex_data.begin(), model.vertex_data.end());
+        out.resize(index_data_offset);
+        const auto* indices = reinterpret_cast<const std::byte*>(model.indices.data());
+        out.insert(out.end(), indices, indices + model.indices.size() * sizeof(GLuint));
+        return out;
+    }
+
+    Result<MeshFileView> ReadMeshFile(const std::span<const std::byte> data) {
+        MeshFileHeader header;
+        if (data.size() < sizeof(header)) {
+            return Failure("Mesh file is truncated");
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, MeshFileMagic, sizeof(MeshFileMagic)) != 0) {
+            return Failure("Not a mesh file");
+        }
+        if (header.version != FOW_MESH_FILE_VERSION) {
+            return Failure(std::format("Unsupported mesh file version {}, expected {}", header.version, FOW_MESH_FILE_VERSION));
+        }
+        if (header.position_format > static_cast<uint8_t>(VertexPositionFormat::Unorm16) ||
+            header.normal_format > static_cast<uint8_t>(VertexNormalFormat::Octahedral) ||
+            header.uv_format > static_cast<uint8_t>(VertexUVFormat::Unorm16)) {
+            return Failure("Mesh file has an unknown vertex layout");
+        }
+
+        const size_t tables_end = sizeof(MeshFileHeader) + static_cast<size_t>(header.submesh_count) * sizeof(MeshFileSubmesh) + static_cast<size_t>(header.lod_count) * sizeof(MeshFileLod);
+        if (tables_end > data.size() || header.vertex_data_offset < tables_end || header.vertex_data_offset > data.size() ||
+            header.vertex_data_size > data.size() - header.vertex_data_offset ||
+            header.index_data_offset < header.vertex_data_offset + header.vertex_data_size || header.index_data_offset > data.size() ||
+            header.index_count > (data.size() - header.index_data_offset) / sizeof(GLuint)) {
+            return Failure("Mesh file is truncated");
+        }
+        if (reinterpret_cast<uintptr_t>(data.data() + header.index_data_offset) % alignof(GLuint) != 0) {
+            return Failure("Mesh file data is not aligned");
+        }
+
+        MeshFileView view;
+        view.layout = VertexLayout {
+            static_cast<VertexPositionFormat>(header.position_format),
+            static_cast<VertexNormalFormat>(header.normal_format),
+            static_cast<VertexUVFormat>(header.uv_format)
+        };
+        view.material_count = header.material_count;
+        view.bounds = BoundingSphere { Vector3 { header.bounds[0], header.bounds[1], header.bounds[2] }, header.bounds[3] };
+        view.vertex_data = data.subspan(header.vertex_data_offset, header.vertex_data_size);
+        view.indices = std::span(reinterpret_cast<const GLuint*>(data.data() + header.index_data_offset), header.index_count);
+
+        const auto* lods = data.data() + sizeof(MeshFileHeader) + static_cast<size_t>(header.submesh_count) * sizeof(MeshFileSubmesh);
+        const uint32_t stride = view.layout.stride();
+        view.submeshes.reserve(header.submesh_count);
+        for (uint32_t i = 0; i < header.submesh_count; ++i) {
+            MeshFileSubmesh submesh;
+            std::memcpy(&submesh, data.data() + sizeof(MeshFileHeader) + i * sizeof(MeshFileSubmesh), sizeof(submesh));
+            if (static_cast<uint64_t>(submesh.vertex_offset) + static_cast<uint64_t>(submesh.vertex_count) * stride > header.vertex_data_size ||
+                static_cast<uint64_t>(submesh.index_offset) + submesh.index_count > header.index_count ||
+                static_cast<uint64_t>(submesh.first_lod) + submesh.lod_count > header.lod_count) {
+                return Failure(std::format("Submesh {} of mesh file is out of range", i));
+            }
+            if (submesh.material_index >= header.material_count) {
+                return Failure(std::format("Submesh {} of mesh file uses material {} of {}", i, submesh.material_index, header.material_count));
+            }
+            // Indices are relative to the submesh's first vertex and must stay inside its own vertices.
+            const auto submesh_indices = view.indices.subspan(submesh.index_offset, submesh.index_count);
+            if (const auto it = std::ranges::find_if(submesh_indices, [&](const GLuint index) { return index >= submesh.vertex_count; }); it != submesh_indices.end()) {
+                return Failure(std::format("Submesh {} of mesh file references vertex {} of {}", i, *it, submesh.vertex_count));
+            }
+
+            CookedSubmesh& cooked = view.submeshes.emplace_back(CookedSubmesh {
+                submesh.material_index, submesh.vertex_offset, submesh.vertex_count, submesh.index_offset, submesh.index_count,
+                VertexQuantization {
+                    Vector3 { submesh.quantization_scale[0], submesh.quantization_scale[1], submesh.quantization_scale[2] },
+                    Vector3 { submesh.quantization_offset[0], submesh.quantization_offset[1], submesh.quantization_offset[2] }
+                },
+                BoundingSphere { Vector3 { submesh.bounds[0], submesh.bounds[1], submesh.bounds[2] }, submesh.bounds[3] },
+                { }
+            });
+            cooked.lods.reserve(submesh.lod_count);
+            for (uint32_t lod_i = 0; lod_i < submesh.lod_count; ++lod_i) {
+                MeshFileLod lod;
+                std::memcpy(&lod, lods + (submesh.first_lod + lod_i) * sizeof(MeshFileLod), sizeof(lod));
+                if (lod.index_count < 0 || static_cast<uint64_t>(lod.index_offset) + static_cast<uint64_t>(lod.index_count) > submesh.index_count) {
+                    return Failure(std::format("Level of detail {} of submesh {} is out of range", lod_i, i));
+                }
+                cooked.lods.push_back(MeshLod { lod.index_offset, lod.index_count, lod.error });
+            }
+        }
+        return Success<MeshFileView>(std::move(view));
+    }
+}
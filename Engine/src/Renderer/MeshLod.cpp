@@ -0,0 +1,303 @@
+#include "fow/Renderer/MeshLod.hpp"
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace fow {
+    BoundingSphere BoundingSphere::transformed(const Matrix4& matrix) const {
+        const float scale = std::max({ glm::length(Vector3(matrix[0])), glm::length(Vector3(matrix[1])), glm::length(Vector3(matrix[2])) });
+        return BoundingSphere { Vector3(matrix * Vector4(center, 1.0f)), radius * scale };
+    }
+
+    BoundingSphere BoundingSphere::FromVertices(const Vector<Vertex>& vertices) {
+        if (vertices.empty()) {
+            return BoundingSphere { };
+        }
+        Vector3 min = vertices.front().position, max = vertices.front().position;
+        for (const auto& vertex : vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+        BoundingSphere sphere { (min + max) * 0.5f, 0.0f };
+        for (const auto& vertex : vertices) {
+            sphere.radius = std::max(sphere.radius, glm::distance(sphere.center, vertex.position));
+        }
+        return sphere;
+    }
+
+    // Area weighted sum of squared plane distances, divided by the total weight it is the mean squared distance.
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0, weight = 0;
+
+        void add_plane(const Vector3& normal, const float distance, const float plane_weight) {
+            const double a = normal.x, b = normal.y, c = normal.z, d = distance, w = plane_weight;
+            a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+            b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+            c2 += w * c * c; cd += w * c * d;
+            d2 += w * d * d;
+            weight += w;
+        }
+        Quadric& operator+=(const Quadric& other) {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+            return *this;
+        }
+        [[nodiscard]] double evaluate(const Vector3& p) const {
+            const double x = p.x, y = p.y, z = p.z;
+            const double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                               + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                               + c2 * z * z + 2 * cd * z
+                               + d2;
+            return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct EdgeCollapse {
+        GLuint from, to;
+        double cost;
+    };
+
+    static uint64_t EdgeKey(const GLuint a, const GLuint b) {
+        return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+    }
+
+    Vector<GLuint> SimplifyMesh(const Vector<Vertex>& vertices, const Vector<GLuint>& indices, const size_t target_index_count, const float target_error, float* result_error) {
+        Vector<GLuint> result(indices.begin(), indices.end() - static_cast<ptrdiff_t>(indices.size() % 3));
+        if (result_error != nullptr) {
+            *result_error = 0.0f;
+        }
+        const size_t vertex_count = vertices.size();
+        if (result.size() <= target_index_count || vertex_count == 0) {
+            return result;
+        }
+
+        // Normalized positions, so that errors are relative to the bounding sphere.
+        const auto sphere = BoundingSphere::FromVertices(vertices);
+        const float inverse_radius = sphere.radius > 0.0f ? 1.0f / sphere.radius : 1.0f;
+        Vector<Vector3> positions(vertex_count);
+        for (size_t i = 0; i < vertex_count; ++i) {
+            positions[i] = (vertices[i].position - sphere.center) * inverse_radius;
+        }
+
+        // Vertices that share a position with another one sit on an attribute seam, moving only one side would tear it.
+        Vector<GLuint> position_ids(vertex_count);
+        Vector<bool> locked(vertex_count, false);
+        {
+            HashMap<uint64_t, GLuint> first_with_position;
+            first_with_position.reserve(vertex_count);
+            for (GLuint i = 0; i < vertex_count; ++i) {
+                const auto& p = vertices[i].position;
+                const uint64_t key = (static_cast<uint64_t>(std::bit_cast<uint32_t>(p.x + 0.0f)) * 0x9E3779B97F4A7C15ull)
+                                   ^ (static_cast<uint64_t>(std::bit_cast<uint32_t>(p.y + 0.0f)) * 0xC2B2AE3D27D4EB4Full)
+                                   ^ (static_cast<uint64_t>(std::bit_cast<uint32_t>(p.z + 0.0f)) * 0x165667B19E3779F9ull);
+                auto [it, inserted] = first_with_position.try_emplace(key, i);
+                // Hash collisions between different positions only lock a few more vertices than necessary.
+                position_ids[i] = it->second;
+                if (!inserted) {
+                    locked[i] = true;
+                    locked[it->second] = true;
+                }
+            }
+        }
+
+        // Edges that belong to a single triangle are on the border of the mesh.
+        {
+            HashMap<uint64_t, uint32_t> edge_uses;
+            edge_uses.reserve(result.size());
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (size_t e = 0; e < 3; ++e) {
+                    ++edge_uses[EdgeKey(position_ids[result[i + e]], position_ids[result[i + (e + 1) % 3]])];
+                }
+            }
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (size_t e = 0; e < 3; ++e) {
+                    const GLuint a = result[i + e], b = result[i + (e + 1) % 3];
+                    if (edge_uses[EdgeKey(position_ids[a], position_ids[b])] == 1) {
+                        locked[a] = true;
+                        locked[b] = true;
+                    }
+                }
+            }
+        }
+
+        // Quadrics are shared by all vertices at a position.
+        Vector<Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const Vector3& p0 = positions[result[i]];
+            const Vector3 normal = glm::cross(positions[result[i + 1]] - p0, positions[result[i + 2]] - p0);
+            const float area = glm::length(normal);
+            if (area <= 0.0f) {
+                continue;
+            }
+            const Vector3 unit_normal = normal / area;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                quadrics[position_ids[result[i + corner]]].add_plane(unit_normal, -glm::dot(unit_normal, p0), area);
+            }
+        }
+
+        const double max_cost = static_cast<double>(target_error) * static_cast<double>(target_error);
+        double error = 0.0;
+        Vector<size_t> adjacency_offsets(vertex_count + 1);
+        Vector<uint32_t> adjacency;
+        Vector<EdgeCollapse> collapses;
+        Vector<GLuint> remap(vertex_count);
+        Vector<bool> touched(vertex_count);
+
+        // Each pass collapses a set of edges whose triangles do not overlap, then rewrites the index buffer.
+        while (result.size() > target_index_count) {
+            const size_t triangle_count = result.size() / 3;
+            std::ranges::fill(adjacency_offsets, 0);
+            for (const auto index : result) {
+                ++adjacency_offsets[index + 1];
+            }
+            for (size_t v = 0; v < vertex_count; ++v) {
+                adjacency_offsets[v + 1] += adjacency_offsets[v];
+            }
+            adjacency.resize(result.size());
+            {
+                Vector<size_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+                for (size_t i = 0; i < result.size(); ++i) {
+                    adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (size_t e = 0; e < 3; ++e) {
+                    const GLuint a = result[i + e], b = result[i + (e + 1) % 3];
+                    const Quadric* qa = &quadrics[position_ids[a]];
+                    const Quadric* qb = &quadrics[position_ids[b]];
+                    for (const auto& [from, to] : { std::pair { a, b }, std::pair { b, a } }) {
+                        if (locked[from]) {
+                            continue;
+                        }
+                        Quadric combined = *qa;
+                        combined += *qb;
+                        if (const double cost = combined.evaluate(positions[to]); cost <= max_cost) {
+                            collapses.push_back(EdgeCollapse { from, to, cost });
+                        }
+                    }
+                }
+            }
+            if (collapses.empty()) {
+                break;
+            }
+            std::ranges::sort(collapses, [](const EdgeCollapse& a, const EdgeCollapse& b) { return a.cost < b.cost; });
+
+            for (GLuint v = 0; v < vertex_count; ++v) {
+                remap[v] = v;
+            }
+            touched.assign(vertex_count, false);
+            size_t remaining_triangles = triangle_count;
+            const size_t target_triangles = target_index_count / 3;
+            size_t collapsed = 0;
+            for (const auto& collapse : collapses) {
+                if (remaining_triangles <= target_triangles) {
+                    break;
+                }
+                if (touched[collapse.from] || touched[collapse.to]) {
+                    continue;
+                }
+
+                // Reject collapses that flip a triangle that is kept.
+                bool flips = false;
+                size_t removed_triangles = 0;
+                for (size_t i = adjacency_offsets[collapse.from]; i < adjacency_offsets[collapse.from + 1] && !flips; ++i) {
+                    const GLuint* triangle = &result[adjacency[i] * 3];
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                        ++removed_triangles;
+                        continue;
+                    }
+                    Vector3 corners[3], moved[3];
+                    for (size_t corner = 0; corner < 3; ++corner) {
+                        corners[corner] = positions[triangle[corner]];
+                        moved[corner] = triangle[corner] == collapse.from ? positions[collapse.to] : corners[corner];
+                    }
+                    const Vector3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                    const Vector3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                    flips = glm::dot(before, after) <= 0.0f;
+                }
+                if (flips) {
+                    continue;
+                }
+
+                remap[collapse.from] = collapse.to;
+                quadrics[position_ids[collapse.to]] += quadrics[position_ids[collapse.from]];
+                for (size_t i = adjacency_offsets[collapse.from]; i < adjacency_offsets[collapse.from + 1]; ++i) {
+                    for (size_t corner = 0; corner < 3; ++corner) {
+                        touched[result[adjacency[i] * 3 + corner]] = true;
+                    }
+                }
+                error = std::max(error, collapse.cost);
+                remaining_triangles -= std::min(removed_triangles, remaining_triangles);
+                ++collapsed;
+            }
+            if (collapsed == 0) {
+                break;
+            }
+
+            for (auto& index : result) {
+                index = remap[index];
+            }
+            FOW_DISCARD(RemoveDegenerateTriangles(result));
+        }
+
+        if (result_error != nullptr) {
+            *result_error = static_cast<float>(std::sqrt(error));
+        }
+        return result;
+    }
+
+    Vector<MeshLodLevel> GenerateMeshLods(const Vector<Vertex>& vertices, const Vector<GLuint>& indices, const MeshLodOptions& options) {
+        Vector<MeshLodLevel> levels;
+        levels.push_back(MeshLodLevel { indices, 0.0f });
+        while (levels.size() < options.max_levels) {
+            const size_t previous_count = levels.back().indices.size();
+            const size_t target_count = static_cast<size_t>(static_cast<float>(previous_count / 3) * options.reduction) * 3;
+            float error = 0.0f;
+            auto simplified = SimplifyMesh(vertices, indices, target_count, options.max_error, &error);
+            // Stop once the error limit or locked vertices keep the simplifier from making real progress.
+            if (simplified.empty() || simplified.size() * 10 > previous_count * 9) {
+                break;
+            }
+            OptimizeVertexCache(simplified, vertices.size());
+            levels.push_back(MeshLodLevel { std::move(simplified), std::max(error, levels.back().error) });
+        }
+        return levels;
+    }
+
+    float ProjectSphereRadius(const BoundingSphere& sphere, const Matrix4& view, const Matrix4& projection, const float viewport_height) {
+        const float scale = projection[1][1] * viewport_height * 0.5f;
+        if (projection[3][3] == 1.0f) {
+            // Orthographic, the size does not depend on the distance.
+            return sphere.radius * scale;
+        }
+        const float depth = -(view * Vector4(sphere.center, 1.0f)).z;
+        if (depth <= sphere.radius) {
+            return std::numeric_limits<float>::infinity();
+        }
+        return sphere.radius * scale / depth;
+    }
+
+    size_t SelectMeshLod(const Vector<MeshLod>& lods, const float projected_radius, const size_t current, const MeshLodSelectionParams& params) {
+        size_t target = 0;
+        while (target + 1 < lods.size() && lods[target + 1].error * projected_radius <= params.pixel_error) {
+            ++target;
+        }
+        // Switching to a finer level happens right away, coarser levels have to be clearly good enough.
+        if (current < lods.size() && target > current) {
+            const float threshold = params.pixel_error * (1.0f - params.hysteresis);
+            while (target > current && lods[target].error * projected_radius > threshold) {
+                --target;
+            }
+        }
+        return target;
+    }
+}
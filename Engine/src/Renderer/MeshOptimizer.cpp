@@ -0,0 +1,331 @@
+#include "fow/Renderer/MeshOptimizer.hpp"
+#include "fow/Renderer/Mesh.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+namespace fow {
+    static constexpr GLuint InvalidIndex = ~0u;
+
+    static FOW_CONSTEXPR uint64_t HashCombine(const uint64_t seed, const uint64_t value) {
+        return seed ^ (value * 0x9E3779B97F4A7C15ull + 0x7F4A7C159E3779B9ull + (seed << 6) + (seed >> 2));
+    }
+    static uint64_t HashFloats(uint64_t seed, const float* values, const size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            // Adding zero turns -0.0 into 0.0, both compare equal.
+            seed = HashCombine(seed, std::bit_cast<uint32_t>(values[i] + 0.0f));
+        }
+        return seed;
+    }
+    static uint64_t ExactKey(const Vertex& vertex) {
+        uint64_t key = HashFloats(0, &vertex.position.x, 3);
+        key = HashFloats(key, &vertex.normal.x, 3);
+        key = HashFloats(key, &vertex.tangent.x, 3);
+        key = HashFloats(key, &vertex.bitangent.x, 3);
+        return HashFloats(key, &vertex.uv.x, 2);
+    }
+    static uint64_t CellKey(const Vector3& cell) {
+        uint64_t key = HashCombine(0, static_cast<uint64_t>(static_cast<int64_t>(cell.x)));
+        key = HashCombine(key, static_cast<uint64_t>(static_cast<int64_t>(cell.y)));
+        return HashCombine(key, static_cast<uint64_t>(static_cast<int64_t>(cell.z)));
+    }
+    template<glm::length_t L>
+    static bool WithinEpsilon(const glm::vec<L, float>& a, const glm::vec<L, float>& b, const float epsilon) {
+        return glm::all(glm::lessThanEqual(glm::abs(a - b), glm::vec<L, float> { epsilon }));
+    }
+
+    bool VertexWelder::matches(const Vertex& a, const Vertex& b) const {
+        if (m_options.mode == VertexWeldMode::Exact) {
+            return a.position == b.position && a.normal == b.normal && a.tangent == b.tangent && a.bitangent == b.bitangent && a.uv == b.uv;
+        }
+        return WithinEpsilon(a.position, b.position, m_options.position_epsilon) &&
+               WithinEpsilon(a.normal, b.normal, m_options.normal_epsilon) &&
+               WithinEpsilon(a.tangent, b.tangent, m_options.normal_epsilon) &&
+               WithinEpsilon(a.bitangent, b.bitangent, m_options.normal_epsilon) &&
+               WithinEpsilon(a.uv, b.uv, m_options.uv_epsilon);
+    }
+
+    GLuint VertexWelder::find(const Vector<Vertex>& vertices, const uint64_t key, const Vertex& vertex) const {
+        const auto it = m_buckets.find(key);
+        if (it == m_buckets.end()) {
+            return InvalidIndex;
+        }
+        for (GLuint index = it->second; index != InvalidIndex; index = m_next[index]) {
+            if (matches(vertices[index], vertex)) {
+                return index;
+            }
+        }
+        return InvalidIndex;
+    }
+
+    GLuint VertexWelder::add(Vector<Vertex>& vertices, const Vertex& vertex) {
+        uint64_t key;
+        if (m_options.mode == VertexWeldMode::Epsilon && m_options.position_epsilon > 0.0f) {
+            // Cells are as large as the tolerance, so every match lies in one of the neighbouring cells.
+            const Vector3 cell = glm::floor(vertex.position / m_options.position_epsilon);
+            for (int z = -1; z <= 1; ++z) {
+                for (int y = -1; y <= 1; ++y) {
+                    for (int x = -1; x <= 1; ++x) {
+                        if (const auto index = find(vertices, CellKey(cell + Vector3 { x, y, z }), vertex); index != InvalidIndex) {
+                            return index;
+                        }
+                    }
+                }
+            }
+            key = CellKey(cell);
+        } else {
+            key = ExactKey(vertex);
+            if (const auto index = find(vertices, key, vertex); index != InvalidIndex) {
+                return index;
+            }
+        }
+
+        const auto index = static_cast<GLuint>(vertices.size());
+        vertices.push_back(vertex);
+        const auto [it, inserted] = m_buckets.try_emplace(key, index);
+        m_next.push_back(inserted ? InvalidIndex : it->second);
+        it->second = index;
+        return index;
+    }
+
+    void VertexWelder::reserve(const size_t vertex_count) {
+        m_buckets.reserve(vertex_count);
+        m_next.reserve(vertex_count);
+    }
+    void VertexWelder::clear() {
+        m_buckets.clear();
+        m_next.clear();
+    }
+
+    size_t WeldVertices(Vector<Vertex>& vertices, Vector<GLuint>& indices, const VertexWeldOptions& options) {
+        VertexWelder welder { options };
+        welder.reserve(vertices.size());
+        Vector<Vertex> welded;
+        welded.reserve(vertices.size());
+
+        Vector<GLuint> remap(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            remap[i] = welder.add(welded, vertices[i]);
+        }
+        for (auto& index : indices) {
+            index = remap[index];
+        }
+
+        const size_t removed = vertices.size() - welded.size();
+        vertices = std::move(welded);
+        return removed;
+    }
+
+    size_t RemoveDegenerateTriangles(Vector<GLuint>& indices) {
+        size_t write = 0;
+        for (size_t read = 0; read + 2 < indices.size(); read += 3) {
+            const GLuint a = indices[read], b = indices[read + 1], c = indices[read + 2];
+            if (a != b && b != c && a != c) {
+                indices[write++] = a;
+                indices[write++] = b;
+                indices[write++] = c;
+            }
+        }
+        const size_t removed = (indices.size() - write) / 3;
+        indices.resize(write);
+        return removed;
+    }
+
+    void OptimizeVertexCache(Vector<GLuint>& indices, const size_t vertex_count, const uint32_t cache_size, Vector<size_t>* cluster_offsets) {
+        if (cluster_offsets != nullptr) {
+            cluster_offsets->clear();
+        }
+        const size_t triangle_count = indices.size() / 3;
+        if (triangle_count == 0 || vertex_count == 0) {
+            return;
+        }
+
+        // Triangles adjacent to each vertex, live counts the ones that are not emitted yet.
+        Vector<uint32_t> live(vertex_count, 0);
+        for (size_t i = 0; i < triangle_count * 3; ++i) {
+            ++live[indices[i]];
+        }
+        Vector<size_t> adjacency_offsets(vertex_count + 1, 0);
+        for (size_t v = 0; v < vertex_count; ++v) {
+            adjacency_offsets[v + 1] = adjacency_offsets[v] + live[v];
+        }
+        Vector<uint32_t> adjacency(adjacency_offsets.back());
+        {
+            Vector<size_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t i = 0; i < triangle_count * 3; ++i) {
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        Vector<uint32_t> cache_time(vertex_count, 0);
+        uint32_t time = cache_size + 1;
+        Vector<bool> emitted(triangle_count, false);
+        Vector<GLuint> dead_ends;
+        dead_ends.reserve(triangle_count * 3);
+        Vector<GLuint> candidates;
+        Vector<GLuint> output;
+        output.reserve(triangle_count * 3);
+        size_t cursor = 0;
+
+        // Continues with the most recently used vertex that still has triangles, or the next one in input order.
+        const auto skip_dead_end = [&]() -> int64_t {
+            if (cluster_offsets != nullptr && (cluster_offsets->empty() || cluster_offsets->back() != output.size())) {
+                cluster_offsets->push_back(output.size());
+            }
+            while (!dead_ends.empty()) {
+                const GLuint vertex = dead_ends.back();
+                dead_ends.pop_back();
+                if (live[vertex] > 0) {
+                    return vertex;
+                }
+            }
+            for (; cursor < vertex_count; ++cursor) {
+                if (live[cursor] > 0) {
+                    return static_cast<int64_t>(cursor);
+                }
+            }
+            return -1;
+        };
+
+        int64_t fan = skip_dead_end();
+        while (fan >= 0) {
+            candidates.clear();
+            for (size_t i = adjacency_offsets[fan]; i < adjacency_offsets[fan + 1]; ++i) {
+                const uint32_t triangle = adjacency[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    const GLuint vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    dead_ends.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --live[vertex];
+                    if (time - cache_time[vertex] > cache_size) {
+                        cache_time[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = true;
+            }
+
+            // Prefer the oldest vertex that is still in the cache after its remaining triangles are emitted.
+            int64_t next = -1;
+            int64_t best_priority = -1;
+            for (const auto vertex : candidates) {
+                if (live[vertex] == 0) {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (time - cache_time[vertex] + 2 * live[vertex] <= cache_size) {
+                    priority = time - cache_time[vertex];
+                }
+                if (priority > best_priority) {
+                    best_priority = priority;
+                    next = vertex;
+                }
+            }
+            fan = next >= 0 ? next : skip_dead_end();
+        }
+
+        if (cluster_offsets != nullptr && !cluster_offsets->empty() && cluster_offsets->back() == output.size()) {
+            cluster_offsets->pop_back();
+        }
+        // Trailing indices of an incomplete triangle are kept as they were.
+        output.insert(output.end(), indices.begin() + static_cast<ptrdiff_t>(triangle_count * 3), indices.end());
+        indices = std::move(output);
+    }
+
+    void OptimizeOverdraw(Vector<GLuint>& indices, const Vector<Vertex>& vertices, const Vector<size_t>& cluster_offsets) {
+        if (cluster_offsets.size() < 2) {
+            return;
+        }
+
+        struct Cluster {
+            size_t begin, end;
+            Vector3 centroid, normal;
+            float area, sort_key;
+        };
+        Vector<Cluster> clusters;
+        clusters.reserve(cluster_offsets.size());
+        Vector3 mesh_centroid { 0.0f };
+        float mesh_area = 0.0f;
+        for (size_t i = 0; i < cluster_offsets.size(); ++i) {
+            Cluster cluster { cluster_offsets[i], i + 1 < cluster_offsets.size() ? cluster_offsets[i + 1] : indices.size() - indices.size() % 3, Vector3 { 0.0f }, Vector3 { 0.0f }, 0.0f, 0.0f };
+            for (size_t j = cluster.begin; j + 2 < cluster.end; j += 3) {
+                const Vector3& p0 = vertices[indices[j]].position;
+                const Vector3& p1 = vertices[indices[j + 1]].position;
+                const Vector3& p2 = vertices[indices[j + 2]].position;
+                const Vector3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+                cluster.normal += normal;
+                cluster.area += area;
+            }
+            mesh_centroid += cluster.centroid;
+            mesh_area += cluster.area;
+            clusters.push_back(cluster);
+        }
+        if (mesh_area <= 0.0f) {
+            return;
+        }
+        mesh_centroid /= mesh_area;
+
+        // Clusters that face away from the center are likely to occlude the rest of the mesh from most directions.
+        for (auto& cluster : clusters) {
+            const float normal_length = glm::length(cluster.normal);
+            if (cluster.area > 0.0f && normal_length > 0.0f) {
+                cluster.sort_key = glm::dot(cluster.centroid / cluster.area - mesh_centroid, cluster.normal / normal_length);
+            }
+        }
+        std::ranges::stable_sort(clusters, [](const Cluster& a, const Cluster& b) { return a.sort_key > b.sort_key; });
+
+        Vector<GLuint> output;
+        output.reserve(indices.size());
+        for (const auto& cluster : clusters) {
+            output.insert(output.end(), indices.begin() + static_cast<ptrdiff_t>(cluster.begin), indices.begin() + static_cast<ptrdiff_t>(cluster.end));
+        }
+        output.insert(output.end(), indices.end() - static_cast<ptrdiff_t>(indices.size() % 3), indices.end());
+        indices = std::move(output);
+    }
+
+    void OptimizeVertexFetch(Vector<Vertex>& vertices, Vector<GLuint>& indices) {
+        Vector<GLuint> remap(vertices.size(), InvalidIndex);
+        Vector<Vertex> reordered;
+        reordered.reserve(vertices.size());
+        for (auto& index : indices) {
+            if (remap[index] == InvalidIndex) {
+                remap[index] = static_cast<GLuint>(reordered.size());
+                reordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices = std::move(reordered);
+    }
+
+    float ComputeACMR(const Vector<GLuint>& indices, const size_t vertex_count, const uint32_t cache_size) {
+        const size_t triangle_count = indices.size() / 3;
+        if (triangle_count == 0) {
+            return 0.0f;
+        }
+        // A vertex is in the FIFO while fewer than cache_size misses happened since it was inserted.
+        Vector<size_t> inserted(vertex_count, 0);
+        size_t misses = 0;
+        for (size_t i = 0; i < triangle_count * 3; ++i) {
+            const GLuint vertex = indices[i];
+            if (inserted[vertex] == 0 || misses - inserted[vertex] >= cache_size) {
+                inserted[vertex] = ++misses;
+            }
+        }
+        return static_cast<float>(misses) / static_cast<float>(triangle_count);
+    }
+
+    void OptimizeMesh(Vector<Vertex>& vertices, Vector<GLuint>& indices, const VertexWeldOptions& options) {
+        FOW_DISCARD(WeldVertices(vertices, indices, options));
+        FOW_DISCARD(RemoveDegenerateTriangles(indices));
+        Vector<size_t> cluster_offsets;
+        OptimizeVertexCache(indices, vertices.size(), FOW_VERTEX_CACHE_SIZE, &cluster_offsets);
+        OptimizeOverdraw(indices, vertices, cluster_offsets);
+        OptimizeVertexFetch(vertices, indices);
+    }
+}
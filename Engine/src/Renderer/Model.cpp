@@ -1,5 +1,10 @@
 #include "fow/Renderer/GL.hpp"
 #include "fow/Renderer/Model.hpp"
+#include "fow/Renderer/MeshFile.hpp"
+#include "fow/Renderer/MeshLod.hpp"
+#include "fow/Renderer/MeshOptimizer.hpp"
+#include "fow/Renderer/UploadQueue.hpp"
+#include "fow/Shared/Parallel.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -45,6 +50,20 @@ namespace fow {
         }
     }
 
+    void Model::draw(const Matrix4& model_matrix, Vector<size_t>& lods) const {
+        const size_t mesh_count = m_meshes.size();
+        lods.resize(mesh_count, SIZE_MAX);
+        for (size_t i = 0; i < mesh_count; ++i) {
+            const auto& mesh = m_meshes.at(i);
+            lods[i] = mesh->select_lod(model_matrix, lods[i]);
+            if (MaterialPtr material_override = nullptr; m_material_overrides.size() > i && (material_override = m_material_overrides.at(i)) != nullptr) {
+                mesh->draw_lod(lods[i], material_override, model_matrix);
+            } else {
+                mesh->draw_lod(lods[i], model_matrix);
+            }
+        }
+    }
+
     void Model::draw_instances(const Vector<Transform>& transforms) const {
         const size_t mesh_count = m_meshes.size();
         for (size_t i = 0; i < mesh_count; ++i) {
@@ -56,6 +75,28 @@ namespace fow {
         }
     }
 
+    bool Model::enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const {
+        Vector<size_t> lods;
+        return enqueue_draws(builder, transform.matrix(), lods);
+    }
+    bool Model::enqueue_draws(MultiDrawBuilder& builder, const Matrix4& model_matrix, Vector<size_t>& lods) const {
+        const size_t mesh_count = m_meshes.size();
+        Vector<MaterialPtr> materials(mesh_count);
+        for (size_t i = 0; i < mesh_count; ++i) {
+            materials[i] = m_material_overrides.size() > i && m_material_overrides.at(i) != nullptr ? m_material_overrides.at(i) : m_meshes.at(i)->material();
+            if (!m_meshes.at(i)->supports_multi_draw(materials[i])) {
+                return false;
+            }
+        }
+        lods.resize(mesh_count, SIZE_MAX);
+        for (size_t i = 0; i < mesh_count; ++i) {
+            const auto& mesh = m_meshes.at(i);
+            lods[i] = mesh->select_lod(model_matrix, lods[i]);
+            builder.add(mesh->draw_item(lods[i], materials[i], model_matrix));
+        }
+        return true;
+    }
+
     Vector<MaterialPtr> Model::materials() const {
         Vector<MaterialPtr> materials;
         for (const auto& mesh : m_meshes) {
@@ -83,61 +124,86 @@ namespace fow {
         }
     }
 
-    static Result<> ProcessModelNodes(const String& source_path, const aiScene* scene, const aiNode* node, Vector<MeshPtr>& meshes, const Vector<MaterialPtr>& materials) {
-        if (!scene->HasMeshes()) {
-            return Failure("No mesh data found!");
-        }
+    static const VertexWeldOptions ModelImportWeldOptions = VertexWeldOptions { VertexWeldMode::Epsilon };
+
+    struct ImportedSubmesh {
+        uint32_t material_index;
+        Vector<Vertex> vertices;
+        Vector<MeshLodLevel> lods;
+    };
+
+    static void CollectModelMeshes(const aiScene* scene, const aiNode* node, Vector<const aiMesh*>& meshes) {
         for (size_t mesh_i = 0; mesh_i < node->mNumMeshes; ++mesh_i) {
-            const auto* mesh = scene->mMeshes[node->mMeshes[mesh_i]];
-
-            MaterialPtr material = nullptr;
-            Vector<Vertex> vertices;
-            Vector<GLuint> indices;
-            for (size_t face_i = 0; face_i < mesh->mNumFaces; ++face_i) {
-                const auto& face = mesh->mFaces[face_i];
-                for (size_t idx_i = 0; idx_i < face.mNumIndices; ++idx_i) {
-                    const auto idx  = face.mIndices[idx_i];
-                    const auto pos  = mesh->mVertices[idx];
-                    const auto norm = mesh->mNormals[idx];
-                    const auto tang = mesh->mTangents[idx];
-                    const auto bitang = mesh->mBitangents[idx];
-                    aiVector3D uv;
-                    if (mesh->HasTextureCoords(0)) {
-                        uv = mesh->mTextureCoords[0][idx];
-                    } else {
-                        uv = aiVector3D(0.0f, 0.0f, 0.0f);
-                    }
-                    indices.emplace_back(vertices.size());
-                    vertices.emplace_back(
-                        Vector3 { pos.x, pos.y, pos.z },
-                        Vector3 { norm.x, norm.y, norm.z },
-                        Vector3 { tang.x, tang.y, tang.z },
-                        Vector3 { bitang.x, bitang.y, bitang.z },
-                        Vector2 { uv.x, 1.0f - uv.y }
-                    );
-                }
-                if (mesh->mMaterialIndex < materials.size()) {
-                    material = materials.at(mesh->mMaterialIndex);
-                } else {
-                    Debug::LogError(std::format("Failed to set material {} for model \"{}\": Material at index is not defined!", mesh->mMaterialIndex, source_path));
-                }
-            }
+            meshes.push_back(scene->mMeshes[node->mMeshes[mesh_i]]);
+        }
+        for (size_t i = 0; i < node->mNumChildren; ++i) {
+            CollectModelMeshes(scene, node->mChildren[i], meshes);
+        }
+    }
 
-            const auto mesh_result = Mesh::Create(material, vertices, indices);
-            if (!mesh_result.has_value()) {
-                return Failure(std::format("Failed to load mesh data: {}", mesh_result.error().message));
-            }
-            meshes.emplace_back(std::move(mesh_result.value()));
+    // Only touches the aiMesh and the output, so it can run on any thread.
+    static ImportedSubmesh ImportModelMesh(const aiMesh* mesh) {
+        Vector<Vertex> vertices;
+        vertices.reserve(mesh->mNumVertices);
+        for (size_t vert_i = 0; vert_i < mesh->mNumVertices; ++vert_i) {
+            const auto pos  = mesh->mVertices[vert_i];
+            const auto norm = mesh->HasNormals() ? mesh->mNormals[vert_i] : aiVector3D(0.0f, 1.0f, 0.0f);
+            const auto tang = mesh->HasTangentsAndBitangents() ? mesh->mTangents[vert_i] : aiVector3D(1.0f, 0.0f, 0.0f);
+            const auto bitang = mesh->HasTangentsAndBitangents() ? mesh->mBitangents[vert_i] : aiVector3D(0.0f, 0.0f, 1.0f);
+            const auto uv = mesh->HasTextureCoords(0) ? mesh->mTextureCoords[0][vert_i] : aiVector3D(0.0f, 0.0f, 0.0f);
+            vertices.emplace_back(
+                Vector3 { pos.x, pos.y, pos.z },
+                Vector3 { norm.x, norm.y, norm.z },
+                Vector3 { tang.x, tang.y, tang.z },
+                Vector3 { bitang.x, bitang.y, bitang.z },
+                Vector2 { uv.x, 1.0f - uv.y }
+            );
         }
 
-        if (node->mNumChildren > 0) {
-            for (size_t i = 0; i < node->mNumChildren; ++i) {
-                if (const auto result = ProcessModelNodes(source_path, scene, node->mChildren[i], meshes, materials); !result.has_value()) {
-                    return result;
-                }
+        // Meshes are drawn as triangle lists, points and lines are split off by aiProcess_SortByPType.
+        Vector<GLuint> indices;
+        indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
+        for (size_t face_i = 0; face_i < mesh->mNumFaces; ++face_i) {
+            if (const auto& face = mesh->mFaces[face_i]; face.mNumIndices == 3) {
+                indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
             }
         }
-        return Success();
+        OptimizeMesh(vertices, indices, ModelImportWeldOptions);
+
+        auto lods = GenerateMeshLods(vertices, indices);
+        return ImportedSubmesh { mesh->mMaterialIndex, std::move(vertices), std::move(lods) };
+    }
+
+    static Result<Vector<ImportedSubmesh>> ImportModel(const Vector<uint8_t>& data) {
+        Assimp::Importer importer;
+        const auto scene = importer.ReadFileFromMemory(data.data(), data.size(), aiProcessPreset_TargetRealtime_Quality & ~aiProcess_ImproveCacheLocality);
+        if (scene == nullptr) {
+            return Failure(importer.GetErrorString());
+        }
+        if (!scene->HasMeshes()) {
+            return Failure("No mesh data found!");
+        }
+
+        // Submeshes are converted, welded and simplified in parallel, the results keep the node order.
+        Vector<const aiMesh*> meshes;
+        CollectModelMeshes(scene, scene->mRootNode, meshes);
+        Vector<ImportedSubmesh> submeshes(meshes.size());
+        ParallelFor(meshes.size(), [&](const size_t i) {
+            submeshes[i] = ImportModelMesh(meshes[i]);
+        });
+        return Success<Vector<ImportedSubmesh>>(std::move(submeshes));
+    }
+
+    static MaterialPtr FindModelMaterial(const String& source_path, const uint32_t index, const Vector<MaterialPtr>& materials) {
+        // Models loaded without a material list, e.g. bare mesh files, draw with the placeholder shader.
+        if (materials.empty()) {
+            return nullptr;
+        }
+        if (index < materials.size()) {
+            return materials.at(index);
+        }
+        Debug::LogError(std::format("Failed to set material {} for model \"{}\": Material at index is not defined!", index, source_path));
+        return nullptr;
     }
 
     void Model::set_material_overrides(const Vector<MaterialPtr>& material_overrides) {
@@ -152,21 +218,117 @@ namespace fow {
         }
     }
 
-    Result<ModelPtr> Model::Load(const String& source_path, const Vector<uint8_t>& data, const Vector<MaterialPtr>& materials) {
-        Assimp::Importer importer;
-        const auto scene = importer.ReadFileFromMemory(data.data(), data.size(), aiProcessPreset_TargetRealtime_Quality);
-        if (scene == nullptr) {
-            return Failure(std::format("Failed to load model \"{}\": {}", source_path, importer.GetErrorString()));
+    Result<ModelPtr> Model::Load(const String& source_path, const Vector<uint8_t>& data, const Vector<MaterialPtr>& materials, const bool deferred) {
+        const auto submeshes = ImportModel(data);
+        if (!submeshes.has_value()) {
+            return Failure(std::format("Failed to load model \"{}\": {}", source_path, submeshes.error().message));
         }
 
         Vector<MeshPtr> meshes;
-        if (const auto proc_result = ProcessModelNodes(source_path, scene, scene->mRootNode, meshes, materials); !proc_result.has_value()) {
-            return Failure(std::format("Failed to load model \"{}\": {}", source_path, proc_result.error().message));
+        meshes.reserve(submeshes->size());
+        for (const auto& submesh : submeshes.value()) {
+            const auto material = FindModelMaterial(source_path, submesh.material_index, materials);
+            if (deferred) {
+                const auto* bytes = reinterpret_cast<const std::byte*>(submesh.vertices.data());
+                MeshUploadPayload payload {
+                    material, VertexLayout::Full, VertexQuantization { }, Vector<std::byte>(bytes, bytes + submesh.vertices.size() * sizeof(Vertex)),
+                    static_cast<uint32_t>(submesh.vertices.size()), { }, { }, BoundingSphere::FromVertices(submesh.vertices)
+                };
+                for (const auto& level : submesh.lods) {
+                    payload.lods.push_back(MeshLod { static_cast<GLuint>(payload.indices.size()), static_cast<GLsizei>(level.indices.size()), level.error });
+                    payload.indices.insert(payload.indices.end(), level.indices.begin(), level.indices.end());
+                }
+                meshes.emplace_back(UploadQueue::Instance().enqueue(std::move(payload)));
+                continue;
+            }
+            const auto mesh_result = Mesh::CreateWithLods(material, submesh.vertices, submesh.lods);
+            if (!mesh_result.has_value()) {
+                return Failure(std::format("Failed to load model \"{}\": Failed to load mesh data: {}", source_path, mesh_result.error().message));
+            }
+            meshes.emplace_back(std::move(mesh_result.value()));
         }
         return Success<ModelPtr>(std::move(std::make_shared<Model>(meshes)));
     }
 
+    Result<ModelPtr> Model::LoadCooked(const String& source_path, const Vector<uint8_t>& data, const Vector<MaterialPtr>& materials, const bool deferred) {
+        const auto file = ReadMeshFile(std::as_bytes(std::span(data)));
+        if (!file.has_value()) {
+            return Failure(std::format("Failed to load model \"{}\": {}", source_path, file.error().message));
+        }
+
+        // Buffers are uploaded straight from the loaded file, deferred uploads need their own copy as the file goes away.
+        Vector<MeshPtr> meshes;
+        meshes.reserve(file->submeshes.size());
+        for (const auto& submesh : file->submeshes) {
+            const auto material = FindModelMaterial(source_path, submesh.material_index, materials);
+            const auto vertex_data = file->vertex_data.subspan(submesh.vertex_offset, static_cast<size_t>(submesh.vertex_count) * file->layout.stride());
+            const auto indices = file->indices.subspan(submesh.index_offset, submesh.index_count);
+            if (deferred) {
+                meshes.emplace_back(UploadQueue::Instance().enqueue(MeshUploadPayload {
+                    material, file->layout, submesh.quantization, Vector<std::byte>(vertex_data.begin(), vertex_data.end()), submesh.vertex_count,
+                    Vector<GLuint>(indices.begin(), indices.end()), submesh.lods, submesh.bounds
+                }));
+                continue;
+            }
+            const auto mesh_result = Mesh::CreateFromEncoded(
+                material, file->layout, submesh.quantization, vertex_data.data(), submesh.vertex_count,
+                indices.data(), submesh.index_count, submesh.lods, submesh.bounds
+            );
+            if (!mesh_result.has_value()) {
+                return Failure(std::format("Failed to load model \"{}\": Failed to load mesh data: {}", source_path, mesh_result.error().message));
+            }
+            meshes.emplace_back(std::move(mesh_result.value()));
+        }
+        return Success<ModelPtr>(std::move(std::make_shared<Model>(meshes)));
+    }
+
+    Result<CookedModel> Model::Cook(const String& source_path, const Vector<uint8_t>& data, const VertexLayout& layout) {
+        const auto submeshes = ImportModel(data);
+        if (!submeshes.has_value()) {
+            return Failure(std::format("Failed to cook model \"{}\": {}", source_path, submeshes.error().message));
+        }
+
+        CookedModel model;
+        model.layout = layout;
+        Vector<Vertex> all_vertices;
+        for (const auto& submesh : submeshes.value()) {
+            CookedSubmesh cooked {
+                submesh.material_index,
+                static_cast<uint32_t>(model.vertex_data.size()), static_cast<uint32_t>(submesh.vertices.size()),
+                static_cast<uint32_t>(model.indices.size()), 0,
+                VertexQuantization { }, BoundingSphere::FromVertices(submesh.vertices), { }
+            };
+            if (layout == VertexLayout::Full) {
+                const auto* bytes = reinterpret_cast<const std::byte*>(submesh.vertices.data());
+                model.vertex_data.insert(model.vertex_data.end(), bytes, bytes + submesh.vertices.size() * sizeof(Vertex));
+            } else {
+                const auto encoded = layout.encode(submesh.vertices, cooked.quantization);
+                model.vertex_data.insert(model.vertex_data.end(), encoded.begin(), encoded.end());
+            }
+            for (const auto& level : submesh.lods) {
+                cooked.lods.push_back(MeshLod { cooked.index_count, static_cast<GLsizei>(level.indices.size()), level.error });
+                model.indices.insert(model.indices.end(), level.indices.begin(), level.indices.end());
+                cooked.index_count += static_cast<uint32_t>(level.indices.size());
+            }
+            model.material_count = std::max(model.material_count, submesh.material_index + 1);
+            all_vertices.insert(all_vertices.end(), submesh.vertices.begin(), submesh.vertices.end());
+            model.submeshes.push_back(std::move(cooked));
+        }
+        model.bounds = BoundingSphere::FromVertices(all_vertices);
+        return Success<CookedModel>(std::move(model));
+    }
+
+    void ModelInstance::draw(const Transform& transform) const {
+        if (m_pModel != nullptr) {
+            m_pModel->draw(transform.matrix(), m_lods);
+        }
+    }
+    bool ModelInstance::enqueue_draws(MultiDrawBuilder& builder, const Transform& transform) const {
+        return m_pModel == nullptr || m_pModel->enqueue_draws(builder, transform.matrix(), m_lods);
+    }
+
     Result<ModelPtr> Model::LoadAsset(const Path& path, const AssetLoaderFlags::Type flags) {
+        const bool deferred = (flags & AssetLoaderFlags::Deferred) != 0;
         if (path.extension().equals(".xml", StringCompareType::CaseInsensitive)) {
             const auto doc = Assets::LoadAsXml(path, flags);
             if (!doc.has_value()) {
@@ -207,8 +369,19 @@ namespace fow {
                     ++i;
                 }
             }
-            return Load(path.as_string(), data.value(), materials);
+            // Cooked sources skip the import, everything else goes through assimp at load time.
+            if (Path(src_node.child_value()).extension().equals(FOW_MESH_FILE_EXTENSION, StringCompareType::CaseInsensitive)) {
+                return LoadCooked(path.as_string(), data.value(), materials, deferred);
+            }
+            return Load(path.as_string(), data.value(), materials, deferred);
+        }
+        if (path.extension().equals(FOW_MESH_FILE_EXTENSION, StringCompareType::CaseInsensitive)) {
+            const auto data = Assets::LoadAsBytes(path, flags);
+            if (!data.has_value()) {
+                return Failure(std::format("Failed to load model \"{}\": Could not read model data", path));
+            }
+            return LoadCooked(path.as_string(), data.value(), { }, deferred);
         }
-        return Failure(std::format("Failed to load model \"{}\": Expected asset extension '.xml'", path));
+        return Failure(std::format("Failed to load model \"{}\": Expected asset extension '.xml' or '{}'", path, FOW_MESH_FILE_EXTENSION));
     }
 }
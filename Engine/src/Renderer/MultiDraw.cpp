@@ -0,0 +1,117 @@
+#include "fow/Renderer/MultiDraw.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/RenderQueue.hpp"
+#include "fow/Renderer.hpp"
+
+#include <algorithm>
+
+namespace fow {
+    MultiDrawBuilder::MultiDrawBuilder() : m_uCommandBuffer(0), m_uParamsBuffer(0), m_iCommandBufferSize(0), m_iParamsBufferSize(0) { }
+
+    MultiDrawBuilder::~MultiDrawBuilder() {
+        release();
+    }
+
+    void MultiDrawBuilder::add(const DrawItem& item) {
+        m_items.push_back(item);
+    }
+
+    void MultiDrawBuilder::build() {
+        // Draws of one program end up next to each other, so the program and the material only change between batches.
+        const auto key = [](const DrawItem& item) {
+            const Shader* shader = item.material != nullptr ? item.material->shader().get() : nullptr;
+            return std::make_tuple(shader, item.material.get(), item.arena, item.first_index);
+        };
+        std::ranges::stable_sort(m_items, { }, key);
+
+        m_commands.clear();
+        m_params.clear();
+        m_batches.clear();
+        m_materials.clear();
+        m_commands.reserve(m_items.size());
+        m_params.reserve(m_items.size());
+        for (const auto& item : m_items) {
+            if (m_batches.empty() || m_batches.back().material != item.material || m_batches.back().arena != item.arena) {
+                if (m_materials.empty() || m_materials.back() != item.material.get()) {
+                    m_materials.push_back(item.material.get());
+                }
+                m_batches.push_back(MultiDrawBatch { item.material, item.arena, static_cast<uint32_t>(m_commands.size()), 0 });
+            }
+            const auto draw_index = static_cast<GLuint>(m_commands.size());
+            m_commands.push_back(DrawElementsIndirectCommand { static_cast<GLuint>(item.index_count), 1, item.first_index, item.base_vertex, draw_index });
+            m_params.push_back(DrawParams {
+                item.model_matrix,
+                Vector4(item.quantization.scale, 0.0f),
+                Vector4(item.quantization.offset, 0.0f),
+                Vector4u { static_cast<uint32_t>(m_materials.size() - 1), 0u, 0u, 0u }
+            });
+            ++m_batches.back().command_count;
+        }
+    }
+
+    static void UploadBuffer(const GLenum target, GLuint& buffer, GLsizeiptr& capacity, const void* data, const GLsizeiptr size) {
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(target, buffer);
+        if (capacity < size) {
+            // Grows geometrically, the draw count changes a little every frame.
+            capacity = std::max(size, capacity * 2);
+            glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+        }
+        glBufferSubData(target, 0, size, data);
+    }
+
+    void MultiDrawBuilder::submit() const {
+        if (m_commands.empty()) {
+            return;
+        }
+        UploadBuffer(GL_SHADER_STORAGE_BUFFER, m_uParamsBuffer, m_iParamsBufferSize, m_params.data(), static_cast<GLsizeiptr>(m_params.size() * sizeof(DrawParams)));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FOW_SHADER_DRAW_PARAMS_BUFFER_BINDING, m_uParamsBuffer);
+        UploadBuffer(GL_DRAW_INDIRECT_BUFFER, m_uCommandBuffer, m_iCommandBufferSize, m_commands.data(), static_cast<GLsizeiptr>(m_commands.size() * sizeof(DrawElementsIndirectCommand)));
+
+        for (const auto& batch : m_batches) {
+            ShaderPtr shader;
+            if (batch.material != nullptr && batch.material->is_valid()) {
+                RenderQueue::ApplyCurrentSceneParamsToMaterial(batch.material);
+                Debug::Assert(batch.material->apply());
+                shader = batch.material->shader();
+            } else {
+                shader = Shader::PlaceHolder();
+                shader->use();
+            }
+            Debug::Assert(shader->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix()), "Error while applying uniform \"MATRIX_PROJECTION\"");
+            Debug::Assert(shader->set_uniform("MATRIX_VIEW", Renderer::GetViewMatrix()), "Error while applying uniform \"MATRIX_VIEW\"");
+            FOW_DISCARD(shader->set_uniform("VERTEX_FORMAT", batch.arena->layout().shader_flags()));
+            FOW_DISCARD(shader->set_uniform("MULTI_DRAW", true));
+            FOW_DISCARD(shader->set_uniform("DRAW_PARAMS_OFFSET", batch.first_command));
+
+            GlStateCache::Instance().bind_vertex_array(batch.arena->vao());
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void*>(batch.first_command * sizeof(DrawElementsIndirectCommand)),
+                                        static_cast<GLsizei>(batch.command_count), 0);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    void MultiDrawBuilder::clear() {
+        m_items.clear();
+        m_commands.clear();
+        m_params.clear();
+        m_batches.clear();
+        m_materials.clear();
+    }
+
+    void MultiDrawBuilder::release() {
+        clear();
+        if (m_uCommandBuffer != 0) {
+            glDeleteBuffers(1, &m_uCommandBuffer);
+            m_uCommandBuffer = 0;
+        }
+        if (m_uParamsBuffer != 0) {
+            glDeleteBuffers(1, &m_uParamsBuffer);
+            m_uParamsBuffer = 0;
+        }
+        m_iCommandBufferSize = m_iParamsBufferSize = 0;
+    }
+}
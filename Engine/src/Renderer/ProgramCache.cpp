@@ -0,0 +1,201 @@
+#include "fow/Renderer/ProgramCache.hpp"
+
+#include "fow/Shared/Filesys.hpp"
+
+#include <cstring>
+
+namespace fow {
+    struct ProgramCacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t source_hash;
+        uint64_t driver_hash;
+        uint32_t binary_format;
+        uint32_t binary_size;
+    };
+    static_assert(sizeof(ProgramCacheHeader) == 32);
+
+    static constexpr char ProgramCacheMagic[4] = { 'F', 'P', 'R', 'G' };
+
+    // FNV-1a, every part is prefixed with its length so moving text between the parts changes the hash.
+    static void HashBytes(uint64_t& hash, const void* data, const size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+    }
+    static void HashPart(uint64_t& hash, const std::string_view part) {
+        const uint64_t size = part.size();
+        HashBytes(hash, &size, sizeof(size));
+        HashBytes(hash, part.data(), part.size());
+    }
+
+    String ProgramCacheKey::filename() const {
+        return std::format("{:016x}{}", source_hash, FOW_PROGRAM_CACHE_EXTENSION);
+    }
+
+    ProgramCacheKey ProgramCacheKey::Create(const std::string_view vertex, const std::string_view fragment, const std::string_view defines, const std::string_view driver) {
+        ProgramCacheKey key { 0xCBF29CE484222325ull, 0xCBF29CE484222325ull };
+        HashPart(key.source_hash, vertex);
+        HashPart(key.source_hash, fragment);
+        HashPart(key.source_hash, defines);
+        HashPart(key.driver_hash, driver);
+        return key;
+    }
+
+    Vector<std::byte> WriteProgramCacheFile(const ProgramCacheKey& key, const ProgramBinary& binary) {
+        ProgramCacheHeader header { };
+        std::memcpy(header.magic, ProgramCacheMagic, sizeof(ProgramCacheMagic));
+        header.version = FOW_PROGRAM_CACHE_VERSION;
+        header.source_hash = key.source_hash;
+        header.driver_hash = key.driver_hash;
+        header.binary_format = binary.format;
+        header.binary_size = static_cast<uint32_t>(binary.data.size());
+
+        Vector<std::byte> out(sizeof(ProgramCacheHeader) + binary.data.size());
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(header), binary.data.data(), binary.data.size());
+        return out;
+    }
+
+    Result<ProgramBinary> ReadProgramCacheFile(const std::span<const std::byte> data, const ProgramCacheKey& key) {
+        if (data.size() < sizeof(ProgramCacheHeader)) {
+            return Failure("Program cache file is truncated");
+        }
+        ProgramCacheHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, ProgramCacheMagic, sizeof(ProgramCacheMagic)) != 0) {
+            return Failure("Not a program cache file");
+        }
+        if (header.version != FOW_PROGRAM_CACHE_VERSION) {
+            return Failure(std::format("Unsupported program cache file version {}, expected {}", header.version, FOW_PROGRAM_CACHE_VERSION));
+        }
+        if (header.source_hash != key.source_hash) {
+            return Failure("Program cache file was written for other sources");
+        }
+        if (header.driver_hash != key.driver_hash) {
+            return Failure("Program cache file was written by another driver");
+        }
+        if (data.size() - sizeof(ProgramCacheHeader) != header.binary_size) {
+            return Failure("Program cache file is truncated");
+        }
+
+        ProgramBinary binary;
+        binary.format = header.binary_format;
+        binary.data.assign(data.begin() + sizeof(ProgramCacheHeader), data.end());
+        return binary;
+    }
+
+    namespace ProgramCache {
+        static Path s_directory;
+        static Option<bool> s_supported = std::nullopt;
+        static Option<String> s_driver_id = std::nullopt;
+
+        void SetDirectory(const Path& directory) {
+            s_directory = directory;
+            if (!s_directory.is_empty() && !s_directory.exists() && !Path::CreateDirectory(s_directory, true)) {
+                Debug::LogWarning(std::format("Failed to create program cache directory \"{}\", the cache is disabled", s_directory));
+                s_directory = Path { };
+            }
+        }
+        Path GetDirectory() {
+            return s_directory;
+        }
+
+        bool IsEnabled() {
+            if (s_directory.is_empty()) {
+                return false;
+            }
+            if (!s_supported.has_value()) {
+                GLint format_count = 0;
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+                s_supported = format_count > 0;
+            }
+            return s_supported.value();
+        }
+
+        static String GlString(const GLenum name) {
+            const auto* value = reinterpret_cast<const char*>(glGetString(name));
+            return value != nullptr ? String(value) : String();
+        }
+
+        const String& DriverId() {
+            if (!s_driver_id.has_value()) {
+                s_driver_id = std::format("{}\n{}\n{}", GlString(GL_VENDOR), GlString(GL_RENDERER), GlString(GL_VERSION));
+            }
+            return s_driver_id.value();
+        }
+
+        ProgramCacheKey MakeKey(const std::string_view vertex, const std::string_view fragment, const std::string_view defines) {
+            const auto& driver = DriverId();
+            return ProgramCacheKey::Create(vertex, fragment, defines, std::string_view(driver.as_cstr(), driver.size()));
+        }
+
+        Option<GLuint> Load(const ProgramCacheKey& key) {
+            if (!IsEnabled()) {
+                return std::nullopt;
+            }
+            const auto path = s_directory / key.filename();
+            if (!path.exists()) {
+                return std::nullopt;
+            }
+            const auto file = Files::ReadAllBytes(path);
+            if (!file.has_value()) {
+                return std::nullopt;
+            }
+            const auto binary = ReadProgramCacheFile(std::as_bytes(std::span(file.value())), key);
+            if (!binary.has_value()) {
+                Debug::LogDebug(std::format("Ignoring cached program \"{}\": {}", path, binary.error().message));
+                return std::nullopt;
+            }
+
+            const GLuint program = glCreateProgram();
+            if (program == 0) {
+                return std::nullopt;
+            }
+            glProgramBinary(program, binary->format, binary->data.data(), static_cast<GLsizei>(binary->data.size()));
+            GLint status = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+            if (!status) {
+                // Drivers may reject binaries even when all strings match, the caller compiles and overwrites it.
+                glDeleteProgram(program);
+                return std::nullopt;
+            }
+            return program;
+        }
+
+        void Store(const ProgramCacheKey& key, const GLuint program) {
+            if (!IsEnabled()) {
+                return;
+            }
+            GLint size = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+            if (size <= 0) {
+                return;
+            }
+            ProgramBinary binary;
+            binary.data.resize(static_cast<size_t>(size));
+            GLsizei written = 0;
+            glGetProgramBinary(program, size, &written, &binary.format, binary.data.data());
+            if (written <= 0) {
+                return;
+            }
+            binary.data.resize(static_cast<size_t>(written));
+
+            const auto file = WriteProgramCacheFile(key, binary);
+            const auto* bytes = reinterpret_cast<const uint8_t*>(file.data());
+            if (const auto result = Files::WriteAllBytes(s_directory / key.filename(), Vector<uint8_t>(bytes, bytes + file.size())); !result.has_value()) {
+                Debug::LogWarning(std::format("Failed to write program cache: {}", result.error().message));
+            }
+        }
+
+        void Clear() {
+            if (s_directory.is_empty()) {
+                return;
+            }
+            for (const auto& path : s_directory.list_dir(String("*" FOW_PROGRAM_CACHE_EXTENSION))) {
+                path.remove();
+            }
+        }
+    }
+}
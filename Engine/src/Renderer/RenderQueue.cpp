@@ -1,12 +1,22 @@
 #include "fow/Renderer/RenderQueue.hpp"
 
 #include "fow/Renderer.hpp"
+#include "fow/Renderer/LightClusters.hpp"
+#include "fow/Renderer/MultiDraw.hpp"
+#include "fow/Renderer/SpriteBatch.hpp"
+#include "fow/Renderer/TextureAtlas.hpp"
+#include "fow/Renderer/UploadQueue.hpp"
 
 #define RENDERABLE_MESH   0
 #define RENDERABLE_MODEL  1
 #define RENDERABLE_SPRITE 2
 
 namespace fow {
+    float LightInfo::radius() const {
+        const float brightness = std::max({ color.r, color.g, color.b }) * intensity;
+        return brightness > 0.0f ? std::sqrt(brightness / FOW_LIGHT_ATTENUATION_CUTOFF) : 0.0f;
+    }
+
     namespace RenderQueue {
         struct Renderable {
             std::variant<
@@ -15,9 +25,39 @@ namespace fow {
             > object;
 
             void draw() const;
+            [[nodiscard]] bool enqueue_draws(MultiDrawBuilder& builder) const;
+        };
+
+        // Mirrors the std140 layout of the "SceneParams" uniform block.
+        struct SceneParams {
+            Matrix4 projection;
+            Matrix4 view;
+            Vector4 camera_position;
+            Vector4 sunlight_color;
+            Vector4 sunlight_direction;
+            Vector4 viewport;
+            Vector4u cluster_grid;      // xyz: grid size, w: 0 when the lights could not be clustered
+            Vector4 cluster_depth;      // x: near, y: far, z: depth slice scale, w: depth slice bias
+            float env_map_strength;
+            GLint light_count;
+            float padding[2];
+        };
+        static_assert(offsetof(SceneParams, cluster_grid) == 192);
+        static_assert(sizeof(SceneParams) == 240);
+
+        struct ImpostorBatch {
+            ImpostorPtr impostor;
+            Vector<ImpostorInstance> instances;
         };
 
         static Deque<Renderable> s_render_queue;
+        static Vector<ImpostorBatch> s_impostor_batches;
+        static SceneParams s_scene_params { };
+        static GLuint s_scene_ubo = 0;
+        static LightClusterGrid s_light_clusters;
+        static MultiDrawBuilder s_multi_draw;
+        static Vector<const Renderable*> s_direct_draws;
+        static Vector<ClusterLight> s_cluster_lights;
         static Vector<LightInfoPtr> s_lights;
         static Vector4 s_sunlight_color = Vector4(0.0f);
         static bool s_sunlight_enabled = false;
@@ -33,6 +73,14 @@ namespace fow {
         void EnqueueInstanced(const Ref<IDrawable3DInstanced>& drawable, const Vector<Transform>& transforms) {
             s_render_queue.push_back(Renderable { std::make_tuple(drawable, transforms) });
         }
+        void EnqueueImpostor(const ImpostorPtr& impostor, const Matrix4& model_matrix) {
+            // Only a handful of different impostors are visible at once, a linear search beats hashing here.
+            auto it = std::ranges::find(s_impostor_batches, impostor, &ImpostorBatch::impostor);
+            if (it == s_impostor_batches.end()) {
+                it = s_impostor_batches.insert(it, ImpostorBatch { impostor, { } });
+            }
+            it->instances.push_back(MakeImpostorInstance(impostor->bounds(), model_matrix));
+        }
 
         void SetSkybox(const SkyboxPtr& skybox) {
             s_skybox = skybox;
@@ -90,13 +138,76 @@ namespace fow {
         }
 
         void Render() {
+            // Resources finished by loader threads become resident before anything is drawn.
+            UploadQueue::Instance().process();
+            UpdateSceneParams();
             if (s_skybox != nullptr) {
                 s_skybox->draw();
             }
-            while (!s_render_queue.empty()) {
-                s_render_queue.front().draw();
-                s_render_queue.pop_front();
+            // Opaque meshes that live in a mesh arena are collected into multi-draw batches and drawn first, everything
+            // drawn one by one comes after them in queue order, so transparent meshes blend over the opaque geometry.
+            for (const auto& renderable : s_render_queue) {
+                if (!renderable.enqueue_draws(s_multi_draw)) {
+                    s_direct_draws.push_back(&renderable);
+                }
+            }
+            s_multi_draw.build();
+            s_multi_draw.submit();
+            s_multi_draw.clear();
+            // Batches stay around with their storage while their impostor keeps being drawn.
+            std::erase_if(s_impostor_batches, [](const ImpostorBatch& batch) { return batch.instances.empty(); });
+            for (auto& batch : s_impostor_batches) {
+                batch.impostor->draw_instances(batch.instances);
+                batch.instances.clear();
+            }
+            for (const auto* renderable : s_direct_draws) {
+                renderable->draw();
+            }
+            s_direct_draws.clear();
+            s_render_queue.clear();
+        }
+
+        void UpdateSceneParams() {
+            s_scene_params.projection = Renderer::GetProjectionMatrix();
+            s_scene_params.view = Renderer::GetViewMatrix();
+            s_scene_params.camera_position = Vector4(Renderer::GetCameraPosition(), 1.0f);
+
+            const bool has_sunlight = s_sunlight_enabled && s_sunlight_transform != nullptr;
+            s_scene_params.sunlight_color = has_sunlight ? s_sunlight_color : Vector4(0.0f);
+            s_scene_params.sunlight_direction = Vector4(has_sunlight ? s_sunlight_transform->get_forward() : Vector3Constants::Zero, 0.0f);
+            s_scene_params.env_map_strength = s_envMapIntensity;
+
+            const auto viewport = Renderer::GetViewport();
+            s_scene_params.viewport = Vector4 { viewport.x, viewport.y, viewport.width, viewport.height };
+
+            s_cluster_lights.clear();
+            for (const auto& light : s_lights) {
+                if (!light->enabled) {
+                    continue;
+                }
+                s_cluster_lights.push_back(ClusterLight {
+                    Vector4(light->transform != nullptr ? light->transform->get_position() : Vector3Constants::Zero, light->radius()),
+                    Vector4(light->color, light->intensity)
+                });
+            }
+            s_scene_params.light_count = static_cast<GLint>(s_cluster_lights.size());
+
+            // Without clustering (e.g. orthographic cameras) shaders fall back to iterating every light.
+            const bool clustered = s_light_clusters.assign(s_scene_params.view, s_scene_params.projection, s_cluster_lights).has_value();
+            s_scene_params.cluster_grid = Vector4u { s_light_clusters.size(), clustered ? 1u : 0u };
+            s_scene_params.cluster_depth = Vector4 { s_light_clusters.near_plane(), s_light_clusters.far_plane(), s_light_clusters.depth_slice_params() };
+            s_light_clusters.upload(s_cluster_lights);
+
+            if (s_scene_ubo == 0) {
+                glGenBuffers(1, &s_scene_ubo);
+                glBindBuffer(GL_UNIFORM_BUFFER, s_scene_ubo);
+                glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneParams), nullptr, GL_DYNAMIC_DRAW);
+            } else {
+                glBindBuffer(GL_UNIFORM_BUFFER, s_scene_ubo);
             }
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SceneParams), &s_scene_params);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            glBindBufferBase(GL_UNIFORM_BUFFER, FOW_SHADER_SCENE_BLOCK_BINDING, s_scene_ubo);
         }
 
         void ApplyCurrentSceneParamsToMaterial(const MaterialPtr& mat) {
@@ -104,23 +215,24 @@ namespace fow {
                 return;
             }
 
-            size_t i = 0;
-            for (const auto& light : s_lights) {
-                Debug::Assert(mat->set_parameter_optional(std::format("Lights[{}].Position", i), light->transform != nullptr ? light->transform->get_position() : Vector3Constants::Zero));
-                Debug::Assert(mat->set_parameter_optional(std::format("Lights[{}].Color", i), Vector4(light->color, light->intensity)));
-                ++i;
-            }
-            Debug::Assert(mat->set_parameter_optional("LightCount", static_cast<GLuint>(s_lights.size())));
-            Debug::Assert(mat->set_parameter_optional("SunLightColor", s_sunlight_color));
-            Debug::Assert(mat->set_parameter_optional("SunLightDir", s_sunlight_transform->get_forward()));
-
+            // Everything else is read from the scene uniform block, only samplers are bound per material.
             if (s_envMap != nullptr) {
                 Debug::Assert(mat->set_parameter_optional("EnvMap", s_envMap));
             }
             if (s_envMapBlur != nullptr) {
                 Debug::Assert(mat->set_parameter_optional("EnvMapBlur", s_envMapBlur));
             }
-            Debug::Assert(mat->set_parameter_optional("EnvMapStrength", s_envMapIntensity));
+        }
+
+        void Release() {
+            s_render_queue.clear();
+            s_impostor_batches.clear();
+            s_light_clusters.release();
+            s_multi_draw.release();
+            if (s_scene_ubo != 0) {
+                glDeleteBuffers(1, &s_scene_ubo);
+                s_scene_ubo = 0;
+            }
         }
 
         inline void Renderable::draw() const {
@@ -132,38 +244,47 @@ namespace fow {
                 std::get<0>(r)->draw_instances(std::get<1>(r));
             }
         }
+        inline bool Renderable::enqueue_draws(MultiDrawBuilder& builder) const {
+            if (object.index() == 0) {
+                const auto& r = std::get<0>(object);
+                return std::get<0>(r)->enqueue_draws(builder, std::get<1>(r));
+            }
+            return false;
+        }
     }
 
     namespace RenderQueue2D {
         struct Renderable {
-            std::variant<Sprite2DPtr, TextSprite2DPtr> object;
+            Ref<IDrawable2D> drawable;
             Rectangle rectangle;
-
-            void draw() const;
+            int32_t layer;
         };
 
-        static Deque<Renderable> s_render_queue;
+        static Vector<Renderable> s_render_queue;
 
-        void Enqueue(const Sprite2DPtr& sprite, const Rectangle& rectangle) {
-            s_render_queue.push_back(Renderable { sprite, rectangle });
-        }
-        void Enqueue(const TextSprite2DPtr& sprite, const Rectangle& rectangle) {
-            s_render_queue.push_back(Renderable { sprite, rectangle });
+        void Enqueue(const Ref<IDrawable2D>& drawable, const Rectangle& rectangle, const int32_t layer) {
+            if (drawable != nullptr) {
+                s_render_queue.push_back(Renderable { drawable, rectangle, layer });
+            }
         }
 
         void Render() {
-            while (!s_render_queue.empty()) {
-                s_render_queue.front().draw();
-                s_render_queue.pop_front();
-            }
-        }
+            std::ranges::stable_sort(s_render_queue, { }, &Renderable::layer);
+            // Textures loaded since the last frame join their pages before any quad looks them up.
+            TextureAtlas::Instance().update();
 
-        inline void Renderable::draw() const {
-            if (object.index() == 0) {
-                std::get<0>(object)->draw_2d(rectangle);
-            } else {
-                std::get<1>(object)->draw_2d(rectangle);
+            auto& batch = SpriteBatch2D::Instance();
+            for (const auto& renderable : s_render_queue) {
+                batch.set_layer(renderable.layer);
+                if (!renderable.drawable->batch_2d(batch, renderable.rectangle)) {
+                    // Everything batched so far lies below the drawable.
+                    batch.flush();
+                    renderable.drawable->draw_2d(renderable.rectangle);
+                }
             }
+            batch.flush();
+            batch.set_layer(0);
+            s_render_queue.clear();
         }
     }
-}
\ No newline at end of file
+}
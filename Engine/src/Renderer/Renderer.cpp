@@ -1,6 +1,8 @@
 #include "fow/Renderer/GL.hpp"
 #include "fow/Renderer.hpp"
 #include "fow/Renderer/ShaderLib.hpp"
+#include "fow/Renderer/MeshArena.hpp"
+#include "fow/Renderer/UploadQueue.hpp"
 
 namespace fow {
     namespace Renderer {
@@ -30,6 +32,11 @@ namespace fow {
             if (const auto result = ShaderLib::Load(s_base_path); !result.has_value()) {
                 return result;
             }
+            if (const auto bundle_path = s_base_path / FOW_SHADER_BUNDLE_FILENAME; bundle_path.exists()) {
+                if (const auto result = ShaderBundle::Load(bundle_path); !result.has_value()) {
+                    Debug::LogWarning(result.error().message);
+                }
+            }
 
             s_pTextEngine = TTF_CreateSurfaceTextEngine();
             if (s_pTextEngine == nullptr) {
@@ -43,15 +50,12 @@ namespace fow {
 
             Debug::LogInfo(std::format("Initialized OpenGL v{}", reinterpret_cast<const char*>(glGetString(GL_VERSION))));
 
-            if (msaa > 0) {
-                glEnable(GL_MULTISAMPLE);
-            } else {
-                glDisable(GL_MULTISAMPLE);
-            }
-
-            glEnable(GL_CULL_FACE);
-            glEnable(GL_DEPTH_TEST);
-            glDepthFunc(GL_LESS);
+            auto& state = GlStateCache::Instance();
+            state.invalidate();
+            state.set_enabled(GL_MULTISAMPLE, msaa > 0);
+            state.set_enabled(GL_CULL_FACE, true);
+            state.set_enabled(GL_DEPTH_TEST, true);
+            state.set_depth_func(GL_LESS);
 
             s_initialized = true;
 
@@ -100,6 +104,14 @@ namespace fow {
                 s_pFontLibrary = nullptr;
             }
             Debug::FreeDebugMesh();
+            RenderQueue::Release();
+            UploadQueue::Instance().release();
+            GlyphAtlas::Instance().release();
+            TextLayoutCache::Instance().clear();
+            SpriteBatch2D::Instance().release();
+            TextureAtlas::Instance().release();
+            MeshArena::ReleaseAll();
+            ShaderBundle::Unload();
             ShaderLib::Unload();
         }
 
@@ -108,11 +120,10 @@ namespace fow {
         }
 
         void EnableBlend(const bool enabled, BlendFactor src, BlendFactor dst) {
+            auto& state = GlStateCache::Instance();
+            state.set_enabled(GL_BLEND, enabled);
             if (enabled) {
-                glEnable(GL_BLEND);
-                glBlendFunc(static_cast<GLenum>(src), static_cast<GLenum>(dst));
-            } else {
-                glDisable(GL_BLEND);
+                state.set_blend_func(static_cast<GLenum>(src), static_cast<GLenum>(dst));
             }
         }
 
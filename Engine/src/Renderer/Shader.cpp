@@ -1,6 +1,10 @@
 #include "fow/Renderer/GL.hpp"
 #include "fow/Renderer/Shader.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/ProgramCache.hpp"
+#include "fow/Renderer/ShaderBundle.hpp"
 
+#include <algorithm>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "fow/Shared/StringConversion.hpp"
@@ -8,16 +12,17 @@
 namespace fow {
     Shader::~Shader() {
         if (m_uProgram != 0 && m_bInitialized) {
+            GlStateCache::Instance().forget_program(m_uProgram);
             glDeleteProgram(m_uProgram);
         }
     }
 
     void Shader::use() const {
-        glUseProgram(m_uProgram);
+        GlStateCache::Instance().use_program(m_uProgram);
     }
 
     bool Shader::set_uniform(const String& name, const bool value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -25,7 +30,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const GLint value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -33,7 +38,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const GLuint value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -41,7 +46,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const GLfloat value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -49,7 +54,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const GLdouble value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -57,7 +62,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector2b& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -65,7 +70,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector3b& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -73,7 +78,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector4b& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -81,7 +86,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector2i& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -89,7 +94,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector3i& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -97,7 +102,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector4i& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -105,7 +110,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector2u& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -113,7 +118,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector3u& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -121,7 +126,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector4u& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -129,7 +134,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector2& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -137,7 +142,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector3& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -145,7 +150,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector4& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -153,7 +158,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const glm::dvec2& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -161,7 +166,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const glm::dvec3& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -169,7 +174,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const glm::dvec4& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -177,7 +182,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Matrix4& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -194,7 +199,7 @@ namespace fow {
         return set_uniform(name, uint_values);
     }
     bool Shader::set_uniform(const String& name, const Vector<GLint>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -202,7 +207,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<GLuint>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -210,7 +215,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<GLfloat>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -218,7 +223,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<GLdouble>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -226,7 +231,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector2i>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -234,7 +239,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector3i>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -242,7 +247,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector4i>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -250,7 +255,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector2u>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -258,7 +263,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector3u>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -266,7 +271,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector4u>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -274,7 +279,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector2>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -282,7 +287,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector3>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -290,7 +295,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Vector4>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -298,7 +303,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<glm::dvec2>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -306,7 +311,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<glm::dvec3>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -314,7 +319,7 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<glm::dvec4>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -322,20 +327,12 @@ namespace fow {
         return true;
     }
     bool Shader::set_uniform(const String& name, const Vector<Matrix4>& values) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
 
-        Vector<GLfloat> float_data(values.size() * 16);
-        for (const auto& value : values) {
-            const auto& p = glm::value_ptr(value);
-            for (uint8_t i = 0; i < 16; ++i) {
-                float_data.emplace_back(p[i]);
-            }
-        }
-
-        glUniformMatrix4fv(loc, values.size(), GL_FALSE, float_data.data());
+        glUniformMatrix4fv(loc, values.size(), GL_FALSE, reinterpret_cast<const GLfloat*>(values.data()));
         return true;
     }
 
@@ -400,7 +397,7 @@ namespace fow {
         glUniform4d(location, value.x, value.y, value.z, value.w);
     }
     void Shader::set_uniform(const GLint location, const Matrix4& value) const {
-        glUniformMatrix4fv(location, 16, GL_TRUE, &value[0][0]);
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
     }
 
     void Shader::set_uniform(const GLint location, const Vector<bool>& values) const {
@@ -460,19 +457,11 @@ namespace fow {
         glUniform4dv(location, values.size(), reinterpret_cast<const GLdouble*>(values.data()));
     }
     void Shader::set_uniform(const GLint location, const Vector<Matrix4>& values) const {
-        Vector<GLfloat> float_data(values.size() * 16);
-        for (const auto& value : values) {
-            const auto& p = glm::value_ptr(value);
-            for (uint8_t i = 0; i < 16; ++i) {
-                float_data.emplace_back(p[i]);
-            }
-        }
-
-        glUniformMatrix4fv(location, values.size(), GL_FALSE, float_data.data());
+        glUniformMatrix4fv(location, values.size(), GL_FALSE, reinterpret_cast<const GLfloat*>(values.data()));
     }
 
     bool Shader::get_uniform(const String& name, bool& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -482,7 +471,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, GLint& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -490,7 +479,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, GLuint& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -498,7 +487,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, GLfloat& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -506,7 +495,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, GLdouble& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -514,7 +503,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector2b& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -524,7 +513,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector3b& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -534,7 +523,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector4b& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -544,7 +533,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector2i& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -552,7 +541,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector3i& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -560,7 +549,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector4i& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -568,7 +557,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector2u& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -576,7 +565,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector3u& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -584,7 +573,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector4u& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -592,7 +581,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector2& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -600,7 +589,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector3& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -608,7 +597,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, Vector4& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -616,7 +605,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, glm::dvec2& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -624,7 +613,7 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, glm::dvec3& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -632,14 +621,14 @@ namespace fow {
         return true;
     }
     bool Shader::get_uniform(const String& name, glm::dvec4& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
         return true;
     }
     bool Shader::get_uniform(const String& name, Matrix4& value) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
+        const GLint loc = uniform_location(name);
         if (loc < 0) {
             return false;
         }
@@ -647,67 +636,190 @@ namespace fow {
         return true;
     }
 
-    GLint Shader::uniform_location(const String& name) const {
-        return glGetUniformLocation(m_uProgram, name.as_cstr());
-    }
+    void ParseShaderUniformDefaults(const String& source, HashMap<String, String>& defaults) {
+        constexpr std::string_view marker = "// default:";
+        const std::string_view src(source.as_cstr(), source.size());
+        size_t line_start = 0;
+        while (line_start < src.size()) {
+            size_t line_end = src.find('\n', line_start);
+            if (line_end == std::string_view::npos) {
+                line_end = src.size();
+            }
+            const auto line = src.substr(line_start, line_end - line_start);
+            line_start = line_end + 1;
 
-    Result<ShaderUniformInfo> Shader::get_uniform_info(const String& name) const {
-        const GLint loc = glGetUniformLocation(m_uProgram, name.as_cstr());
-        if (loc < 0) {
-            return Failure(std::format("No such uniform \"{}\"", name));
+            const auto marker_pos = line.find(marker);
+            if (marker_pos == std::string_view::npos) {
+                continue;
+            }
+            const auto semicolon = line.rfind(';', marker_pos);
+            if (semicolon == std::string_view::npos) {
+                continue;
+            }
+            auto declaration = line.substr(0, semicolon);
+            declaration = declaration.substr(0, declaration.find_last_not_of(" \t") + 1);
+            const auto name = declaration.substr(declaration.find_last_of(" \t") + 1);
+
+            auto value = line.substr(marker_pos + marker.size());
+            value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+            value = value.substr(0, value.find_last_not_of(" \t\r") + 1);
+            if (!name.empty() && !value.empty()) {
+                defaults.insert_or_assign(String(name), String(value));
+            }
         }
-        return get_uniform_info(loc);
     }
 
-    Result<ShaderUniformInfo> Shader::get_uniform_info(const GLint location) const {
-        if (location < 0) {
-            return Failure(std::format("Uniform location {} is out of range", location));
+    void Shader::reflect(const HashMap<String, String>& defaults) {
+        m_uniforms.clear();
+        m_uniform_lookup.clear();
+        m_uniform_locations.clear();
+        m_uniform_blocks.clear();
+
+        GLint block_count = 0, max_block_name_length = 0;
+        glGetProgramInterfaceiv(m_uProgram, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &block_count);
+        glGetProgramInterfaceiv(m_uProgram, GL_UNIFORM_BLOCK, GL_MAX_NAME_LENGTH, &max_block_name_length);
+        m_uniform_blocks.reserve(block_count);
+
+        constexpr GLenum block_properties[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+        std::string block_name_buffer(std::max(max_block_name_length, 1), '\0');
+        for (GLint i = 0; i < block_count; ++i) {
+            GLint results[2];
+            glGetProgramResourceiv(m_uProgram, GL_UNIFORM_BLOCK, i, 2, block_properties, 2, nullptr, results);
+
+            GLsizei name_length = 0;
+            glGetProgramResourceName(m_uProgram, GL_UNIFORM_BLOCK, i, max_block_name_length, &name_length, block_name_buffer.data());
+            const std::string_view name(block_name_buffer.data(), name_length);
+            if (name == FOW_SHADER_SCENE_BLOCK_NAME) {
+                glUniformBlockBinding(m_uProgram, i, FOW_SHADER_SCENE_BLOCK_BINDING);
+                results[0] = FOW_SHADER_SCENE_BLOCK_BINDING;
+            } else if (name == FOW_SHADER_MATERIAL_BLOCK_NAME) {
+                glUniformBlockBinding(m_uProgram, i, FOW_SHADER_MATERIAL_BLOCK_BINDING);
+                results[0] = FOW_SHADER_MATERIAL_BLOCK_BINDING;
+            }
+            m_uniform_blocks.emplace_back(ShaderUniformBlockInfo { String(name), i, results[0], results[1] });
         }
 
-        if (!glIsProgram(m_uProgram)) {
-            return Failure(std::format("Shader with id {} is not a valid Shader program!", m_uProgram));
+        GLint storage_block_count = 0, max_storage_name_length = 0;
+        glGetProgramInterfaceiv(m_uProgram, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &storage_block_count);
+        glGetProgramInterfaceiv(m_uProgram, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &max_storage_name_length);
+        std::string storage_name_buffer(std::max(max_storage_name_length, 1), '\0');
+        for (GLint i = 0; i < storage_block_count; ++i) {
+            GLsizei name_length = 0;
+            glGetProgramResourceName(m_uProgram, GL_SHADER_STORAGE_BLOCK, i, max_storage_name_length, &name_length, storage_name_buffer.data());
+            const std::string_view name(storage_name_buffer.data(), name_length);
+            if (name == FOW_SHADER_LIGHT_BUFFER_NAME) {
+                glShaderStorageBlockBinding(m_uProgram, i, FOW_SHADER_LIGHT_BUFFER_BINDING);
+            } else if (name == FOW_SHADER_CLUSTER_BUFFER_NAME) {
+                glShaderStorageBlockBinding(m_uProgram, i, FOW_SHADER_CLUSTER_BUFFER_BINDING);
+            } else if (name == FOW_SHADER_CLUSTER_INDEX_BUFFER_NAME) {
+                glShaderStorageBlockBinding(m_uProgram, i, FOW_SHADER_CLUSTER_INDEX_BUFFER_BINDING);
+            } else if (name == FOW_SHADER_DRAW_PARAMS_BUFFER_NAME) {
+                glShaderStorageBlockBinding(m_uProgram, i, FOW_SHADER_DRAW_PARAMS_BUFFER_BINDING);
+            } else if (name == FOW_SHADER_IMPOSTOR_INSTANCE_BUFFER_NAME) {
+                glShaderStorageBlockBinding(m_uProgram, i, FOW_SHADER_IMPOSTOR_INSTANCE_BUFFER_BINDING);
+            }
         }
 
-        GLint uniform_count;
+        GLint uniform_count = 0, max_name_length = 0;
         glGetProgramInterfaceiv(m_uProgram, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniform_count);
+        glGetProgramInterfaceiv(m_uProgram, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length);
+        m_uniforms.reserve(uniform_count);
 
+        constexpr GLenum properties[] = { GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE, GL_BLOCK_INDEX, GL_OFFSET };
+        std::string name_buffer(std::max(max_name_length, 1), '\0');
+        for (GLint i = 0; i < uniform_count; ++i) {
+            GLint results[5];
+            glGetProgramResourceiv(m_uProgram, GL_UNIFORM, i, 5, properties, 5, nullptr, results);
 
-        constexpr GLenum properties[] = { GL_LOCATION, GL_TYPE, GL_NAME_LENGTH };
-        for (size_t i = 0; i < uniform_count; i++) {
-            GLint results[3];
-            glGetProgramResourceiv(m_uProgram, GL_UNIFORM, i, 3, properties, 3, nullptr, results);
-            if (results[0] == location) {
-                String name(1024);
-                glGetProgramResourceName(m_uProgram, GL_UNIFORM, i, name.capacity(), nullptr, name.data());
-                name.recalculate_size();
+            GLsizei name_length = 0;
+            glGetProgramResourceName(m_uProgram, GL_UNIFORM, i, max_name_length, &name_length, name_buffer.data());
+            const std::string name(name_buffer.data(), name_length);
 
-                ShaderUniformInfo info;
-                info.name = name;
-                info.location = location;
-                info.type = static_cast<ShaderUniformType>(results[1]);
+            const size_t index = m_uniforms.size();
+            m_uniforms.emplace_back(ShaderUniformInfo {
+                .name = String(name),
+                .location = results[0],
+                .type = static_cast<ShaderUniformType>(results[1]),
+                .array_size = results[2],
+                .block_index = results[3],
+                .block_offset = results[4]
+            });
+            if (const auto it = defaults.find(m_uniforms.back().name); it != defaults.end()) {
+                m_uniforms.back().default_value = it->second;
+            }
+            if (results[0] >= 0) {
+                m_uniform_locations.emplace(results[0], index);
+            }
+            m_uniform_lookup.emplace(name, ShaderUniformSlot { index, results[0] });
 
-                return Success<ShaderUniformInfo>(info);
+            // Plain arrays are reported once as "name[0]", expose the base name and every element as well.
+            if (name.ends_with("[0]")) {
+                const auto base = name.substr(0, name.size() - 3);
+                m_uniform_lookup.emplace(base, ShaderUniformSlot { index, results[0] });
+                for (GLint element = 1; element < results[2] && results[0] >= 0; ++element) {
+                    auto element_name = std::format("{}[{}]", base, element);
+                    const GLint location = glGetUniformLocation(m_uProgram, element_name.c_str());
+                    m_uniform_lookup.emplace(std::move(element_name), ShaderUniformSlot { index, location });
+                }
             }
         }
+    }
 
-        return Failure(std::format("Uniform at location {} not found!", location));
+    GLint Shader::uniform_location(const std::string_view name) const {
+        if (const auto it = m_uniform_lookup.find(name); it != m_uniform_lookup.end()) {
+            return it->second.location;
+        }
+        return -1;
+    }
+
+    const ShaderUniformInfo* Shader::find_uniform(const std::string_view name) const {
+        if (const auto it = m_uniform_lookup.find(name); it != m_uniform_lookup.end()) {
+            return &m_uniforms[it->second.index];
+        }
+        return nullptr;
+    }
+
+    const ShaderUniformBlockInfo* Shader::find_uniform_block(const std::string_view name) const {
+        for (const auto& block : m_uniform_blocks) {
+            if (std::string_view(block.name.as_cstr(), block.name.size()) == name) {
+                return &block;
+            }
+        }
+        return nullptr;
     }
 
-    size_t Shader::get_uniform_count() const {
-        GLint count = 0;
-        glGetProgramiv(m_uProgram, GL_ACTIVE_UNIFORMS, &count);
-        return count;
+    ssize_t Shader::uniform_index(const std::string_view name) const {
+        if (const auto it = m_uniform_lookup.find(name); it != m_uniform_lookup.end() && it->second.location == m_uniforms[it->second.index].location) {
+            return static_cast<ssize_t>(it->second.index);
+        }
+        return -1;
+    }
+
+    Result<ShaderUniformInfo> Shader::get_uniform_info(const String& name) const {
+        const auto it = m_uniform_lookup.find(std::string_view(name.as_cstr(), name.size()));
+        if (it == m_uniform_lookup.end() || it->second.location < 0) {
+            return Failure(std::format("No such uniform \"{}\"", name));
+        }
+        auto info = m_uniforms[it->second.index];
+        info.location = it->second.location;
+        return Success<ShaderUniformInfo>(std::move(info));
+    }
+
+    Result<ShaderUniformInfo> Shader::get_uniform_info(const GLint location) const {
+        if (location < 0) {
+            return Failure(std::format("Uniform location {} is out of range", location));
+        }
+        if (const auto it = m_uniform_locations.find(location); it != m_uniform_locations.end()) {
+            return Success<ShaderUniformInfo>(m_uniforms[it->second]);
+        }
+        return Failure(std::format("Uniform at location {} not found!", location));
     }
 
     HashMap<String, ShaderUniformInfo> Shader::list_uniforms() const {
         HashMap<String, ShaderUniformInfo> uniforms;
-        int count = 0;
-        glGetProgramiv(m_uProgram, GL_ACTIVE_UNIFORMS, &count);
-        uniforms.reserve(count);
-        for (int i = 0; i < count; ++i) {
-            if (const auto info = get_uniform_info(i); info.has_value()) {
-                uniforms.emplace(info->name, info.value());
-            }
+        uniforms.reserve(m_uniforms.size());
+        for (const auto& info : m_uniforms) {
+            uniforms.emplace(info.name, info);
         }
         return uniforms;
     }
@@ -717,6 +829,24 @@ namespace fow {
             return FromCache(name);
         }
 
+        if (auto cooked = ShaderBundle::TryLoad(name, vertex, fragment); cooked != nullptr) {
+            return Success<ShaderPtr>(std::move(cooked));
+        }
+
+        HashMap<String, String> defaults;
+        ParseShaderUniformDefaults(vertex, defaults);
+        ParseShaderUniformDefaults(fragment, defaults);
+
+        // A binary linked by an earlier run skips compiling and linking entirely, anything wrong with it falls back to
+        // compiling from source.
+        Option<ProgramCacheKey> cache_key = std::nullopt;
+        if (ProgramCache::IsEnabled()) {
+            cache_key = ProgramCache::MakeKey(std::string_view(vertex.as_cstr(), vertex.size()), std::string_view(fragment.as_cstr(), fragment.size()));
+            if (const auto program = ProgramCache::Load(cache_key.value()); program.has_value()) {
+                return Success<ShaderPtr>(CacheShader(std::move(std::make_shared<Shader>(std::move(Shader { name, program.value(), defaults })))));
+            }
+        }
+
         GLint status;
         const GLuint vid = glCreateShader(GL_VERTEX_SHADER);
         if (vid == 0) {
@@ -762,6 +892,9 @@ namespace fow {
         }
         glAttachShader(id, vid);
         glAttachShader(id, fid);
+        if (cache_key.has_value()) {
+            glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
         glLinkProgram(id);
         glGetProgramiv(id, GL_LINK_STATUS, &status);
         if (!status) {
@@ -775,7 +908,26 @@ namespace fow {
         glDeleteShader(fid);
         glDeleteShader(vid);
 
-        return Success<ShaderPtr>(CacheShader(std::move(std::make_shared<Shader>(std::move(Shader { name, id })))));
+        if (cache_key.has_value()) {
+            ProgramCache::Store(cache_key.value(), id);
+        }
+        return Success<ShaderPtr>(CacheShader(std::move(std::make_shared<Shader>(std::move(Shader { name, id, defaults })))));
+    }
+    Result<ShaderPtr> Shader::CompileVariant(const String& name, const ShaderVariantKey key) {
+        if (const auto variant_name = ShaderVariantName(name, key); IsCached(variant_name)) {
+            return FromCache(variant_name);
+        }
+        const auto sources = GetShaderVariantSources(name, key);
+        if (!sources.has_value()) {
+            return Failure(sources.error());
+        }
+        return Compile(sources->name, sources->vertex, sources->fragment);
+    }
+    ShaderPtr Shader::CacheLinkedProgram(const String& name, const GLuint program, const String& vertex, const String& fragment) {
+        HashMap<String, String> defaults;
+        ParseShaderUniformDefaults(vertex, defaults);
+        ParseShaderUniformDefaults(fragment, defaults);
+        return CacheShader(std::move(std::make_shared<Shader>(std::move(Shader { name, program, defaults }))));
     }
     Result<ShaderPtr> Shader::FromBinary(const String& name, const void* data, const size_t data_size, const String& vertex_entry, const String& fragment_entry) {
         if (IsCached(name)) {
@@ -840,7 +992,7 @@ namespace fow {
     }
     Result<ShaderPtr> Shader::FromBinary(const String& name, const void* vertex_data, const size_t vertex_data_size,
         const void* fragment_data, const size_t fragment_data_size, const String& vertex_entry,
-        const String& fragment_entry) {
+        const String& fragment_entry, const HashMap<String, String>& defaults) {
         if (IsCached(name)) {
             return FromCache(name);
         }
@@ -850,7 +1002,7 @@ namespace fow {
         if (vid == 0) {
             return Failure(std::format("Failed to generate vertex shader: GL Error {}", glGetError()));
         }
-        glShaderBinary(1, &vid, GL_SHADER_BINARY_FORMAT_SPIR_V, vertex_data, vertex_data_size);
+        glShaderBinary(1, &vid, GL_SHADER_BINARY_FORMAT_SPIR_V, vertex_data, static_cast<GLsizei>(vertex_data_size));
         glSpecializeShader(vid, vertex_entry.as_cstr(), 0, nullptr, nullptr);
         glGetShaderiv(vid, GL_COMPILE_STATUS, &status);
         if (!status) {
@@ -865,7 +1017,7 @@ namespace fow {
         if (fid == 0) {
             return Failure(std::format("Failed to generate fragment shader: GL Error {}", glGetError()));
         }
-        glShaderBinary(1, &fid, GL_SHADER_BINARY_FORMAT_SPIR_V, fragment_data, fragment_data_size);
+        glShaderBinary(1, &fid, GL_SHADER_BINARY_FORMAT_SPIR_V, fragment_data, static_cast<GLsizei>(fragment_data_size));
         glSpecializeShader(fid, fragment_entry.as_cstr(), 0, nullptr, nullptr);
         glGetShaderiv(fid, GL_COMPILE_STATUS, &status);
         if (!status) {
@@ -886,11 +1038,12 @@ namespace fow {
         glAttachShader(id, vid);
         glAttachShader(id, fid);
         glLinkProgram(id);
-        glGetShaderiv(id, GL_LINK_STATUS, &status);
+        glGetProgramiv(id, GL_LINK_STATUS, &status);
         if (!status) {
             String info_log(2048);
             glGetProgramInfoLog(id, 2048, nullptr, info_log.data());
             info_log.recalculate_size();
+            glDeleteProgram(id);
             glDeleteShader(fid);
             glDeleteShader(vid);
             return Failure(std::format("Failed to link shader program: {}", info_log));
@@ -898,7 +1051,7 @@ namespace fow {
         glDeleteShader(fid);
         glDeleteShader(vid);
 
-        return Success<ShaderPtr>(CacheShader(std::move(std::make_shared<Shader>(std::move(Shader { name, id })))));
+        return Success<ShaderPtr>(CacheShader(std::move(std::make_shared<Shader>(std::move(Shader { name, id, defaults })))));
     }
 
     static std::unordered_map<String, ShaderPtr> s_shaders;
@@ -948,6 +1101,9 @@ namespace fow {
     bool Shader::IsCached(const String& name) {
         return s_shaders.contains(name);
     }
+    void Shader::UncacheShader(const String& name) {
+        s_shaders.erase(name);
+    }
 
     void Shader::UnloadShaderCache() {
         s_shaders.clear();
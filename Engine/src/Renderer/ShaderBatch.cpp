@@ -0,0 +1,247 @@
+#include "fow/Renderer/ShaderBatch.hpp"
+#include "fow/Renderer/ShaderBundle.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#ifdef _WIN32
+    #define FOW_HAS_KHR_PARALLEL_SHADER_COMPILE GLEW_KHR_parallel_shader_compile
+    #define FOW_HAS_ARB_PARALLEL_SHADER_COMPILE GLEW_ARB_parallel_shader_compile
+#else
+    #define FOW_HAS_KHR_PARALLEL_SHADER_COMPILE GLAD_GL_KHR_parallel_shader_compile
+    #define FOW_HAS_ARB_PARALLEL_SHADER_COMPILE GLAD_GL_ARB_parallel_shader_compile
+#endif
+
+namespace fow {
+    static Option<bool> s_parallel_supported = std::nullopt;
+
+    static String ShaderInfoLog(const GLuint shader) {
+        String info_log(2048);
+        glGetShaderInfoLog(shader, 2048, nullptr, info_log.data());
+        info_log.recalculate_size();
+        return info_log;
+    }
+    static String ProgramInfoLog(const GLuint program) {
+        String info_log(2048);
+        glGetProgramInfoLog(program, 2048, nullptr, info_log.data());
+        info_log.recalculate_size();
+        return info_log;
+    }
+
+    ShaderCompileBatch::~ShaderCompileBatch() {
+        for (auto& job : m_pending) {
+            Release(job);
+        }
+    }
+
+    ShaderCompileBatch& ShaderCompileBatch::operator=(ShaderCompileBatch&& other) noexcept {
+        if (this != &other) {
+            for (auto& job : m_pending) {
+                Release(job);
+            }
+            m_jobs = std::exchange(other.m_jobs, { });
+            m_pending = std::exchange(other.m_pending, { });
+            m_errors = std::exchange(other.m_errors, { });
+            m_uCompleted = std::exchange(other.m_uCompleted, 0);
+            m_bSubmitted = std::exchange(other.m_bSubmitted, false);
+        }
+        return *this;
+    }
+
+    void ShaderCompileBatch::add(const String& name, const String& vertex, const String& fragment) {
+        if (m_bSubmitted) {
+            Debug::LogWarning(std::format("Shader \"{}\" was added to a compile batch that is already submitted, it is compiled on first use", name));
+            return;
+        }
+        if (Shader::IsCached(name) || std::ranges::any_of(m_jobs, [&name](const Job& job) { return job.name == name; })) {
+            return;
+        }
+        // Cooked SPIR-V is ready right away, there is nothing to compile in parallel.
+        if (ShaderBundle::TryLoad(name, vertex, fragment) != nullptr) {
+            return;
+        }
+        m_jobs.push_back(Job { name, vertex, fragment });
+    }
+
+    Result<> ShaderCompileBatch::add(const String& shader_name) {
+        return add(shader_name, ShaderFeatures::All);
+    }
+    Result<> ShaderCompileBatch::add(const String& shader_name, const ShaderVariantKey key) {
+        if (Shader::IsCached(ShaderVariantName(shader_name, key))) {
+            return Success();
+        }
+        const auto sources = GetShaderVariantSources(shader_name, key);
+        if (!sources.has_value()) {
+            return Failure(sources.error());
+        }
+        add(sources->name, sources->vertex, sources->fragment);
+        return Success();
+    }
+
+    void ShaderCompileBatch::submit() {
+        if (m_bSubmitted) {
+            return;
+        }
+        m_bSubmitted = true;
+
+        static bool s_threads_requested = false;
+        if (!s_threads_requested && IsParallelSupported()) {
+            // Lets the driver pick how many threads it compiles on, the default of some drivers is a single one.
+            if (FOW_HAS_KHR_PARALLEL_SHADER_COMPILE) {
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+            } else {
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+            }
+            s_threads_requested = true;
+        }
+
+        m_pending.reserve(m_jobs.size());
+        for (auto& job : m_jobs) {
+            start(job);
+            m_pending.push_back(std::move(job));
+        }
+        m_jobs.clear();
+    }
+
+    bool ShaderCompileBatch::poll(const double time_budget_ms) {
+        submit();
+
+        const bool parallel = IsParallelSupported();
+        const auto start = std::chrono::steady_clock::now();
+        bool first = true;
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (!first && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= time_budget_ms) {
+                break;
+            }
+            if (parallel && !is_ready(*it)) {
+                ++it;
+                continue;
+            }
+            finish(*it);
+            it = m_pending.erase(it);
+            first = false;
+        }
+        return is_done();
+    }
+
+    Result<> ShaderCompileBatch::wait() {
+        submit();
+        // Queries the status right away, which waits for the driver when it is not done yet.
+        for (auto& job : m_pending) {
+            finish(job);
+        }
+        m_pending.clear();
+
+        if (!m_errors.empty()) {
+            return Failure(m_errors.front());
+        }
+        return Success();
+    }
+
+    bool ShaderCompileBatch::IsParallelSupported() {
+        if (!s_parallel_supported.has_value()) {
+            s_parallel_supported = FOW_HAS_KHR_PARALLEL_SHADER_COMPILE || FOW_HAS_ARB_PARALLEL_SHADER_COMPILE;
+        }
+        return s_parallel_supported.value();
+    }
+
+    void ShaderCompileBatch::start(Job& job) {
+        if (ProgramCache::IsEnabled()) {
+            job.cache_key = ProgramCache::MakeKey(std::string_view(job.vertex.as_cstr(), job.vertex.size()), std::string_view(job.fragment.as_cstr(), job.fragment.size()));
+            if (const auto program = ProgramCache::Load(job.cache_key.value()); program.has_value()) {
+                job.program = program.value();
+                job.from_cache = true;
+                return;
+            }
+        }
+
+        // No status is queried here, that would make the driver finish the shader before the next one is handed over.
+        job.vertex_id = glCreateShader(GL_VERTEX_SHADER);
+        job.fragment_id = glCreateShader(GL_FRAGMENT_SHADER);
+        job.program = glCreateProgram();
+        if (job.vertex_id == 0 || job.fragment_id == 0 || job.program == 0) {
+            return;
+        }
+
+        const char* vertex_cstr = job.vertex.as_cstr();
+        glShaderSource(job.vertex_id, 1, &vertex_cstr, nullptr);
+        glCompileShader(job.vertex_id);
+        const char* fragment_cstr = job.fragment.as_cstr();
+        glShaderSource(job.fragment_id, 1, &fragment_cstr, nullptr);
+        glCompileShader(job.fragment_id);
+
+        glAttachShader(job.program, job.vertex_id);
+        glAttachShader(job.program, job.fragment_id);
+        if (job.cache_key.has_value()) {
+            glProgramParameteri(job.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(job.program);
+    }
+
+    bool ShaderCompileBatch::is_ready(const Job& job) const {
+        if (job.from_cache || job.program == 0) {
+            return true;
+        }
+        GLint done = GL_FALSE;
+        glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    void ShaderCompileBatch::finish(Job& job) {
+        ++m_uCompleted;
+        if (!job.from_cache && (job.vertex_id == 0 || job.fragment_id == 0 || job.program == 0)) {
+            m_errors.emplace_back(std::format("Failed to generate shader \"{}\": GL Error {}", job.name, glGetError()));
+            Debug::LogError(m_errors.back().message);
+            Release(job);
+            return;
+        }
+
+        if (!job.from_cache) {
+            GLint status = GL_FALSE;
+            glGetProgramiv(job.program, GL_LINK_STATUS, &status);
+            if (!status) {
+                // The compile logs explain most link failures, so they are checked first.
+                GLint vertex_status = GL_FALSE, fragment_status = GL_FALSE;
+                glGetShaderiv(job.vertex_id, GL_COMPILE_STATUS, &vertex_status);
+                glGetShaderiv(job.fragment_id, GL_COMPILE_STATUS, &fragment_status);
+                if (!vertex_status) {
+                    m_errors.emplace_back(std::format("Failed to compile vertex shader of \"{}\": {}", job.name, ShaderInfoLog(job.vertex_id)));
+                } else if (!fragment_status) {
+                    m_errors.emplace_back(std::format("Failed to compile fragment shader of \"{}\": {}", job.name, ShaderInfoLog(job.fragment_id)));
+                } else {
+                    m_errors.emplace_back(std::format("Failed to link shader program \"{}\": {}", job.name, ProgramInfoLog(job.program)));
+                }
+                Debug::LogError(m_errors.back().message);
+                Release(job);
+                return;
+            }
+            glDeleteShader(job.fragment_id);
+            glDeleteShader(job.vertex_id);
+            job.fragment_id = 0;
+            job.vertex_id = 0;
+
+            if (job.cache_key.has_value()) {
+                ProgramCache::Store(job.cache_key.value(), job.program);
+            }
+        }
+
+        Shader::CacheLinkedProgram(job.name, job.program, job.vertex, job.fragment);
+        job.program = 0;
+    }
+
+    void ShaderCompileBatch::Release(Job& job) {
+        if (job.vertex_id != 0) {
+            glDeleteShader(job.vertex_id);
+            job.vertex_id = 0;
+        }
+        if (job.fragment_id != 0) {
+            glDeleteShader(job.fragment_id);
+            job.fragment_id = 0;
+        }
+        if (job.program != 0) {
+            glDeleteProgram(job.program);
+            job.program = 0;
+        }
+    }
+}
@@ -0,0 +1,219 @@
+#include "fow/Renderer/ShaderBundle.hpp"
+#include "fow/Renderer/ProgramCache.hpp"
+
+#include "fow/Shared/Filesys.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace fow {
+    struct ShaderBundleHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(ShaderBundleHeader) == 16);
+
+    static constexpr char ShaderBundleMagic[4] = { 'F', 'S', 'P', 'V' };
+
+    class ShaderBundleWriter {
+        Vector<std::byte>& m_out;
+    public:
+        explicit ShaderBundleWriter(Vector<std::byte>& out) : m_out(out) { }
+
+        void write(const void* data, const size_t size) {
+            const auto* bytes = static_cast<const std::byte*>(data);
+            m_out.insert(m_out.end(), bytes, bytes + size);
+        }
+        void write_u32(const uint32_t value) { write(&value, sizeof(value)); }
+        void write_u64(const uint64_t value) { write(&value, sizeof(value)); }
+        void write_string(const String& value) {
+            write_u32(static_cast<uint32_t>(value.size()));
+            write(value.as_cstr(), value.size());
+        }
+        void write_words(const Vector<uint32_t>& words) {
+            write_u32(static_cast<uint32_t>(words.size()));
+            write(words.data(), words.size() * sizeof(uint32_t));
+        }
+    };
+
+    // Every read checks the remaining size, a damaged file fails instead of reading past the end.
+    class ShaderBundleReader {
+        std::span<const std::byte> m_data;
+        size_t m_uOffset;
+    public:
+        explicit ShaderBundleReader(const std::span<const std::byte> data, const size_t offset) : m_data(data), m_uOffset(offset) { }
+
+        [[nodiscard]] FOW_CONSTEXPR bool at_end() const { return m_uOffset == m_data.size(); }
+
+        bool read(void* out, const size_t size) {
+            if (m_data.size() - m_uOffset < size) {
+                return false;
+            }
+            std::memcpy(out, m_data.data() + m_uOffset, size);
+            m_uOffset += size;
+            return true;
+        }
+        bool read_u32(uint32_t& value) { return read(&value, sizeof(value)); }
+        bool read_u64(uint64_t& value) { return read(&value, sizeof(value)); }
+        bool read_string(String& value) {
+            uint32_t size = 0;
+            if (!read_u32(size) || m_data.size() - m_uOffset < size) {
+                return false;
+            }
+            value = String(reinterpret_cast<const char*>(m_data.data() + m_uOffset), size);
+            m_uOffset += size;
+            return true;
+        }
+        bool read_words(Vector<uint32_t>& words) {
+            uint32_t count = 0;
+            if (!read_u32(count) || (m_data.size() - m_uOffset) / sizeof(uint32_t) < count) {
+                return false;
+            }
+            words.resize(count);
+            return read(words.data(), count * sizeof(uint32_t));
+        }
+    };
+
+    uint64_t ShaderSourceHash(const std::string_view vertex, const std::string_view fragment) {
+        return ProgramCacheKey::Create(vertex, fragment, { }, { }).source_hash;
+    }
+
+    Vector<std::byte> WriteShaderBundle(const Vector<ShaderBundleEntry>& entries) {
+        ShaderBundleHeader header { };
+        std::memcpy(header.magic, ShaderBundleMagic, sizeof(ShaderBundleMagic));
+        header.version = FOW_SHADER_BUNDLE_VERSION;
+        header.entry_count = static_cast<uint32_t>(entries.size());
+
+        Vector<std::byte> out;
+        ShaderBundleWriter writer(out);
+        writer.write(&header, sizeof(header));
+        for (const auto& entry : entries) {
+            writer.write_string(entry.name);
+            writer.write_u64(entry.source_hash);
+            writer.write_u32(static_cast<uint32_t>(entry.defaults.size()));
+            for (const auto& [ name, value ] : entry.defaults) {
+                writer.write_string(name);
+                writer.write_string(value);
+            }
+        }
+        // The SPIR-V follows the manifest in the same order.
+        for (const auto& entry : entries) {
+            writer.write_words(entry.vertex);
+            writer.write_words(entry.fragment);
+        }
+        return out;
+    }
+
+    Result<Vector<ShaderBundleEntry>> ReadShaderBundle(const std::span<const std::byte> data) {
+        if (data.size() < sizeof(ShaderBundleHeader)) {
+            return Failure("Shader bundle is truncated");
+        }
+        ShaderBundleHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, ShaderBundleMagic, sizeof(ShaderBundleMagic)) != 0) {
+            return Failure("Not a shader bundle");
+        }
+        if (header.version != FOW_SHADER_BUNDLE_VERSION) {
+            return Failure(std::format("Unsupported shader bundle version {}, expected {}", header.version, FOW_SHADER_BUNDLE_VERSION));
+        }
+
+        ShaderBundleReader reader(data, sizeof(ShaderBundleHeader));
+        Vector<ShaderBundleEntry> entries;
+        // Each entry takes at least 16 bytes, a huge count in a damaged header must not reserve gigabytes.
+        entries.reserve(std::min<size_t>(header.entry_count, data.size() / 16));
+        for (uint32_t i = 0; i < header.entry_count; ++i) {
+            ShaderBundleEntry entry;
+            uint32_t default_count = 0;
+            if (!reader.read_string(entry.name) || !reader.read_u64(entry.source_hash) || !reader.read_u32(default_count)) {
+                return Failure("Shader bundle manifest is truncated");
+            }
+            for (uint32_t j = 0; j < default_count; ++j) {
+                String name, value;
+                if (!reader.read_string(name) || !reader.read_string(value)) {
+                    return Failure("Shader bundle manifest is truncated");
+                }
+                entry.defaults.insert_or_assign(std::move(name), std::move(value));
+            }
+            entries.push_back(std::move(entry));
+        }
+        for (auto& entry : entries) {
+            if (!reader.read_words(entry.vertex) || !reader.read_words(entry.fragment)) {
+                return Failure(std::format("SPIR-V of shader \"{}\" is truncated", entry.name));
+            }
+        }
+        if (!reader.at_end()) {
+            return Failure("Shader bundle has trailing data");
+        }
+        return entries;
+    }
+
+    namespace ShaderBundle {
+        static HashMap<String, ShaderBundleEntry> s_entries;
+        static bool s_usable = true;
+
+        Result<> Load(const Path& path) {
+            const auto file = Files::ReadAllBytes(path);
+            if (!file.has_value()) {
+                return Failure(std::format("Failed to load shader bundle \"{}\": {}", path, file.error().message));
+            }
+            auto entries = ReadShaderBundle(std::as_bytes(std::span(file.value())));
+            if (!entries.has_value()) {
+                return Failure(std::format("Failed to load shader bundle \"{}\": {}", path, entries.error().message));
+            }
+            s_entries.clear();
+            for (auto& entry : entries.value()) {
+                auto name = entry.name;
+                s_entries.insert_or_assign(std::move(name), std::move(entry));
+            }
+            s_usable = true;
+            Debug::LogDebug(std::format("Loaded {} cooked shaders from \"{}\"", s_entries.size(), path));
+            return Success();
+        }
+
+        void Unload() {
+            s_entries.clear();
+        }
+
+        bool IsLoaded() {
+            return !s_entries.empty();
+        }
+
+        ShaderPtr TryLoad(const String& name, const String& vertex, const String& fragment) {
+            if (!s_usable) {
+                return nullptr;
+            }
+            const auto it = s_entries.find(name);
+            if (it == s_entries.end()) {
+                return nullptr;
+            }
+            const auto& entry = it->second;
+            if (entry.source_hash != ShaderSourceHash(std::string_view(vertex.as_cstr(), vertex.size()), std::string_view(fragment.as_cstr(), fragment.size()))) {
+                Debug::LogDebug(std::format("Cooked shader \"{}\" is outdated, compiling it from source", name));
+                return nullptr;
+            }
+
+            const auto shader = Shader::FromBinary(name,
+                entry.vertex.data(), entry.vertex.size() * sizeof(uint32_t),
+                entry.fragment.data(), entry.fragment.size() * sizeof(uint32_t),
+                "main", "main", entry.defaults
+            );
+            if (!shader.has_value()) {
+                Debug::LogWarning(std::format("Failed to load cooked shader \"{}\", compiling it from source: {}", name, shader.error().message));
+                return nullptr;
+            }
+
+            const auto& loaded = shader.value();
+            const bool named = std::ranges::none_of(loaded->uniforms(), [](const ShaderUniformInfo& info) { return info.name.is_empty(); }) &&
+                               std::ranges::none_of(loaded->uniform_blocks(), [](const ShaderUniformBlockInfo& info) { return info.name.is_empty(); });
+            if (!named) {
+                Debug::LogWarning("The driver does not report uniform names of SPIR-V shaders, the shader bundle is not used");
+                Shader::UncacheShader(name);
+                s_usable = false;
+                return nullptr;
+            }
+            return loaded;
+        }
+    }
+}
@@ -3,6 +3,9 @@
 
 #include "fow/Renderer/GL.hpp"
 
+#include <algorithm>
+#include <span>
+
 #ifdef _WIN32
     #define SHADERLIB_FILENAME "shaderlib.dll"
 #else
@@ -12,67 +15,103 @@
 namespace fow::ShaderLib {
     const fow::Dylib* s_shaderlib = nullptr;
     static Path s_shaderlib_basedir = "";
+    // Resolved once on load, lookups never go through the dynamic linker again.
+    static std::span<const ShaderLibSource> s_sources;
+    static std::span<const ShaderLibShader> s_shaders;
+
+    template<typename T>
+    static const T* FindByName(const std::span<const T> entries, const std::string_view name) {
+        const auto it = std::ranges::lower_bound(entries, name, { }, [](const T& entry) { return std::string_view(entry.name); });
+        if (it == entries.end() || std::string_view(it->name) != name) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    template<typename T>
+    static bool IsSortedByName(const std::span<const T> entries) {
+        return std::ranges::is_sorted(entries, std::ranges::less { }, [](const T& entry) { return std::string_view(entry.name); });
+    }
 
     Result<> Load(const Path& base_path) {
         s_shaderlib_basedir = base_path;
         if (s_shaderlib == nullptr) {
             s_shaderlib = new Dylib(base_path / SHADERLIB_FILENAME);
             if (!s_shaderlib->is_valid()) {
+                Unload();
                 return Failure("Failed to load shader library!");
             }
 
-            if (const auto shaderlib_init = s_shaderlib->symbol<void(*)()>("ShaderLibInitialize"); shaderlib_init != nullptr) {
-                shaderlib_init();
+            if (const auto get_table = s_shaderlib->symbol<const ShaderLibTable*(*)()>("ShaderLibGetTable"); get_table != nullptr) {
+                if (auto result = LoadTable(get_table()); !result.has_value()) {
+                    Unload();
+                    return result;
+                }
                 return Success();
             }
-            return Failure("Failed to initialize shader library!");
+            Unload();
+            return Failure("Failed to initialize shader library: Could not load function \"ShaderLibGetTable\"!");
+        }
+        return Success();
+    }
+
+    Result<> LoadTable(const ShaderLibTable* table) {
+        if (table == nullptr) {
+            return Failure("Failed to initialize shader library: No shader table!");
+        }
+        if (table->version != FOW_SHADERLIB_TABLE_VERSION) {
+            return Failure(std::format("Failed to initialize shader library: Table version {} is not supported, expected {}! Rebuild the shader library.", table->version, FOW_SHADERLIB_TABLE_VERSION));
         }
+        const std::span sources(table->sources, table->source_count);
+        const std::span shaders(table->shaders, table->shader_count);
+        if (!IsSortedByName(sources) || !IsSortedByName(shaders)) {
+            return Failure("Failed to initialize shader library: Shader table is not sorted!");
+        }
+        if (std::ranges::any_of(shaders, [&sources](const ShaderLibShader& shader) { return shader.vertex >= sources.size() || shader.fragment >= sources.size(); })) {
+            return Failure("Failed to initialize shader library: Shader table references missing sources!");
+        }
+        s_sources = sources;
+        s_shaders = shaders;
         return Success();
     }
 
     Result<ShaderSources> GetSourcesForShader(const String& name) {
-        if (s_shaderlib == nullptr) {
+        if (s_sources.empty()) {
             return Failure(std::format("Failed to get sources for shader \"{}\": Shader library is not loaded!", name));
         }
-        if (const auto fn = s_shaderlib->symbol("ShaderLibGetRequiredSources"); fn != nullptr) {
-            ShaderSources sources;
-            if (reinterpret_cast<bool(*)(const char*, ShaderSources*)>(fn)(name.as_cstr(), &sources)) {
-                return Success<ShaderSources>(sources);
-            }
-            return Failure(std::format("Failed to get sources for shader \"{}\": No such shader!", name));
+        if (const auto* shader = FindByName(s_shaders, std::string_view(name.as_cstr(), name.size())); shader != nullptr) {
+            return Success<ShaderSources>(ShaderSources { s_sources[shader->vertex].name, s_sources[shader->fragment].name });
         }
-        return Failure(std::format("Failed to get sources for shader \"{}\": Could not load function \"ShaderLibGetRequiredSources\"", name));
+        return Failure(std::format("Failed to get sources for shader \"{}\": No such shader!", name));
     }
-    Result<String> GetSource(const String& name) {
-        if (s_shaderlib == nullptr) {
+    Result<std::string_view> GetSource(const String& name) {
+        if (s_sources.empty()) {
             return Failure(std::format("Failed to get shader source \"{}\": Shader library is not loaded!", name));
         }
-        if (const auto fn = s_shaderlib->symbol("ShaderLibGetSource"); fn != nullptr) {
-            const char* src = reinterpret_cast<const char*(*)(const char*)>(fn)(name.as_cstr());
-            if (src == nullptr) {
-                return Failure(std::format("Failed to get shader source \"{}\": Shader source doesn't exists!", name));
-            }
-            return Success<String>(src);
+        if (const auto* source = FindByName(s_sources, std::string_view(name.as_cstr(), name.size())); source != nullptr) {
+            return Success<std::string_view>(std::string_view(source->source, source->size));
         }
-        return Failure(std::format("Failed to get shader source \"{}\": Could not load function \"ShaderLibGetSource\"", name));
+        return Failure(std::format("Failed to get shader source \"{}\": Shader source doesn't exists!", name));
+    }
+
+    uint32_t GetSourceStages(const String& name) {
+        const auto* source = FindByName(s_sources, std::string_view(name.as_cstr(), name.size()));
+        return source != nullptr ? source->stages : ShaderLibStage::None;
     }
 
     Vector<String> GetShaders() {
-        if (s_shaderlib != nullptr) {
-            if (const auto fn = s_shaderlib->symbol("ShaderLibGetShaders"); fn != nullptr) {
-                std::vector<std::string> shaders;
-                reinterpret_cast<void(*)(std::vector<std::string>*)>(fn)(&shaders);
-                Vector<String> result;
-                std::ranges::transform(shaders, std::back_inserter(result), [](const std::string& value) { return String(value); });
-                return result;
-            }
-        }
-        return { };
+        Vector<String> result;
+        result.reserve(s_shaders.size());
+        std::ranges::transform(s_shaders, std::back_inserter(result), [](const ShaderLibShader& shader) { return String(shader.name); });
+        return result;
     }
 
     void Unload() {
+        s_sources = { };
+        s_shaders = { };
         if (s_shaderlib != nullptr) {
             delete s_shaderlib;
+            s_shaderlib = nullptr;
         }
     }
 }
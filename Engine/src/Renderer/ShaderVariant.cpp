@@ -0,0 +1,142 @@
+#include "fow/Renderer/ShaderVariant.hpp"
+#include "fow/Renderer/ShaderLib.hpp"
+
+#include <algorithm>
+
+namespace fow {
+    static constexpr ShaderFeatures::Type AllShaderFeatures[] = {
+        ShaderFeatures::NormalMap,
+        ShaderFeatures::SpecularMap,
+        ShaderFeatures::EmissionMap,
+        ShaderFeatures::ColorTintMask,
+        ShaderFeatures::AlphaScissor
+    };
+
+    static bool IsIdentifierChar(const char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    static bool ContainsIdentifier(const std::string_view source, const std::string_view identifier) {
+        for (size_t pos = source.find(identifier); pos != std::string_view::npos; pos = source.find(identifier, pos + 1)) {
+            const size_t end = pos + identifier.size();
+            if ((pos == 0 || !IsIdentifierChar(source[pos - 1])) && (end == source.size() || !IsIdentifierChar(source[end]))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view ShaderFeatureDefine(const ShaderFeatures::Type feature) {
+        switch (feature) {
+            case ShaderFeatures::NormalMap:     return "NORMAL_MAP";
+            case ShaderFeatures::SpecularMap:   return "SPECULAR_MAP";
+            case ShaderFeatures::EmissionMap:   return "EMISSION_MAP";
+            case ShaderFeatures::ColorTintMask: return "COLOR_TINT_MASK";
+            case ShaderFeatures::AlphaScissor:  return "ALPHA_SCISSOR";
+            default:                            return { };
+        }
+    }
+
+    ShaderVariantKey ShaderSourceFeatures(const std::string_view source) {
+        ShaderVariantKey features = ShaderFeatures::None;
+        for (const auto feature : AllShaderFeatures) {
+            if (ContainsIdentifier(source, ShaderFeatureDefine(feature))) {
+                features |= feature;
+            }
+        }
+        return features;
+    }
+
+    String ShaderVariantDefines(const ShaderVariantKey key) {
+        std::string defines = "#define " FOW_SHADER_VARIANT_DEFINE "\n";
+        for (const auto feature : AllShaderFeatures) {
+            if ((key & feature) != 0) {
+                defines += std::format("#define {}\n", ShaderFeatureDefine(feature));
+            }
+        }
+        return defines;
+    }
+
+    String InjectShaderDefines(const std::string_view source, const std::string_view defines) {
+        if (!source.starts_with("#version")) {
+            return std::format("{}#line 1\n{}", defines, source);
+        }
+        const size_t line_end = source.find('\n');
+        if (line_end == std::string_view::npos) {
+            return std::format("{}\n{}", source, defines);
+        }
+        return std::format("{}{}#line 2\n{}", source.substr(0, line_end + 1), defines, source.substr(line_end + 1));
+    }
+
+    String ShaderVariantName(const String& name, const ShaderVariantKey key, const ShaderVariantKey supported) {
+        const ShaderVariantKey masked = key & supported;
+        if (masked == supported) {
+            return name;
+        }
+        std::string features;
+        for (const auto feature : AllShaderFeatures) {
+            if ((masked & feature) != 0) {
+                if (!features.empty()) {
+                    features += '|';
+                }
+                features += ShaderFeatureDefine(feature);
+            }
+        }
+        return std::format("{}[{}]", name, features);
+    }
+
+    std::pair<String, ShaderVariantKey> ParseShaderVariantName(const String& name) {
+        const std::string_view view(name.as_cstr(), name.size());
+        const size_t open = view.rfind('[');
+        if (open == std::string_view::npos || !view.ends_with(']')) {
+            return { name, ShaderFeatures::All };
+        }
+        ShaderVariantKey key = ShaderFeatures::None;
+        std::string_view features = view.substr(open + 1, view.size() - open - 2);
+        while (!features.empty()) {
+            const size_t end = std::min(features.find('|'), features.size());
+            for (const auto feature : AllShaderFeatures) {
+                if (features.substr(0, end) == ShaderFeatureDefine(feature)) {
+                    key |= feature;
+                }
+            }
+            features.remove_prefix(std::min(end + 1, features.size()));
+        }
+        return { String(view.substr(0, open)), key };
+    }
+
+    ShaderVariantSources MakeShaderVariantSources(const String& name, const String& vertex, const String& fragment, const ShaderVariantKey key) {
+        const std::string_view vertex_src(vertex.as_cstr(), vertex.size());
+        const std::string_view fragment_src(fragment.as_cstr(), fragment.size());
+        const ShaderVariantKey supported = ShaderSourceFeatures(vertex_src) | ShaderSourceFeatures(fragment_src);
+        const ShaderVariantKey masked = key & supported;
+        if (masked == supported) {
+            return ShaderVariantSources { name, vertex, fragment };
+        }
+
+        const auto defines = ShaderVariantDefines(masked);
+        const std::string_view defines_view(defines.as_cstr(), defines.size());
+        return ShaderVariantSources {
+            ShaderVariantName(name, masked, supported),
+            InjectShaderDefines(vertex_src, defines_view),
+            InjectShaderDefines(fragment_src, defines_view)
+        };
+    }
+
+    Result<ShaderVariantSources> GetShaderVariantSources(const String& name, const ShaderVariantKey key) {
+        const auto source_paths = ShaderLib::GetSourcesForShader(name);
+        if (!source_paths.has_value()) {
+            return Failure(std::format("Sources for shader \"{}\" not found!", name));
+        }
+        const auto vertex = ShaderLib::GetSource(source_paths->vertex);
+        if (!vertex.has_value()) {
+            return Failure(std::format("Failed to load vertex shader \"{}\"!", source_paths->vertex));
+        }
+        const auto fragment = ShaderLib::GetSource(source_paths->fragment);
+        if (!fragment.has_value()) {
+            return Failure(std::format("Failed to load fragment shader \"{}\"!", source_paths->fragment));
+        }
+
+        return Success<ShaderVariantSources>(MakeShaderVariantSources(name, vertex.value(), fragment.value(), key));
+    }
+}
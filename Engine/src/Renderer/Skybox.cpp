@@ -52,7 +52,7 @@ namespace fow {
 
     Skybox::Skybox(const MaterialPtr& material) : m_pMaterial(material) {
         glGenVertexArrays(1, &m_uVao);
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
         glGenBuffers(1, &m_uVbo);
 
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
@@ -60,11 +60,11 @@ namespace fow {
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, reinterpret_cast<void*>(0));
         glEnableVertexAttribArray(0);
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
     }
     Skybox::Skybox(MaterialPtr&& material) noexcept : m_pMaterial(std::move(material)) {
         glGenVertexArrays(1, &m_uVao);
-        glBindVertexArray(m_uVao);
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
         glGenBuffers(1, &m_uVbo);
 
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
@@ -72,22 +72,19 @@ namespace fow {
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, reinterpret_cast<void*>(0));
         glEnableVertexAttribArray(0);
-        glBindVertexArray(0);
+        GlStateCache::Instance().bind_vertex_array(0);
     }
     Skybox::~Skybox() {
         if (m_uVbo != 0) {
             glDeleteBuffers(1, &m_uVbo);
         }
         if (m_uVao != 0) {
+            GlStateCache::Instance().forget_vertex_array(m_uVao);
             glDeleteVertexArrays(1, &m_uVao);
         }
     }
 
     void Skybox::draw() const {
-        glDisable(GL_CULL_FACE);
-        glDepthMask(GL_FALSE);
-        glBindVertexArray(m_uVao);
-
         auto view = Renderer::GetViewMatrix();
         view[3] = Vector4(0.0f, 0.0f, 0.0f, 1.0f); // Clear translation
 
@@ -95,9 +92,13 @@ namespace fow {
         Debug::Assert(m_pMaterial->shader()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix()), "Error while applying uniform \"MATRIX_PROJECTION\"");
         Debug::Assert(m_pMaterial->shader()->set_uniform("MATRIX_VIEW", view), "Error while applying uniform \"MATRIX_VIEW\"");
 
+        auto& state = GlStateCache::Instance();
+        state.set_enabled(GL_CULL_FACE, false);
+        state.set_depth_mask(false);
+        state.bind_vertex_array(m_uVao);
         glDrawArrays(GL_TRIANGLES, 0, VERTEX_COUNT);
-        glDepthMask(GL_TRUE);
-        glEnable(GL_CULL_FACE);
+        state.set_depth_mask(true);
+        state.set_enabled(GL_CULL_FACE, true);
     }
 
     Result<SkyboxPtr> Skybox::LoadAsset(const Path& path, const AssetLoaderFlags::Type flags) {
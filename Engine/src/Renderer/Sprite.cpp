@@ -3,6 +3,61 @@
 #include "fow/Renderer.hpp"
 
 namespace fow {
+    // Shader library name of the material, the features of its variant left out.
+    static bool UsesShader(const MaterialPtr& material, const std::string_view shader_name) {
+        if (material == nullptr || material->shader() == nullptr) {
+            return false;
+        }
+        const auto& name = material->shader()->name();
+        const std::string_view base_name(name.as_cstr(), name.size());
+        return base_name.substr(0, base_name.find('[')) == shader_name;
+    }
+
+    template<typename T>
+    static T MaterialValue(const Material& material, const String& name, const T& fallback) {
+        MaterialParameterValue value;
+        if (material.get_parameter(name, value).has_value()) {
+            if (const auto* result = std::get_if<T>(&value)) {
+                return *result;
+            }
+        }
+        return fallback;
+    }
+
+    // Threshold of the AlphaScissor and AlphaScissorThreshold parameters, zero when alpha scissoring is off.
+    static float MaterialAlphaScissor(const Material& material) {
+        return MaterialValue(material, "AlphaScissor", false) ? MaterialValue(material, "AlphaScissorThreshold", 0.5f) : 0.0f;
+    }
+
+    // Looks the parameters up by name only when the shader or the expected shader name changed since the last call.
+    static const SpriteBatchParams& ResolveBatchParams(SpriteBatchParams& params, const MaterialPtr& material, const std::string_view shader_name) {
+        const ShaderPtr shader = material != nullptr ? material->shader() : nullptr;
+        if (shader == params.shader && shader_name == params.expected_shader) {
+            return params;
+        }
+        params = SpriteBatchParams { shader, shader_name, UsesShader(material, shader_name) };
+        if (params.is_batchable) {
+            params.uv_offset               = material->parameter<Vector2>("UVOffset").value_or(MaterialParam<Vector2> { });
+            params.uv_scale                = material->parameter<Vector2>("UVScale").value_or(MaterialParam<Vector2> { });
+            params.color_tint              = material->parameter<Vector4>("ColorTint").value_or(MaterialParam<Vector4> { });
+            params.main_texture            = material->parameter<TexturePtr>("MainTexture").value_or(MaterialParam<TexturePtr> { });
+            params.border_thickness        = material->parameter<float>("BorderThickness").value_or(MaterialParam<float> { });
+            params.alpha_scissor           = material->parameter<bool>("AlphaScissor").value_or(MaterialParam<bool> { });
+            params.alpha_scissor_threshold = material->parameter<float>("AlphaScissorThreshold").value_or(MaterialParam<float> { });
+        }
+        return params;
+    }
+
+    // The quad of a material that passed ResolveBatchParams, with the UVs and texture still to be filled in.
+    static SpriteQuad BatchQuad(const Material& material, const SpriteBatchParams& params, const Rectangle& rect) {
+        const auto tint = material.get_parameter(params.color_tint).value_or(Vector4(1.0f));
+        SpriteQuad quad;
+        quad.rect = rect;
+        quad.color = Color { tint.r, tint.g, tint.b, tint.a };
+        quad.alpha_scissor = material.get_parameter(params.alpha_scissor).value_or(false) ? material.get_parameter(params.alpha_scissor_threshold).value_or(0.5f) : 0.0f;
+        return quad;
+    }
+
     void Sprite::setup_sprite() {
         if (m_pMesh == nullptr) {
             const auto result = Mesh::CreateQuad(m_pMaterial);
@@ -115,6 +170,21 @@ namespace fow {
         m_pMesh->draw_2d(rect, m_pMaterial);
     }
 
+    bool Sprite2D::batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const {
+        const auto& params = ResolveBatchParams(m_batchParams, m_pMaterial, "Generic2D");
+        if (!params.is_batchable || m_pMaterial->get_parameter(params.border_thickness).value_or(0.0f) != 0.0f) {
+            return false;
+        }
+        const auto uv_offset = m_pMaterial->get_parameter(params.uv_offset).value_or(Vector2(0.0f));
+
+        auto quad = BatchQuad(*m_pMaterial, params, rect);
+        quad.uv_min = uv_offset;
+        quad.uv_max = uv_offset + m_pMaterial->get_parameter(params.uv_scale).value_or(Vector2(1.0f));
+        quad.texture = m_pMaterial->get_parameter(params.main_texture).value_or(nullptr);
+        batch.add(quad);
+        return true;
+    }
+
     Result<Sprite2DPtr> Sprite2D::LoadAsset(const Path& path, AssetLoaderFlags::Type flags) {
         const auto xml = Assets::LoadAsXml(path, flags);
         if (!xml.has_value()) {
@@ -148,6 +218,10 @@ namespace fow {
         if (root.child("Billboard")) {
             Debug::LogWarning(std::format("Asset \"{}\" is loaded as Sprite2D, parameter \"Billboard\" will be ignored!", path));
         }
+        // Sprites of the same page share batches, the material keeps the texture for drawing without the batch.
+        if (UsesShader(material, "Generic2D")) {
+            TextureAtlas::Instance().add(CastRef<Texture2D>(MaterialValue<TexturePtr>(*material, "MainTexture", nullptr)));
+        }
 
         return Success<Sprite2DPtr>(std::make_shared<Sprite2D>(std::move(material)));
     }
@@ -241,6 +315,25 @@ namespace fow {
         m_pMesh->draw_2d(rect);
     }
 
+    bool ArraySprite2D::batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const {
+        const auto& params = ResolveBatchParams(m_batchParams, m_pMaterial, m_pTexture.index() == 0 ? "Generic2D" : "Array2D");
+        if (!params.is_batchable || m_pMaterial->get_parameter(params.border_thickness).value_or(0.0f) != 0.0f) {
+            return false;
+        }
+        auto quad = BatchQuad(*m_pMaterial, params, rect);
+        if (m_pTexture.index() == 0) {
+            const auto uv_offset = m_pMaterial->get_parameter(params.uv_offset).value_or(Vector2(0.0f));
+            quad.uv_min = uv_offset;
+            quad.uv_max = uv_offset + m_pMaterial->get_parameter(params.uv_scale).value_or(Vector2(1.0f));
+            quad.texture = std::get<0>(m_pTexture);
+        } else {
+            quad.array_layer = static_cast<float>(m_uIndex);
+            quad.texture = std::get<1>(m_pTexture);
+        }
+        batch.add(quad);
+        return true;
+    }
+
     Result<ArraySprite2DPtr> ArraySprite2D::LoadAsset(const Path& path, const AssetLoaderFlags::Type flags) {
         const auto xml = Assets::LoadAsXml(path, flags);
         if (!xml.has_value()) {
@@ -413,6 +506,22 @@ namespace fow {
         Sprite2D::draw_2d(rect);
     }
 
+    bool QuadSprite2D::batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const {
+        if (!UsesShader(m_pMaterial, "Rectangle2D")) {
+            return false;
+        }
+        SpriteQuad quad;
+        quad.rect = rect;
+        quad.params = Vector4 { rect.width, rect.height, m_fRadius, m_fBorderThickness };
+        quad.color = m_Color;
+        quad.border_color = m_BorderColor;
+        quad.texture = m_pBackgroundTexture != nullptr ? TexturePtr(m_pBackgroundTexture) : MaterialValue(*m_pMaterial, "MainTexture", Texture::DefaultWhite());
+        quad.mode = SpriteQuadMode::RoundedRect;
+        quad.alpha_scissor = MaterialAlphaScissor(*m_pMaterial);
+        batch.add(quad);
+        return true;
+    }
+
     Result<QuadSprite2DPtr> QuadSprite2D::FromXml(const pugi::xml_document& doc) {
         const auto root = doc.child("QuadSprite2D");
         if (!root) {
@@ -440,6 +549,7 @@ namespace fow {
                     return Failure(std::format("Failed to load QuadSprite2D texture: {}", texture_result.error().message));
                 }
                 texture = texture_result.value().ptr();
+                TextureAtlas::Instance().add(texture);
             }
         }
         if (const auto cn = node.child("Border"); cn) {
@@ -513,6 +623,7 @@ namespace fow {
                         return Failure(std::format("Failed to load QuadSprite2D texture: {}", texture_result.error().message));
                     }
                     texture = texture_result.value().ptr();
+                    TextureAtlas::Instance().add(texture);
                 } catch (const ThemeResolutionException& e) {
                     Debug::LogError(std::format("Failed to resolve theme constant \"{}\" in node \"Background\": {}", e.what(), node.name()));
                 }
@@ -668,77 +779,57 @@ namespace fow {
         }
     }
 
-    NineSliceSprite2D::NineSliceSprite2D(const Texture2DPtr& texture) : m_pTexture(texture) {
-        setup_sprite();
-    }
-    NineSliceSprite2D::NineSliceSprite2D(Texture2DPtr&& texture) noexcept : m_pTexture(std::move(texture)) {
-        setup_sprite();
-    }
+    NineSliceSprite2D::NineSliceSprite2D(const Texture2DPtr& texture) : m_pTexture(texture) { }
+    NineSliceSprite2D::NineSliceSprite2D(Texture2DPtr&& texture) noexcept : m_pTexture(std::move(texture)) { }
 
     void NineSliceSprite2D::set_texture(const Texture2DPtr& texture) {
         m_pTexture = texture;
-        setup_sprite();
     }
     void NineSliceSprite2D::set_texture(Texture2DPtr&& texture) noexcept {
         m_pTexture = std::move(texture);
-        setup_sprite();
     }
 
     void NineSliceSprite2D::draw_2d(const Rectangle& rect) const {
+        FOW_DISCARD(SpriteBatch2D::Instance().draw_immediate(*this, rect));
+    }
+
+    bool NineSliceSprite2D::batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const {
         if (!is_valid()) {
-            return;
+            return true;
         }
-
-        constexpr auto one_third = 1.0f / 3.0f;
-        Vector2 position = rect.position();
-
-        for (auto i = 0; i < 9; ++i) {
-            if (i % 3 == 1 && rect.size().x <= m_pTexture->size().x * 2.0f) {
-                continue;
-            }
-
-            m_pMeshes[i]->draw_2d(Rectangle { position, rect.size() * one_third });
-
-            position += Vector2(one_third, 0.0) * rect.size();
-            if (i % 3 == 2) {
-                position.x = 0.0f;
-                position.y += one_third * rect.height;
-            }
+        const Vector2 image_size(m_pTexture->size());
+        if (image_size.x <= 0.0f || image_size.y <= 0.0f) {
+            return true;
         }
-    }
-
-    void NineSliceSprite2D::setup_sprite() {
-        auto origin = Vector2(0.0);
-        auto end    = Vector2(0.25);
 
-        for (auto i = 0; i < 9; ++i) {
-            const auto mat = Material::New("StretchSprite2D");
-            Debug::Assert(mat);
-            if (mat.has_value()) {
-                Debug::Assert(mat.value()->set_parameter("MainTexture", m_pTexture));
-                Debug::Assert(mat.value()->set_parameter("ImageSize", m_pTexture->size()));
-                Debug::Assert(mat.value()->set_parameter("UVStart", origin));
-                Debug::Assert(mat.value()->set_parameter("UVEnd", end));
-                const auto mesh = Mesh::CreateQuad2D(mat.value());
-                Debug::Assert(mesh);
-                if (mesh.has_value()) {
-                    m_pMeshes[i] = mesh.value();
-                    origin += Vector2(0.25, 0.0);
-                    end    += Vector2(0.25, 0.0);
+        // Without the middle column the sides share the width.
+        const bool has_middle = rect.width > image_size.x * 2.0f;
+        const Vector2 slice_size { rect.width / (has_middle ? 3.0f : 2.0f), rect.height / 3.0f };
+
+        SpriteQuad quad;
+        quad.texture = m_pTexture;
+        quad.mode = SpriteQuadMode::Stretch;
+        for (int row = 0; row < 3; ++row) {
+            float x = rect.x;
+            for (int column = 0; column < 3; ++column) {
+                if (column == 1 && !has_middle) {
+                    continue;
                 }
-            }
-
-            if (i % 3 == 2) {
-                origin.x = 0.0f;
-                end.x    = 0.25f;
-
-                origin.y += 0.25f;
-                end.y    += 0.25f;
+                const Vector2 uv_start { static_cast<float>(column) * 0.25f, static_cast<float>(row) * 0.25f };
+                quad.rect = Rectangle { x, rect.y + static_cast<float>(row) * slice_size.y, slice_size };
+                // Repeats of the slice across its part of the area, like StretchSprite2D.
+                quad.uv_max = slice_size / image_size;
+                quad.params = Vector4 { uv_start, uv_start + 0.25f };
+                batch.add(quad);
+                x += slice_size.x;
             }
         }
+        return true;
     }
 
-    Font::Font(const Path& path, const uint32_t size) : m_pFace(nullptr) {
+    static uint32_t s_uNextFontId = 1;
+
+    Font::Font(const Path& path, const uint32_t size) : m_pFace(nullptr), m_uId(s_uNextFontId++), m_uSize(size), m_fAscender(0.0f), m_fDescender(0.0f), m_fLineHeight(0.0f) {
         const auto full_path = path.is_absolute() ? path : path.as_absolute(Renderer::GetBasePath() / "res");
         if (!full_path.exists()) {
             Debug::LogError(std::format("Font file \"{}\" does not exist!", path));
@@ -750,7 +841,11 @@ namespace fow {
             Debug::LogError(std::format("Failed to load font \"{}\": {} ({})", path, error_message != nullptr ? error_message : "Unknown error", static_cast<uint32_t>(error)));
             return;
         }
+        FT_Select_Charmap(m_pFace, FT_ENCODING_UNICODE);
         FT_Set_Pixel_Sizes(m_pFace, 0, size);
+        m_fAscender   = static_cast<float>(m_pFace->size->metrics.ascender) / 64.0f;
+        m_fDescender  = static_cast<float>(m_pFace->size->metrics.descender) / 64.0f;
+        m_fLineHeight = static_cast<float>(m_pFace->size->metrics.height) / 64.0f;
     }
     Font::~Font() {
         if (m_pFace != nullptr) {
@@ -799,91 +894,44 @@ namespace fow {
         m_eTextAlignment.vertical = vertical_alignment;
     }
 
-    Result<Texture2DPtr> TextRenderer::create_texture(const Vector2i& texture_size) const {
-        return create_texture(texture_size, TextureInfo());
+    void TextRenderer::set_wrap_width(const int32_t width) {
+        m_iWrapWidth = std::max(width, 0);
     }
-    Result<Texture2DPtr> TextRenderer::create_texture(const Vector2i& texture_size, const TextureInfo& info) const {
-        return create_texture(texture_size, info, nullptr);
-    }
-    Result<Texture2DPtr> TextRenderer::create_texture(const Vector2i& texture_size, const TexturePtr& reuse) const {
-        return create_texture(texture_size, TextureInfo(), reuse);
-    }
-    Result<Texture2DPtr> TextRenderer::create_texture(const Vector2i& texture_size, const TextureInfo& info, const TexturePtr& reuse) const {
-        if (m_pFont == nullptr) {
-            return Failure(std::format("Failed to render text \"{}\": Font is not set", m_sText));
-        }
-
-        const auto face = m_pFont->m_pFace;
-        const auto target_width = texture_size.x;
-        const auto target_height = texture_size.y;
 
-        // 1. Calculate the bounding box of the actual text string
-        int text_width = 0;
-        int max_ascent = 0;
-        int max_descent = 0;
-
-        for (const char c : m_sText) {
-            if (FT_Load_Char(face, c, FT_LOAD_DEFAULT)) continue;
-            text_width += face->glyph->advance.x >> 6;
-            max_ascent = std::max(max_ascent, face->glyph->bitmap_top);
-            max_descent = std::max(max_descent, static_cast<int>(face->glyph->bitmap.rows - face->glyph->bitmap_top));
+    Result<Vector<GlyphQuad>> TextRenderer::layout(const Vector2i& area_size) const {
+        if (m_pFont == nullptr || !m_pFont->is_valid()) {
+            return Failure(std::format("Failed to lay out text \"{}\": Font is not set", m_sText));
         }
-        const int text_height = max_ascent + max_descent;
 
-        // 2. Determine starting X based on Horizontal Alignment
-        int start_x = 0;
-        switch (m_eTextAlignment.horizontal) {
-            case HorizontalAlignment::Left:   start_x = 0; break;
-            case HorizontalAlignment::Center: start_x = (target_width - text_width) / 2; break;
-            case HorizontalAlignment::Right:  start_x = (target_width - text_width); break;
+        auto result = TextLayoutCache::Instance().get(*m_pFont, std::string_view(m_sText.as_cstr(), m_sText.size()), m_iWrapWidth, m_pLayout);
+        if (!result.has_value()) {
+            return Failure(result.error());
         }
+        m_pLayout = result.value();
+        const auto& text_layout = *m_pLayout;
 
-        // 3. Determine starting Y based on Vertical Alignment
-        // We align the "block", then adjust for the font baseline
-        int start_y_offset = 0;
+        float offset_y = 0.0f;
         switch (m_eTextAlignment.vertical) {
-            case VerticalAlignment::Top:    start_y_offset = 0; break;
-            case VerticalAlignment::Center: start_y_offset = (target_height - text_height) / 2; break;
-            case VerticalAlignment::Bottom: start_y_offset = (target_height - text_height); break;
+            case VerticalAlignment::Top:    offset_y = 0.0f; break;
+            case VerticalAlignment::Center: offset_y = (static_cast<float>(area_size.y) - text_layout.height) * 0.5f; break;
+            case VerticalAlignment::Bottom: offset_y = static_cast<float>(area_size.y) - text_layout.height; break;
         }
-
-        // The baseline Y position
-        const int baseline_y = start_y_offset + max_ascent;
-
-        // 4. Initialize RGBA buffer
-        Vector<uint8_t> buffer(target_width * target_height * 4, 0);
-
-        int current_x = start_x;
-        for (const char c : m_sText) {
-            if (FT_Load_Char(face, c, FT_LOAD_RENDER)) continue;
-
-            const FT_GlyphSlot slot = face->glyph;
-
-            // Calculate pixel position: baseline minus the glyph's top offset
-            int glyph_y_top = baseline_y - slot->bitmap_top;
-
-            for (uint32_t row = 0; row < slot->bitmap.rows; ++row) {
-                for (uint32_t col = 0; col < slot->bitmap.width; ++col) {
-                    const int pixel_x = current_x + slot->bitmap_left + col;
-                    const int pixel_y = glyph_y_top + row;
-
-                    // Bounds check to prevent buffer overflow if text exceeds target_width/height
-                    if (pixel_x < 0 || pixel_x >= static_cast<int>(target_width) || pixel_y < 0 || pixel_y >= static_cast<int>(target_height))
-                        continue;
-
-                    const uint8_t alpha = slot->bitmap.buffer[row * slot->bitmap.width + col];
-                    const size_t idx = (pixel_y * target_width + pixel_x) * 4;
-
-                    buffer[idx + 0] = static_cast<uint8_t>(m_Color.r * 255);
-                    buffer[idx + 1] = static_cast<uint8_t>(m_Color.g * 255);
-                    buffer[idx + 2] = static_cast<uint8_t>(m_Color.b * 255);
-                    buffer[idx + 3] = static_cast<uint8_t>(alpha * m_Color.a);
-                }
+        Vector<GlyphQuad> quads(text_layout.glyphs);
+        for (size_t i = 0; i < text_layout.lines.size(); ++i) {
+            const auto& line = text_layout.lines[i];
+            float offset_x = 0.0f;
+            switch (m_eTextAlignment.horizontal) {
+                case HorizontalAlignment::Left:   offset_x = 0.0f; break;
+                case HorizontalAlignment::Center: offset_x = std::floor((static_cast<float>(area_size.x) - line.width) * 0.5f); break;
+                case HorizontalAlignment::Right:  offset_x = static_cast<float>(area_size.x) - line.width; break;
+            }
+            const size_t end = i + 1 < text_layout.lines.size() ? text_layout.lines[i + 1].first_glyph : quads.size();
+            for (size_t q = line.first_glyph; q < end; ++q) {
+                quads[q].min += Vector2 { offset_x, offset_y };
+                quads[q].max += Vector2 { offset_x, offset_y };
             }
-            current_x += slot->advance.x >> 6;
         }
-
-        return Texture2D::CreateFromRawData(buffer, reuse != nullptr ? reuse->id() : 0, texture_size, info, TexturePixelFormat::RGBA, TextureInternalPixelFormat::RGBA);
+        return quads;
     }
 
     BaseTextSprite::BaseTextSprite(const String& text, const FontPtr& font, const MaterialPtr& material, const IntRectangle& text_area) :
@@ -894,36 +942,36 @@ namespace fow {
     }
 
     void TextSprite::draw(const Transform& transform) const {
-        if (m_pMesh == nullptr) return;
-        Debug::Assert(m_pMaterial->set_parameter("MainTexture", m_pTexture));
-        Debug::Assert(m_pMaterial->set_parameter("BillboardMode", static_cast<GLuint>(m_eBillboardMode)));
-        m_pMesh->draw(transform);
+        draw_instances({ transform });
     }
     void TextSprite::draw_instances(const Vector<Transform>& transforms) const {
-        if (m_pMesh == nullptr) return;
-        Debug::Assert(m_pMaterial->set_parameter("MainTexture", m_pTexture));
+        if (transforms.empty() || !prepare_draw()) return;
+        RenderQueue::ApplyCurrentSceneParamsToMaterial(m_pMaterial);
         Debug::Assert(m_pMaterial->set_parameter("BillboardMode", static_cast<GLuint>(m_eBillboardMode)));
-        m_pMesh->draw_instances(transforms);
+        Debug::Assert(m_pMaterial->apply());
+        // The camera comes from the SceneParams block, only the model matrices are set, all of them with one call.
+        const auto& shader = m_pMaterial->shader();
+        if (shader != m_pModelMatrixShader) {
+            m_pModelMatrixShader = shader;
+            m_iModelMatrixLocation = shader->uniform_location("MATRIX_MODEL[0]");
+        }
+        if (Debug::Assert(m_iModelMatrixLocation >= 0, "Error while applying uniform \"MATRIX_MODEL\"")) {
+            return;
+        }
+        m_modelMatrices.clear();
+        for (const auto& transform : transforms) {
+            m_modelMatrices.push_back(transform.matrix());
+        }
+        shader->set_uniform(m_iModelMatrixLocation, m_modelMatrices);
+        m_quads.draw(static_cast<GLsizei>(transforms.size()));
     }
 
     void TextSprite::setup_sprite() {
-        if (m_pMesh == nullptr) {
-            const auto result = Mesh::CreateQuad(m_pMaterial);
-            if (!result.has_value()) {
-                Debug::LogError("Failed to create quad mesh for sprite");
-                return;
-            }
-            m_pMesh = result.value();
-        }
-
         BaseTextSprite::setup_sprite();
     }
 
     void BaseTextSprite::set_material(const MaterialPtr& material) {
         m_pMaterial = material;
-        if (m_pMesh != nullptr) {
-            m_pMesh->set_material(m_pMaterial);
-        }
     }
 
     String BaseTextSprite::text() const {
@@ -931,6 +979,9 @@ namespace fow {
     }
 
     void BaseTextSprite::set_text(const String& text) {
+        if (text == m_textRenderer.text()) {
+            return;
+        }
         m_textRenderer.set_text(text);
         setup_sprite();
     }
@@ -941,8 +992,8 @@ namespace fow {
     }
 
     void BaseTextSprite::set_color(const Color& color) {
+        // Applied as a uniform on draw, the glyphs stay as they are.
         m_textRenderer.set_color(color);
-        setup_sprite();
     }
 
     void BaseTextSprite::set_alignment(const TextAlignment& alignment) {
@@ -950,18 +1001,61 @@ namespace fow {
         setup_sprite();
     }
 
+    void BaseTextSprite::set_wrap_width(const int32_t width) {
+        if (width == m_textRenderer.wrap_width()) {
+            return;
+        }
+        m_textRenderer.set_wrap_width(width);
+        setup_sprite();
+    }
+
     void BaseTextSprite::set_text_area(const IntRectangle& rect) {
+        const bool resized = rect.width != m_textArea.width || rect.height != m_textArea.height;
         m_textArea = rect;
-        setup_sprite();
+        if (resized) {
+            setup_sprite();
+        }
     }
 
     void BaseTextSprite::setup_sprite() {
-        auto result = m_textRenderer.create_texture(m_textArea.size());
+        m_bLayoutValid = false;
+    }
+
+    void BaseTextSprite::update_layout() const {
+        const auto& atlas = GlyphAtlas::Instance();
+        auto result = m_textRenderer.layout(m_textArea.size());
         if (!result.has_value()) {
             Debug::LogError(result.error().message);
-            return;
+            m_glyphs.clear();
+        } else {
+            m_glyphs = std::move(result.value());
         }
-        m_pTexture = result.value();
+        m_uAtlasGeneration = atlas.generation();
+        m_bLayoutValid = true;
+        m_bQuadsValid = false;
+    }
+
+    bool BaseTextSprite::update_glyphs() const {
+        if (!m_bLayoutValid || m_uAtlasGeneration != GlyphAtlas::Instance().generation()) {
+            update_layout();
+        }
+        return !m_glyphs.empty() && GlyphAtlas::Instance().texture() != nullptr;
+    }
+
+    bool BaseTextSprite::prepare_draw() const {
+        if (m_pMaterial == nullptr || !update_glyphs()) {
+            return false;
+        }
+        if (!m_bQuadsValid) {
+            m_quads.update(m_glyphs, Vector2(m_textArea.size()));
+            m_bQuadsValid = true;
+        }
+        if (m_quads.is_empty()) {
+            return false;
+        }
+        Debug::Assert(m_pMaterial->set_parameter("MainTexture", TexturePtr(GlyphAtlas::Instance().texture())));
+        Debug::Assert(m_pMaterial->set_parameter("ColorTint", static_cast<Vector4>(m_textRenderer.color())));
+        return true;
     }
 
     TextSprite2D::TextSprite2D(const String& text, const FontPtr& font, const MaterialPtr& material, const IntRectangle& text_area): BaseTextSprite(text, font, material, text_area) {
@@ -969,25 +1063,40 @@ namespace fow {
     }
 
     void TextSprite2D::draw_2d(const Rectangle& rect) const {
-        if (m_pMesh == nullptr) return;
-        Debug::Assert(m_pMaterial->set_parameter("MainTexture", m_pTexture));
-        m_pMesh->draw_2d(rect);
+        if (!prepare_draw()) return;
+        Debug::Assert(m_pMaterial->apply());
+        Debug::Assert(m_pMaterial->shader()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix2D()), "Error while applying uniform \"MATRIX_PROJECTION\"");
+        Debug::Assert(m_pMaterial->shader()->set_uniform("AreaPosition", rect.position()), "Error while applying uniform \"AreaPosition\"");
+        Debug::Assert(m_pMaterial->shader()->set_uniform("AreaSize", rect.size()), "Error while applying uniform \"AreaSize\"");
+        m_quads.draw();
     }
 
-    void TextSprite2D::setup_sprite() {
-        m_pMaterial->set_parameter("UVOffset", Vector2(0.0));
-        m_pMaterial->set_parameter("UVScale",  Vector2(1.0));
-        if (m_pMesh == nullptr) {
-            const auto result = Mesh::CreateQuad2D(m_pMaterial);
-            if (!result.has_value()) {
-                Debug::LogError("Failed to create quad mesh for sprite");
-                return;
-            }
-            m_pMesh = result.value();
-        } else {
-            m_pMesh->set_material(m_pMaterial);
+    bool TextSprite2D::batch_2d(SpriteBatch2D& batch, const Rectangle& rect) const {
+        if (!UsesShader(m_pMaterial, "Text2D")) {
+            return false;
         }
+        if (!update_glyphs() || m_textArea.width <= 0 || m_textArea.height <= 0) {
+            return true;
+        }
+        // The glyphs are laid out in the text area and scaled to the drawn area, like Text2D.vsh does.
+        const Vector2 scale = rect.size() / Vector2(m_textArea.size());
+
+        SpriteQuad quad;
+        quad.color = m_textRenderer.color();
+        quad.texture = GlyphAtlas::Instance().texture();
+        quad.mode = SpriteQuadMode::DistanceField;
+        quad.alpha_scissor = MaterialAlphaScissor(*m_pMaterial);
+        for (const auto& glyph : m_glyphs) {
+            quad.rect = Rectangle { rect.position() + glyph.min * scale, (glyph.max - glyph.min) * scale };
+            quad.uv_min = glyph.uv_min;
+            quad.uv_max = glyph.uv_max;
+            quad.array_layer = static_cast<float>(glyph.page);
+            batch.add(quad);
+        }
+        return true;
+    }
 
+    void TextSprite2D::setup_sprite() {
         BaseTextSprite::setup_sprite();
     }
 }
@@ -0,0 +1,335 @@
+#include "fow/Renderer/SpriteBatch.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/RenderShared.hpp"
+#include "fow/Renderer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+namespace fow {
+    uint32_t PackColorRGBA8(const Color& color) {
+        const auto byte = [](const float value) {
+            return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+        };
+        // Memory order r, g, b, a, read back as normalized unsigned bytes.
+        return byte(color.r) | byte(color.g) << 8 | byte(color.b) << 16 | byte(color.a) << 24;
+    }
+
+    bool RemapToAtlas(SpriteQuad& quad, const AtlasRegion& region) {
+        switch (quad.mode) {
+            case SpriteQuadMode::Texture:
+            case SpriteQuadMode::RoundedRect: {
+                const auto is_inside = [](const Vector2& uv) { return uv.x >= 0.0f && uv.y >= 0.0f && uv.x <= 1.0f && uv.y <= 1.0f; };
+                if (!is_inside(quad.uv_min) || !is_inside(quad.uv_max)) {
+                    return false;
+                }
+                quad.uv_min = region.map(quad.uv_min);
+                quad.uv_max = region.map(quad.uv_max);
+                break;
+            }
+            case SpriteQuadMode::Stretch:
+                // The repeats stay in uv, only the rectangle they repeat moves onto the page.
+                quad.params = Vector4 { region.map(Vector2 { quad.params.x, quad.params.y }), region.map(Vector2 { quad.params.z, quad.params.w }) };
+                break;
+            default:
+                return false;
+        }
+        quad.texture = region.page;
+        return true;
+    }
+
+    template<size_t N>
+    static Option<uint32_t> FindOrAddSlot(std::array<TexturePtr, N>& slots, uint32_t& count, const TexturePtr& texture) {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (slots[i] == texture) {
+                return i;
+            }
+        }
+        if (count == N) {
+            return std::nullopt;
+        }
+        slots[count] = texture;
+        return count++;
+    }
+
+    static bool IsArrayTexture(const TexturePtr& texture) {
+        return texture != nullptr && texture->target() == TextureTarget::Texture2DArray;
+    }
+
+    static Option<uint32_t> FindOrAddSlot(SpriteBatchRange& batch, const TexturePtr& texture) {
+        return IsArrayTexture(texture) ? FindOrAddSlot(batch.arrays, batch.array_count, texture) : FindOrAddSlot(batch.textures, batch.texture_count, texture);
+    }
+
+    static void WriteQuad(SpriteVertex* vertices, const SpriteQuad& quad, const uint32_t slot) {
+        const uint32_t flags = slot | (IsArrayTexture(quad.texture) ? 0x10u : 0u) | static_cast<uint32_t>(quad.mode) << 8;
+        const uint32_t color = PackColorRGBA8(quad.color);
+        const uint32_t border_color = PackColorRGBA8(quad.border_color);
+        const Vector2 min { quad.rect.x, quad.rect.y };
+        const Vector2 max { quad.rect.x + quad.rect.width, quad.rect.y + quad.rect.height };
+        const float layer = quad.array_layer;
+        // Same corners as the quads of Mesh::CreateQuad2D, SpriteBatch2D.vsh derives the quad coordinates from them.
+        vertices[0] = SpriteVertex { { min.x, min.y }, { quad.uv_min.x, quad.uv_min.y, layer }, quad.params, color, border_color, flags, quad.alpha_scissor };
+        vertices[1] = SpriteVertex { { min.x, max.y }, { quad.uv_min.x, quad.uv_max.y, layer }, quad.params, color, border_color, flags, quad.alpha_scissor };
+        vertices[2] = SpriteVertex { { max.x, max.y }, { quad.uv_max.x, quad.uv_max.y, layer }, quad.params, color, border_color, flags, quad.alpha_scissor };
+        vertices[3] = SpriteVertex { { max.x, min.y }, { quad.uv_max.x, quad.uv_min.y, layer }, quad.params, color, border_color, flags, quad.alpha_scissor };
+    }
+
+    SpriteBatch2D::SpriteBatch2D(const TextureAtlas* atlas) : m_iLayer(0), m_bOrdered(true), m_pAtlas(atlas), m_uVao(0), m_uVbo(0), m_uEbo(0), m_uCapacity(0),
+                                                              m_uUploadBegin(0), m_uUploadEnd(0), m_uDrawCalls(0) { }
+
+    SpriteBatch2D::~SpriteBatch2D() {
+        release();
+    }
+
+    void SpriteBatch2D::add(const SpriteQuad& quad) {
+        m_quads.push_back(quad);
+        m_layers.push_back(m_iLayer);
+        remap(m_quads.back());
+    }
+
+    void SpriteBatch2D::remap(SpriteQuad& quad) const {
+        if (m_pAtlas != nullptr && quad.texture != nullptr) {
+            if (const auto* region = m_pAtlas->find(quad.texture.get()); region != nullptr) {
+                FOW_DISCARD(RemapToAtlas(quad, *region));
+            }
+        }
+    }
+
+    void SpriteBatch2D::build() {
+        m_vertices.clear();
+        m_batches.clear();
+        m_uUploadBegin = 0;
+        m_uUploadEnd = m_quads.size();
+        if (m_quads.empty()) {
+            return;
+        }
+
+        // Layers only reorder quads when they were added out of order, a layer keeps the order of its quads.
+        Vector<uint32_t> order(m_quads.size());
+        std::iota(order.begin(), order.end(), 0u);
+        m_bOrdered = std::ranges::is_sorted(m_layers);
+        if (!m_bOrdered) {
+            std::ranges::stable_sort(order, { }, [this](const uint32_t index) { return m_layers[index]; });
+        }
+
+        m_vertices.resize(m_quads.size() * 4);
+        for (size_t i = 0; i < order.size(); ++i) {
+            const auto& quad = m_quads[order[i]];
+            Option<uint32_t> slot;
+            if (!m_batches.empty()) {
+                slot = FindOrAddSlot(m_batches.back(), quad.texture);
+            }
+            if (!slot.has_value()) {
+                slot = FindOrAddSlot(m_batches.emplace_back(SpriteBatchRange { static_cast<uint32_t>(i), 0, { }, { }, 0, 0 }), quad.texture);
+            }
+            ++m_batches.back().quad_count;
+            WriteQuad(&m_vertices[i * 4], quad, slot.value());
+        }
+    }
+
+    bool SpriteBatch2D::patch(const size_t first_quad, const std::span<const SpriteQuad> quads) {
+        // Vertices are only at the index of their quad while build kept the order.
+        if (!m_bOrdered || m_vertices.size() != m_quads.size() * 4 || first_quad + quads.size() > m_quads.size()) {
+            return false;
+        }
+        if (quads.empty()) {
+            return true;
+        }
+
+        Vector<SpriteQuad> remapped(quads.begin(), quads.end());
+        Vector<uint32_t> slots(quads.size());
+        // Slots are taken on copies of the batches, they only replace the batches once every quad found one.
+        Vector<SpriteBatchRange> touched;
+        auto batch = std::ranges::upper_bound(m_batches, static_cast<uint32_t>(first_quad), { }, &SpriteBatchRange::first_quad) - 1;
+        touched.push_back(*batch);
+        for (size_t i = 0; i < remapped.size(); ++i) {
+            const auto index = static_cast<uint32_t>(first_quad + i);
+            while (index >= batch->first_quad + batch->quad_count) {
+                touched.push_back(*++batch);
+            }
+            remap(remapped[i]);
+            // A free slot of the batch can take a new texture, the other quads of the batch do not notice.
+            const auto slot = FindOrAddSlot(touched.back(), remapped[i].texture);
+            if (!slot.has_value()) {
+                return false;
+            }
+            slots[i] = slot.value();
+        }
+
+        auto first_batch = batch - static_cast<ptrdiff_t>(touched.size() - 1);
+        std::ranges::move(touched, first_batch);
+
+        for (size_t i = 0; i < remapped.size(); ++i) {
+            m_quads[first_quad + i] = std::move(remapped[i]);
+            WriteQuad(&m_vertices[(first_quad + i) * 4], m_quads[first_quad + i], slots[i]);
+        }
+        if (m_uUploadBegin == m_uUploadEnd) {
+            m_uUploadBegin = first_quad;
+            m_uUploadEnd = first_quad + quads.size();
+        } else {
+            m_uUploadBegin = std::min(m_uUploadBegin, first_quad);
+            m_uUploadEnd = std::max(m_uUploadEnd, first_quad + quads.size());
+        }
+        return true;
+    }
+
+    bool SpriteBatch2D::prepare_gl(const size_t quads) const {
+        if (m_pMaterial == nullptr) {
+            const auto material = Material::New("SpriteBatch2D");
+            if (!material.has_value()) {
+                Debug::LogError(std::format("Failed to create sprite batch material: {}", material.error().message));
+                return false;
+            }
+            m_pMaterial = material.value();
+            m_pMaterial->set_opaque(false);
+            m_pMaterial->set_depth_test(false);
+            m_pMaterial->set_backface_culling(false);
+            m_textureParams.clear();
+            m_arrayParams.clear();
+            for (size_t i = 0; i < FOW_SPRITE_BATCH_TEXTURE_SLOTS; ++i) {
+                m_textureParams.push_back(m_pMaterial->parameter<TexturePtr>(std::format("SpriteTexture{}", i)).value_or(MaterialParam<TexturePtr> { }));
+            }
+            for (size_t i = 0; i < FOW_SPRITE_BATCH_ARRAY_SLOTS; ++i) {
+                m_arrayParams.push_back(m_pMaterial->parameter<TexturePtr>(std::format("SpriteArray{}", i)).value_or(MaterialParam<TexturePtr> { }));
+            }
+        }
+        if (quads <= m_uCapacity && m_uVao != 0) {
+            return true;
+        }
+
+        const size_t capacity = std::max<size_t>(std::bit_ceil(quads), 256);
+        if (m_uVao == 0) {
+            glGenVertexArrays(1, &m_uVao);
+            glGenBuffers(1, &m_uVbo);
+            glGenBuffers(1, &m_uEbo);
+        }
+
+        // The indices never change for a capacity, only the vertices are streamed every submit.
+        Vector<GLuint> indices;
+        indices.reserve(capacity * 6);
+        for (GLuint quad = 0; quad < capacity; ++quad) {
+            const GLuint base = quad * 4;
+            indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+        }
+
+        GlStateCache::Instance().bind_vertex_array(m_uVao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * 4 * sizeof(SpriteVertex)), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uEbo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, position)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, uv)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, params)));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, color)));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, border_color)));
+        glEnableVertexAttribArray(5);
+        glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, flags)));
+        glEnableVertexAttribArray(6);
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), reinterpret_cast<void*>(offsetof(SpriteVertex, alpha_scissor)));
+        GlStateCache::Instance().bind_vertex_array(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_uCapacity = capacity;
+        return true;
+    }
+
+    void SpriteBatch2D::submit() const {
+        const size_t quads = m_vertices.size() / 4;
+        const size_t capacity = m_uCapacity;
+        if (m_batches.empty() || !prepare_gl(quads)) {
+            return;
+        }
+        if (m_uCapacity != capacity || (m_uUploadBegin == 0 && m_uUploadEnd >= quads)) {
+            // Orphans the storage of the previous submit, so the driver does not wait for draws still reading from it.
+            glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_uCapacity * 4 * sizeof(SpriteVertex)), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(m_vertices.size() * sizeof(SpriteVertex)), m_vertices.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        } else if (m_uUploadBegin < m_uUploadEnd) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(m_uUploadBegin * 4 * sizeof(SpriteVertex)),
+                            static_cast<GLsizeiptr>((m_uUploadEnd - m_uUploadBegin) * 4 * sizeof(SpriteVertex)), &m_vertices[m_uUploadBegin * 4]);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        m_uUploadBegin = m_uUploadEnd = 0;
+
+        for (const auto& batch : m_batches) {
+            for (size_t i = 0; i < m_textureParams.size(); ++i) {
+                if (m_textureParams[i].is_valid()) {
+                    m_pMaterial->set_parameter(m_textureParams[i], batch.textures[i]);
+                }
+            }
+            for (size_t i = 0; i < m_arrayParams.size(); ++i) {
+                if (m_arrayParams[i].is_valid()) {
+                    m_pMaterial->set_parameter(m_arrayParams[i], batch.arrays[i]);
+                }
+            }
+            Debug::Assert(m_pMaterial->apply());
+            Debug::Assert(m_pMaterial->shader()->set_uniform("MATRIX_PROJECTION", Renderer::GetProjectionMatrix2D()), "Error while applying uniform \"MATRIX_PROJECTION\"");
+
+            GlStateCache::Instance().bind_vertex_array(m_uVao);
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.quad_count * 6), GL_UNSIGNED_INT, reinterpret_cast<void*>(batch.first_quad * 6 * sizeof(GLuint)));
+            ++m_uDrawCalls;
+        }
+    }
+
+    void SpriteBatch2D::clear() {
+        m_quads.clear();
+        m_layers.clear();
+        m_vertices.clear();
+        m_batches.clear();
+        m_bOrdered = true;
+        m_uUploadBegin = m_uUploadEnd = 0;
+    }
+
+    void SpriteBatch2D::flush() {
+        if (m_quads.empty()) {
+            return;
+        }
+        build();
+        submit();
+        clear();
+    }
+
+    bool SpriteBatch2D::draw_immediate(const IDrawable2D& drawable, const Rectangle& rect) {
+        flush();
+        if (!drawable.batch_2d(*this, rect)) {
+            return false;
+        }
+        flush();
+        return true;
+    }
+
+    void SpriteBatch2D::release() {
+        if (m_uVao != 0) {
+            GlStateCache::Instance().forget_vertex_array(m_uVao);
+            glDeleteVertexArrays(1, &m_uVao);
+        }
+        if (m_uVbo != 0) {
+            glDeleteBuffers(1, &m_uVbo);
+        }
+        if (m_uEbo != 0) {
+            glDeleteBuffers(1, &m_uEbo);
+        }
+        m_uVao = m_uVbo = m_uEbo = 0;
+        m_uCapacity = 0;
+        // The next submit uploads everything into the new buffer.
+        m_uUploadBegin = 0;
+        m_uUploadEnd = m_quads.size();
+        m_pMaterial = nullptr;
+        m_textureParams.clear();
+        m_arrayParams.clear();
+    }
+
+    SpriteBatch2D& SpriteBatch2D::Instance() {
+        static SpriteBatch2D s_instance(&TextureAtlas::Instance());
+        return s_instance;
+    }
+}
@@ -0,0 +1,262 @@
+#include "fow/Renderer/TextLayout.hpp"
+#include "fow/Renderer/Sprite.hpp"
+
+#include <algorithm>
+
+namespace fow {
+    static bool IsWrapSpace(const char c) {
+        return c == ' ' || c == '\t' || c == '\n';
+    }
+
+    size_t TextLayout::resume_cursor(const std::string_view new_text) const {
+        const std::string_view old_text(text.as_cstr(), text.size());
+        const size_t max_common = std::min(old_text.size(), new_text.size());
+        size_t common = 0;
+        while (common < max_common && old_text[common] == new_text[common]) {
+            ++common;
+        }
+
+        // Last codepoint that starts at or before the first changed byte.
+        const auto it = std::upper_bound(cursors.begin(), cursors.end(), common, [](const size_t value, const TextCursor& cursor) {
+            return value < cursor.byte;
+        });
+        size_t index = it == cursors.begin() ? 0 : static_cast<size_t>(it - cursors.begin()) - 1;
+        // A malformed sequence, decoded one byte at a time, can decode differently once the new text completes it.
+        while (index > 0 && common - cursors[index - 1].byte < 4 && cursors[index].byte - cursors[index - 1].byte == 1 &&
+               static_cast<uint8_t>(old_text[cursors[index - 1].byte]) >= 0x80) {
+            --index;
+        }
+        if (wrap_width <= 0 || index == 0) {
+            return index;
+        }
+
+        // A changed word can move up to the previous line when it starts a wrapped line, or push words down. Lines are
+        // only broken greedily, so everything before the line above the word stays.
+        while (index > 0 && !IsWrapSpace(old_text[cursors[index - 1].byte])) {
+            --index;
+        }
+        const uint32_t line = cursors[index].line;
+        return lines[line > 0 ? line - 1 : 0].first_codepoint;
+    }
+
+    size_t TextLayout::memory_usage() const {
+        return sizeof(TextLayout) + text.size() + glyphs.capacity() * sizeof(GlyphQuad) + lines.capacity() * sizeof(TextLine) + cursors.capacity() * sizeof(TextCursor);
+    }
+
+    TextLayoutCache::TextLayoutCache(const size_t budget) : m_uBudget(budget), m_uMemoryUsage(0), m_uHits(0), m_uMisses(0), m_uResumed(0) { }
+
+    Result<TextLayoutPtr> TextLayoutCache::get(const Font& font, const std::string_view text, const int32_t wrap_width, const TextLayoutPtr& previous) {
+        if (!font.is_valid()) {
+            return Failure(std::format("Failed to lay out text \"{}\": Font is not loaded", text));
+        }
+
+        const uint32_t generation = GlyphAtlas::Instance().generation();
+        const auto key = MakeKey(font.id(), font.size(), text, wrap_width);
+        if (const auto cached = find(key, text); cached != nullptr) {
+            if (cached->generation == generation) {
+                ++m_uHits;
+                return Success<TextLayoutPtr>(cached);
+            }
+            // Glyphs were evicted from the atlas, all cached layouts point at stale atlas space.
+            clear();
+        }
+        ++m_uMisses;
+
+        const bool can_resume = previous != nullptr && previous->font == font.id() && previous->size == font.size() &&
+                                previous->wrap_width == wrap_width && previous->generation == generation;
+        auto result = layout(font, text, wrap_width, can_resume ? previous.get() : nullptr);
+        if (!result.has_value()) {
+            return Failure(result.error());
+        }
+        insert(key, result.value());
+        return Success<TextLayoutPtr>(result.value());
+    }
+
+    TextLayoutPtr TextLayoutCache::find(const TextLayoutKey& key, const std::string_view text) {
+        const auto it = m_index.find(key);
+        if (it == m_index.end()) {
+            return nullptr;
+        }
+        const auto& layout = it->second->layout;
+        if (std::string_view(layout->text.as_cstr(), layout->text.size()) != text) {
+            return nullptr;
+        }
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return layout;
+    }
+
+    void TextLayoutCache::insert(const TextLayoutKey& key, const TextLayoutPtr& layout) {
+        if (const auto it = m_index.find(key); it != m_index.end()) {
+            m_uMemoryUsage -= it->second->layout->memory_usage();
+            m_entries.erase(it->second);
+            m_index.erase(it);
+        }
+        if (layout == nullptr || layout->memory_usage() > m_uBudget) {
+            return;
+        }
+        m_entries.push_front(Entry { key, layout });
+        m_index.insert_or_assign(key, m_entries.begin());
+        m_uMemoryUsage += layout->memory_usage();
+        evict();
+    }
+
+    void TextLayoutCache::clear() {
+        m_entries.clear();
+        m_index.clear();
+        m_uMemoryUsage = 0;
+    }
+
+    void TextLayoutCache::set_budget(const size_t budget) {
+        m_uBudget = budget;
+        evict();
+    }
+
+    void TextLayoutCache::evict() {
+        while (m_uMemoryUsage > m_uBudget && !m_entries.empty()) {
+            const auto& entry = m_entries.back();
+            m_uMemoryUsage -= entry.layout->memory_usage();
+            m_index.erase(entry.key);
+            m_entries.pop_back();
+        }
+    }
+
+    TextLayoutKey TextLayoutCache::MakeKey(const uint32_t font, const uint32_t size, const std::string_view text, const int32_t wrap_width) {
+        return TextLayoutKey { font, size, std::hash<std::string_view> { }(text), wrap_width };
+    }
+
+    TextLayoutCache& TextLayoutCache::Instance() {
+        static TextLayoutCache s_instance;
+        return s_instance;
+    }
+
+    Result<Ref<TextLayout>> TextLayoutCache::layout(const Font& font, const std::string_view text, const int32_t wrap_width, const TextLayout* previous) {
+        const FT_Face face = font.m_pFace;
+        const uint32_t bucket = GlyphSizeBucket(static_cast<float>(font.size()));
+        const float scale = static_cast<float>(font.size()) / static_cast<float>(bucket);
+        const float max_width = static_cast<float>(wrap_width);
+        const bool has_kerning = FT_HAS_KERNING(face);
+        auto& atlas = GlyphAtlas::Instance();
+
+        auto result = CreateRef<TextLayout>();
+        result->text = String(text);
+        result->font = font.id();
+        result->size = font.size();
+        result->wrap_width = wrap_width;
+
+        // Glyphs rasterized for this text can evict the ones placed before them, then the layout starts over once.
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            auto& glyphs = result->glyphs;
+            auto& lines = result->lines;
+            auto& cursors = result->cursors;
+            const uint32_t generation = atlas.generation();
+
+            size_t first = 0;
+            if (previous != nullptr && attempt == 0) {
+                first = previous->resume_cursor(text);
+            }
+            TextCursor state { 0, 0, 0, 0, 0.0f, 0.0f };
+            if (first > 0) {
+                state = previous->cursors[first];
+                glyphs.assign(previous->glyphs.begin(), previous->glyphs.begin() + state.glyph);
+                lines.assign(previous->lines.begin(), previous->lines.begin() + state.line + 1);
+                cursors.assign(previous->cursors.begin(), previous->cursors.begin() + static_cast<ptrdiff_t>(first));
+                ++m_uResumed;
+            } else {
+                glyphs.clear();
+                lines.assign(1, TextLine { 0, 0, 0.0f, false });
+                cursors.clear();
+            }
+            glyphs.reserve(text.size());
+            cursors.reserve(text.size() + 1);
+
+            float pen_x = state.pen_x;
+            float line_width = state.line_width;
+            float baseline = font.ascender() + static_cast<float>(state.line) * font.line_height();
+            uint32_t line = state.line;
+            FT_UInt previous_glyph = state.previous;
+            size_t word_start = first;
+            for (size_t offset = state.byte; offset < text.size();) {
+                const size_t index = cursors.size();
+                cursors.push_back(TextCursor { static_cast<uint32_t>(offset), static_cast<uint32_t>(glyphs.size()), line, previous_glyph, pen_x, line_width });
+                const char32_t codepoint = DecodeUtf8Next(text, offset);
+
+                if (codepoint == U'\n') {
+                    lines.back().width = line_width;
+                    lines.push_back(TextLine { static_cast<uint32_t>(glyphs.size()), static_cast<uint32_t>(index + 1), 0.0f, false });
+                    pen_x = 0.0f;
+                    line_width = 0.0f;
+                    baseline += font.line_height();
+                    ++line;
+                    previous_glyph = 0;
+                    word_start = index + 1;
+                    continue;
+                }
+
+                const FT_UInt glyph_index = FT_Get_Char_Index(face, codepoint);
+                const auto* glyph = atlas.glyph(font, glyph_index, bucket);
+                if (glyph == nullptr) {
+                    continue;
+                }
+                const float advance = glyph->advance * scale;
+                // Words are not kerned against the space before them, so a wrapped line starts the same either way.
+                if (codepoint == U' ' || codepoint == U'\t') {
+                    pen_x += advance;
+                    previous_glyph = 0;
+                    word_start = index + 1;
+                    continue;
+                }
+
+                // The word moves to the next line, a word that is wider than a whole line is broken as well.
+                while (wrap_width > 0 && pen_x > 0.0f && pen_x + advance > max_width) {
+                    if (cursors[word_start].line != line || cursors[word_start].line_width <= 0.0f) {
+                        word_start = index;
+                    }
+                    const TextCursor start = cursors[word_start];
+                    lines.back().width = start.line_width;
+                    lines.push_back(TextLine { start.glyph, static_cast<uint32_t>(word_start), 0.0f, true });
+                    for (size_t i = start.glyph; i < glyphs.size(); ++i) {
+                        glyphs[i].min += Vector2 { -start.pen_x, font.line_height() };
+                        glyphs[i].max += Vector2 { -start.pen_x, font.line_height() };
+                    }
+                    for (size_t i = word_start; i <= index; ++i) {
+                        cursors[i].pen_x -= start.pen_x;
+                        cursors[i].line_width = cursors[i].pen_x;
+                        cursors[i].line += 1;
+                    }
+                    cursors[word_start].previous = 0;
+                    if (word_start == index) {
+                        previous_glyph = 0;
+                    }
+                    pen_x -= start.pen_x;
+                    line_width = pen_x;
+                    baseline += font.line_height();
+                    ++line;
+                }
+
+                if (has_kerning && previous_glyph != 0 && glyph_index != 0) {
+                    FT_Vector kerning;
+                    if (FT_Get_Kerning(face, previous_glyph, glyph_index, FT_KERNING_DEFAULT, &kerning) == FT_Err_Ok) {
+                        pen_x += static_cast<float>(kerning.x) / 64.0f;
+                    }
+                }
+                if (glyph->size.x > 0.0f && glyph->size.y > 0.0f) {
+                    const Vector2 min { pen_x + glyph->bearing.x * scale, baseline - glyph->bearing.y * scale };
+                    glyphs.push_back(GlyphQuad { min, min + glyph->size * scale, glyph->uv_min, glyph->uv_max, glyph->page });
+                }
+                pen_x += advance;
+                line_width = pen_x;
+                previous_glyph = glyph_index;
+            }
+            cursors.push_back(TextCursor { static_cast<uint32_t>(text.size()), static_cast<uint32_t>(glyphs.size()), line, previous_glyph, pen_x, line_width });
+            lines.back().width = line_width;
+
+            if (atlas.generation() == generation) {
+                result->generation = generation;
+                break;
+            }
+        }
+
+        result->height = font.ascender() - font.descender() + static_cast<float>(result->lines.size() - 1) * font.line_height();
+        return Success<Ref<TextLayout>>(result);
+    }
+}
@@ -1,5 +1,7 @@
 #include "fow/Renderer/GL.hpp"
 #include "fow/Renderer/Texture.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+#include "fow/Renderer/UploadQueue.hpp"
 
 #include "image_array.h"
 #include "fow/Shared/StringConversion.hpp"
@@ -175,7 +177,7 @@ namespace fow {
         }
 
         info.MagFilter = pointFilter ? TextureMagFilterMode::Nearest : TextureMagFilterMode::Linear;
-        info.MinFilter = info.GenerateMipMaps ?
+        info.MinFilter = info.GenerateMipMaps.value_or(false) ?
             (pointFilter ? TextureMinFilterMode::NearestMipmapLinear : TextureMinFilterMode::LinearMipmapLinear) :
             (pointFilter ? TextureMinFilterMode::Nearest : TextureMinFilterMode::Linear);
         info.WrapS = clamp ? TextureWrapMode::ClampToEdge : TextureWrapMode::Repeat;
@@ -186,6 +188,7 @@ namespace fow {
 
     Texture::~Texture() {
         if (m_uId != 0 && m_bInitialized) {
+            GlStateCache::Instance().forget_texture(m_uId);
             glDeleteTextures(1, &m_uId);
         }
     }
@@ -193,7 +196,7 @@ namespace fow {
     GLsizei Texture::width() const {
         GLsizei value = -1;
         const auto gl_target = static_cast<GLenum>(target());
-        glBindTexture(gl_target, m_uId);
+        GlStateCache::Instance().bind_texture(gl_target, m_uId);
         glGetTexLevelParameteriv(gl_target, 0, GL_TEXTURE_WIDTH, &value);
         if (value < 0) {
             Debug::LogError("Failed to get texture width");
@@ -203,7 +206,7 @@ namespace fow {
     GLsizei Texture::height() const {
         GLsizei value = -1;
         const auto gl_target = static_cast<GLenum>(target());
-        glBindTexture(gl_target, m_uId);
+        GlStateCache::Instance().bind_texture(gl_target, m_uId);
         glGetTexLevelParameteriv(gl_target, 0, GL_TEXTURE_HEIGHT, &value);
         if (value < 0) {
             Debug::LogError("Failed to get texture height");
@@ -214,7 +217,7 @@ namespace fow {
     Vector2i Texture::size() const {
         Vector2i value = Vector2i { -1 };
         const auto gl_target = static_cast<GLenum>(target());
-        glBindTexture(gl_target, m_uId);
+        GlStateCache::Instance().bind_texture(gl_target, m_uId);
         glGetTexLevelParameteriv(gl_target, 0, GL_TEXTURE_WIDTH, &value.x);
         glGetTexLevelParameteriv(gl_target, 0, GL_TEXTURE_HEIGHT, &value.y);
         if (value.x < 0) {
@@ -228,18 +231,14 @@ namespace fow {
 
     GLsizei Texture::depth() const {
         GLsizei value;
-        const auto gl_target = static_cast<GLenum>(target());
-        glBindTexture(gl_target, m_uId);
-        glGetTextureLevelParameteriv(gl_target, 0, GL_TEXTURE_DEPTH, &value);
+        glGetTextureLevelParameteriv(m_uId, 0, GL_TEXTURE_DEPTH, &value);
         return value;
     }
     Vector3i Texture::size_3d() const {
         Vector3i value;
-        const auto gl_target = static_cast<GLenum>(target());
-        glBindTexture(gl_target, m_uId);
-        glGetTextureLevelParameteriv(gl_target, 0, GL_TEXTURE_WIDTH, &value.x);
-        glGetTextureLevelParameteriv(gl_target, 0, GL_TEXTURE_HEIGHT, &value.y);
-        glGetTextureLevelParameteriv(gl_target, 0, GL_TEXTURE_DEPTH, &value.z);
+        glGetTextureLevelParameteriv(m_uId, 0, GL_TEXTURE_WIDTH, &value.x);
+        glGetTextureLevelParameteriv(m_uId, 0, GL_TEXTURE_HEIGHT, &value.y);
+        glGetTextureLevelParameteriv(m_uId, 0, GL_TEXTURE_DEPTH, &value.z);
         return value;
     }
 
@@ -256,9 +255,7 @@ namespace fow {
 
     TextureInternalPixelFormat Texture::format() const {
         GLsizei value;
-        const auto gl_target = static_cast<GLenum>(target());
-        glBindTexture(gl_target, m_uId);
-        glGetTextureLevelParameteriv(gl_target, 0, GL_TEXTURE_INTERNAL_FORMAT, &value);
+        glGetTextureLevelParameteriv(m_uId, 0, GL_TEXTURE_INTERNAL_FORMAT, &value);
         return static_cast<TextureInternalPixelFormat>(value);
     }
 
@@ -307,8 +304,8 @@ namespace fow {
     }
 
     void Texture::bind(const uint8_t unit) const {
-        glActiveTexture(GL_TEXTURE0 + (unit % 32));
-        glBindTexture(static_cast<GLenum>(target()), m_uId);
+        const auto id = m_uId == 0 && target() == TextureTarget::Texture2D ? DefaultGray()->id() : m_uId;
+        GlStateCache::Instance().bind_texture(unit % FOW_GL_STATE_CACHE_MAX_TEXTURE_UNITS, static_cast<GLenum>(target()), id);
     }
 
     static TexturePtr s_placeholder_texture = nullptr;
@@ -339,13 +336,13 @@ namespace fow {
             throw std::runtime_error(std::format("Failed to generate placeholder texture: GL error {}", glGetError()));
         }
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FOW_TEXTURE_PLACEHOLDER_SIZE, FOW_TEXTURE_PLACEHOLDER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
         s_placeholder_texture = std::make_shared<Texture2D>(std::move(Texture2D { id }));
         return s_placeholder_texture;
     }
@@ -365,13 +362,13 @@ namespace fow {
             throw std::runtime_error(std::format("Failed to generate default white texture: GL error {}", glGetError()));
         }
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FOW_TEXTURE_PLACEHOLDER_SIZE, FOW_TEXTURE_PLACEHOLDER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
         s_white_texture = std::make_shared<Texture2D>(std::move(Texture2D { id }));
         return s_white_texture;
     }
@@ -392,13 +389,13 @@ namespace fow {
             throw std::runtime_error(std::format("Failed to generate default white texture: GL error {}", glGetError()));
         }
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FOW_TEXTURE_PLACEHOLDER_SIZE, FOW_TEXTURE_PLACEHOLDER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
         s_gray_texture = std::make_shared<Texture2D>(std::move(Texture2D { id }));
         return s_gray_texture;
     }
@@ -419,13 +416,13 @@ namespace fow {
             throw std::runtime_error(std::format("Failed to generate default black texture: GL error {}", glGetError()));
         }
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FOW_TEXTURE_PLACEHOLDER_SIZE, FOW_TEXTURE_PLACEHOLDER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
         s_black_texture = std::make_shared<Texture2D>(std::move(Texture2D { id }));
         return s_black_texture;
     }
@@ -445,13 +442,13 @@ namespace fow {
             throw std::runtime_error(std::format("Failed to generate default normal texture: GL error {}", glGetError()));
         }
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, FOW_TEXTURE_PLACEHOLDER_SIZE, FOW_TEXTURE_PLACEHOLDER_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
         s_normal_texture = std::make_shared<Texture2D>(std::move(Texture2D { id }));
         return s_normal_texture;
     }
@@ -491,7 +488,7 @@ namespace fow {
             goto LOAD_GL_TEXTURE_END;
         }
 
-        if (info.GenerateMipMaps) {
+        if (info.GenerateMipMaps.value_or(false)) {
             flags |= SOIL_FLAG_MIPMAPS;
         }
         if (info.CoCg.value_or(false)) {
@@ -517,17 +514,18 @@ namespace fow {
             goto LOAD_GL_TEXTURE_END;
         }
 
-        glBindTexture(gl_target, id);
+        GlStateCache::Instance().bind_texture(gl_target, id);
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(mag_filter));
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(min_filter));
         glTextureParameteri(id, GL_TEXTURE_WRAP_S,     static_cast<GLint>(wrap_s)    );
         glTextureParameteri(id, GL_TEXTURE_WRAP_T,     static_cast<GLint>(wrap_t)    );
 
-        glBindTexture(gl_target, 0);
+        GlStateCache::Instance().bind_texture(gl_target, 0);
         result = Success<GLuint>(id);
 
     LOAD_GL_TEXTURE_END:
         if (!result.has_value() && id != 0) {
+            GlStateCache::Instance().forget_texture(id);
             glDeleteTextures(1, &id);
         }
         return result;
@@ -558,7 +556,7 @@ namespace fow {
             return Failure(std::format("Failed to generate OpenGL texture handle: GL error \"{}\"", glGetError()));
         }
 
-        if (info.GenerateMipMaps) {
+        if (info.GenerateMipMaps.value_or(false)) {
             flags |= SOIL_FLAG_MIPMAPS;
         }
         if (info.CoCg.value_or(false)) {
@@ -586,17 +584,18 @@ namespace fow {
             );
         } else {
             if (id != 0) {
+                GlStateCache::Instance().forget_texture(id);
                 glDeleteTextures(1, &id);
             }
             return Failure("Failed to load OpenGL texture data: Unsupported texture target");
         }
 
-        glBindTexture(gl_target, id);
+        GlStateCache::Instance().bind_texture(gl_target, id);
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(mag_filter));
         glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(min_filter));
         glTextureParameteri(id, GL_TEXTURE_WRAP_S,     static_cast<GLint>(wrap_s)    );
         glTextureParameteri(id, GL_TEXTURE_WRAP_T,     static_cast<GLint>(wrap_t)    );
-        glBindTexture(gl_target, 0);
+        GlStateCache::Instance().bind_texture(gl_target, 0);
 
         return Success<GLuint>(id);
     }
@@ -616,6 +615,23 @@ namespace fow {
         return Failure(std::format("Failed to load image data \"{}\": {}", info.Source, id_result.error().message), id_result.error().location);
     }
 
+    Result<Texture2DPtr> Texture2D::LoadFromMemoryDeferred(const Vector<uint8_t>& data, const TextureInfo& info) {
+        if (info.Target.value_or(TextureTarget::Texture2D) != TextureTarget::Texture2D) {
+            return Failure(std::format("Failed to load image data \"{}\": Only 2D textures can be uploaded deferred", info.Source));
+        }
+        int width, height, channels;
+        auto* pixels = SOIL_load_image_from_memory(data.data(), static_cast<int>(data.size()), &width, &height, &channels, SOIL_LOAD_RGBA);
+        if (pixels == nullptr) {
+            return Failure(std::format("Failed to load image data \"{}\": {}", info.Source, SOIL_last_result()));
+        }
+        TextureUploadPayload payload {
+            Vector<uint8_t>(pixels, pixels + static_cast<size_t>(width) * height * 4), Vector2i { width, height }, info,
+            TexturePixelFormat::RGBA, info.SRgb.value_or(false) ? TextureInternalPixelFormat::SRGBA : TextureInternalPixelFormat::RGBA
+        };
+        SOIL_free_image_data(pixels);
+        return Success<Texture2DPtr>(UploadQueue::Instance().enqueue(std::move(payload)));
+    }
+
     Result<Texture2DPtr> Texture2D::LoadAsset(const Path& path, const AssetLoaderFlags::Type flags) {
         if (!path.extension().equals(".xml", StringCompareType::CaseInsensitive)) {
             return Failure(std::format("Failed to load texture \"{}\": Expected asset extension '.xml'", path));
@@ -632,6 +648,9 @@ namespace fow {
             return Failure(std::format("Failed to load texture \"{}\": Expected target 'Texture2D'", path));
         }
         if (const auto image_data = Assets::LoadAsBytes(info_value->Source.c_str(), flags); image_data.has_value()) {
+            if (flags & AssetLoaderFlags::Deferred) {
+                return LoadFromMemoryDeferred(image_data.value(), info_value.value());
+            }
             return LoadFromMemory(image_data.value(), info_value.value());
         }
         return Failure(std::format("Failed to load texture \"{}\": Image data \"{}\" cannot be found!", path, info_value->Source));
@@ -658,7 +677,7 @@ namespace fow {
             return Failure(std::format("Failed to generate OpenGL texture handle: GL error \"{}\"", glGetError()));
         }
 
-        glBindTexture(GL_TEXTURE_2D, id);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
 
         glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), static_cast<GLsizei>(size.x), static_cast<GLsizei>(size.y), 0, static_cast<GLenum>(format), GL_UNSIGNED_BYTE, data.data());
         glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(mag_filter));
@@ -666,10 +685,10 @@ namespace fow {
         glTextureParameteri(id, GL_TEXTURE_WRAP_S, static_cast<GLenum>(wrap_s));
         glTextureParameteri(id, GL_TEXTURE_WRAP_T, static_cast<GLenum>(wrap_t));
 
-        if (info.GenerateMipMaps) {
+        if (info.GenerateMipMaps.value_or(false)) {
             glGenerateTextureMipmap(id);
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
 
         return Success<Texture2DPtr>(std::make_shared<Texture2D>(std::move(Texture2D { id })));
     }
@@ -0,0 +1,273 @@
+#include "fow/Renderer/TextureAtlas.hpp"
+#include "fow/Renderer/GlStateCache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+
+namespace fow {
+    MaxRectsPacker::MaxRectsPacker(const Vector2i& size) : m_iUsedArea(0) {
+        reset(size);
+    }
+
+    void MaxRectsPacker::reset(const Vector2i& size) {
+        m_size = size;
+        m_free.clear();
+        m_iUsedArea = 0;
+        if (size.x > 0 && size.y > 0) {
+            m_free.push_back(Rect { 0, 0, size.x, size.y });
+        }
+    }
+
+    float MaxRectsPacker::occupancy() const {
+        const auto area = static_cast<int64_t>(m_size.x) * m_size.y;
+        return area > 0 ? static_cast<float>(static_cast<double>(m_iUsedArea) / static_cast<double>(area)) : 0.0f;
+    }
+
+    Option<Vector2i> MaxRectsPacker::pack(const Vector2i& size) {
+        if (size.x <= 0 || size.y <= 0) {
+            return std::nullopt;
+        }
+
+        // Best short side fit, the long side on ties.
+        size_t best_index = SIZE_MAX;
+        int best_short = INT_MAX;
+        int best_long = INT_MAX;
+        for (size_t i = 0; i < m_free.size(); ++i) {
+            const auto& free = m_free[i];
+            if (free.width < size.x || free.height < size.y) {
+                continue;
+            }
+            const int left_x = free.width - size.x;
+            const int left_y = free.height - size.y;
+            const int short_side = std::min(left_x, left_y);
+            const int long_side = std::max(left_x, left_y);
+            if (short_side < best_short || (short_side == best_short && long_side < best_long)) {
+                best_index = i;
+                best_short = short_side;
+                best_long = long_side;
+            }
+        }
+        if (best_index == SIZE_MAX) {
+            return std::nullopt;
+        }
+
+        const Rect placed { m_free[best_index].x, m_free[best_index].y, size.x, size.y };
+        // Every free rectangle the new one overlaps is replaced by the up to four parts of it that stay free.
+        Vector<Rect> next;
+        next.reserve(m_free.size() + 4);
+        for (const auto& free : m_free) {
+            if (placed.x >= free.x + free.width || placed.x + placed.width <= free.x ||
+                placed.y >= free.y + free.height || placed.y + placed.height <= free.y) {
+                next.push_back(free);
+                continue;
+            }
+            if (placed.x > free.x) {
+                next.push_back(Rect { free.x, free.y, placed.x - free.x, free.height });
+            }
+            if (placed.x + placed.width < free.x + free.width) {
+                next.push_back(Rect { placed.x + placed.width, free.y, free.x + free.width - placed.x - placed.width, free.height });
+            }
+            if (placed.y > free.y) {
+                next.push_back(Rect { free.x, free.y, free.width, placed.y - free.y });
+            }
+            if (placed.y + placed.height < free.y + free.height) {
+                next.push_back(Rect { free.x, placed.y + placed.height, free.width, free.y + free.height - placed.y - placed.height });
+            }
+        }
+        m_free = std::move(next);
+        prune();
+
+        m_iUsedArea += static_cast<int64_t>(size.x) * size.y;
+        return Vector2i { placed.x, placed.y };
+    }
+
+    void MaxRectsPacker::prune() {
+        const auto contains = [](const Rect& outer, const Rect& inner) {
+            return inner.x >= outer.x && inner.y >= outer.y &&
+                   inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+        };
+        for (size_t i = 0; i < m_free.size(); ++i) {
+            for (size_t j = i + 1; j < m_free.size();) {
+                if (contains(m_free[i], m_free[j])) {
+                    m_free.erase(m_free.begin() + static_cast<ptrdiff_t>(j));
+                    continue;
+                }
+                if (contains(m_free[j], m_free[i])) {
+                    m_free.erase(m_free.begin() + static_cast<ptrdiff_t>(i));
+                    --i;
+                    break;
+                }
+                ++j;
+            }
+        }
+    }
+
+    void TextureAtlas::add(const Texture2DPtr& texture) {
+        if (texture == nullptr) {
+            return;
+        }
+        std::lock_guard lock(m_mutex);
+        m_pending.push_back(texture);
+    }
+
+    void TextureAtlas::update() {
+        Vector<std::weak_ptr<Texture2D>> pending;
+        {
+            std::lock_guard lock(m_mutex);
+            pending.swap(m_pending);
+        }
+        if (pending.empty()) {
+            return;
+        }
+        // The cells of destroyed textures are not given back, the pages only empty on release.
+        std::erase_if(m_regions, [](const auto& entry) { return entry.second.source.expired(); });
+
+        Vector<std::weak_ptr<Texture2D>> waiting;
+        for (const auto& weak : pending) {
+            const auto texture = weak.lock();
+            if (texture == nullptr || m_regions.contains(texture.get())) {
+                continue;
+            }
+            if (!texture->is_valid()) {
+                waiting.push_back(weak);
+                continue;
+            }
+            const auto size = texture->size();
+            if (size.x <= 0 || size.y <= 0 || size.x > FOW_TEXTURE_ATLAS_MAX_SIZE || size.y > FOW_TEXTURE_ATLAS_MAX_SIZE ||
+                texture->format() != TextureInternalPixelFormat::RGBA) {
+                continue;
+            }
+            const auto filter = texture->mag_filter();
+            const auto cell = allocate(CellSize(size), filter);
+            if (!cell.has_value()) {
+                continue;
+            }
+
+            auto& page = m_pages[cell->first];
+            copy(*texture, page, cell->second, size);
+            page.is_dirty = true;
+
+            constexpr float page_size = FOW_TEXTURE_ATLAS_PAGE_SIZE;
+            m_regions.insert_or_assign(texture.get(), AtlasRegion {
+                page.texture,
+                Vector2(cell->second + FOW_TEXTURE_ATLAS_PADDING) / page_size,
+                Vector2(size) / page_size,
+                texture
+            });
+            ++m_uRevision;
+        }
+
+        for (auto& page : m_pages) {
+            if (page.is_dirty) {
+                page.texture->generate_mipmaps();
+                page.is_dirty = false;
+            }
+        }
+        if (!waiting.empty()) {
+            std::lock_guard lock(m_mutex);
+            m_pending.insert(m_pending.end(), waiting.begin(), waiting.end());
+        }
+    }
+
+    const AtlasRegion* TextureAtlas::find(const Texture* texture) const {
+        const auto it = m_regions.find(texture);
+        // A destroyed texture can leave its address to a new one before the next update drops its region.
+        return it != m_regions.end() && !it->second.source.expired() ? &it->second : nullptr;
+    }
+
+    void TextureAtlas::release() {
+        m_regions.clear();
+        m_pages.clear();
+        ++m_uRevision;
+        std::lock_guard lock(m_mutex);
+        m_pending.clear();
+    }
+
+    Vector2i TextureAtlas::CellSize(const Vector2i& size) {
+        constexpr int padding = FOW_TEXTURE_ATLAS_PADDING;
+        static_assert(std::has_single_bit(static_cast<unsigned>(padding)), "FOW_TEXTURE_ATLAS_PADDING has to be a power of two");
+        // Cells that are multiples of the padding only leave positions that are multiples of it, so the mip blocks of
+        // a texture never reach into its neighbours.
+        const auto align = [](const int value) { return (value + 2 * padding + padding - 1) / padding * padding; };
+        return Vector2i { align(size.x), align(size.y) };
+    }
+
+    TextureAtlas& TextureAtlas::Instance() {
+        static TextureAtlas s_instance;
+        return s_instance;
+    }
+
+    Option<std::pair<size_t, Vector2i>> TextureAtlas::allocate(const Vector2i& size, const TextureMagFilterMode filter) {
+        for (size_t page = 0; page < m_pages.size(); ++page) {
+            if (m_pages[page].filter != filter) {
+                continue;
+            }
+            if (const auto position = m_pages[page].packer.pack(size); position.has_value()) {
+                return std::make_pair(page, position.value());
+            }
+        }
+        if (const auto result = add_page(filter); !result.has_value()) {
+            Debug::LogError(result.error().message);
+            return std::nullopt;
+        }
+        if (const auto position = m_pages.back().packer.pack(size); position.has_value()) {
+            return std::make_pair(m_pages.size() - 1, position.value());
+        }
+        return std::nullopt;
+    }
+
+    Result<> TextureAtlas::add_page(const TextureMagFilterMode filter) {
+        constexpr auto levels = static_cast<GLsizei>(std::bit_width(static_cast<unsigned>(FOW_TEXTURE_ATLAS_PADDING)));
+
+        GLuint id = 0;
+        glGenTextures(1, &id);
+        if (id == 0) {
+            return Failure(std::format("Failed to create texture atlas page: GL error {}", glGetError()));
+        }
+        const bool is_nearest = filter == TextureMagFilterMode::Nearest;
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
+        glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, FOW_TEXTURE_ATLAS_PAGE_SIZE, FOW_TEXTURE_ATLAS_PAGE_SIZE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, is_nearest ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, is_nearest ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+        constexpr GLubyte zero[4] = { 0, 0, 0, 0 };
+        glClearTexImage(id, 0, GL_RGBA, GL_UNSIGNED_BYTE, zero);
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
+
+        m_pages.push_back(Page {
+            CreateRef<Texture2D>(Texture2D(id)),
+            MaxRectsPacker(Vector2i { FOW_TEXTURE_ATLAS_PAGE_SIZE, FOW_TEXTURE_ATLAS_PAGE_SIZE }),
+            filter,
+            false
+        });
+        return Success();
+    }
+
+    void TextureAtlas::copy(const Texture2D& texture, const Page& page, const Vector2i& position, const Vector2i& size) const {
+        constexpr int padding = FOW_TEXTURE_ATLAS_PADDING;
+        const GLuint source = texture.id();
+        const GLuint target = page.texture->id();
+        const Vector2i origin = position + padding;
+
+        glCopyImageSubData(source, GL_TEXTURE_2D, 0, 0, 0, 0,
+                           target, GL_TEXTURE_2D, 0, origin.x, origin.y, 0, size.x, size.y, 1);
+        // The gutter repeats the edge texels, filtering and mips at the edge see the texture as if it was clamped.
+        for (int i = 0; i < padding; ++i) {
+            glCopyImageSubData(source, GL_TEXTURE_2D, 0, 0, 0, 0,
+                               target, GL_TEXTURE_2D, 0, position.x + i, origin.y, 0, 1, size.y, 1);
+            glCopyImageSubData(source, GL_TEXTURE_2D, 0, size.x - 1, 0, 0,
+                               target, GL_TEXTURE_2D, 0, origin.x + size.x + i, origin.y, 0, 1, size.y, 1);
+        }
+        // Rows after the columns, so the corners repeat the corner texels.
+        for (int i = 0; i < padding; ++i) {
+            glCopyImageSubData(target, GL_TEXTURE_2D, 0, position.x, origin.y, 0,
+                               target, GL_TEXTURE_2D, 0, position.x, position.y + i, 0, size.x + 2 * padding, 1, 1);
+            glCopyImageSubData(target, GL_TEXTURE_2D, 0, position.x, origin.y + size.y - 1, 0,
+                               target, GL_TEXTURE_2D, 0, position.x, origin.y + size.y + i, 0, size.x + 2 * padding, 1, 1);
+        }
+    }
+}
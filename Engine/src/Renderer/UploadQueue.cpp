@@ -0,0 +1,265 @@
+#include "fow/Renderer/UploadQueue.hpp"
+
+#include "fow/Renderer/GlStateCache.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace fow {
+    static size_t AlignUp(const size_t value, const size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    Option<size_t> RingAllocator::allocate(const size_t size, const size_t alignment) {
+        if (size > m_uCapacity) {
+            return std::nullopt;
+        }
+        size_t offset = AlignUp(m_uHead, alignment);
+        size_t skipped = offset - m_uHead;
+        // Allocations never wrap around, the rest of the ring is skipped instead.
+        if (offset + size > m_uCapacity) {
+            offset = 0;
+            skipped = m_uCapacity - m_uHead;
+        }
+        if (m_uUsed + skipped + size > m_uCapacity) {
+            return std::nullopt;
+        }
+        m_uUsed += skipped + size;
+        m_uPosition += skipped + size;
+        m_uHead = offset + size;
+        return offset;
+    }
+
+    void RingAllocator::release_until(const uint64_t position) {
+        if (position <= m_uPosition) {
+            m_uUsed = std::min<size_t>(m_uUsed, m_uPosition - position);
+        }
+    }
+
+    void RingAllocator::reset(const size_t capacity) {
+        m_uCapacity = capacity;
+        m_uHead = 0;
+        m_uUsed = 0;
+    }
+
+    MeshPtr UploadQueue::enqueue(MeshUploadPayload&& payload) {
+        const auto index_count = payload.lods.empty() ? static_cast<GLsizei>(payload.indices.size()) : payload.lods.front().index_count;
+        auto mesh = std::make_shared<Mesh>(std::move(Mesh {
+            0, 0, 0, index_count, payload.material, payload.primitive, payload.layout, payload.quantization, payload.lods, payload.bounds
+        }));
+        std::lock_guard lock { m_mutex };
+        m_jobs.emplace_back(MeshJob { mesh, std::move(payload) });
+        return mesh;
+    }
+    Texture2DPtr UploadQueue::enqueue(TextureUploadPayload&& payload) {
+        auto texture = std::make_shared<Texture2D>();
+        std::lock_guard lock { m_mutex };
+        m_jobs.emplace_back(TextureJob { texture, std::move(payload) });
+        return texture;
+    }
+
+    void UploadQueue::process(const size_t byte_budget, const double time_budget_ms) {
+        if (m_uStagingBuffer == 0 && !m_bStagingFailed) {
+            if (const auto result = create_staging(); !result.has_value()) {
+                // Uploads still work without it, they just go straight from the payloads.
+                Debug::LogError(std::format("Failed to create upload staging buffer: {}", result.error().message));
+                m_bStagingFailed = true;
+            }
+        }
+        retire_fences(false);
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto staged_before = m_ring.position();
+        size_t uploaded_bytes = 0;
+        bool first = true;
+        while (first || (uploaded_bytes < byte_budget && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < time_budget_ms)) {
+            Job job;
+            {
+                std::lock_guard lock { m_mutex };
+                if (m_jobs.empty()) {
+                    break;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            const bool done = std::visit([&](auto& value) { return upload(value, uploaded_bytes); }, job);
+            if (!done) {
+                // Out of staging space, the job keeps its place for the next frame.
+                std::lock_guard lock { m_mutex };
+                m_jobs.push_front(std::move(job));
+                break;
+            }
+            first = false;
+        }
+
+        if (m_ring.position() != staged_before) {
+            m_fences.push_back(StagingFence { glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_ring.position() });
+        }
+    }
+
+    void UploadQueue::flush() {
+        while (pending() > 0) {
+            process(SIZE_MAX, std::numeric_limits<double>::infinity());
+            if (pending() > 0) {
+                retire_fences(true);
+            }
+        }
+    }
+
+    void UploadQueue::release() {
+        for (const auto& fence : m_fences) {
+            glDeleteSync(fence.sync);
+        }
+        m_fences.clear();
+        if (m_uStagingBuffer != 0) {
+            glDeleteBuffers(1, &m_uStagingBuffer);
+            m_uStagingBuffer = 0;
+        }
+        m_pStaging = nullptr;
+        m_bStagingFailed = false;
+        m_ring.reset(0);
+    }
+
+    size_t UploadQueue::pending() const {
+        std::lock_guard lock { m_mutex };
+        return m_jobs.size();
+    }
+
+    UploadQueue& UploadQueue::Instance() {
+        static UploadQueue s_instance;
+        return s_instance;
+    }
+
+    Result<> UploadQueue::create_staging() {
+        glGenBuffers(1, &m_uStagingBuffer);
+        if (m_uStagingBuffer == 0) {
+            return Failure(std::format("GL error {}", glGetError()));
+        }
+        // Persistent and coherent, so payloads are written once and never mapped or flushed per upload.
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_uStagingBuffer);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, FOW_UPLOAD_STAGING_SIZE, nullptr, flags);
+        m_pStaging = static_cast<std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, FOW_UPLOAD_STAGING_SIZE, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (m_pStaging == nullptr) {
+            glDeleteBuffers(1, &m_uStagingBuffer);
+            m_uStagingBuffer = 0;
+            return Failure(std::format("Failed to map buffer: GL error {}", glGetError()));
+        }
+        m_ring.reset(FOW_UPLOAD_STAGING_SIZE);
+        return Success();
+    }
+
+    void UploadQueue::retire_fences(const bool wait) {
+        if (wait && !m_fences.empty()) {
+            glClientWaitSync(m_fences.front().sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+        }
+        while (!m_fences.empty()) {
+            const auto status = glClientWaitSync(m_fences.front().sync, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+            m_ring.release_until(m_fences.front().position);
+            glDeleteSync(m_fences.front().sync);
+            m_fences.pop_front();
+        }
+    }
+
+    Option<size_t> UploadQueue::stage(const size_t size, const size_t alignment) {
+        if (m_pStaging == nullptr || size > m_ring.capacity()) {
+            return std::nullopt;
+        }
+        return m_ring.allocate(size, alignment);
+    }
+
+    bool UploadQueue::upload(MeshJob& job, size_t& uploaded_bytes) {
+        const auto mesh = job.mesh.lock();
+        if (mesh == nullptr) {
+            return true;
+        }
+        const auto& payload = job.payload;
+        const size_t index_offset = AlignUp(payload.vertex_data.size(), alignof(GLuint));
+        const size_t size = index_offset + payload.indices.size() * sizeof(GLuint);
+
+        // Payloads larger than the whole staging buffer are uploaded directly.
+        const bool use_staging = m_pStaging != nullptr && size <= m_ring.capacity();
+        Option<size_t> offset = std::nullopt;
+        if (use_staging) {
+            offset = stage(size, 16);
+            if (!offset.has_value()) {
+                return false;
+            }
+        }
+
+        auto& arena = MeshArena::Get(payload.layout);
+        const auto handle = arena.allocate(payload.vertex_count, static_cast<uint32_t>(payload.indices.size()));
+        if (!handle.has_value()) {
+            Debug::LogError(std::format("Failed to upload mesh: {}", handle.error().message));
+            return true;
+        }
+        if (offset.has_value()) {
+            std::memcpy(m_pStaging + *offset, payload.vertex_data.data(), payload.vertex_data.size());
+            std::memcpy(m_pStaging + *offset + index_offset, payload.indices.data(), payload.indices.size() * sizeof(GLuint));
+            arena.copy(handle.value(), m_uStagingBuffer, static_cast<GLintptr>(*offset), static_cast<GLintptr>(*offset + index_offset));
+        } else {
+            arena.write(handle.value(), payload.vertex_data.data(), payload.indices.data());
+        }
+        mesh->make_resident(arena, handle.value());
+        uploaded_bytes += size;
+        return true;
+    }
+
+    bool UploadQueue::upload(TextureJob& job, size_t& uploaded_bytes) {
+        const auto texture = job.texture.lock();
+        if (texture == nullptr) {
+            return true;
+        }
+        const auto& payload = job.payload;
+        const size_t size = payload.pixels.size();
+
+        const bool use_staging = m_pStaging != nullptr && size <= m_ring.capacity();
+        Option<size_t> offset = std::nullopt;
+        if (use_staging) {
+            offset = stage(size, 16);
+            if (!offset.has_value()) {
+                return false;
+            }
+        }
+
+        GLuint id;
+        glGenTextures(1, &id);
+        if (id == 0) {
+            Debug::LogError(std::format("Failed to upload texture \"{}\": GL error {}", payload.info.Source, glGetError()));
+            return true;
+        }
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        if (offset.has_value()) {
+            // The image is read from the staging buffer, the call returns without waiting for the copy.
+            std::memcpy(m_pStaging + *offset, payload.pixels.data(), size);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uStagingBuffer);
+            glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(payload.internal_format), payload.size.x, payload.size.y, 0,
+                         static_cast<GLenum>(payload.format), GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(*offset));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(payload.internal_format), payload.size.x, payload.size.y, 0,
+                         static_cast<GLenum>(payload.format), GL_UNSIGNED_BYTE, payload.pixels.data());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(payload.info.MagFilter.value_or(TextureMagFilterMode::Linear)));
+        glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(payload.info.MinFilter.value_or(TextureMinFilterMode::Linear)));
+        glTextureParameteri(id, GL_TEXTURE_WRAP_S, static_cast<GLint>(payload.info.WrapS.value_or(TextureWrapMode::Repeat)));
+        glTextureParameteri(id, GL_TEXTURE_WRAP_T, static_cast<GLint>(payload.info.WrapT.value_or(TextureWrapMode::Repeat)));
+        if (payload.info.GenerateMipMaps.value_or(false)) {
+            glGenerateTextureMipmap(id);
+        }
+        GlStateCache::Instance().bind_texture(GL_TEXTURE_2D, 0);
+
+        Texture& target = *texture;
+        target.m_uId = id;
+        target.m_bInitialized = true;
+        uploaded_bytes += size;
+        return true;
+    }
+}
@@ -0,0 +1,124 @@
+#include "fow/Renderer/VertexLayout.hpp"
+#include "fow/Renderer/Mesh.hpp"
+
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+namespace fow {
+    const VertexLayout VertexLayout::Full = VertexLayout { };
+    const VertexLayout VertexLayout::Compact = VertexLayout { VertexPositionFormat::Unorm16, VertexNormalFormat::Octahedral, VertexUVFormat::Half };
+
+    Vector2 EncodeOctahedral(const Vector3& normal) {
+        const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (length <= 0.0f) {
+            return Vector2 { 0.0f };
+        }
+        const Vector3 n = normal / length;
+        if (n.z >= 0.0f) {
+            return Vector2 { n.x, n.y };
+        }
+        return Vector2 {
+            (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+        };
+    }
+    Vector3 DecodeOctahedral(const Vector2& encoded) {
+        Vector3 n { encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+        const float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+
+    template<typename T>
+    static std::byte* WriteAttribute(std::byte* dst, const T& value) {
+        std::memcpy(dst, &value, sizeof(T));
+        return dst + sizeof(T);
+    }
+
+    Vector<std::byte> VertexLayout::encode(const Vector<Vertex>& vertices, VertexQuantization& quantization, const bool fit_bounds) const {
+        if (position != VertexPositionFormat::Unorm16) {
+            quantization = VertexQuantization { };
+        } else if (fit_bounds && !vertices.empty()) {
+            Vector3 min = vertices.front().position, max = vertices.front().position;
+            for (const auto& vertex : vertices) {
+                min = glm::min(min, vertex.position);
+                max = glm::max(max, vertex.position);
+            }
+            quantization.offset = min;
+            quantization.scale = max - min;
+        }
+        const Vector3 inverse_scale = glm::mix(Vector3 { 0.0f }, 1.0f / quantization.scale, glm::greaterThan(quantization.scale, Vector3 { 0.0f }));
+
+        Vector<std::byte> data(static_cast<size_t>(stride()) * vertices.size());
+        std::byte* dst = data.data();
+        for (const auto& vertex : vertices) {
+            if (position == VertexPositionFormat::Float32) {
+                dst = WriteAttribute(dst, vertex.position);
+            } else {
+                dst = WriteAttribute(dst, glm::packUnorm4x16(Vector4((vertex.position - quantization.offset) * inverse_scale, 0.0f)));
+            }
+
+            if (normal == VertexNormalFormat::Float32) {
+                dst = WriteAttribute(dst, vertex.normal);
+                dst = WriteAttribute(dst, vertex.tangent);
+                dst = WriteAttribute(dst, vertex.bitangent);
+            } else {
+                const float bitangent_sign = glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.0f ? -1.0f : 1.0f;
+                const Vector3 tangent = glm::length(vertex.tangent) > 0.0f ? glm::normalize(vertex.tangent) : Vector3 { 1.0f, 0.0f, 0.0f };
+                dst = WriteAttribute(dst, glm::packSnorm2x16(EncodeOctahedral(vertex.normal)));
+                dst = WriteAttribute(dst, glm::packSnorm3x10_1x2(Vector4(tangent, bitangent_sign)));
+            }
+
+            switch (uv) {
+                case VertexUVFormat::Float32: dst = WriteAttribute(dst, vertex.uv); break;
+                case VertexUVFormat::Half:    dst = WriteAttribute(dst, glm::packHalf2x16(vertex.uv)); break;
+                case VertexUVFormat::Unorm16: dst = WriteAttribute(dst, glm::packUnorm2x16(vertex.uv)); break;
+            }
+        }
+        return data;
+    }
+
+    void VertexLayout::setup_attributes() const {
+        const auto stride_size = static_cast<GLsizei>(stride());
+        uintptr_t offset = 0;
+
+        // Position
+        if (position == VertexPositionFormat::Float32) {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride_size, reinterpret_cast<void*>(offset));
+        } else {
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride_size, reinterpret_cast<void*>(offset));
+        }
+        glEnableVertexAttribArray(0);
+        offset += position_size();
+
+        if (normal == VertexNormalFormat::Float32) {
+            // Normal
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride_size, reinterpret_cast<void*>(offset));
+            glEnableVertexAttribArray(1);
+            // Tangent
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride_size, reinterpret_cast<void*>(offset + 12));
+            glEnableVertexAttribArray(2);
+            // Bitangent
+            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride_size, reinterpret_cast<void*>(offset + 24));
+            glEnableVertexAttribArray(3);
+        } else {
+            // Octahedral normal
+            glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride_size, reinterpret_cast<void*>(offset));
+            glEnableVertexAttribArray(1);
+            // Tangent with bitangent sign, the bitangent is reconstructed in the vertex shader
+            glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride_size, reinterpret_cast<void*>(offset + 4));
+            glEnableVertexAttribArray(2);
+            glDisableVertexAttribArray(3);
+        }
+        offset += normal_size();
+
+        // UV
+        switch (uv) {
+            case VertexUVFormat::Float32: glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride_size, reinterpret_cast<void*>(offset)); break;
+            case VertexUVFormat::Half:    glVertexAttribPointer(4, 2, GL_HALF_FLOAT, GL_FALSE, stride_size, reinterpret_cast<void*>(offset)); break;
+            case VertexUVFormat::Unorm16: glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride_size, reinterpret_cast<void*>(offset)); break;
+        }
+        glEnableVertexAttribArray(4);
+    }
+}
@@ -0,0 +1,36 @@
+#include "fow/Shared/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace fow {
+    size_t GetWorkerThreadCount() {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    void ParallelFor(const size_t count, const std::function<void(size_t)>& job, const size_t max_threads) {
+        const size_t thread_count = std::min(count, max_threads == 0 ? GetWorkerThreadCount() : max_threads);
+        if (thread_count <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                job(i);
+            }
+            return;
+        }
+
+        // Jobs are handed out one at a time, their cost can vary a lot between indices.
+        std::atomic<size_t> next { 0 };
+        const auto worker = [&] {
+            for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+                job(i);
+            }
+        };
+        std::vector<std::jthread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+    }
+}
@@ -0,0 +1,42 @@
+// Cooks models into the .fmesh format, so the runtime does not have to run the assimp import.
+// Usage: FogOfWarMeshCooker <input> <output.fmesh> [--compact]
+
+#include <cstdio>
+#include <fstream>
+
+#include "fow/Renderer/Model.hpp"
+#include "fow/Renderer/MeshFile.hpp"
+
+using namespace fow;
+
+int main(const int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <input> <output%s> [--compact]\n", argv[0], FOW_MESH_FILE_EXTENSION);
+        return 1;
+    }
+    const String input_path = argv[1];
+    const String output_path = argv[2];
+    const bool compact = argc > 3 && std::string_view(argv[3]) == "--compact";
+
+    std::ifstream input(input_path.as_cstr(), std::ios::binary);
+    if (!input) {
+        std::fprintf(stderr, "Failed to open \"%s\"\n", input_path.as_cstr());
+        return 1;
+    }
+    const Vector<uint8_t> data { std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+
+    const auto model = Model::Cook(input_path, data, compact ? VertexLayout::Compact : VertexLayout::Full);
+    if (!model.has_value()) {
+        std::fprintf(stderr, "%s\n", model.error().message.as_cstr());
+        return 1;
+    }
+
+    const auto file = WriteMeshFile(model.value());
+    std::ofstream output(output_path.as_cstr(), std::ios::binary | std::ios::trunc);
+    if (!output || !output.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()))) {
+        std::fprintf(stderr, "Failed to write \"%s\"\n", output_path.as_cstr());
+        return 1;
+    }
+    std::printf("Cooked \"%s\" to \"%s\": %zu submeshes, %zu bytes\n", input_path.as_cstr(), output_path.as_cstr(), model->submeshes.size(), file.size());
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Cooks every shader of the shader library and all of its variants into a .fspv bundle of SPIR-V, so shader errors
+// fail the build and the runtime does not have to parse GLSL.
+// Usage: FogOfWarShaderCooker --engine-shaders <dir> [--game-shaders <dir>] --out <shaders.fspv> [--strip-debug]
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include <nlohmann/json.hpp>
+#include <glslang/Public/ShaderLang.h>
+#include <glslang/Public/ResourceLimits.h>
+#include <glslang/SPIRV/GlslangToSpv.h>
+
+#include "fow/Renderer/ShaderBundle.hpp"
+#include "fow/Renderer/ShaderVariant.hpp"
+
+using namespace fow;
+
+struct CookerShader {
+    std::filesystem::path vertex;
+    std::filesystem::path fragment;
+};
+
+// Line endings are normalized like Python's text mode does for compile_shaders.py, the source hashes have to match the
+// sources of the shader library.
+static Option<String> ReadText(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return std::nullopt;
+    }
+    const std::string raw { std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+    std::string text;
+    text.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\r') {
+            text += raw[i];
+        } else if (i + 1 >= raw.size() || raw[i + 1] != '\n') {
+            text += '\n';
+        }
+    }
+    return String(text);
+}
+
+// Game shaders replace engine shaders of the same name, like in compile_shaders.py.
+static bool ParseShadersJson(const std::filesystem::path& directory, std::map<std::string, CookerShader>& shaders) {
+    std::ifstream input(directory / "shaders.json");
+    if (!input) {
+        std::fprintf(stderr, "Shader definition \"%s\" cannot be found\n", (directory / "shaders.json").string().c_str());
+        return false;
+    }
+    const auto json = nlohmann::json::parse(input, nullptr, false);
+    if (json.is_discarded() || !json.contains("shaders")) {
+        std::fprintf(stderr, "No shaders specified in \"%s\"\n", (directory / "shaders.json").string().c_str());
+        return false;
+    }
+    for (const auto& [ name, shader ] : json["shaders"].items()) {
+        if (!shader.contains("vertex") || !shader.contains("fragment")) {
+            std::fprintf(stderr, "Shader \"%s\" needs a vertex and a fragment source\n", name.c_str());
+            return false;
+        }
+        shaders.insert_or_assign(name, CookerShader { directory / shader["vertex"].get<std::string>(), directory / shader["fragment"].get<std::string>() });
+    }
+    return true;
+}
+
+static bool CompileStage(glslang::TShader& shader, const EShLanguage stage, const String& source, const String& name) {
+    const char* text = source.as_cstr();
+    shader.setStrings(&text, 1);
+    shader.setEnvInput(glslang::EShSourceGlsl, stage, glslang::EShClientOpenGL, 100);
+    shader.setEnvClient(glslang::EShClientOpenGL, glslang::EShTargetOpenGL_450);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+    // Loose uniforms have no layout qualifiers in our sources, SPIR-V for GL needs explicit locations.
+    shader.setAutoMapLocations(true);
+    shader.setAutoMapBindings(true);
+    if (!shader.parse(GetDefaultResources(), 460, false, static_cast<EShMessages>(EShMsgSpvRules | EShMsgDefault))) {
+        std::fprintf(stderr, "Failed to compile %s shader of \"%s\":\n%s\n", stage == EShLangVertex ? "vertex" : "fragment", name.as_cstr(), shader.getInfoLog());
+        return false;
+    }
+    return true;
+}
+
+static bool Cook(const ShaderVariantSources& sources, const bool strip_debug, ShaderBundleEntry& entry) {
+    glslang::TShader vertex(EShLangVertex);
+    glslang::TShader fragment(EShLangFragment);
+    if (!CompileStage(vertex, EShLangVertex, sources.vertex, sources.name) || !CompileStage(fragment, EShLangFragment, sources.fragment, sources.name)) {
+        return false;
+    }
+
+    glslang::TProgram program;
+    program.addShader(&vertex);
+    program.addShader(&fragment);
+    if (!program.link(static_cast<EShMessages>(EShMsgSpvRules | EShMsgDefault)) || !program.mapIO()) {
+        std::fprintf(stderr, "Failed to link \"%s\":\n%s\n", sources.name.as_cstr(), program.getInfoLog());
+        return false;
+    }
+
+    // OpName is kept even when stripping, the engine looks uniforms and blocks up by name.
+    glslang::SpvOptions options;
+    options.generateDebugInfo = !strip_debug;
+    options.validate = true;
+    std::vector<unsigned int> vertex_spirv, fragment_spirv;
+    glslang::GlslangToSpv(*program.getIntermediate(EShLangVertex), vertex_spirv, &options);
+    glslang::GlslangToSpv(*program.getIntermediate(EShLangFragment), fragment_spirv, &options);
+
+    entry.name = sources.name;
+    entry.source_hash = ShaderSourceHash(std::string_view(sources.vertex.as_cstr(), sources.vertex.size()), std::string_view(sources.fragment.as_cstr(), sources.fragment.size()));
+    entry.defaults.clear();
+    ParseShaderUniformDefaults(sources.vertex, entry.defaults);
+    ParseShaderUniformDefaults(sources.fragment, entry.defaults);
+    entry.vertex.assign(vertex_spirv.begin(), vertex_spirv.end());
+    entry.fragment.assign(fragment_spirv.begin(), fragment_spirv.end());
+    return true;
+}
+
+int main(const int argc, char** argv) {
+    Vector<std::filesystem::path> directories;
+    std::filesystem::path output_path;
+    bool strip_debug = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if ((arg == "--engine-shaders" || arg == "--game-shaders") && i + 1 < argc) {
+            directories.emplace_back(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (arg == "--strip-debug") {
+            strip_debug = true;
+        } else {
+            std::fprintf(stderr, "Unknown argument \"%s\"\n", argv[i]);
+            return 1;
+        }
+    }
+    if (directories.empty() || output_path.empty()) {
+        std::fprintf(stderr, "Usage: %s --engine-shaders <dir> [--game-shaders <dir>] --out <output%s> [--strip-debug]\n", argv[0], FOW_SHADER_BUNDLE_EXTENSION);
+        return 1;
+    }
+
+    std::map<std::string, CookerShader> shaders;
+    for (const auto& directory : directories) {
+        if (!ParseShadersJson(directory, shaders)) {
+            return 1;
+        }
+    }
+
+    glslang::InitializeProcess();
+    Vector<ShaderBundleEntry> entries;
+    bool failed = false;
+    for (const auto& [ name, shader ] : shaders) {
+        const auto vertex = ReadText(shader.vertex);
+        const auto fragment = ReadText(shader.fragment);
+        if (!vertex.has_value() || !fragment.has_value()) {
+            std::fprintf(stderr, "Failed to read the sources of \"%s\"\n", name.c_str());
+            failed = true;
+            continue;
+        }
+
+        // Every subset of the features the shader checks for, down to the variant without any.
+        const ShaderVariantKey supported = ShaderSourceFeatures(std::string_view(vertex->as_cstr(), vertex->size())) |
+                                           ShaderSourceFeatures(std::string_view(fragment->as_cstr(), fragment->size()));
+        ShaderVariantKey key = supported;
+        while (true) {
+            ShaderBundleEntry entry;
+            if (Cook(MakeShaderVariantSources(String(name), vertex.value(), fragment.value(), key), strip_debug, entry)) {
+                entries.push_back(std::move(entry));
+            } else {
+                failed = true;
+            }
+            if (key == 0) {
+                break;
+            }
+            key = (key - 1) & supported;
+        }
+    }
+    glslang::FinalizeProcess();
+    if (failed) {
+        return 1;
+    }
+
+    const auto file = WriteShaderBundle(entries);
+    std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+    if (!output || !output.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()))) {
+        std::fprintf(stderr, "Failed to write \"%s\"\n", output_path.string().c_str());
+        return 1;
+    }
+    std::printf("Cooked %zu shaders and variants from %zu shaders to \"%s\", %zu bytes\n", entries.size(), shaders.size(), output_path.string().c_str(), file.size());
+    return 0;
+}
@@ -10,32 +10,31 @@ class ShaderInfo:
 
 SHADERLIB_SOURCE = """#include "ShaderLib.hpp"
 
-static std::unordered_map<std::string, std::string> s_sources;
-static std::unordered_map<std::string, ShaderSources> s_shaders;
-
-void ShaderLibInitialize() {
-$(SHADER_REGISTER)
-}
-const char* ShaderLibGetSource(const char* name) {
-    if (s_sources.contains(name)) {
-        return s_sources.at(name).c_str();
-    }
-    return nullptr;
-}
-bool ShaderLibGetRequiredSources(const char* name, ShaderSources* sources) {
-    if (sources != nullptr && s_shaders.contains(name)) {
-        *sources = s_shaders.at(name);
-        return true;
-    }
-    return false;
-}
-void ShaderLibGetShaders(std::vector<std::string>* shaders) {
-    for (const auto& name: s_shaders | std::views::keys) {
-        shaders->emplace_back(name);
-    }
+#include <iterator>
+
+$(SOURCE_TEXTS)
+static constexpr ShaderLibSource s_sources[] = {
+$(SOURCE_TABLE)
+};
+static constexpr ShaderLibShader s_shaders[] = {
+$(SHADER_TABLE)
+};
+static constexpr ShaderLibTable s_table = {
+    SHADER_LIB_TABLE_VERSION,
+    static_cast<uint32_t>(std::size(s_sources)),
+    static_cast<uint32_t>(std::size(s_shaders)),
+    s_sources,
+    s_shaders
+};
+
+const ShaderLibTable* ShaderLibGetTable() {
+    return &s_table;
 }
 """
 
+STAGE_VERTEX   = 1
+STAGE_FRAGMENT = 2
+
 def parse_args():
 	parser = argparse.ArgumentParser()
 	parser.add_argument("--engine-shaders", required=True)
@@ -117,26 +116,32 @@ if __name__ == "__main__":
 
 	source_path = os.path.join(output_path, "ShaderLib.cpp")
 
+	# The engine looks names up with a binary search, both tables are sorted by name.
+	source_names = sorted(source_files_result.keys())
+	source_indices = { name: i for i, name in enumerate(source_names) }
+	source_stages = { name: 0 for name in source_names }
+	for shader in shaders_result.values():
+		source_stages[shader.vertex]   |= STAGE_VERTEX
+		source_stages[shader.fragment] |= STAGE_FRAGMENT
+
+	source_texts = ""
+	source_table = []
+	for i, name in enumerate(source_names):
+		# One literal per line keeps the generated file readable and every literal short.
+		lines = source_files_result[name].splitlines(keepends=True)
+		literal = "\n".join(f'    "{make_cstr(line)}"' for line in lines) if len(lines) > 0 else '    ""'
+		source_texts += f"static constexpr char s_source_{i}[] =\n{literal};\n"
+		stages = " | ".join(stage for bit, stage in ((STAGE_VERTEX, "SHADER_LIB_STAGE_VERTEX"), (STAGE_FRAGMENT, "SHADER_LIB_STAGE_FRAGMENT")) if source_stages[name] & bit) or "0"
+		source_table.append(f'    {{ "{make_cstr(name)}", s_source_{i}, sizeof(s_source_{i}) - 1, {stages} }}')
+
+	shader_table = []
+	for name in sorted(shaders_result.keys()):
+		shader = shaders_result[name]
+		shader_table.append(f'    {{ "{make_cstr(name)}", {source_indices[shader.vertex]}, {source_indices[shader.fragment]} }}')
+
 	with (open(source_path, "w") as f):
-		shader_fill_map = ""
-		shader_register = ""
-		for name, source in source_files_result.items():
-			source_cstr = make_cstr(source)
-			shader_fill_map += \
-f'''    if (s_sources.contains("{name}"))  {{
-        s_sources.at("{name}") = "{source_cstr}";
-    }} else {{
-        s_sources.emplace("{name}", "{source_cstr}");
-    }}
-'''
-		for name, shader in shaders_result.items():
-			shader_register += \
-f'''
-    if (s_shaders.contains("{name}"))  {{
-        s_shaders.at("{name}") = ShaderSources("{shader.vertex}", "{shader.fragment}");
-    }} else {{
-        s_shaders.emplace("{name}", ShaderSources("{shader.vertex}", "{shader.fragment}"));
-    }}'''
-
-		f.write(SHADERLIB_SOURCE.replace("$(SHADER_REGISTER)", f"{shader_fill_map}\n{shader_register}"))
+		f.write(SHADERLIB_SOURCE
+			.replace("$(SOURCE_TEXTS)", source_texts)
+			.replace("$(SOURCE_TABLE)", ",\n".join(source_table))
+			.replace("$(SHADER_TABLE)", ",\n".join(shader_table)))
 		print(f"Written shaderlib source file \"{source_path}\"")
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/GlStateCache.hpp"
+
+using namespace fow;
+
+static std::vector<std::string> s_calls;
+
+static GlFunctionTable RecordingFunctionTable() {
+    return GlFunctionTable {
+        .use_program       = [](GLuint program) { s_calls.emplace_back(std::format("UseProgram({})", program)); },
+        .bind_vertex_array = [](GLuint vao) { s_calls.emplace_back(std::format("BindVertexArray({})", vao)); },
+        .active_texture    = [](GLenum unit) { s_calls.emplace_back(std::format("ActiveTexture({})", unit - GL_TEXTURE0)); },
+        .bind_texture      = [](GLenum target, GLuint texture) { s_calls.emplace_back(std::format("BindTexture({}, {})", target, texture)); },
+        .bind_sampler      = [](GLuint unit, GLuint sampler) { s_calls.emplace_back(std::format("BindSampler({}, {})", unit, sampler)); },
+        .enable            = [](GLenum capability) { s_calls.emplace_back(std::format("Enable({})", capability)); },
+        .disable           = [](GLenum capability) { s_calls.emplace_back(std::format("Disable({})", capability)); },
+        .blend_func        = [](GLenum src, GLenum dst) { s_calls.emplace_back(std::format("BlendFunc({}, {})", src, dst)); },
+        .depth_func        = [](GLenum func) { s_calls.emplace_back(std::format("DepthFunc({})", func)); },
+        .depth_mask        = [](GLboolean enabled) { s_calls.emplace_back(std::format("DepthMask({})", enabled)); },
+        .cull_face         = [](GLenum mode) { s_calls.emplace_back(std::format("CullFace({})", mode)); },
+        .stencil_func      = [](GLenum func, GLint ref, GLuint mask) { s_calls.emplace_back(std::format("StencilFunc({}, {}, {})", func, ref, mask)); },
+        .stencil_op        = [](GLenum sfail, GLenum dfail, GLenum dpass) { s_calls.emplace_back(std::format("StencilOp({}, {}, {})", sfail, dfail, dpass)); },
+        .stencil_mask      = [](GLuint mask) { s_calls.emplace_back(std::format("StencilMask({})", mask)); },
+        .bind_framebuffer  = [](GLenum target, GLuint framebuffer) { s_calls.emplace_back(std::format("BindFramebuffer({}, {})", target, framebuffer)); }
+    };
+}
+
+TEST(GlStateCache, SkipsRedundantCalls) {
+    s_calls.clear();
+    GlStateCache cache { RecordingFunctionTable() };
+
+    cache.use_program(3);
+    cache.use_program(3);
+    cache.bind_vertex_array(7);
+    cache.bind_vertex_array(7);
+    cache.set_enabled(GL_BLEND, true);
+    cache.set_enabled(GL_BLEND, true);
+    cache.set_enabled(GL_BLEND, false);
+    cache.set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    cache.set_depth_mask(false);
+    cache.set_depth_mask(false);
+
+    EXPECT_EQ(s_calls.size(), 6);
+    EXPECT_EQ(cache.stats().forwarded_calls, 6);
+    EXPECT_EQ(cache.stats().avoided_calls, 5);
+}
+
+TEST(GlStateCache, TracksTexturesPerUnit) {
+    s_calls.clear();
+    GlStateCache cache { RecordingFunctionTable() };
+
+    cache.bind_texture(0, GL_TEXTURE_2D, 10);
+    cache.bind_texture(1, GL_TEXTURE_2D, 11);
+    cache.bind_texture(0, GL_TEXTURE_2D, 10);
+    cache.bind_texture(1, GL_TEXTURE_2D, 11);
+    ASSERT_EQ(s_calls.size(), 4);
+    EXPECT_EQ(s_calls[0], "ActiveTexture(0)");
+    EXPECT_EQ(s_calls[2], "ActiveTexture(1)");
+
+    // Binding without a unit targets the active one.
+    cache.bind_texture(GL_TEXTURE_2D, 11);
+    EXPECT_EQ(s_calls.size(), 4);
+    cache.bind_texture(GL_TEXTURE_2D, 12);
+    ASSERT_EQ(s_calls.size(), 5);
+    EXPECT_EQ(s_calls[4], std::format("BindTexture({}, 12)", GL_TEXTURE_2D));
+}
+
+TEST(GlStateCache, ForgetsDeletedObjects) {
+    s_calls.clear();
+    GlStateCache cache { RecordingFunctionTable() };
+
+    cache.use_program(3);
+    cache.bind_texture(0, GL_TEXTURE_2D, 10);
+    cache.forget_program(3);
+    cache.forget_texture(10);
+    cache.use_program(3);
+    cache.bind_texture(0, GL_TEXTURE_2D, 10);
+    EXPECT_EQ(s_calls.size(), 5);
+
+    cache.invalidate();
+    cache.use_program(3);
+    EXPECT_EQ(s_calls.size(), 6);
+}
+
+TEST(GlStateCache, FramebufferTargets) {
+    s_calls.clear();
+    GlStateCache cache { RecordingFunctionTable() };
+
+    cache.bind_framebuffer(GL_FRAMEBUFFER, 4);
+    cache.bind_framebuffer(GL_READ_FRAMEBUFFER, 4);
+    cache.bind_framebuffer(GL_DRAW_FRAMEBUFFER, 4);
+    EXPECT_EQ(s_calls.size(), 1);
+    cache.bind_framebuffer(GL_READ_FRAMEBUFFER, 5);
+    cache.bind_framebuffer(GL_FRAMEBUFFER, 4);
+    EXPECT_EQ(s_calls.size(), 3);
+}
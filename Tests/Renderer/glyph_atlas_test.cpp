@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/GlyphAtlas.hpp"
+
+using namespace fow;
+
+static bool Overlaps(const Vector2i& a_pos, const Vector2i& a_size, const Vector2i& b_pos, const Vector2i& b_size) {
+    return a_pos.x < b_pos.x + b_size.x && b_pos.x < a_pos.x + a_size.x &&
+           a_pos.y < b_pos.y + b_size.y && b_pos.y < a_pos.y + a_size.y;
+}
+
+TEST(SkylinePacker, PackedRectanglesStayInBoundsAndDoNotOverlap) {
+    SkylinePacker packer({ 128, 128 });
+    Vector<std::pair<Vector2i, Vector2i>> placed;
+    for (int i = 0; i < 64; ++i) {
+        const Vector2i size { 5 + (i * 7) % 13, 4 + (i * 5) % 11 };
+        const auto position = packer.pack(size);
+        if (!position.has_value()) {
+            continue;
+        }
+        EXPECT_GE(position->x, 0);
+        EXPECT_GE(position->y, 0);
+        EXPECT_LE(position->x + size.x, 128);
+        EXPECT_LE(position->y + size.y, 128);
+        for (const auto& [ other_pos, other_size ] : placed) {
+            EXPECT_FALSE(Overlaps(position.value(), size, other_pos, other_size));
+        }
+        placed.emplace_back(position.value(), size);
+    }
+    EXPECT_EQ(placed.size(), 64);
+    EXPECT_GT(packer.occupancy(), 0.0f);
+    EXPECT_LE(packer.occupancy(), 1.0f);
+}
+
+TEST(SkylinePacker, FailsWhenFullAndResets) {
+    SkylinePacker packer({ 32, 32 });
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(packer.pack({ 16, 16 }).has_value());
+    }
+    EXPECT_FLOAT_EQ(packer.occupancy(), 1.0f);
+    EXPECT_FALSE(packer.pack({ 1, 1 }).has_value());
+    EXPECT_FALSE(packer.pack({ 33, 1 }).has_value());
+
+    packer.reset({ 32, 32 });
+    EXPECT_FLOAT_EQ(packer.occupancy(), 0.0f);
+    const auto position = packer.pack({ 32, 32 });
+    ASSERT_TRUE(position.has_value());
+    EXPECT_EQ(position->x, 0);
+    EXPECT_EQ(position->y, 0);
+}
+
+TEST(DecodeUtf8, DecodesMultibyteSequences) {
+    EXPECT_EQ(DecodeUtf8("Fog"), (Vector<char32_t> { U'F', U'o', U'g' }));
+    EXPECT_EQ(DecodeUtf8("\xC3\xA9"), Vector<char32_t> { U'é' });
+    EXPECT_EQ(DecodeUtf8("\xE2\x82\xAC"), Vector<char32_t> { U'€' });
+    EXPECT_EQ(DecodeUtf8("\xF0\x9F\x98\x80"), Vector<char32_t> { U'\U0001F600' });
+    EXPECT_TRUE(DecodeUtf8("").empty());
+}
+
+TEST(DecodeUtf8, ReplacesMalformedSequences) {
+    // Stray continuation byte, overlong '/', encoded surrogate and a sequence cut short by the end of the text.
+    EXPECT_EQ(DecodeUtf8("a\x80" "b"), (Vector<char32_t> { U'a', U'�', U'b' }));
+    EXPECT_EQ(DecodeUtf8("\xC0\xAF").front(), U'�');
+    EXPECT_EQ(DecodeUtf8("\xED\xA0\x80").front(), U'�');
+    EXPECT_EQ(DecodeUtf8("x\xE2\x82"), (Vector<char32_t> { U'x', U'�', U'�' }));
+}
+
+TEST(GlyphSizeBucket, RoundsUpToClampedPowersOfTwo) {
+    EXPECT_EQ(GlyphSizeBucket(1.0f), FOW_GLYPH_SDF_MIN_SIZE);
+    EXPECT_EQ(GlyphSizeBucket(16.0f), 16);
+    EXPECT_EQ(GlyphSizeBucket(17.0f), 32);
+    EXPECT_EQ(GlyphSizeBucket(48.0f), 64);
+    EXPECT_EQ(GlyphSizeBucket(1000.0f), FOW_GLYPH_SDF_MAX_SIZE);
+}
@@ -0,0 +1,54 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/Impostor.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace fow;
+
+TEST(Impostor, SelectsCapturedViews) {
+    const ImpostorViewGrid grid { 8, 3, glm::radians(60.0f) };
+    for (uint32_t row = 0; row < grid.pitch_views; ++row) {
+        for (uint32_t column = 0; column < grid.yaw_views; ++column) {
+            EXPECT_EQ(grid.select(grid.direction(column, row)), Vector2u(column, row));
+        }
+    }
+}
+
+TEST(Impostor, SelectsNearestView) {
+    const ImpostorViewGrid grid { 8, 3, glm::radians(60.0f) };
+
+    // Just short of a full turn wraps around to the first column.
+    const float yaw = glm::two_pi<float>() - 0.1f;
+    EXPECT_EQ(grid.select(Vector3 { std::sin(yaw), 0.0f, std::cos(yaw) }), Vector2u(0, 0));
+    EXPECT_EQ(grid.select(Vector3 { -1.0f, 0.0f, 0.0f }), Vector2u(6, 0));
+
+    // Below the horizon and straight above clamp to the captured rows, the length of the direction does not matter.
+    EXPECT_EQ(grid.select(Vector3 { 0.0f, -1.0f, 1.0f }).y, 0u);
+    EXPECT_EQ(grid.select(Vector3 { 0.0f, 10.0f, 0.0f }).y, 2u);
+    EXPECT_EQ(grid.select(Vector3 { 0.0f, 1.0f, 2.0f }).y, 1u);
+}
+
+TEST(Impostor, FrameRects) {
+    const ImpostorViewGrid grid { 8, 2, glm::radians(45.0f) };
+    const auto rect = grid.frame_rect(3, 1);
+    EXPECT_FLOAT_EQ(rect.x, 0.375f);
+    EXPECT_FLOAT_EQ(rect.y, 0.5f);
+    EXPECT_FLOAT_EQ(rect.width, 0.125f);
+    EXPECT_FLOAT_EQ(rect.height, 0.5f);
+}
+
+TEST(Impostor, InstanceFromModelMatrix) {
+    const BoundingSphere bounds { Vector3 { 0.0f, 1.0f, 0.0f }, 2.0f };
+    Matrix4 matrix = glm::translate(Matrix4(1.0f), Vector3 { 10.0f, 0.0f, -5.0f });
+    matrix = glm::rotate(matrix, glm::half_pi<float>(), Vector3 { 0.0f, 1.0f, 0.0f });
+    matrix = glm::scale(matrix, Vector3 { 3.0f });
+
+    const auto instance = MakeImpostorInstance(bounds, matrix);
+    EXPECT_NEAR(instance.center_radius.x, 10.0f, 1e-5f);
+    EXPECT_NEAR(instance.center_radius.y, 3.0f, 1e-5f);
+    EXPECT_NEAR(instance.center_radius.z, -5.0f, 1e-5f);
+    EXPECT_NEAR(instance.center_radius.w, 6.0f, 1e-5f);
+    EXPECT_NEAR(instance.orientation.x, glm::half_pi<float>(), 1e-5f);
+}
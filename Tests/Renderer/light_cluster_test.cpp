@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/LightClusters.hpp"
+
+using namespace fow;
+
+static const Matrix4 TestProjection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+static uint32_t ClusterOf(const LightClusterGrid& grid, const Vector3& view_position) {
+    const Vector4 clip = TestProjection * Vector4(view_position, 1.0f);
+    const Vector2 ndc = Vector2(clip) / clip.w;
+    const Vector2 slice_params = grid.depth_slice_params();
+    const auto x = static_cast<uint32_t>((ndc.x * 0.5f + 0.5f) * static_cast<float>(grid.size().x));
+    const auto y = static_cast<uint32_t>((ndc.y * 0.5f + 0.5f) * static_cast<float>(grid.size().y));
+    const auto z = static_cast<uint32_t>(std::floor(std::log(-view_position.z) * slice_params.x + slice_params.y));
+    return grid.cluster_index(x, y, z);
+}
+
+static bool ClusterContains(const LightClusterGrid& grid, const uint32_t cluster, const uint32_t light) {
+    const auto& range = grid.ranges()[cluster];
+    for (uint32_t i = 0; i < range.count; ++i) {
+        if (grid.indices()[range.offset + i] == light) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(LightClusterGrid, ExtractsClippingPlanes) {
+    LightClusterGrid grid;
+    ASSERT_TRUE(grid.assign(Matrix4 { 1.0f }, TestProjection, { }).has_value());
+    EXPECT_NEAR(grid.near_plane(), 0.1f, 1e-4f);
+    EXPECT_NEAR(grid.far_plane(), 100.0f, 1e-1f);
+    EXPECT_EQ(grid.ranges().size(), grid.cluster_count());
+    EXPECT_TRUE(grid.indices().empty());
+}
+
+TEST(LightClusterGrid, RejectsOrthographicProjection) {
+    LightClusterGrid grid;
+    EXPECT_FALSE(grid.assign(Matrix4 { 1.0f }, glm::ortho(0.0f, 10.0f, 0.0f, 10.0f, 0.1f, 100.0f), { }).has_value());
+}
+
+TEST(LightClusterGrid, AssignsLightsToOverlappingClusters) {
+    LightClusterGrid grid;
+    const Vector<ClusterLight> lights = {
+        ClusterLight { Vector4 {  0.0f, 0.0f, -10.0f, 1.0f }, Vector4 { 1.0f } },
+        ClusterLight { Vector4 { -8.0f, 3.0f, -40.0f, 2.0f }, Vector4 { 1.0f } },
+        ClusterLight { Vector4 {  0.0f, 0.0f,  10.0f, 1.0f }, Vector4 { 1.0f } } // Behind the camera
+    };
+    ASSERT_TRUE(grid.assign(Matrix4 { 1.0f }, TestProjection, lights).has_value());
+
+    const uint32_t first = ClusterOf(grid, Vector3 { 0.0f, 0.0f, -10.0f });
+    const uint32_t second = ClusterOf(grid, Vector3 { -8.0f, 3.0f, -40.0f });
+    EXPECT_TRUE(ClusterContains(grid, first, 0));
+    EXPECT_FALSE(ClusterContains(grid, first, 1));
+    EXPECT_TRUE(ClusterContains(grid, second, 1));
+    EXPECT_FALSE(ClusterContains(grid, second, 0));
+
+    for (const auto index : grid.indices()) {
+        EXPECT_NE(index, 2u);
+    }
+    // A corner cluster far away from both lights stays empty.
+    EXPECT_EQ(grid.ranges()[grid.cluster_index(grid.size().x - 1, grid.size().y - 1, 0)].count, 0u);
+}
+
+TEST(LightClusterGrid, MovingViewMovesLights) {
+    LightClusterGrid grid;
+    const Vector<ClusterLight> lights = { ClusterLight { Vector4 { 0.0f, 0.0f, -10.0f, 1.0f }, Vector4 { 1.0f } } };
+    const Matrix4 view = glm::translate(Matrix4 { 1.0f }, Vector3 { 0.0f, 0.0f, -10.0f });
+    ASSERT_TRUE(grid.assign(view, TestProjection, lights).has_value());
+    EXPECT_TRUE(ClusterContains(grid, ClusterOf(grid, Vector3 { 0.0f, 0.0f, -20.0f }), 0));
+    EXPECT_FALSE(ClusterContains(grid, ClusterOf(grid, Vector3 { 0.0f, 0.0f, -10.0f }), 0));
+}
@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/MeshArena.hpp"
+
+using namespace fow;
+
+TEST(MeshArena, AllocatesFirstFit) {
+    RangeAllocator allocator { 100 };
+    EXPECT_EQ(allocator.allocate(30), 0u);
+    EXPECT_EQ(allocator.allocate(30), 30u);
+    EXPECT_EQ(allocator.allocate(30), 60u);
+    EXPECT_FALSE(allocator.allocate(20).has_value());
+    EXPECT_EQ(allocator.allocate(10), 90u);
+    EXPECT_EQ(allocator.free_size(), 0u);
+    EXPECT_EQ(allocator.free_block_count(), 0u);
+}
+
+TEST(MeshArena, CoalescesFreedBlocks) {
+    RangeAllocator allocator { 100 };
+    const auto a = allocator.allocate(20).value();
+    const auto b = allocator.allocate(20).value();
+    const auto c = allocator.allocate(20).value();
+    FOW_DISCARD(allocator.allocate(40));
+
+    allocator.free(a, 20);
+    allocator.free(c, 20);
+    EXPECT_EQ(allocator.free_block_count(), 2u);
+    EXPECT_EQ(allocator.largest_free_block(), 20u);
+    EXPECT_FALSE(allocator.allocate(40).has_value());
+
+    // Freeing the block in between merges all three.
+    allocator.free(b, 20);
+    EXPECT_EQ(allocator.free_block_count(), 1u);
+    EXPECT_EQ(allocator.largest_free_block(), 60u);
+    EXPECT_EQ(allocator.allocate(60), 0u);
+}
+
+TEST(MeshArena, ReusesHolesBeforeTheEnd) {
+    RangeAllocator allocator { 100 };
+    const auto a = allocator.allocate(10).value();
+    FOW_DISCARD(allocator.allocate(10));
+    allocator.free(a, 10);
+    EXPECT_EQ(allocator.allocate(5), 0u);
+    EXPECT_EQ(allocator.allocate(5), 5u);
+    EXPECT_EQ(allocator.allocate(5), 20u);
+}
+
+TEST(MeshArena, GrowMergesWithTrailingFreeBlock) {
+    RangeAllocator allocator { 100 };
+    FOW_DISCARD(allocator.allocate(90));
+    allocator.grow(200);
+    EXPECT_EQ(allocator.capacity(), 200u);
+    EXPECT_EQ(allocator.free_block_count(), 1u);
+    EXPECT_EQ(allocator.allocate(110), 90u);
+
+    // Without free space at the end a new block is appended.
+    allocator.grow(300);
+    EXPECT_EQ(allocator.free_block_count(), 1u);
+    EXPECT_EQ(allocator.largest_free_block(), 100u);
+}
+
+TEST(MeshArena, ResetAfterCompacting) {
+    RangeAllocator allocator { 100 };
+    for (uint32_t i = 0; i < 10; ++i) {
+        FOW_DISCARD(allocator.allocate(10));
+    }
+    for (uint32_t i = 0; i < 10; i += 2) {
+        allocator.free(i * 10, 10);
+    }
+    // Half of the space is free, but too fragmented for a large mesh.
+    EXPECT_EQ(allocator.free_size(), 50u);
+    EXPECT_FALSE(allocator.allocate(20).has_value());
+
+    allocator.reset(100, 50);
+    EXPECT_EQ(allocator.free_block_count(), 1u);
+    EXPECT_EQ(allocator.allocate(50), 50u);
+}
+
+TEST(MeshArena, ZeroSizedAllocationsTakeNoSpace) {
+    RangeAllocator allocator { 10 };
+    EXPECT_EQ(allocator.allocate(0), 0u);
+    allocator.free(0, 0);
+    EXPECT_EQ(allocator.free_size(), 10u);
+    EXPECT_EQ(allocator.free_block_count(), 1u);
+}
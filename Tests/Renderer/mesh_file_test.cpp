@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/MeshFile.hpp"
+
+#include <cstring>
+
+using namespace fow;
+
+static CookedModel CreateCookedModel() {
+    const Vector<Vertex> vertices = {
+        Vertex { Vector3 { 0.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector2 { 0.0f, 0.0f } },
+        Vertex { Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector2 { 1.0f, 0.0f } },
+        Vertex { Vector3 { 1.0f, 1.0f, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector2 { 1.0f, 1.0f } },
+        Vertex { Vector3 { 0.0f, 1.0f, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector2 { 0.0f, 1.0f } },
+    };
+
+    CookedModel model;
+    model.layout = VertexLayout::Compact;
+    model.material_count = 2;
+    model.bounds = BoundingSphere::FromVertices(vertices);
+    for (uint32_t i = 0; i < 2; ++i) {
+        CookedSubmesh submesh { i, static_cast<uint32_t>(model.vertex_data.size()), 4, static_cast<uint32_t>(model.indices.size()), 9, { }, model.bounds, { } };
+        const auto encoded = model.layout.encode(vertices, submesh.quantization);
+        model.vertex_data.insert(model.vertex_data.end(), encoded.begin(), encoded.end());
+        model.indices.insert(model.indices.end(), { 0u, 1u, 2u, 0u, 2u, 3u, 0u, 1u, 2u });
+        submesh.lods = { MeshLod { 0, 6, 0.0f }, MeshLod { 6, 3, 0.25f } };
+        model.submeshes.push_back(submesh);
+    }
+    return model;
+}
+
+TEST(MeshFile, RoundTrip) {
+    const auto model = CreateCookedModel();
+    const auto data = WriteMeshFile(model);
+
+    const auto view = ReadMeshFile(data);
+    ASSERT_TRUE(view.has_value()) << view.error().message;
+    EXPECT_EQ(view->layout, model.layout);
+    EXPECT_EQ(view->material_count, 2u);
+    EXPECT_FLOAT_EQ(view->bounds.radius, model.bounds.radius);
+    ASSERT_EQ(view->vertex_data.size(), model.vertex_data.size());
+    EXPECT_EQ(std::memcmp(view->vertex_data.data(), model.vertex_data.data(), model.vertex_data.size()), 0);
+    ASSERT_EQ(view->indices.size(), model.indices.size());
+    EXPECT_TRUE(std::equal(view->indices.begin(), view->indices.end(), model.indices.begin()));
+
+    ASSERT_EQ(view->submeshes.size(), 2u);
+    for (size_t i = 0; i < 2; ++i) {
+        const auto& expected = model.submeshes[i];
+        const auto& actual = view->submeshes[i];
+        EXPECT_EQ(actual.material_index, expected.material_index);
+        EXPECT_EQ(actual.vertex_offset, expected.vertex_offset);
+        EXPECT_EQ(actual.index_offset, expected.index_offset);
+        EXPECT_EQ(actual.quantization.scale, expected.quantization.scale);
+        EXPECT_EQ(actual.quantization.offset, expected.quantization.offset);
+        ASSERT_EQ(actual.lods.size(), 2u);
+        EXPECT_EQ(actual.lods[1].index_offset, 6u);
+        EXPECT_EQ(actual.lods[1].index_count, 3);
+        EXPECT_FLOAT_EQ(actual.lods[1].error, 0.25f);
+    }
+}
+
+TEST(MeshFile, RejectsInvalidFiles) {
+    auto data = WriteMeshFile(CreateCookedModel());
+
+    EXPECT_FALSE(ReadMeshFile(std::span(data).first(data.size() - 4)).has_value());
+    EXPECT_FALSE(ReadMeshFile(std::span(data).first(16)).has_value());
+
+    auto wrong_version = data;
+    wrong_version[4] = std::byte { 0xFF };
+    EXPECT_FALSE(ReadMeshFile(wrong_version).has_value());
+
+    auto wrong_magic = data;
+    wrong_magic[0] = std::byte { 'X' };
+    EXPECT_FALSE(ReadMeshFile(wrong_magic).has_value());
+}
+
+TEST(MeshFile, RejectsOutOfRangeSubmeshes) {
+    auto model = CreateCookedModel();
+    model.submeshes[1].index_count = 100;
+    EXPECT_FALSE(ReadMeshFile(WriteMeshFile(model)).has_value());
+
+    model = CreateCookedModel();
+    model.submeshes[0].lods[1].index_count = 10;
+    EXPECT_FALSE(ReadMeshFile(WriteMeshFile(model)).has_value());
+
+    model = CreateCookedModel();
+    model.submeshes[1].material_index = model.material_count;
+    EXPECT_FALSE(ReadMeshFile(WriteMeshFile(model)).has_value());
+
+    model = CreateCookedModel();
+    model.indices[model.submeshes[1].index_offset + 2] = model.submeshes[1].vertex_count;
+    EXPECT_FALSE(ReadMeshFile(WriteMeshFile(model)).has_value());
+}
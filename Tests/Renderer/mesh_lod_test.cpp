@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/MeshLod.hpp"
+
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+using namespace fow;
+
+static Vertex PositionVertex(const Vector3& position) {
+    return Vertex { position, glm::normalize(position), Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector2 { 0.0f } };
+}
+
+// Closed sphere without attribute seams.
+static void CreateSphere(const uint32_t rings, const uint32_t segments, Vector<Vertex>& vertices, Vector<GLuint>& indices) {
+    vertices.push_back(PositionVertex(Vector3 { 0.0f, 1.0f, 0.0f }));
+    for (uint32_t ring = 1; ring < rings; ++ring) {
+        for (uint32_t segment = 0; segment < segments; ++segment) {
+            const float theta = std::numbers::pi_v<float> * static_cast<float>(ring) / static_cast<float>(rings);
+            const float phi = 2.0f * std::numbers::pi_v<float> * static_cast<float>(segment) / static_cast<float>(segments);
+            vertices.push_back(PositionVertex(Vector3 { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) }));
+        }
+    }
+    vertices.push_back(PositionVertex(Vector3 { 0.0f, -1.0f, 0.0f }));
+
+    const auto bottom = static_cast<GLuint>(vertices.size() - 1);
+    const auto index = [segments](const uint32_t ring, const uint32_t segment) { return 1 + (ring - 1) * segments + segment % segments; };
+    for (uint32_t segment = 0; segment < segments; ++segment) {
+        indices.insert(indices.end(), { 0u, index(1, segment + 1), index(1, segment) });
+        indices.insert(indices.end(), { bottom, index(rings - 1, segment), index(rings - 1, segment + 1) });
+    }
+    for (uint32_t ring = 1; ring + 1 < rings; ++ring) {
+        for (uint32_t segment = 0; segment < segments; ++segment) {
+            const GLuint a = index(ring, segment), b = index(ring, segment + 1), c = index(ring + 1, segment), d = index(ring + 1, segment + 1);
+            indices.insert(indices.end(), { a, b, c, b, d, c });
+        }
+    }
+}
+
+TEST(MeshLod, SimplifiesFlatAreasWithoutError) {
+    Vector<Vertex> vertices;
+    Vector<GLuint> indices;
+    constexpr GLuint size = 16;
+    for (GLuint y = 0; y <= size; ++y) {
+        for (GLuint x = 0; x <= size; ++x) {
+            vertices.push_back(PositionVertex(Vector3 { static_cast<float>(x), static_cast<float>(y), 0.0f }));
+        }
+    }
+    for (GLuint y = 0; y < size; ++y) {
+        for (GLuint x = 0; x < size; ++x) {
+            const GLuint a = y * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+
+    float error = 1.0f;
+    const auto simplified = SimplifyMesh(vertices, indices, 0, 1e-3f, &error);
+    EXPECT_LT(simplified.size(), indices.size() / 4);
+    EXPECT_FLOAT_EQ(error, 0.0f);
+
+    // Border vertices are locked, so the covered area stays the same.
+    float area = 0.0f;
+    for (size_t i = 0; i < simplified.size(); i += 3) {
+        const Vector3& p0 = vertices[simplified[i]].position;
+        area += glm::cross(vertices[simplified[i + 1]].position - p0, vertices[simplified[i + 2]].position - p0).z * 0.5f;
+    }
+    EXPECT_NEAR(std::abs(area), static_cast<float>(size * size), 1e-3f);
+}
+
+TEST(MeshLod, GeneratesChainWithIncreasingError) {
+    Vector<Vertex> vertices;
+    Vector<GLuint> indices;
+    CreateSphere(32, 64, vertices, indices);
+
+    const auto lods = GenerateMeshLods(vertices, indices);
+    ASSERT_GT(lods.size(), 2u);
+    EXPECT_EQ(lods.front().indices, indices);
+    for (size_t i = 1; i < lods.size(); ++i) {
+        EXPECT_LT(lods[i].indices.size(), lods[i - 1].indices.size());
+        EXPECT_GE(lods[i].error, lods[i - 1].error);
+        EXPECT_LE(lods[i].error, MeshLodOptions { }.max_error);
+    }
+}
+
+TEST(MeshLod, ProjectsSphereRadius) {
+    const Matrix4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    const Matrix4 view = glm::lookAt(Vector3 { 0.0f }, Vector3 { 0.0f, 0.0f, -1.0f }, Vector3 { 0.0f, 1.0f, 0.0f });
+    // With a 90 degree field of view a sphere of radius 1 at distance 10 covers a tenth of half the viewport.
+    EXPECT_NEAR(ProjectSphereRadius(BoundingSphere { Vector3 { 0.0f, 0.0f, -10.0f }, 1.0f }, view, projection, 1000.0f), 50.0f, 1e-2f);
+    EXPECT_TRUE(std::isinf(ProjectSphereRadius(BoundingSphere { Vector3 { 0.0f }, 1.0f }, view, projection, 1000.0f)));
+}
+
+TEST(MeshLod, SelectsCoarsestLevelBelowThreshold) {
+    const Vector<MeshLod> lods = { MeshLod { 0, 300, 0.0f }, MeshLod { 300, 150, 0.01f }, MeshLod { 450, 60, 0.05f } };
+    EXPECT_EQ(SelectMeshLod(lods, 1000.0f, SIZE_MAX), 0u);
+    EXPECT_EQ(SelectMeshLod(lods, 90.0f, SIZE_MAX), 1u);
+    EXPECT_EQ(SelectMeshLod(lods, 10.0f, SIZE_MAX), 2u);
+    EXPECT_EQ(SelectMeshLod(lods, std::numeric_limits<float>::infinity(), SIZE_MAX), 0u);
+    EXPECT_EQ(SelectMeshLod({ }, 10.0f, SIZE_MAX), 0u);
+}
+
+TEST(MeshLod, HysteresisDelaysCoarserLevels) {
+    const Vector<MeshLod> lods = { MeshLod { 0, 300, 0.0f }, MeshLod { 300, 150, 0.01f } };
+    // Just below the threshold, a fresh selection switches but a drawn object keeps its level.
+    EXPECT_EQ(SelectMeshLod(lods, 95.0f, SIZE_MAX), 1u);
+    EXPECT_EQ(SelectMeshLod(lods, 95.0f, 0), 0u);
+    EXPECT_EQ(SelectMeshLod(lods, 70.0f, 0), 1u);
+    // Going back to the finer level happens as soon as the error is visible.
+    EXPECT_EQ(SelectMeshLod(lods, 95.0f, 1), 1u);
+    EXPECT_EQ(SelectMeshLod(lods, 101.0f, 1), 0u);
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <tuple>
+
+using namespace fow;
+
+static Vertex GridVertex(const float x, const float y) {
+    return Vertex { Vector3 { x, y, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector2 { x, y } };
+}
+
+// Unindexed grid, every triangle has its own vertices like the old model import produced.
+static void CreateTriangleSoup(const uint32_t size, Vector<Vertex>& vertices, Vector<GLuint>& indices) {
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            const auto fx = static_cast<float>(x), fy = static_cast<float>(y);
+            for (const auto& corner : { Vector2 { 0, 0 }, Vector2 { 0, 1 }, Vector2 { 1, 0 }, Vector2 { 1, 0 }, Vector2 { 0, 1 }, Vector2 { 1, 1 } }) {
+                indices.push_back(static_cast<GLuint>(vertices.size()));
+                vertices.push_back(GridVertex(fx + corner.x, fy + corner.y));
+            }
+        }
+    }
+}
+
+static Vector<std::array<Vector3, 3>> SortedTriangles(const Vector<Vertex>& vertices, const Vector<GLuint>& indices) {
+    Vector<std::array<Vector3, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        std::array triangle { vertices[indices[i]].position, vertices[indices[i + 1]].position, vertices[indices[i + 2]].position };
+        // Rotate the smallest corner to the front, the winding stays the same.
+        const auto less = [](const Vector3& a, const Vector3& b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+        std::ranges::rotate(triangle, std::ranges::min_element(triangle, less));
+        triangles.push_back(triangle);
+    }
+    std::ranges::sort(triangles, [](const auto& a, const auto& b) {
+        return std::tie(a[0].x, a[0].y, a[1].x, a[1].y, a[2].x, a[2].y) < std::tie(b[0].x, b[0].y, b[1].x, b[1].y, b[2].x, b[2].y);
+    });
+    return triangles;
+}
+
+TEST(MeshOptimizer, WeldsExactDuplicates) {
+    Vector<Vertex> vertices;
+    Vector<GLuint> indices;
+    CreateTriangleSoup(4, vertices, indices);
+    EXPECT_EQ(WeldVertices(vertices, indices), 96u - 25u);
+    EXPECT_EQ(vertices.size(), 25u);
+    EXPECT_EQ(indices.size(), 96u);
+}
+
+TEST(MeshOptimizer, WeldsWithinEpsilon) {
+    Vector<Vertex> vertices = { GridVertex(0.0f, 0.0f), GridVertex(1e-6f, 0.0f), GridVertex(1.0f, 0.0f) };
+    Vector<GLuint> indices = { 0, 1, 2 };
+
+    auto exact = vertices;
+    auto exact_indices = indices;
+    EXPECT_EQ(WeldVertices(exact, exact_indices), 0u);
+
+    EXPECT_EQ(WeldVertices(vertices, indices, VertexWeldOptions { VertexWeldMode::Epsilon }), 1u);
+    EXPECT_EQ(indices[0], indices[1]);
+    EXPECT_EQ(RemoveDegenerateTriangles(indices), 1u);
+    EXPECT_TRUE(indices.empty());
+}
+
+TEST(MeshOptimizer, WelderReturnsExistingIndices) {
+    VertexWelder welder;
+    Vector<Vertex> vertices;
+    EXPECT_EQ(welder.add(vertices, GridVertex(0.0f, 0.0f)), 0u);
+    EXPECT_EQ(welder.add(vertices, GridVertex(1.0f, 0.0f)), 1u);
+    EXPECT_EQ(welder.add(vertices, GridVertex(-0.0f, 0.0f)), 0u);
+    EXPECT_EQ(welder.add(vertices, GridVertex(1.0f, 0.0f)), 1u);
+    EXPECT_EQ(vertices.size(), 2u);
+}
+
+TEST(MeshOptimizer, ReordersForVertexCache) {
+    Vector<Vertex> vertices;
+    Vector<GLuint> indices;
+    CreateTriangleSoup(32, vertices, indices);
+    FOW_DISCARD(WeldVertices(vertices, indices));
+
+    // Shuffle the triangles so that the input has no locality left.
+    Vector<size_t> order(indices.size() / 3);
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::ranges::shuffle(order, std::mt19937 { 42 });
+    Vector<GLuint> shuffled;
+    for (const auto triangle : order) {
+        shuffled.insert(shuffled.end(), indices.begin() + static_cast<ptrdiff_t>(triangle * 3), indices.begin() + static_cast<ptrdiff_t>(triangle * 3 + 3));
+    }
+
+    const auto expected = SortedTriangles(vertices, shuffled);
+    const float shuffled_acmr = ComputeACMR(shuffled, vertices.size());
+    auto optimized = shuffled;
+    Vector<size_t> clusters;
+    OptimizeVertexCache(optimized, vertices.size(), FOW_VERTEX_CACHE_SIZE, &clusters);
+    EXPECT_LT(ComputeACMR(optimized, vertices.size()), shuffled_acmr * 0.5f);
+    EXPECT_FALSE(clusters.empty());
+    EXPECT_EQ(SortedTriangles(vertices, optimized), expected);
+
+    OptimizeOverdraw(optimized, vertices, clusters);
+    OptimizeVertexFetch(vertices, optimized);
+    EXPECT_EQ(SortedTriangles(vertices, optimized), expected);
+    EXPECT_EQ(optimized.front(), 0u);
+}
+
+TEST(MeshOptimizer, OptimizeMeshShrinksTriangleSoup) {
+    Vector<Vertex> vertices;
+    Vector<GLuint> indices;
+    CreateTriangleSoup(16, vertices, indices);
+    const auto expected = SortedTriangles(vertices, indices);
+    OptimizeMesh(vertices, indices, VertexWeldOptions { VertexWeldMode::Epsilon });
+    EXPECT_EQ(vertices.size(), 17u * 17u);
+    EXPECT_EQ(SortedTriangles(vertices, indices), expected);
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/MultiDraw.hpp"
+
+using namespace fow;
+
+static DrawItem Item(const MaterialPtr& material, const MeshArena& arena, const GLuint first_index, const GLsizei index_count, const GLint base_vertex, const float x = 0.0f) {
+    return DrawItem { material, &arena, first_index, index_count, base_vertex, VertexQuantization { }, glm::translate(Matrix4 { 1.0f }, Vector3 { x, 0.0f, 0.0f }) };
+}
+
+TEST(MultiDraw, GroupsItemsByMaterialAndArena) {
+    const MeshArena full { VertexLayout::Full, 16, 16 }, compact { VertexLayout::Compact, 16, 16 };
+    const auto a = CreateRef<Material>(), b = CreateRef<Material>();
+
+    MultiDrawBuilder builder;
+    builder.add(Item(a, full, 0, 36, 0));
+    builder.add(Item(b, full, 36, 12, 24));
+    builder.add(Item(a, compact, 0, 6, 0));
+    builder.add(Item(a, full, 36, 12, 24));
+    builder.add(Item(b, full, 0, 36, 0));
+    builder.add(Item(a, full, 0, 36, 0));
+    builder.build();
+
+    ASSERT_EQ(builder.commands().size(), 6u);
+    ASSERT_EQ(builder.params().size(), 6u);
+    ASSERT_EQ(builder.batches().size(), 3u);
+    EXPECT_EQ(builder.materials().size(), 2u);
+
+    uint32_t next_command = 0;
+    for (const auto& batch : builder.batches()) {
+        EXPECT_EQ(batch.first_command, next_command);
+        for (uint32_t i = batch.first_command; i < batch.first_command + batch.command_count; ++i) {
+            const auto& item = builder.items()[i];
+            EXPECT_EQ(item.material, batch.material);
+            EXPECT_EQ(item.arena, batch.arena);
+            EXPECT_EQ(builder.materials()[builder.params()[i].material.x], batch.material.get());
+        }
+        next_command += batch.command_count;
+    }
+    EXPECT_EQ(next_command, 6u);
+}
+
+TEST(MultiDraw, CommandsMatchItems) {
+    const MeshArena arena { VertexLayout::Full, 16, 16 };
+    const auto material = CreateRef<Material>();
+
+    MultiDrawBuilder builder;
+    builder.add(Item(material, arena, 120, 60, 40, 2.0f));
+    builder.add(Item(material, arena, 0, 36, 0, 1.0f));
+    builder.build();
+
+    // Ranges within a batch are ordered by their position in the element buffer.
+    ASSERT_EQ(builder.batches().size(), 1u);
+    const auto& commands = builder.commands();
+    ASSERT_EQ(commands.size(), 2u);
+    EXPECT_EQ(commands[0].first_index, 0u);
+    EXPECT_EQ(commands[0].count, 36u);
+    EXPECT_EQ(commands[0].base_vertex, 0);
+    EXPECT_EQ(commands[1].first_index, 120u);
+    EXPECT_EQ(commands[1].count, 60u);
+    EXPECT_EQ(commands[1].base_vertex, 40);
+    for (GLuint i = 0; i < commands.size(); ++i) {
+        EXPECT_EQ(commands[i].instance_count, 1u);
+        EXPECT_EQ(commands[i].base_instance, i);
+    }
+    EXPECT_FLOAT_EQ(builder.params()[0].model[3].x, 1.0f);
+    EXPECT_FLOAT_EQ(builder.params()[1].model[3].x, 2.0f);
+}
+
+TEST(MultiDraw, ClearResetsBuilder) {
+    const MeshArena arena { VertexLayout::Full, 16, 16 };
+    MultiDrawBuilder builder;
+    builder.add(Item(nullptr, arena, 0, 3, 0));
+    builder.build();
+    EXPECT_EQ(builder.batches().size(), 1u);
+
+    builder.clear();
+    builder.build();
+    EXPECT_TRUE(builder.items().empty());
+    EXPECT_TRUE(builder.commands().empty());
+    EXPECT_TRUE(builder.batches().empty());
+}
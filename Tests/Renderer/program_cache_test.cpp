@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/ProgramCache.hpp"
+
+using namespace fow;
+
+static constexpr std::string_view Vertex = "#version 460 core\nvoid main() { gl_Position = vec4(0.0); }";
+static constexpr std::string_view Fragment = "#version 460 core\nout vec4 FRAGMENT_COLOR;\nvoid main() { FRAGMENT_COLOR = vec4(1.0); }";
+static constexpr std::string_view Driver = "Vendor\nRenderer\n4.6.0 Driver 1.0";
+
+static ProgramBinary CreateBinary() {
+    ProgramBinary binary;
+    binary.format = 0x8E21;
+    for (int i = 0; i < 37; ++i) {
+        binary.data.push_back(static_cast<std::byte>(i * 7));
+    }
+    return binary;
+}
+
+TEST(ProgramCache, KeyDependsOnEveryInput) {
+    const auto key = ProgramCacheKey::Create(Vertex, Fragment, "", Driver);
+    EXPECT_EQ(key, ProgramCacheKey::Create(Vertex, Fragment, "", Driver));
+
+    EXPECT_NE(key.source_hash, ProgramCacheKey::Create(Vertex, Fragment, "#define NORMAL_MAP\n", Driver).source_hash);
+    EXPECT_NE(key.source_hash, ProgramCacheKey::Create(Fragment, Vertex, "", Driver).source_hash);
+    // Text moved from one stage to the other is a different program.
+    EXPECT_NE(ProgramCacheKey::Create("ab", "c", "", Driver).source_hash, ProgramCacheKey::Create("a", "bc", "", Driver).source_hash);
+
+    const auto updated_driver = ProgramCacheKey::Create(Vertex, Fragment, "", "Vendor\nRenderer\n4.6.0 Driver 1.1");
+    EXPECT_EQ(key.source_hash, updated_driver.source_hash);
+    EXPECT_NE(key.driver_hash, updated_driver.driver_hash);
+    // The stale binary of the old driver is overwritten instead of kept next to the new one.
+    EXPECT_EQ(key.filename(), updated_driver.filename());
+    EXPECT_TRUE(key.filename().ends_with(FOW_PROGRAM_CACHE_EXTENSION));
+}
+
+TEST(ProgramCache, RoundTrip) {
+    const auto key = ProgramCacheKey::Create(Vertex, Fragment, "", Driver);
+    const auto binary = CreateBinary();
+    const auto data = WriteProgramCacheFile(key, binary);
+
+    const auto result = ReadProgramCacheFile(data, key);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+    EXPECT_EQ(result->format, binary.format);
+    EXPECT_EQ(result->data, binary.data);
+}
+
+TEST(ProgramCache, RejectsMismatchedFiles) {
+    const auto key = ProgramCacheKey::Create(Vertex, Fragment, "", Driver);
+    const auto data = WriteProgramCacheFile(key, CreateBinary());
+
+    EXPECT_FALSE(ReadProgramCacheFile(data, ProgramCacheKey::Create(Vertex, Fragment, "#define INSTANCED\n", Driver)).has_value());
+    EXPECT_FALSE(ReadProgramCacheFile(data, ProgramCacheKey::Create(Vertex, Fragment, "", "Other Vendor")).has_value());
+
+    EXPECT_FALSE(ReadProgramCacheFile(std::span(data).first(data.size() - 1), key).has_value());
+    EXPECT_FALSE(ReadProgramCacheFile(std::span(data).first(8), key).has_value());
+
+    auto wrong_version = data;
+    wrong_version[4] = std::byte { 0xFF };
+    EXPECT_FALSE(ReadProgramCacheFile(wrong_version, key).has_value());
+
+    auto wrong_magic = data;
+    wrong_magic[0] = std::byte { 'X' };
+    EXPECT_FALSE(ReadProgramCacheFile(wrong_magic, key).has_value());
+}
@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/ShaderBatch.hpp"
+
+using namespace fow;
+
+static constexpr const char* Vertex = "#version 460 core\nvoid main() { gl_Position = vec4(0.0); }";
+static constexpr const char* Fragment = "#version 460 core\nout vec4 FRAGMENT_COLOR;\nvoid main() { FRAGMENT_COLOR = vec4(1.0); }";
+
+TEST(ShaderCompileBatch, SkipsShadersAddedBefore) {
+    ShaderCompileBatch batch;
+    batch.add("ShaderBatchTestA", Vertex, Fragment);
+    batch.add("ShaderBatchTestB", Vertex, Fragment);
+    batch.add("ShaderBatchTestA", Vertex, Fragment);
+    EXPECT_EQ(batch.total(), 2u);
+    EXPECT_EQ(batch.completed(), 0u);
+    EXPECT_FALSE(batch.is_done());
+}
+
+TEST(ShaderCompileBatch, CountsProgress) {
+    ShaderCompileBatch empty;
+    EXPECT_EQ(empty.total(), 0u);
+    EXPECT_FLOAT_EQ(empty.progress(), 1.0f);
+
+    ShaderCompileBatch batch;
+    batch.add("ShaderBatchTestA", Vertex, Fragment);
+    batch.add("ShaderBatchTestB", Vertex, Fragment);
+    EXPECT_FLOAT_EQ(batch.progress(), 0.0f);
+
+    // The target takes over the jobs, the source is empty afterwards.
+    ShaderCompileBatch moved;
+    moved = std::move(batch);
+    EXPECT_EQ(moved.total(), 2u);
+    EXPECT_EQ(batch.total(), 0u);
+}
+
+TEST(ShaderCompileBatch, IgnoresShadersAddedAfterSubmit) {
+    ShaderCompileBatch batch;
+    batch.submit();
+    EXPECT_TRUE(batch.is_done());
+
+    batch.add("ShaderBatchTestA", Vertex, Fragment);
+    EXPECT_EQ(batch.total(), 0u);
+    EXPECT_TRUE(batch.is_done());
+    EXPECT_FLOAT_EQ(batch.progress(), 1.0f);
+}
@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/ShaderBundle.hpp"
+
+using namespace fow;
+
+static constexpr std::string_view Vertex = "#version 460 core\nvoid main() { gl_Position = vec4(0.0); }";
+static constexpr std::string_view Fragment = "#version 460 core\nout vec4 FRAGMENT_COLOR;\nvoid main() { FRAGMENT_COLOR = vec4(1.0); }";
+
+static Vector<ShaderBundleEntry> CreateEntries() {
+    ShaderBundleEntry plain;
+    plain.name = "PbrGeneric";
+    plain.source_hash = ShaderSourceHash(Vertex, Fragment);
+    plain.defaults.insert_or_assign("Material.roughness", "0.5");
+    plain.defaults.insert_or_assign("Material.tint", "1.0 1.0 1.0");
+    plain.vertex = { 0x07230203, 0x00010000, 1, 2, 3 };
+    plain.fragment = { 0x07230203, 0x00010000, 4, 5 };
+
+    ShaderBundleEntry variant;
+    variant.name = "PbrGeneric[NORMAL_MAP]";
+    variant.source_hash = 42;
+    variant.vertex = { 0x07230203 };
+    variant.fragment = { };
+    return { plain, variant };
+}
+
+TEST(ShaderBundle, SourceHashDependsOnBothStages) {
+    EXPECT_EQ(ShaderSourceHash(Vertex, Fragment), ShaderSourceHash(Vertex, Fragment));
+    EXPECT_NE(ShaderSourceHash(Vertex, Fragment), ShaderSourceHash(Fragment, Vertex));
+    EXPECT_NE(ShaderSourceHash(Vertex, Fragment), ShaderSourceHash(Vertex, "#version 460 core\nvoid main() { }"));
+}
+
+TEST(ShaderBundle, RoundTrip) {
+    const auto entries = CreateEntries();
+    const auto data = WriteShaderBundle(entries);
+
+    const auto result = ReadShaderBundle(data);
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+    ASSERT_EQ(result->size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& read = result->at(i);
+        EXPECT_EQ(read.name, entries[i].name);
+        EXPECT_EQ(read.source_hash, entries[i].source_hash);
+        EXPECT_EQ(read.vertex, entries[i].vertex);
+        EXPECT_EQ(read.fragment, entries[i].fragment);
+        EXPECT_EQ(read.defaults.size(), entries[i].defaults.size());
+        for (const auto& [ name, value ] : entries[i].defaults) {
+            ASSERT_TRUE(read.defaults.contains(name));
+            EXPECT_EQ(read.defaults.at(name), value);
+        }
+    }
+}
+
+TEST(ShaderBundle, EmptyBundle) {
+    const auto result = ReadShaderBundle(WriteShaderBundle({ }));
+    ASSERT_TRUE(result.has_value()) << result.error().message;
+    EXPECT_TRUE(result->empty());
+}
+
+TEST(ShaderBundle, RejectsDamagedFiles) {
+    const auto data = WriteShaderBundle(CreateEntries());
+
+    // Every truncation fails instead of reading past the end.
+    for (size_t size = 0; size < data.size(); ++size) {
+        EXPECT_FALSE(ReadShaderBundle(std::span(data).first(size)).has_value()) << "Truncated to " << size << " bytes";
+    }
+
+    auto bad_magic = data;
+    bad_magic[0] = std::byte { 'X' };
+    EXPECT_FALSE(ReadShaderBundle(bad_magic).has_value());
+
+    auto bad_version = data;
+    bad_version[4] = static_cast<std::byte>(FOW_SHADER_BUNDLE_VERSION + 1);
+    EXPECT_FALSE(ReadShaderBundle(bad_version).has_value());
+
+    auto trailing = data;
+    trailing.push_back(std::byte { 0 });
+    EXPECT_FALSE(ReadShaderBundle(trailing).has_value());
+
+    // A huge entry count in a damaged header is rejected without allocating for it.
+    auto bad_count = data;
+    bad_count[8] = bad_count[9] = bad_count[10] = bad_count[11] = std::byte { 0xFF };
+    EXPECT_FALSE(ReadShaderBundle(bad_count).has_value());
+}
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/ShaderLib.hpp"
+
+using namespace fow;
+
+static constexpr char Vertex[] = "#version 460 core\nvoid main() { gl_Position = vec4(0.0); }";
+static constexpr char Fragment[] = "#version 460 core\nout vec4 FRAGMENT_COLOR;\nvoid main() { FRAGMENT_COLOR = vec4(1.0); }";
+static constexpr char Include[] = "const float PI = 3.14159265;\n";
+
+static constexpr ShaderLibSource Sources[] = {
+    { "include/Math.glsl", Include, sizeof(Include) - 1, ShaderLibStage::None },
+    { "src/Test.fsh", Fragment, sizeof(Fragment) - 1, ShaderLibStage::Fragment },
+    { "src/Test.vsh", Vertex, sizeof(Vertex) - 1, ShaderLibStage::Vertex }
+};
+static constexpr ShaderLibShader Shaders[] = {
+    { "Another", 2, 1 },
+    { "Test", 2, 1 }
+};
+static constexpr ShaderLibTable Table = { FOW_SHADERLIB_TABLE_VERSION, std::size(Sources), std::size(Shaders), Sources, Shaders };
+
+TEST(ShaderLib, LookupReturnsViewsIntoTheTable) {
+    ASSERT_TRUE(ShaderLib::LoadTable(&Table).has_value());
+
+    const auto sources = ShaderLib::GetSourcesForShader("Test");
+    ASSERT_TRUE(sources.has_value()) << sources.error().message;
+    EXPECT_EQ(sources->vertex, "src/Test.vsh");
+    EXPECT_EQ(sources->fragment, "src/Test.fsh");
+
+    const auto vertex = ShaderLib::GetSource(String(sources->vertex));
+    ASSERT_TRUE(vertex.has_value()) << vertex.error().message;
+    EXPECT_EQ(vertex->data(), Vertex);
+    EXPECT_EQ(vertex->size(), sizeof(Vertex) - 1);
+
+    EXPECT_EQ(ShaderLib::GetSourceStages("src/Test.fsh"), ShaderLibStage::Fragment);
+    EXPECT_EQ(ShaderLib::GetSourceStages("include/Math.glsl"), ShaderLibStage::None);
+    EXPECT_EQ(ShaderLib::GetShaders().size(), std::size(Shaders));
+
+    EXPECT_FALSE(ShaderLib::GetSourcesForShader("Tes").has_value());
+    EXPECT_FALSE(ShaderLib::GetSourcesForShader("Tests").has_value());
+    EXPECT_FALSE(ShaderLib::GetSource("src/Missing.fsh").has_value());
+
+    ShaderLib::Unload();
+    EXPECT_FALSE(ShaderLib::GetSourcesForShader("Test").has_value());
+}
+
+TEST(ShaderLib, RejectsInvalidTables) {
+    EXPECT_FALSE(ShaderLib::LoadTable(nullptr).has_value());
+
+    auto outdated = Table;
+    outdated.version = FOW_SHADERLIB_TABLE_VERSION + 1;
+    EXPECT_FALSE(ShaderLib::LoadTable(&outdated).has_value());
+
+    static constexpr ShaderLibShader Unsorted[] = { Shaders[1], Shaders[0] };
+    auto unsorted = Table;
+    unsorted.shaders = Unsorted;
+    EXPECT_FALSE(ShaderLib::LoadTable(&unsorted).has_value());
+
+    static constexpr ShaderLibShader OutOfRange[] = { { "Test", 2, 3 } };
+    auto out_of_range = Table;
+    out_of_range.shaders = OutOfRange;
+    out_of_range.shader_count = 1;
+    EXPECT_FALSE(ShaderLib::LoadTable(&out_of_range).has_value());
+
+    // A rejected table does not replace the loaded one.
+    EXPECT_FALSE(ShaderLib::GetSourcesForShader("Test").has_value());
+}
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/Material.hpp"
+#include "fow/Renderer/ShaderVariant.hpp"
+
+using namespace fow;
+
+static constexpr std::string_view Fragment =
+    "#version 460 core\n"
+    "#ifndef SHADER_VARIANT\n"
+    "    #define NORMAL_MAP\n"
+    "    #define ALPHA_SCISSOR\n"
+    "#endif\n"
+    "uniform sampler2D NormalMap;\n"
+    "uniform bool AlphaScissor;\n";
+
+static std::string_view View(const String& value) {
+    return { value.as_cstr(), value.size() };
+}
+
+TEST(ShaderVariant, DetectsFeaturesOfSource) {
+    EXPECT_EQ(ShaderSourceFeatures(Fragment), ShaderFeatures::NormalMap | ShaderFeatures::AlphaScissor);
+    // Only whole identifiers count.
+    EXPECT_EQ(ShaderSourceFeatures("#define NORMAL_MAPS\nuniform sampler2D MY_EMISSION_MAP;"), ShaderFeatures::None);
+}
+
+TEST(ShaderVariant, InjectsDefinesAfterVersion) {
+    const auto defines = ShaderVariantDefines(ShaderFeatures::AlphaScissor);
+    EXPECT_EQ(View(defines), "#define SHADER_VARIANT\n#define ALPHA_SCISSOR\n");
+
+    const auto source = InjectShaderDefines("#version 460 core\nvoid main() { }", View(defines));
+    EXPECT_EQ(View(source), "#version 460 core\n#define SHADER_VARIANT\n#define ALPHA_SCISSOR\n#line 2\nvoid main() { }");
+
+    const auto unversioned = InjectShaderDefines("void main() { }", View(defines));
+    EXPECT_EQ(View(unversioned), "#define SHADER_VARIANT\n#define ALPHA_SCISSOR\n#line 1\nvoid main() { }");
+}
+
+TEST(ShaderVariant, Names) {
+    const ShaderVariantKey supported = ShaderFeatures::NormalMap | ShaderFeatures::AlphaScissor;
+    EXPECT_EQ(View(ShaderVariantName("PbrGeneric", ShaderFeatures::None, supported)), "PbrGeneric[]");
+    EXPECT_EQ(View(ShaderVariantName("PbrGeneric", ShaderFeatures::NormalMap | ShaderFeatures::EmissionMap, supported)), "PbrGeneric[NORMAL_MAP]");
+    // The variant with every supported feature is the plain shader.
+    EXPECT_EQ(View(ShaderVariantName("PbrGeneric", ShaderFeatures::All, supported)), "PbrGeneric");
+    EXPECT_EQ(View(ShaderVariantName("PbrGeneric", supported, supported)), "PbrGeneric");
+}
+
+TEST(ShaderVariant, ParsesNames) {
+    const auto [ name, key ] = ParseShaderVariantName("PbrGeneric[NORMAL_MAP|ALPHA_SCISSOR]");
+    EXPECT_EQ(View(name), "PbrGeneric");
+    EXPECT_EQ(key, ShaderFeatures::NormalMap | ShaderFeatures::AlphaScissor);
+    EXPECT_EQ(ParseShaderVariantName("PbrGeneric[]").second, ShaderFeatures::None);
+    // Plain names are the variant with every feature.
+    EXPECT_EQ(View(ParseShaderVariantName("PbrGeneric").first), "PbrGeneric");
+    EXPECT_EQ(ParseShaderVariantName("PbrGeneric").second, ShaderFeatures::All);
+
+    const ShaderVariantKey supported = ShaderFeatures::SpecularMap | ShaderFeatures::ColorTintMask | ShaderFeatures::EmissionMap;
+    EXPECT_EQ(ParseShaderVariantName(ShaderVariantName("Unlit", ShaderFeatures::ColorTintMask | ShaderFeatures::EmissionMap, supported)).second,
+              ShaderFeatures::ColorTintMask | ShaderFeatures::EmissionMap);
+}
+
+TEST(ShaderVariant, MaterialSelectsMinimalVariant) {
+    EXPECT_EQ(Material::SelectVariant({ }), ShaderFeatures::None);
+    EXPECT_EQ(Material::SelectVariant({ { "AlphaScissor", true }, { "UseColorTintMask", false } }), ShaderFeatures::AlphaScissor);
+    EXPECT_EQ(Material::SelectVariant({ { "UseColorTintMask", true } }), ShaderFeatures::ColorTintMask);
+    // Unset textures need no sampling.
+    EXPECT_EQ(Material::SelectVariant({ { "NormalMap", TexturePtr(nullptr) }, { "EmissionMap", TexturePtr(nullptr) } }), ShaderFeatures::None);
+}
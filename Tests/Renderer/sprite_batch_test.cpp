@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/SpriteBatch.hpp"
+
+#include <cstring>
+
+using namespace fow;
+
+static SpriteQuad Quad(const TexturePtr& texture, const float x = 0.0f, const SpriteQuadMode::Type mode = SpriteQuadMode::Texture) {
+    SpriteQuad quad;
+    quad.rect = Rectangle { x, 0.0f, 16.0f, 8.0f };
+    quad.texture = texture;
+    quad.mode = mode;
+    return quad;
+}
+
+static uint32_t Slot(const SpriteVertex& vertex) { return vertex.flags & 0xFu; }
+static bool IsArraySlot(const SpriteVertex& vertex) { return (vertex.flags & 0x10u) != 0; }
+
+TEST(SpriteBatch, MergesDifferentTexturesIntoOneBatch) {
+    const TexturePtr a = CreateRef<Texture2D>(), b = CreateRef<Texture2D>();
+    const TexturePtr glyphs = CreateRef<Texture2DArray>();
+
+    SpriteBatch2D batch;
+    batch.add(Quad(a));
+    batch.add(Quad(b));
+    batch.add(Quad(glyphs, 0.0f, SpriteQuadMode::DistanceField));
+    batch.add(Quad(a));
+    batch.build();
+
+    ASSERT_EQ(batch.batches().size(), 1u);
+    const auto& range = batch.batches().front();
+    EXPECT_EQ(range.first_quad, 0u);
+    EXPECT_EQ(range.quad_count, 4u);
+    EXPECT_EQ(range.texture_count, 2u);
+    EXPECT_EQ(range.array_count, 1u);
+    EXPECT_EQ(range.textures[0], a);
+    EXPECT_EQ(range.textures[1], b);
+    EXPECT_EQ(range.arrays[0], glyphs);
+
+    const auto& vertices = batch.vertices();
+    ASSERT_EQ(vertices.size(), 16u);
+    EXPECT_EQ(Slot(vertices[0]), 0u);
+    EXPECT_EQ(Slot(vertices[4]), 1u);
+    EXPECT_EQ(Slot(vertices[8]), 0u);
+    EXPECT_TRUE(IsArraySlot(vertices[8]));
+    EXPECT_EQ(vertices[8].flags >> 8, static_cast<uint32_t>(SpriteQuadMode::DistanceField));
+    EXPECT_EQ(Slot(vertices[12]), 0u);
+    EXPECT_FALSE(IsArraySlot(vertices[12]));
+}
+
+TEST(SpriteBatch, StartsANewBatchWhenTheTextureSlotsAreFull) {
+    Vector<TexturePtr> textures;
+    for (int i = 0; i < FOW_SPRITE_BATCH_TEXTURE_SLOTS + 2; ++i) {
+        textures.push_back(CreateRef<Texture2D>());
+    }
+
+    SpriteBatch2D batch;
+    for (const auto& texture : textures) {
+        batch.add(Quad(texture));
+    }
+    batch.add(Quad(textures.front()));
+    batch.build();
+
+    ASSERT_EQ(batch.batches().size(), 2u);
+    EXPECT_EQ(batch.batches()[0].quad_count, static_cast<uint32_t>(FOW_SPRITE_BATCH_TEXTURE_SLOTS));
+    EXPECT_EQ(batch.batches()[0].texture_count, static_cast<uint32_t>(FOW_SPRITE_BATCH_TEXTURE_SLOTS));
+    EXPECT_EQ(batch.batches()[1].first_quad, static_cast<uint32_t>(FOW_SPRITE_BATCH_TEXTURE_SLOTS));
+    EXPECT_EQ(batch.batches()[1].quad_count, 3u);
+    // The first texture is not in the second batch yet, it gets a slot of its own there.
+    EXPECT_EQ(batch.batches()[1].texture_count, 3u);
+}
+
+TEST(SpriteBatch, OrdersByLayerAndKeepsTheOrderWithinALayer) {
+    const TexturePtr texture = CreateRef<Texture2D>();
+
+    SpriteBatch2D batch;
+    batch.set_layer(1);
+    batch.add(Quad(texture, 10.0f));
+    batch.add(Quad(texture, 11.0f));
+    batch.set_layer(0);
+    batch.add(Quad(texture, 0.0f));
+    batch.set_layer(1);
+    batch.add(Quad(texture, 12.0f));
+    batch.build();
+
+    const auto& vertices = batch.vertices();
+    ASSERT_EQ(vertices.size(), 16u);
+    EXPECT_FLOAT_EQ(vertices[0].position.x, 0.0f);
+    EXPECT_FLOAT_EQ(vertices[4].position.x, 10.0f);
+    EXPECT_FLOAT_EQ(vertices[8].position.x, 11.0f);
+    EXPECT_FLOAT_EQ(vertices[12].position.x, 12.0f);
+    EXPECT_EQ(batch.batches().size(), 1u);
+}
+
+TEST(SpriteBatch, WritesTheCornersOfEachQuad) {
+    SpriteQuad quad = Quad(CreateRef<Texture2DArray>(), 4.0f);
+    quad.uv_min = { 0.25f, 0.5f };
+    quad.uv_max = { 0.75f, 1.0f };
+    quad.array_layer = 3.0f;
+    quad.color = Color { 1.0f, 0.0f, 0.0f, 0.5f };
+
+    SpriteBatch2D batch;
+    batch.add(quad);
+    batch.build();
+
+    const auto& vertices = batch.vertices();
+    ASSERT_EQ(vertices.size(), 4u);
+    EXPECT_EQ(vertices[0].position, (Vector2 { 4.0f, 0.0f }));
+    EXPECT_EQ(vertices[1].position, (Vector2 { 4.0f, 8.0f }));
+    EXPECT_EQ(vertices[2].position, (Vector2 { 20.0f, 8.0f }));
+    EXPECT_EQ(vertices[3].position, (Vector2 { 20.0f, 0.0f }));
+    EXPECT_EQ(vertices[0].uv, (Vector3 { 0.25f, 0.5f, 3.0f }));
+    EXPECT_EQ(vertices[2].uv, (Vector3 { 0.75f, 1.0f, 3.0f }));
+    EXPECT_EQ(vertices[0].color, PackColorRGBA8(quad.color));
+    EXPECT_EQ(PackColorRGBA8(quad.color), 0x800000FFu);
+
+    batch.clear();
+    EXPECT_TRUE(batch.is_empty());
+    EXPECT_TRUE(batch.vertices().empty());
+    EXPECT_TRUE(batch.batches().empty());
+}
+
+TEST(SpriteBatch, PatchesQuadsInPlace) {
+    const TexturePtr a = CreateRef<Texture2D>(), b = CreateRef<Texture2D>();
+
+    SpriteBatch2D batch;
+    batch.add(Quad(a, 0.0f));
+    batch.add(Quad(a, 16.0f));
+    batch.add(Quad(a, 32.0f));
+    batch.build();
+    ASSERT_EQ(batch.batches().size(), 1u);
+
+    const SpriteQuad moved[] = { Quad(b, 100.0f) };
+    ASSERT_TRUE(batch.patch(1, moved));
+    const auto& vertices = batch.vertices();
+    ASSERT_EQ(vertices.size(), 12u);
+    EXPECT_FLOAT_EQ(vertices[0].position.x, 0.0f);
+    EXPECT_FLOAT_EQ(vertices[4].position.x, 100.0f);
+    EXPECT_FLOAT_EQ(vertices[8].position.x, 32.0f);
+    // The new texture took a free slot of the batch the quad is in.
+    EXPECT_EQ(Slot(vertices[4]), 1u);
+    EXPECT_EQ(batch.batches().size(), 1u);
+    EXPECT_EQ(batch.batches().front().textures[1], b);
+    EXPECT_EQ(batch.quads()[1].texture, b);
+
+    EXPECT_FALSE(batch.patch(3, moved));
+}
+
+TEST(SpriteBatch, DoesNotPatchWhenTheBatchNeedsToBeRebuilt) {
+    Vector<TexturePtr> textures;
+    SpriteBatch2D batch;
+    for (int i = 0; i < FOW_SPRITE_BATCH_TEXTURE_SLOTS; ++i) {
+        batch.add(Quad(textures.emplace_back(CreateRef<Texture2D>()), static_cast<float>(i)));
+    }
+    batch.build();
+
+    const SpriteQuad replaced[] = { Quad(CreateRef<Texture2D>(), 50.0f) };
+    EXPECT_FALSE(batch.patch(0, replaced));
+    EXPECT_EQ(batch.quads()[0].texture, textures[0]);
+    EXPECT_FLOAT_EQ(batch.vertices()[0].position.x, 0.0f);
+
+    // The first quad would fit into the last free slot, the second does not, so the first must not keep the slot.
+    SpriteBatch2D partial;
+    for (int i = 0; i < FOW_SPRITE_BATCH_TEXTURE_SLOTS - 1; ++i) {
+        partial.add(Quad(textures[i], static_cast<float>(i)));
+    }
+    partial.build();
+    const SpriteQuad two_new[] = { Quad(CreateRef<Texture2D>()), Quad(CreateRef<Texture2D>()) };
+    EXPECT_FALSE(partial.patch(0, two_new));
+    ASSERT_EQ(partial.batches().size(), 1u);
+    EXPECT_EQ(partial.batches().front().texture_count, static_cast<uint32_t>(FOW_SPRITE_BATCH_TEXTURE_SLOTS - 1));
+    EXPECT_EQ(partial.batches().front().textures[FOW_SPRITE_BATCH_TEXTURE_SLOTS - 1], nullptr);
+    EXPECT_EQ(partial.quads()[0].texture, textures[0]);
+
+    // Reordered layers move the vertices away from the index of their quad.
+    SpriteBatch2D layered;
+    layered.set_layer(1);
+    layered.add(Quad(textures[0]));
+    layered.set_layer(0);
+    layered.add(Quad(textures[0]));
+    layered.build();
+    const SpriteQuad same[] = { Quad(textures[0]) };
+    EXPECT_FALSE(layered.patch(0, same));
+}
+
+TEST(SpriteBatch, PatchingALabelRewritesOnlyItsQuads) {
+    const TexturePtr panel = CreateRef<Texture2D>();
+    const TexturePtr glyphs = CreateRef<Texture2DArray>();
+
+    // A panel, a label of three glyphs and a second panel in one segment, like a Frame records them.
+    SpriteBatch2D segment;
+    segment.add(Quad(panel, 0.0f));
+    for (int i = 0; i < 3; ++i) {
+        segment.add(Quad(glyphs, 20.0f + static_cast<float>(i) * 8.0f, SpriteQuadMode::DistanceField));
+    }
+    segment.add(Quad(panel, 64.0f));
+    segment.build();
+    const auto before = segment.vertices();
+
+    // The label changes its text but keeps its number of glyphs.
+    Vector<SpriteQuad> label;
+    for (int i = 0; i < 3; ++i) {
+        auto& glyph = label.emplace_back(Quad(glyphs, 20.0f + static_cast<float>(i) * 8.0f, SpriteQuadMode::DistanceField));
+        glyph.array_layer = static_cast<float>(i + 5);
+    }
+    ASSERT_TRUE(segment.patch(1, label));
+
+    const auto& after = segment.vertices();
+    ASSERT_EQ(after.size(), before.size());
+    for (size_t i = 0; i < after.size(); ++i) {
+        const bool in_label = i >= 4 && i < 16;
+        EXPECT_EQ(std::memcmp(&after[i], &before[i], sizeof(SpriteVertex)) != 0, in_label) << "vertex " << i;
+    }
+    EXPECT_FLOAT_EQ(after[4].uv.z, 5.0f);
+    EXPECT_FLOAT_EQ(after[12].uv.z, 7.0f);
+    EXPECT_EQ(segment.batches().size(), 1u);
+}
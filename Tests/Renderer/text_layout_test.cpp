@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/TextLayout.hpp"
+
+using namespace fow;
+
+// Layout of single byte text with a cursor per character, lines start at the given codepoints.
+static Ref<TextLayout> MakeLayout(const std::string_view text, const Vector<uint32_t>& line_starts = { 0 }, const int32_t wrap_width = 0) {
+    auto layout = CreateRef<TextLayout>();
+    layout->text = String(text);
+    layout->wrap_width = wrap_width;
+    for (size_t i = 0; i < line_starts.size(); ++i) {
+        layout->lines.push_back(TextLine { line_starts[i], line_starts[i], 0.0f, i > 0 });
+    }
+    uint32_t line = 0;
+    for (uint32_t i = 0; i <= text.size(); ++i) {
+        while (line + 1 < line_starts.size() && line_starts[line + 1] <= i) {
+            ++line;
+        }
+        layout->cursors.push_back(TextCursor { i, i, line, 0, static_cast<float>(i - line_starts[line]) * 10.0f, 0.0f });
+    }
+    return layout;
+}
+
+TEST(TextLayout, ResumesAtTheFirstChangedCodepoint) {
+    const auto layout = MakeLayout("Gold: 120");
+    EXPECT_EQ(layout->resume_cursor("Gold: 125"), 8);
+    EXPECT_EQ(layout->resume_cursor("Gold: 1200"), 9);
+    EXPECT_EQ(layout->resume_cursor("Gold: 120"), 9);
+    EXPECT_EQ(layout->resume_cursor("Wood: 120"), 0);
+    EXPECT_EQ(layout->resume_cursor(""), 0);
+}
+
+TEST(TextLayout, ResumesAtTheStartOfAChangedMultibyteCodepoint) {
+    auto layout = MakeLayout("a\xC3\xA9");
+    layout->cursors = {
+        { 0, 0, 0, 0, 0.0f, 0.0f },
+        { 1, 1, 0, 0, 10.0f, 10.0f },
+        { 3, 2, 0, 0, 20.0f, 20.0f }
+    };
+    EXPECT_EQ(layout->resume_cursor("a\xC3\xA8"), 1);
+    EXPECT_EQ(layout->resume_cursor("a\xC3\xA9!"), 2);
+}
+
+TEST(TextLayout, WrappedTextResumesAtTheLineAboveTheChangedWord) {
+    // "aa bb" | "cc dd" | "ee"
+    const auto layout = MakeLayout("aa bb cc dd ee", { 0, 6, 12 }, 50);
+    EXPECT_EQ(layout->resume_cursor("aa bb cc dd ex"), 6);
+    EXPECT_EQ(layout->resume_cursor("aa bb cc dx ee"), 0);
+    EXPECT_EQ(layout->resume_cursor("aa bx cc dd ee"), 0);
+}
+
+TEST(TextLayoutCache, EvictsTheLeastRecentlyUsedLayout) {
+    const auto a = MakeLayout("a");
+    const auto b = MakeLayout("b");
+    const auto c = MakeLayout("c");
+    TextLayoutCache cache(a->memory_usage() * 2 + a->memory_usage() / 2);
+
+    const auto key_a = TextLayoutCache::MakeKey(1, 16, "a", 0);
+    const auto key_b = TextLayoutCache::MakeKey(1, 16, "b", 0);
+    const auto key_c = TextLayoutCache::MakeKey(1, 16, "c", 0);
+    cache.insert(key_a, a);
+    cache.insert(key_b, b);
+    EXPECT_EQ(cache.find(key_a, "a"), a);
+    cache.insert(key_c, c);
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_LE(cache.memory_usage(), cache.budget());
+    EXPECT_EQ(cache.find(key_a, "a"), a);
+    EXPECT_EQ(cache.find(key_b, "b"), nullptr);
+    EXPECT_EQ(cache.find(key_c, "c"), c);
+
+    cache.set_budget(0);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.memory_usage(), 0);
+}
+
+TEST(TextLayoutCache, KeysSeparateFontsSizesAndWrapWidths) {
+    TextLayoutCache cache;
+    const auto layout = MakeLayout("HP 100");
+    cache.insert(TextLayoutCache::MakeKey(1, 16, "HP 100", 0), layout);
+
+    EXPECT_EQ(cache.find(TextLayoutCache::MakeKey(1, 16, "HP 100", 0), "HP 100"), layout);
+    EXPECT_EQ(cache.find(TextLayoutCache::MakeKey(2, 16, "HP 100", 0), "HP 100"), nullptr);
+    EXPECT_EQ(cache.find(TextLayoutCache::MakeKey(1, 24, "HP 100", 0), "HP 100"), nullptr);
+    EXPECT_EQ(cache.find(TextLayoutCache::MakeKey(1, 16, "HP 100", 64), "HP 100"), nullptr);
+    // A hash collision must not hand out the layout of another text.
+    EXPECT_EQ(cache.find(TextLayoutCache::MakeKey(1, 16, "HP 100", 0), "HP 99"), nullptr);
+}
+
+TEST(TextLayoutCache, DoesNotKeepLayoutsLargerThanTheBudget) {
+    const auto layout = MakeLayout("A long line of text");
+    TextLayoutCache cache(layout->memory_usage() - 1);
+    const auto key = TextLayoutCache::MakeKey(1, 16, "A long line of text", 0);
+    cache.insert(key, layout);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.find(key, "A long line of text"), nullptr);
+}
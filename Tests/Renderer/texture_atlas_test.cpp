@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/SpriteBatch.hpp"
+#include "fow/Renderer/TextureAtlas.hpp"
+
+using namespace fow;
+
+TEST(MaxRectsPacker, PlacesRectanglesInsideThePageWithoutOverlap) {
+    MaxRectsPacker packer(Vector2i { 256, 256 });
+    const Vector<Vector2i> sizes = { { 100, 60 }, { 40, 40 }, { 156, 30 }, { 64, 128 }, { 30, 90 }, { 92, 92 }, { 16, 16 }, { 50, 20 } };
+
+    struct Placed {
+        Vector2i position, size;
+    };
+    Vector<Placed> placed;
+    for (const auto& size : sizes) {
+        const auto position = packer.pack(size);
+        ASSERT_TRUE(position.has_value());
+        EXPECT_GE(position->x, 0);
+        EXPECT_GE(position->y, 0);
+        EXPECT_LE(position->x + size.x, 256);
+        EXPECT_LE(position->y + size.y, 256);
+        for (const auto& other : placed) {
+            const bool overlaps = position->x < other.position.x + other.size.x && other.position.x < position->x + size.x &&
+                                  position->y < other.position.y + other.size.y && other.position.y < position->y + size.y;
+            EXPECT_FALSE(overlaps);
+        }
+        placed.push_back(Placed { position.value(), size });
+    }
+    EXPECT_GT(packer.occupancy(), 0.0f);
+}
+
+TEST(MaxRectsPacker, FillsThePageExactlyAndStartsOverAfterReset) {
+    MaxRectsPacker packer(Vector2i { 64, 64 });
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_TRUE(packer.pack(Vector2i { 16, 16 }).has_value());
+    }
+    EXPECT_FLOAT_EQ(packer.occupancy(), 1.0f);
+    EXPECT_EQ(packer.free_rect_count(), 0u);
+    EXPECT_FALSE(packer.pack(Vector2i { 1, 1 }).has_value());
+
+    packer.reset(Vector2i { 64, 64 });
+    EXPECT_FLOAT_EQ(packer.occupancy(), 0.0f);
+    EXPECT_FALSE(packer.pack(Vector2i { 65, 1 }).has_value());
+    EXPECT_FALSE(packer.pack(Vector2i { 0, 8 }).has_value());
+    EXPECT_EQ(packer.pack(Vector2i { 64, 64 }), (Vector2i { 0, 0 }));
+}
+
+TEST(TextureAtlas, CellsIncludeTheGuttersAndStayAligned) {
+    constexpr int padding = FOW_TEXTURE_ATLAS_PADDING;
+    const auto cell = TextureAtlas::CellSize(Vector2i { 13, 32 });
+    EXPECT_GE(cell.x, 13 + 2 * padding);
+    EXPECT_EQ(cell.y, 32 + 2 * padding);
+    EXPECT_EQ(cell.x % padding, 0);
+    EXPECT_EQ(cell.y % padding, 0);
+
+    // Aligned cells only leave aligned positions, so the texture inside starts on a mip block.
+    MaxRectsPacker packer(Vector2i { 256, 256 });
+    for (const auto& size : { Vector2i { 13, 7 }, Vector2i { 30, 31 }, Vector2i { 1, 1 }, Vector2i { 64, 9 } }) {
+        const auto position = packer.pack(TextureAtlas::CellSize(size));
+        ASSERT_TRUE(position.has_value());
+        EXPECT_EQ(position->x % padding, 0);
+        EXPECT_EQ(position->y % padding, 0);
+    }
+}
+
+TEST(TextureAtlas, RemapsQuadsOntoThePage) {
+    const auto texture = CreateRef<Texture2D>();
+    AtlasRegion region;
+    region.page = CreateRef<Texture2D>();
+    region.uv_offset = { 0.5f, 0.25f };
+    region.uv_scale = { 0.25f, 0.125f };
+
+    SpriteQuad quad;
+    quad.texture = texture;
+    ASSERT_TRUE(RemapToAtlas(quad, region));
+    EXPECT_EQ(quad.texture, region.page);
+    EXPECT_EQ(quad.uv_min, (Vector2 { 0.5f, 0.25f }));
+    EXPECT_EQ(quad.uv_max, (Vector2 { 0.75f, 0.375f }));
+
+    // Repeating UVs would read the neighbours on the page.
+    SpriteQuad tiled;
+    tiled.texture = texture;
+    tiled.uv_max = { 2.0f, 2.0f };
+    EXPECT_FALSE(RemapToAtlas(tiled, region));
+    EXPECT_EQ(tiled.texture, texture);
+
+    SpriteQuad slice;
+    slice.texture = texture;
+    slice.mode = SpriteQuadMode::Stretch;
+    slice.uv_max = { 3.0f, 1.5f };
+    slice.params = Vector4 { 0.25f, 0.0f, 0.5f, 0.25f };
+    ASSERT_TRUE(RemapToAtlas(slice, region));
+    EXPECT_EQ(slice.uv_max, (Vector2 { 3.0f, 1.5f }));
+    EXPECT_EQ(slice.params, (Vector4 { 0.5625f, 0.25f, 0.625f, 0.28125f }));
+}
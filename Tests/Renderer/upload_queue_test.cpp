@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/UploadQueue.hpp"
+
+using namespace fow;
+
+TEST(RingAllocator, AllocatesInOrder) {
+    RingAllocator ring { 256 };
+    EXPECT_EQ(ring.allocate(100), 0u);
+    EXPECT_EQ(ring.allocate(10, 16), 112u);
+    EXPECT_EQ(ring.used(), 122u);
+    EXPECT_EQ(ring.position(), 122u);
+    EXPECT_FALSE(ring.allocate(200).has_value());
+    EXPECT_FALSE(ring.allocate(300).has_value());
+}
+
+TEST(RingAllocator, WrapsAfterRelease) {
+    RingAllocator ring { 256 };
+    ASSERT_TRUE(ring.allocate(100).has_value());
+    const auto first_frame = ring.position();
+    ASSERT_TRUE(ring.allocate(100).has_value());
+    const auto second_frame = ring.position();
+
+    // The tail of the ring is too small, the allocation has to wait for the start to be released.
+    EXPECT_FALSE(ring.allocate(80).has_value());
+    ring.release_until(first_frame);
+    EXPECT_EQ(ring.used(), 100u);
+    EXPECT_EQ(ring.allocate(80), 0u);
+    // Skipped space at the end counts as used until it is released as well.
+    EXPECT_EQ(ring.used(), 236u);
+    EXPECT_FALSE(ring.allocate(40).has_value());
+
+    // The skipped space belongs to the wrapped allocation, so it stays used with it.
+    ring.release_until(second_frame);
+    EXPECT_EQ(ring.used(), 136u);
+    EXPECT_EQ(ring.allocate(40), 80u);
+    ring.release_until(ring.position());
+    EXPECT_EQ(ring.used(), 0u);
+}
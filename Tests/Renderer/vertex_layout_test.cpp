@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+
+#include "fow/Renderer/Mesh.hpp"
+#include "fow/Renderer/VertexLayout.hpp"
+
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+using namespace fow;
+
+TEST(VertexLayout, Strides) {
+    EXPECT_EQ(VertexLayout::Full.stride(), sizeof(Vertex));
+    EXPECT_EQ(VertexLayout::Compact.stride(), 20u);
+    EXPECT_EQ(VertexLayout::Full.shader_flags(), 0u);
+    EXPECT_NE(VertexLayout::Compact.shader_flags() & FOW_VERTEX_FORMAT_OCTAHEDRAL_NORMALS, 0u);
+}
+
+TEST(VertexLayout, OctahedralRoundTrip) {
+    const Vector3 normals[] = {
+        { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+        glm::normalize(Vector3 { 1.0f, 2.0f, -3.0f }), glm::normalize(Vector3 { -0.3f, 0.1f, 0.9f })
+    };
+    for (const auto& normal : normals) {
+        const Vector2 quantized = glm::unpackSnorm2x16(glm::packSnorm2x16(EncodeOctahedral(normal)));
+        EXPECT_GT(glm::dot(DecodeOctahedral(quantized), normal), 0.9999f);
+    }
+}
+
+TEST(VertexLayout, EncodesQuantizedPositions) {
+    const Vector<Vertex> vertices = {
+        Vertex { Vector3 { -2.0f, 0.0f, 1.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector2 { 0.0f, 0.0f } },
+        Vertex { Vector3 {  2.0f, 4.0f, 1.0f }, Vector3 { 0.0f, 1.0f, 0.0f }, Vector3 { 1.0f, 0.0f, 0.0f }, Vector3 { 0.0f, 0.0f, 1.0f }, Vector2 { 1.0f, 0.5f } }
+    };
+    VertexQuantization quantization;
+    const auto data = VertexLayout::Compact.encode(vertices, quantization);
+    ASSERT_EQ(data.size(), vertices.size() * VertexLayout::Compact.stride());
+    EXPECT_EQ(quantization.offset, (Vector3 { -2.0f, 0.0f, 1.0f }));
+    EXPECT_EQ(quantization.scale, (Vector3 { 4.0f, 4.0f, 0.0f }));
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        uint64_t packed;
+        std::memcpy(&packed, data.data() + i * VertexLayout::Compact.stride(), sizeof(packed));
+        const Vector3 position = Vector3(glm::unpackUnorm4x16(packed)) * quantization.scale + quantization.offset;
+        EXPECT_NEAR(glm::distance(position, vertices[i].position), 0.0f, 1e-3f);
+    }
+}
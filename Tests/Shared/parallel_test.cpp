@@ -0,0 +1,25 @@
+#include "gtest/gtest.h"
+
+#include "fow/Shared/Parallel.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace fow;
+
+TEST(Parallel, RunsEveryIndexOnce) {
+    std::vector<std::atomic<int>> counters(1000);
+    ParallelFor(counters.size(), [&](const size_t i) { counters[i].fetch_add(1); }, 8);
+    for (const auto& counter : counters) {
+        EXPECT_EQ(counter.load(), 1);
+    }
+}
+
+TEST(Parallel, SingleThreadRunsInOrder) {
+    std::vector<size_t> order;
+    ParallelFor(5, [&](const size_t i) { order.push_back(i); }, 1);
+    EXPECT_EQ(order, (std::vector<size_t> { 0, 1, 2, 3, 4 }));
+
+    ParallelFor(0, [&](size_t) { order.clear(); });
+    EXPECT_EQ(order.size(), 5u);
+}